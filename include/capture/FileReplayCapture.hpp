@@ -0,0 +1,118 @@
+/**
+ * @file FileReplayCapture.hpp
+ * @brief Screen capture source that replays a dumped capture file
+ */
+
+#ifndef NANOREC_FILEREPLAYCAPTURE_HPP
+#define NANOREC_FILEREPLAYCAPTURE_HPP
+
+#include "IScreenCapture.hpp"
+#include <chrono>
+
+namespace NanoRec
+{
+
+    /**
+     * @class FileReplayCapture
+     * @brief Replays a raw RGB24 or YUV4MPEG2 capture as if it were the screen
+     *
+     * The file is memory-mapped copy-on-write. Raw RGB24 frames are handed
+     * to the pipeline zero-copy through FrameBuffer::borrow(); in-place edits
+     * (redaction, overlay) only touch private pages, which are dropped when
+     * the replay loops. Y4M frames are converted to RGB24 into the buffer.
+     *
+     * In real-time mode captureFrame() returns the frame that would be on
+     * screen at the current wall-clock offset, following the timing trace or
+     * the recorded frame rate, so a slow pipeline drops frames exactly as it
+     * did in production. In maximum-rate mode every call returns the next frame.
+     */
+    class FileReplayCapture : public IScreenCapture
+    {
+    public:
+        struct Options
+        {
+            std::string path;       ///< .y4m, or raw RGB24 frames
+            int width = 0;          ///< Raw frame size (0 = parse "<W>x<H>" from the file name)
+            int height = 0;
+            double fps = 30.0;      ///< Raw frame rate when there is no timing trace
+            std::string timingPath; ///< Optional trace: one timestamp in microseconds per frame
+            bool realtime = true;   ///< Follow recorded timing (false = next frame per call)
+            bool loop = true;       ///< Restart at the end instead of failing
+        };
+
+        explicit FileReplayCapture(const Options &options);
+        ~FileReplayCapture() override;
+
+        bool initialize() override;
+        bool captureFrame(FrameBuffer &buffer) override;
+        int getWidth() const override { return m_width; }
+        int getHeight() const override { return m_height; }
+
+        std::vector<MonitorInfo> enumerateMonitors() override;
+        bool selectMonitor(int monitorId) override { return monitorId <= 0; }
+        int getCurrentMonitor() const override { return -1; }
+
+        std::vector<std::string> getCaptureMethods() const override { return {"replay"}; }
+        bool setCaptureMethod(const std::string &method) override { return method == "replay" || method == "default"; }
+        std::string getCaptureMethod() const override { return "replay"; }
+
+        void shutdown() override;
+
+        size_t getFrameCount() const { return m_frameOffsets.size(); }
+
+        /**
+         * @brief Read "<W>x<H>" from a file name such as capture_1920x1080.rgb
+         * @return true if both dimensions were found
+         */
+        static bool parseSizeFromName(const std::string &path, int &width, int &height);
+
+    private:
+        enum class Format
+        {
+            RawRGB24,
+            Y4M
+        };
+
+        bool mapFile();
+        void unmapFile();
+        bool indexRaw();
+        bool indexY4M();
+        bool loadTiming();
+        size_t selectFrame();
+        void discardPrivatePages(size_t offset, size_t length);
+        void convertY4MFrame(const uint8_t *planes, FrameBuffer &buffer) const;
+
+        Options m_options;
+        Format m_format{Format::RawRGB24};
+        int m_width{0};
+        int m_height{0};
+        bool m_initialized{false};
+
+        // Mapping (copy-on-write)
+        uint8_t *m_mapping{nullptr};
+        size_t m_mappingSize{0};
+#ifdef _WIN32
+        void *m_fileHandle{nullptr};
+        void *m_mappingHandle{nullptr};
+#endif
+
+        // Y4M layout
+        int m_chromaShiftX{1};
+        int m_chromaShiftY{1};
+        bool m_fullRange{false};
+        bool m_monochrome{false};
+
+        std::vector<size_t> m_frameOffsets;  ///< Byte offset of each frame's pixels
+        std::vector<int64_t> m_timestampsUs; ///< Presentation time of each frame from 0
+        int64_t m_durationUs{0};             ///< Loop length
+
+        size_t m_nextFrame{0};
+        size_t m_lastFrame{0};
+        uint64_t m_cycle{0};
+        bool m_started{false};
+        std::chrono::steady_clock::time_point m_startTime;
+    };
+
+} // namespace NanoRec
+
+#endif // NANOREC_FILEREPLAYCAPTURE_HPP
@@ -11,8 +11,10 @@
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <vector>
 #include "MonitorInfo.hpp"
+#include "core/Rect.hpp"
 
 namespace NanoRec
 {
@@ -28,21 +30,45 @@ namespace NanoRec
         int width;     ///< Frame width in pixels
         int height;    ///< Frame height in pixels
         int stride;    ///< Number of bytes per row (may include padding)
+        bool owned;    ///< False when data points into memory owned elsewhere (see borrow())
 
-        FrameBuffer() : data(nullptr), size(0), width(0), height(0), stride(0) {}
+        FrameBuffer() : data(nullptr), size(0), width(0), height(0), stride(0), owned(true) {}
 
         /**
-         * @brief Allocate buffer for frame data
+         * @brief Allocate buffer for frame data (releases any previous allocation)
          * @param w Width in pixels
          * @param h Height in pixels
          */
         void allocate(int w, int h)
         {
+            free();
             width = w;
             height = h;
             stride = width * 3; // RGB24 format
             size = stride * height;
             data = new uint8_t[size];
+            owned = true;
+        }
+
+        /**
+         * @brief Point at pixels owned by someone else (e.g. a file mapping)
+         *
+         * Releases any owned allocation. The memory must stay valid and
+         * writable while the frame is in use; it is never freed here.
+         * @param external Pixel memory
+         * @param w Width in pixels
+         * @param h Height in pixels
+         * @param s Bytes per row
+         */
+        void borrow(uint8_t *external, int w, int h, int s)
+        {
+            free();
+            data = external;
+            width = w;
+            height = h;
+            stride = s;
+            size = static_cast<size_t>(stride) * height;
+            owned = false;
         }
 
         /**
@@ -50,12 +76,13 @@ namespace NanoRec
          */
         void free()
         {
-            if (data)
+            if (data && owned)
             {
                 delete[] data;
-                data = nullptr;
             }
+            data = nullptr;
             size = 0;
+            owned = true;
         }
 
         ~FrameBuffer()
@@ -70,10 +97,11 @@ namespace NanoRec
         // Allow moving
         FrameBuffer(FrameBuffer &&other) noexcept
             : data(other.data), size(other.size), width(other.width),
-              height(other.height), stride(other.stride)
+              height(other.height), stride(other.stride), owned(other.owned)
         {
             other.data = nullptr;
             other.size = 0;
+            other.owned = true;
         }
 
         FrameBuffer &operator=(FrameBuffer &&other) noexcept
@@ -86,8 +114,10 @@ namespace NanoRec
                 width = other.width;
                 height = other.height;
                 stride = other.stride;
+                owned = other.owned;
                 other.data = nullptr;
                 other.size = 0;
+                other.owned = true;
             }
             return *this;
         }
@@ -149,6 +179,73 @@ namespace NanoRec
          */
         virtual int getCurrentMonitor() const = 0;
 
+        /**
+         * @brief Sample the pointer position and button/modifier state
+         * @param x Pointer X in desktop coordinates
+         * @param y Pointer Y in desktop coordinates
+         * @param buttons Backend-specific button/modifier mask
+         * @return false if the backend cannot report input
+         */
+        virtual bool queryPointer(int &x, int &y, unsigned int &buttons)
+        {
+            (void)x;
+            (void)y;
+            (void)buttons;
+            return false;
+        }
+
+        /**
+         * @brief Start or stop listening for raw keyboard/pointer events
+         * @param enabled Listen while true
+         * @return false if the backend cannot report input events
+         */
+        virtual bool setInputEvents(bool enabled)
+        {
+            (void)enabled;
+            return false;
+        }
+
+        /**
+         * @brief Drain input events received since the last poll
+         *
+         * Must be called from the capturing thread (it shares the backend's
+         * connection) and regularly while listening, so events do not queue up.
+         * @return Number of events, or -1 if not listening
+         */
+        virtual int pollInputEvents() { return -1; }
+
+        /**
+         * @brief Areas that changed in the frame returned by the last captureFrame()
+         *
+         * Backends that receive damage (e.g. RFB rectangles) report it so
+         * change-aware stages only re-examine those areas.
+         * @param rects Receives the changed rectangles (may be empty: nothing changed)
+         * @return false if unknown (first frame, size change, or the backend cannot tell)
+         */
+        virtual bool getDirtyRects(std::vector<Rect> &rects) const
+        {
+            (void)rects;
+            return false;
+        }
+
+        /**
+         * @brief List the capture methods this backend supports
+         * @return Method names; the first one is the default
+         */
+        virtual std::vector<std::string> getCaptureMethods() const { return {"default"}; }
+
+        /**
+         * @brief Switch the capture method (e.g. "xgetimage" or "xshm" on X11)
+         * @param method One of getCaptureMethods()
+         * @return true if the method is now active
+         */
+        virtual bool setCaptureMethod(const std::string &method) { return method == "default"; }
+
+        /**
+         * @brief Get the active capture method
+         */
+        virtual std::string getCaptureMethod() const { return "default"; }
+
         /**
          * @brief Shutdown and cleanup resources
          */
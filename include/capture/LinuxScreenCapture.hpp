@@ -16,6 +16,14 @@
 #include <X11/Xutil.h>
 #include <X11/extensions/Xrandr.h>
 
+#ifdef NANOREC_HAVE_XSHM
+#include <X11/extensions/XShm.h>
+#endif
+
+#ifdef NANOREC_HAVE_XINPUT2
+#include <X11/extensions/XInput2.h>
+#endif
+
 namespace NanoRec
 {
 
@@ -23,8 +31,12 @@ namespace NanoRec
      * @class LinuxScreenCapture
      * @brief X11-based screen capture for Linux systems
      *
-     * Uses XGetImage to capture the root window (desktop) contents.
-     * Supports multi-monitor enumeration via XRandR extension.
+     * Uses XGetImage to capture the root window (desktop) contents, or
+     * XShmGetImage into a reused shared-memory image when the MIT-SHM
+     * extension is available ("xshm" capture method).
+     * Supports multi-monitor enumeration via XRandR extension. With XInput2,
+     * raw keyboard/pointer events are selected on the same connection so the
+     * capture loop can raise its rate on input.
      */
     class LinuxScreenCapture : public IScreenCapture
     {
@@ -40,6 +52,13 @@ namespace NanoRec
         std::vector<MonitorInfo> enumerateMonitors() override;
         bool selectMonitor(int monitorId) override;
         int getCurrentMonitor() const override { return m_selectedMonitor; }
+        bool queryPointer(int &x, int &y, unsigned int &buttons) override;
+        bool setInputEvents(bool enabled) override;
+        int pollInputEvents() override;
+
+        std::vector<std::string> getCaptureMethods() const override;
+        bool setCaptureMethod(const std::string &method) override;
+        std::string getCaptureMethod() const override { return m_useShm ? "xshm" : "xgetimage"; }
         
         void shutdown() override;
 
@@ -57,6 +76,24 @@ namespace NanoRec
         int m_captureX, m_captureY;      ///< Capture region position
         int m_captureWidth, m_captureHeight; ///< Capture region size
 
+        bool m_useShm;                   ///< Capture via XShmGetImage
+        bool m_inputEvents;              ///< XInput2 raw events selected on the root window
+        int m_xiOpcode;                  ///< XInputExtension major opcode (-1 = not queried/absent)
+#ifdef NANOREC_HAVE_XSHM
+        XImage *m_shmImage;              ///< Shared-memory image (sized to capture region)
+        XShmSegmentInfo m_shmInfo;       ///< Attached SysV segment
+
+        /**
+         * @brief (Re)create the shared-memory image for the capture region
+         */
+        bool createShmImage();
+
+        /**
+         * @brief Detach and free the shared-memory image
+         */
+        void destroyShmImage();
+#endif
+
         /**
          * @brief Convert X11 image data to RGB24 format
          * @param ximage X11 image structure
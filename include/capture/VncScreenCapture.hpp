@@ -0,0 +1,128 @@
+/**
+ * @file VncScreenCapture.hpp
+ * @brief Screen capture source that records a remote desktop over RFB (VNC)
+ * @author NanoRec-CPP Team
+ * @date 2026-10-18
+ */
+
+#ifndef NANOREC_VNCSCREENCAPTURE_HPP
+#define NANOREC_VNCSCREENCAPTURE_HPP
+
+#include "IScreenCapture.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+struct z_stream_s;
+
+namespace NanoRec
+{
+
+    /**
+     * @class VncScreenCapture
+     * @brief RFB client that keeps a persistent copy of the remote framebuffer
+     *
+     * A receiver thread decodes Raw, CopyRect and (with zlib) ZRLE rectangles
+     * straight into an RGB24 frame and follows DesktopSize changes. Updates
+     * are pulled: each captureFrame() asks for the next incremental update,
+     * so the server only sends what changed, at most once per captured frame.
+     * captureFrame() copies the current frame (in-place edits downstream
+     * never reach it) and getDirtyRects() reports the rectangles applied
+     * since the previous call, so change detection only re-hashes those.
+     *
+     * Supports RFB 3.3/3.7/3.8 with security type None (e.g. x11vnc -nopw on
+     * localhost, or a password-less server behind an SSH tunnel).
+     */
+    class VncScreenCapture : public IScreenCapture
+    {
+    public:
+        struct Options
+        {
+            std::string host = "127.0.0.1";
+            int port = 5900;
+            bool shared = true;      ///< Leave other viewers connected
+            int connectTimeoutMs = 5000;
+        };
+
+        explicit VncScreenCapture(const Options &options);
+        ~VncScreenCapture() override;
+
+        /**
+         * @brief Parse "host", "host:display" (display < 100, port 5900 + display) or "host:port"
+         * @return false if the address is malformed
+         */
+        static bool parseAddress(const std::string &address, std::string &host, int &port);
+
+        bool initialize() override;
+        bool captureFrame(FrameBuffer &buffer) override;
+        int getWidth() const override { return m_width.load(); }
+        int getHeight() const override { return m_height.load(); }
+
+        std::vector<MonitorInfo> enumerateMonitors() override;
+        bool selectMonitor(int monitorId) override { return monitorId <= 0; }
+        int getCurrentMonitor() const override { return -1; }
+
+        bool getDirtyRects(std::vector<Rect> &rects) const override;
+
+        std::vector<std::string> getCaptureMethods() const override { return {"rfb"}; }
+        bool setCaptureMethod(const std::string &method) override { return method == "rfb" || method == "default"; }
+        std::string getCaptureMethod() const override { return "rfb"; }
+
+        void shutdown() override;
+
+        /**
+         * @brief Desktop name announced by the server
+         */
+        const std::string &getDesktopName() const { return m_desktopName; }
+
+    private:
+        bool connectSocket();
+        bool handshake();
+        bool readExact(void *data, size_t size);
+        bool sendAll(const void *data, size_t size);
+        bool readReason(std::string &reason);
+        bool requestUpdate(bool incremental);
+
+        void receiveLoop();
+        bool readFramebufferUpdate();
+        bool decodeRaw(const Rect &rect);
+        bool decodeCopyRect(const Rect &rect);
+        bool decodeZrle(const Rect &rect);
+        bool inflateZrle(size_t compressedSize);
+        void resizeFrame(int width, int height);
+        void markDirty(const Rect &rect);
+
+        Options m_options;
+        int m_socket{-1};
+        std::string m_desktopName;
+
+        std::thread m_receiver;
+        std::atomic<bool> m_connected{false};
+        std::atomic<bool> m_requestPending{false}; ///< An update request is outstanding
+        std::atomic<bool> m_fullUpdate{true};      ///< Next request must be non-incremental
+        std::atomic<int> m_width{0};
+        std::atomic<int> m_height{0};
+
+        // Shared between the receiver and captureFrame()
+        std::mutex m_frameMutex;
+        std::condition_variable m_updated;
+        FrameBuffer m_frame;              ///< Persistent RGB24 copy of the remote desktop
+        std::vector<Rect> m_pendingDirty; ///< Applied since the last captureFrame()
+        bool m_pendingComplete{false};    ///< m_pendingDirty covers every change (no resize)
+        uint64_t m_updates{0};            ///< Completed framebuffer updates
+
+        // Handed out by getDirtyRects() (capture thread only)
+        std::vector<Rect> m_lastDirty;
+        bool m_lastDirtyKnown{false};
+
+        // Receiver only
+        std::vector<uint8_t> m_scratch;
+        std::vector<uint8_t> m_compressed;
+        std::unique_ptr<z_stream_s> m_zlib; ///< One stream for the whole connection (ZRLE)
+    };
+
+} // namespace NanoRec
+
+#endif // NANOREC_VNCSCREENCAPTURE_HPP
@@ -39,6 +39,7 @@ namespace NanoRec
         std::vector<MonitorInfo> enumerateMonitors() override { return {}; }
         bool selectMonitor(int monitorId) override { return true; }
         int getCurrentMonitor() const override { return -1; }
+        bool queryPointer(int &x, int &y, unsigned int &buttons) override;
         
         void shutdown() override;
 
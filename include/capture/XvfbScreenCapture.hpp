@@ -0,0 +1,104 @@
+/**
+ * @file XvfbScreenCapture.hpp
+ * @brief Capture straight from Xvfb's memory-mapped framebuffer file
+ * @author NanoRec-CPP Team
+ * @date 2026-10-18
+ */
+
+#ifndef NANOREC_XVFBSCREENCAPTURE_HPP
+#define NANOREC_XVFBSCREENCAPTURE_HPP
+
+#include "IScreenCapture.hpp"
+
+#ifdef __linux__
+
+#include "LinuxScreenCapture.hpp"
+
+namespace NanoRec
+{
+
+    /**
+     * @class XvfbScreenCapture
+     * @brief Reads pixels from the XWD file Xvfb keeps its screen in (`Xvfb -fbdir DIR`)
+     *
+     * Xvfb started with -fbdir mmaps DIR/Xvfb_screenN as its framebuffer, so
+     * mapping the same file shared gives the live screen with no X protocol
+     * round trip and no intermediate image: rows are converted to RGB24
+     * directly from the mapping ("xvfb" capture method). Everything else
+     * (monitors, pointer, input events) and the fallback go through a
+     * LinuxScreenCapture on the same display; if the file is missing, has an
+     * unsupported pixel layout or shrinks (server exit), capture continues
+     * with XShm/XGetImage. Reads are not synchronized with the server, so a
+     * frame may show a drawing operation half done.
+     */
+    class XvfbScreenCapture : public IScreenCapture
+    {
+    public:
+        /**
+         * @param framebufferPath XWD file of the screen to capture (see findFramebuffer())
+         */
+        explicit XvfbScreenCapture(const std::string &framebufferPath);
+        ~XvfbScreenCapture() override;
+
+        /**
+         * @brief Locate the framebuffer file of the Xvfb serving $DISPLAY
+         *
+         * Uses $NANOREC_XVFB_FRAMEBUFFER if set (e.g. Xvfb in another container
+         * sharing the directory), otherwise looks for a local Xvfb process for
+         * the display number that was started with -fbdir.
+         * @return File path, or empty if $DISPLAY is not such an Xvfb
+         */
+        static std::string findFramebuffer();
+
+        bool initialize() override;
+        bool captureFrame(FrameBuffer &buffer) override;
+        int getWidth() const override { return m_x11.getWidth(); }
+        int getHeight() const override { return m_x11.getHeight(); }
+
+        std::vector<MonitorInfo> enumerateMonitors() override { return m_x11.enumerateMonitors(); }
+        bool selectMonitor(int monitorId) override;
+        int getCurrentMonitor() const override { return m_x11.getCurrentMonitor(); }
+        bool queryPointer(int &x, int &y, unsigned int &buttons) override { return m_x11.queryPointer(x, y, buttons); }
+        bool setInputEvents(bool enabled) override { return m_x11.setInputEvents(enabled); }
+        int pollInputEvents() override { return m_x11.pollInputEvents(); }
+
+        std::vector<std::string> getCaptureMethods() const override;
+        bool setCaptureMethod(const std::string &method) override;
+        std::string getCaptureMethod() const override { return m_useFramebuffer ? "xvfb" : m_x11.getCaptureMethod(); }
+
+        void shutdown() override;
+
+    private:
+        /**
+         * @brief Map the file and check it matches the display (size, 24/32-bit TrueColor)
+         */
+        bool mapFramebuffer();
+        void unmapFramebuffer();
+
+        /**
+         * @brief Cache the selected monitor's offset inside the framebuffer
+         */
+        void updateRegion();
+
+        LinuxScreenCapture m_x11; ///< Display connection, monitors, input and fallback capture
+        std::string m_path;
+
+        int m_fd;
+        uint8_t *m_mapping;
+        size_t m_mappingSize;
+        const uint8_t *m_pixels; ///< First pixel row inside the mapping
+        int m_screenWidth;
+        int m_screenHeight;
+        int m_bytesPerLine;
+        int m_bytesPerPixel;     ///< 4 (BGRX) or 3 (BGR)
+
+        int m_regionX;
+        int m_regionY;
+        bool m_useFramebuffer;
+    };
+
+} // namespace NanoRec
+
+#endif // __linux__
+
+#endif // NANOREC_XVFBSCREENCAPTURE_HPP
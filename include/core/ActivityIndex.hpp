@@ -0,0 +1,177 @@
+#pragma once
+
+#include "core/Rect.hpp"
+#include "core/TileChangeMap.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace NanoRec
+{
+
+    /**
+     * @struct ActivitySecond
+     * @brief Activity summary for one second of a recording
+     */
+    struct ActivitySecond
+    {
+        float changedFraction{0.0f}; ///< Mean fraction of the frame that changed per frame with change data (0..1)
+        float peakFraction{0.0f};    ///< Largest single-frame change in this second (0..1)
+        Rect changedBounds;          ///< Union of changed regions (capture pixels)
+        int inputSamples{0};         ///< Pointer samples that saw movement or button changes
+        int frames{0};               ///< Frames summarized
+
+        bool isActive(float minFraction) const { return peakFraction >= minFraction || inputSamples > 0; }
+    };
+
+    /**
+     * @class ActivityIndexWriter
+     * @brief Writes the per-second activity sidecar while recording
+     *
+     * Fed from the capture thread with the change data the frame already
+     * has, so recording adds no hashing: the tile change map when adaptive
+     * rate or a change wait hashed the frame, else the damage rectangles the
+     * source reported. Frames with neither count only pointer activity. One
+     * fixed-size record is appended per second of video, which keeps the
+     * file valid if recording is interrupted.
+     */
+    class ActivityIndexWriter
+    {
+    public:
+        ~ActivityIndexWriter();
+
+        /**
+         * @brief Create the sidecar for a recording
+         * @param path Sidecar path (see ActivityIndex::sidecarPath)
+         * @param width Capture width in pixels
+         * @param height Capture height in pixels
+         * @param fps Recording frame rate (frames per record)
+         * @return true if the file was created
+         */
+        bool open(const std::string &path, int width, int height, int fps);
+
+        /**
+         * @brief Account one recorded frame
+         * @param changes Change map updated for this frame
+         * @param inputActive Whether an input sample during this frame saw activity
+         * @param inputSampled Whether input was sampled during this frame
+         */
+        void addFrame(const TileChangeMap &changes, bool inputActive, bool inputSampled);
+
+        /**
+         * @brief Account one recorded frame from the source's damage
+         * @param damage Rectangles that changed since the previous frame (capture pixels)
+         */
+        void addFrame(const std::vector<Rect> &damage, bool inputActive, bool inputSampled);
+
+        /**
+         * @brief Account one recorded frame whose content change is unknown (only input counts)
+         */
+        void addFrame(bool inputActive, bool inputSampled);
+
+        /**
+         * @brief Account frame slots the previous frame covered while capture was idle
+         * @param count Number of held (unchanged, input-free) slots
+         */
+        void addRepeatedFrames(int64_t count);
+
+        /**
+         * @brief Whether the current second has no measured change yet
+         *
+         * Sources without damage hash a frame for the sidecar when this is
+         * true, so every second gets a change sample (taken against the
+         * previous sample) without hashing every frame.
+         */
+        bool wantsChangeSample();
+
+        /**
+         * @brief Flush the partial last second and close the file
+         */
+        void close();
+
+        bool isOpen() const { return m_file != nullptr; }
+
+    private:
+        /**
+         * @brief Add a frame to the current second (m_mutex held)
+         * @param fraction Changed fraction, or negative if unknown
+         */
+        void account(double fraction, const Rect &bounds, bool inputActive, bool inputSampled);
+        void flushSecond();
+
+        std::mutex m_mutex;
+        std::FILE *m_file{nullptr};
+        int m_width{0};
+        int m_height{0};
+        int m_fps{30};
+        ActivitySecond m_current;
+        double m_fractionSum{0.0};
+        int m_measuredFrames{0}; ///< Frames of the current second with a known change
+        bool m_firstFrame{true};
+    };
+
+    /**
+     * @class ActivityIndex
+     * @brief Reader for the activity sidecar written next to each recording
+     *
+     * Lets the player and clip tools find where something happened in a long
+     * recording without decoding any video.
+     */
+    class ActivityIndex
+    {
+    public:
+        /**
+         * @brief Sidecar path for a recording ("<recording>.activity")
+         */
+        static std::string sidecarPath(const std::string &recordingPath);
+
+        /**
+         * @brief Load the sidecar of a recording
+         * @param recordingPath Video file (the sidecar path is derived from it)
+         * @return true if a valid sidecar was read
+         */
+        bool load(const std::string &recordingPath);
+
+        void clear();
+
+        bool isLoaded() const { return !m_seconds.empty(); }
+        int getWidth() const { return m_width; }
+        int getHeight() const { return m_height; }
+        int getFps() const { return m_fps; }
+        const std::vector<ActivitySecond> &getSeconds() const { return m_seconds; }
+
+        /**
+         * @brief First active second after the current one's activity burst
+         * @param second Current second
+         * @param minFraction Changed fraction that counts as activity
+         * @return Second index, or -1 if there is none
+         */
+        int findNext(int second, float minFraction) const;
+
+        /**
+         * @brief Start of the activity burst before the current second
+         * @return Second index, or -1 if there is none
+         */
+        int findPrevious(int second, float minFraction) const;
+
+        /**
+         * @brief Active span around a second, merging gaps up to maxGap seconds
+         * @param second Second inside (or next to) the span
+         * @param first First active second of the span
+         * @param last Last active second of the span
+         * @return false if no activity is near the second
+         */
+        bool findSpan(int second, float minFraction, int maxGap, int &first, int &last) const;
+
+    private:
+        bool active(int second, float minFraction) const;
+
+        int m_width{0};
+        int m_height{0};
+        int m_fps{0};
+        std::vector<ActivitySecond> m_seconds;
+    };
+
+} // namespace NanoRec
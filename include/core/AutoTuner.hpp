@@ -0,0 +1,104 @@
+#pragma once
+
+#include "capture/IScreenCapture.hpp"
+#include "core/Config.hpp"
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace NanoRec
+{
+
+    /**
+     * @struct PipelineCandidate
+     * @brief One combination of capture/scale/encode settings to benchmark
+     */
+    struct PipelineCandidate
+    {
+        std::string captureMethod{"default"};
+        int scalerThreads{1};
+        std::string pixelFormat{"yuv420p"};
+        std::string preset{"veryfast"};
+
+        std::string describe() const;
+    };
+
+    /**
+     * @struct PipelineMeasurement
+     * @brief Result of running one candidate
+     */
+    struct PipelineMeasurement
+    {
+        PipelineCandidate candidate;
+        double fps{0.0};          ///< Frames per second through capture -> scale -> encoder pipe
+        double captureMs{0.0};    ///< Average capture time per frame
+        double scaleMs{0.0};      ///< Average scaling time per frame
+        bool sustained{false};    ///< fps meets the target with headroom
+    };
+
+    /**
+     * @brief Benchmarks pipeline configurations on this machine and display
+     *
+     * Runs each candidate unthrottled for a few seconds through the real
+     * capture backend, FrameScaler and an FFmpegVideoWriter writing to a
+     * temporary file, so the measured rate includes the encoder consuming the
+     * pipe. Stages are tuned in order (capture method, scaler threads, then
+     * preset x pixel format) holding earlier winners fixed, which keeps the
+     * run to a couple of dozen candidates instead of the full cross product.
+     * The fastest candidate that sustains the target fps wins.
+     */
+    class AutoTuner
+    {
+    public:
+        struct Options
+        {
+            int targetFps = 30;                ///< Rate the pipeline must sustain
+            int outputWidth = 0;               ///< Recording width (0 = native)
+            int outputHeight = 0;              ///< Recording height (0 = native)
+            double secondsPerCandidate = 2.0;  ///< Measurement time per candidate
+            double headroom = 1.1;             ///< Required fps / target ratio
+            std::vector<std::string> presets{"ultrafast", "superfast", "veryfast", "faster", "fast"};
+            std::vector<std::string> pixelFormats{"yuv420p", "nv12"};
+        };
+
+        /**
+         * @param capture Initialized capture backend (must not be used by another thread meanwhile)
+         */
+        explicit AutoTuner(IScreenCapture *capture);
+
+        /**
+         * @brief Run the benchmark
+         * @param options Target and candidate lists
+         * @param best Fastest candidate that sustains the target (fastest overall if none does)
+         * @return true if at least one candidate could be measured
+         */
+        bool run(const Options &options, PipelineCandidate &best);
+
+        /**
+         * @brief Abort a running benchmark (from another thread)
+         */
+        void cancel() { m_cancelled.store(true); }
+
+        /**
+         * @brief Progress of the current run (0..1)
+         */
+        float getProgress() const { return m_progress.load(); }
+
+        const std::vector<PipelineMeasurement> &getMeasurements() const { return m_measurements; }
+
+        /**
+         * @brief Store a candidate in the configuration
+         */
+        static void apply(const PipelineCandidate &candidate, Config &config);
+
+    private:
+        bool measure(const PipelineCandidate &candidate, const Options &options, PipelineMeasurement &result);
+        const PipelineMeasurement *pickBest(size_t firstIndex, bool requireSustained) const;
+
+        IScreenCapture *m_capture;
+        std::vector<PipelineMeasurement> m_measurements;
+        std::atomic<float> m_progress{0.0f};
+        std::atomic<bool> m_cancelled{false};
+    };
+
+} // namespace NanoRec
@@ -0,0 +1,128 @@
+/**
+ * @file BufferedVideoWriter.hpp
+ * @brief Bounded frame queue that keeps a slow encoder off the capture thread
+ * @author NanoRec-CPP Team
+ * @date 2026-10-18
+ */
+
+#ifndef NANOREC_BUFFEREDVIDEOWRITER_HPP
+#define NANOREC_BUFFEREDVIDEOWRITER_HPP
+
+#include "IVideoWriter.hpp"
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace NanoRec
+{
+
+    /**
+     * @class BufferedVideoWriter
+     * @brief Hands frames to another writer from a worker thread, through a bounded queue
+     *
+     * writeFrame() copies the frame and returns; the worker feeds the wrapped
+     * encoder in order. When maxQueuedFrames are waiting, further frames
+     * are either dropped (writeFrame() returns false) or, with spilling on,
+     * appended to a raw spill file next to the recording until it reaches
+     * maxSpillBytes. Once the encoder catches up the spill file is replayed
+     * in order and new frames go back to the memory queue. If the encoder
+     * goes away, isActive() turns false so the caller can recover.
+     */
+    class BufferedVideoWriter : public IVideoWriter
+    {
+    public:
+        struct Options
+        {
+            int maxQueuedFrames = 8;
+            bool spill = false;                    ///< Overflow to disk instead of dropping
+            uint64_t maxSpillBytes = 256ull << 20; ///< Spill backlog limit (then frames are dropped)
+        };
+
+        BufferedVideoWriter(std::unique_ptr<IVideoWriter> encoder, const Options &options);
+        ~BufferedVideoWriter() override;
+
+        /**
+         * @brief Initialize the wrapped encoder and start the worker
+         */
+        bool initialize(const VideoConfig &config) override;
+
+        /**
+         * @brief Queue a copy of the frame (never waits for the encoder)
+         * @return false if the frame was dropped (queue and spill full, or encoder lost)
+         */
+        bool writeFrame(const uint8_t *frameData, size_t dataSize) override;
+
+        /**
+         * @brief Queue a copy of the frame with its presentation time
+         */
+        bool writeFrameAt(const uint8_t *frameData, size_t dataSize, int64_t pts) override;
+
+        /**
+         * @brief Passed on to the encoder once the queue is drained
+         */
+        void setEndTime(int64_t pts) override;
+
+        /**
+         * @brief Drain the queue and spill file into the encoder, then finalize it
+         */
+        bool finalize() override;
+        bool isActive() const override;
+
+        uint64_t getBytesWritten() const override { return m_encoder->getBytesWritten(); }
+        EncoderUsage getEncoderUsage() const override { return m_encoder->getEncoderUsage(); }
+        bool getQueueStats(WriterQueueStats &stats) const override;
+        bool getWorkerThread(std::thread::native_handle_type &thread) override;
+
+    private:
+        struct QueuedFrame
+        {
+            std::vector<uint8_t> data;
+            int64_t pts; ///< -1 for frames written without a time
+        };
+
+        /**
+         * @brief Queue (or spill) a frame; pts -1 = untimed
+         */
+        bool enqueue(const uint8_t *frameData, size_t dataSize, int64_t pts);
+
+        void workerLoop();
+
+        /**
+         * @brief Append a frame to the spill file (called with m_mutex held)
+         */
+        bool spillFrame(const uint8_t *frameData, size_t dataSize, int64_t pts);
+
+        std::unique_ptr<IVideoWriter> m_encoder;
+        Options m_options;
+        VideoConfig m_config;
+        std::string m_spillPath;
+        std::thread m_worker;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_changed;
+        std::deque<QueuedFrame> m_queue;
+        std::vector<std::vector<uint8_t>> m_pool; ///< Recycled frame copies
+        bool m_active{false};
+        bool m_finishing{false};
+        int64_t m_endPts{-1}; ///< setEndTime(), forwarded after the drain
+
+        // Spill file: frames [m_spillRead, m_spillWritten) wait on disk; while any do, new frames go there too
+        std::ofstream m_spillOut;
+        std::ifstream m_spillIn;
+        bool m_spilling{false};
+        uint64_t m_spillWritten{0};
+        uint64_t m_spillRead{0};
+        size_t m_spillFrameSize{0};
+        std::deque<int64_t> m_spillPts; ///< Times of the frames waiting on disk
+
+        WriterQueueStats m_stats;
+    };
+
+} // namespace NanoRec
+
+#endif // NANOREC_BUFFEREDVIDEOWRITER_HPP
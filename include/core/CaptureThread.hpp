@@ -1,24 +1,86 @@
 #pragma once
 
 #include "capture/IScreenCapture.hpp"
+#include "core/ActivityIndex.hpp"
+#include "core/ChangeWaiter.hpp"
 #include "core/ThreadSafeFrameBuffer.hpp"
 #include "core/FFmpegVideoWriter.hpp"
+#include "core/FramePipeline.hpp"
+#include "core/MjpegPreviewServer.hpp"
+#include "core/RecordingStats.hpp"
+#include "core/RedactionFilter.hpp"
+#include "core/TextOverlay.hpp"
+#include "core/TileChangeMap.hpp"
+#include "core/YuvConverter.hpp"
 #include <atomic>
-#include <thread>
+#include <chrono>
+#include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace NanoRec
 {
 
+    /**
+     * @brief Capture/recording parameters that can change while the thread runs
+     *
+     * Published as immutable snapshots; the capture loop adopts the latest one
+     * at a frame boundary. Cheap fields take effect on the next frame; a
+     * change that alters the encoded stream rolls the recording over to a new
+     * segment file.
+     */
+    struct CaptureSettings
+    {
+        static constexpr int CURRENT_MONITOR = -2; ///< Keep the capture source's selection
+
+        int monitor{CURRENT_MONITOR}; ///< Monitor index, -1 = all monitors
+        int fps{30};                  ///< Capture and recording rate
+        int targetWidth{0};           ///< Recording width (0 = native resolution)
+        int targetHeight{0};          ///< Recording height (0 = native resolution)
+        std::string preset{"medium"};
+        std::string pixelFormat{"yuv420p"};
+        int scalerThreads{1};         ///< Most bands a pipeline stage is split into on the worker pool
+        int stripeRows{0};            ///< Stripe processing of the encoder frame (0 = whole frames)
+        std::string pipeline{FramePipeline::DEFAULT_SPEC}; ///< Stage graph (see FramePipeline)
+        int previewFps{0};            ///< UI preview rate cap (0 = every captured frame)
+        bool adaptiveRate{false};     ///< Capture at fps only around input/motion (variable frame rate video)
+        int idleFps{2};               ///< Capture rate the adaptive mode decays to
+        bool overlayEnabled{true};    ///< Burn in the attached overlay
+        int encoderQueueFrames{0};    ///< Frames buffered ahead of the encoder (0 = write on the capture thread)
+        bool encoderSpill{false};     ///< Overflow the encoder queue to disk instead of dropping frames
+        int encoderSpillMb{256};      ///< Spill backlog limit
+        int encoderRestarts{0};       ///< New segments opened per recording when the encoder dies
+
+        /**
+         * @brief Whether switching from @p other changes the encoder parameters
+         *
+         * Resolution changes caused by a monitor switch are detected by the
+         * capture loop, which knows the new capture size. Queue settings
+         * apply from the next segment on.
+         */
+        bool encoderDiffers(const CaptureSettings &other) const
+        {
+            return fps != other.fps || targetWidth != other.targetWidth || targetHeight != other.targetHeight ||
+                   preset != other.preset || pixelFormat != other.pixelFormat;
+        }
+    };
+
     /**
      * @brief Background thread for screen capture and recording
      *
      * Runs screen capture in a separate thread to keep UI responsive.
-     * Optionally records frames to video file via FFmpegVideoWriter.
+     * Optionally records frames to video file via FFmpegVideoWriter (or
+     * another IVideoWriter, see setVideoWriterFactory()).
      */
     class CaptureThread
     {
     public:
+        using VideoWriterFactory = std::function<std::unique_ptr<IVideoWriter>()>;
+
         CaptureThread();
         ~CaptureThread();
 
@@ -37,7 +99,7 @@ namespace NanoRec
 
         /**
          * @brief Start recording to file
-         * @param filename Output filename
+         * @param filename Output filename (first segment; later segments get a _partN suffix)
          * @param fps Frames per second
          * @param targetWidth Target width (0 = native resolution)
          * @param targetHeight Target height (0 = native resolution)
@@ -46,11 +108,70 @@ namespace NanoRec
         bool startRecording(const std::string &filename, int fps = 30, 
                           int targetWidth = 0, int targetHeight = 0);
 
+        /**
+         * @brief Encoder and scaler settings (published like applySettings())
+         * @param preset x264 preset
+         * @param pixelFormat Encoded pixel format
+         * @param scalerThreads Most bands a pipeline stage is split into on the worker pool
+         * @return true (kept for callers that checked the old recording-only restriction)
+         */
+        bool setEncoderSettings(const std::string &preset, const std::string &pixelFormat, int scalerThreads);
+
+        /**
+         * @brief Publish a new settings snapshot
+         *
+         * Never blocks on the capture loop: the loop picks the snapshot up at
+         * its next frame boundary. While recording, encoder changes (resolution,
+         * fps, preset, pixel format, or a monitor with a different size at
+         * native resolution) finalize the current file and continue in a new
+         * segment.
+         */
+        void applySettings(const CaptureSettings &settings);
+
+        /**
+         * @brief Latest published settings
+         */
+        CaptureSettings getSettings() const;
+
+        /**
+         * @brief Files written by the current (or last) recording, in order
+         */
+        std::vector<std::string> getSegments() const;
+
         /**
          * @brief Stop recording
+         *
+         * Each finalized segment gets a <segment>.stats.json resource report
+         * (CPU per thread and for ffmpeg, memory, bytes piped, frame counts,
+         * stage latency percentiles, encoder queue). Also waits for segments
+         * still finalizing after the recording ended on its own (encoder lost).
          */
         void stopRecording();
 
+        /**
+         * @brief Attach an MJPEG preview server that receives captured frames
+         * @param server Preview server (nullptr to detach); must outlive the capture thread
+         */
+        void setPreviewServer(MjpegPreviewServer *server) { m_previewServer.store(server); }
+
+        /**
+         * @brief Attach a timestamp/label overlay burned into recorded frames
+         * @param overlay Configured overlay (nullptr to detach); used only by the capture thread
+         */
+        void setOverlay(TextOverlay *overlay) { m_overlay.store(overlay); }
+
+        /**
+         * @brief Attach a window redaction filter applied before any consumer sees a frame
+         * @param filter Running filter (nullptr to detach); must outlive the capture thread
+         */
+        void setRedactionFilter(RedactionFilter *filter) { m_redactionFilter.store(filter); }
+
+        /**
+         * @brief Choose the encoder sink for segments opened from now on
+         * @param factory Creates one writer per segment (empty = local FFmpegVideoWriter)
+         */
+        void setVideoWriterFactory(VideoWriterFactory factory);
+
         /**
          * @brief Check if thread is running
          */
@@ -66,26 +187,95 @@ namespace NanoRec
          */
         double getCurrentFPS() const { return m_currentFPS.load(); }
 
+        /**
+         * @brief Fraction of the frame budget spent on capture + encode (smoothed)
+         *
+         * 1.0 means each frame takes exactly 1/fps; above that the loop falls behind.
+         */
+        double getBudgetUsage() const { return m_budgetUsage.load(); }
+
+        /**
+         * @brief Whether adaptive rate currently captures below the configured fps
+         */
+        bool isIdle() const { return m_idle.load(); }
+
+        /**
+         * @brief Screen-stability and region-change waits answered from the tile hashes
+         *
+         * Safe to use from any thread; waits fail early when the capture thread stops.
+         */
+        ChangeWaiter &getChangeWaiter() { return m_changeWaiter; }
+
     private:
         void captureLoop();
+        std::shared_ptr<const CaptureSettings> getSettingsSnapshot() const;
+        bool adoptSettings();
+        VideoConfig segmentConfig(const CaptureSettings &settings, const std::string &filename) const;
+        bool openSegment(const CaptureSettings &settings);
+        void retireWriter();
+        bool advanceSegmentClock(const CaptureSettings &settings);
+        void rebuildPipeline(const CaptureSettings &settings);
+        void writeEncoderFrame(const PipelineFrame &frame);
+        void writeSegmentFrame(const uint8_t *data, size_t size);
+        void skipSlots(int64_t count);
+        void endSegmentClock();
+        void recoverEncoder();
 
         std::thread m_thread;
         std::atomic<bool> m_running{false};
         std::atomic<bool> m_shouldStop{false};
         std::atomic<bool> m_recording{false};
         std::atomic<double> m_currentFPS{0.0};
+        std::atomic<double> m_budgetUsage{0.0};
+        std::atomic<bool> m_idle{false};
 
         IScreenCapture *m_screenCapture{nullptr};
         ThreadSafeFrameBuffer *m_frameBuffer{nullptr};
-        std::unique_ptr<FFmpegVideoWriter> m_videoWriter;
+        std::atomic<MjpegPreviewServer *> m_previewServer{nullptr};
+        std::atomic<TextOverlay *> m_overlay{nullptr};
+        std::atomic<RedactionFilter *> m_redactionFilter{nullptr};
+        std::unique_ptr<IVideoWriter> m_videoWriter;
+        VideoWriterFactory m_videoWriterFactory; ///< Guarded by m_recordingMutex
 
+        // Segments finalized in the background after a rollover (joined by stopRecording)
+        std::vector<std::future<void>> m_retiredWriters;
+
+        // Change map shared by adaptive rate, the activity sidecar and change waits
+        TileChangeMap m_changeMap;
+        ActivityIndexWriter m_activityWriter;
+        ChangeWaiter m_changeWaiter;
+
+        // Serializes recording state between the UI thread and the capture loop
+        mutable std::mutex m_recordingMutex;
         std::string m_recordingFilename;
-        int m_recordingFPS{30};
+        std::vector<std::string> m_segments;
+        VideoConfig m_segmentConfig; ///< Encoder parameters of the open segment
+        int m_encoderRestarts{0};    ///< Segments opened because the encoder died
+
+        // Encoder clock of the open segment; with adaptive rate, frames carry their slot as time
+        std::chrono::steady_clock::time_point m_segmentStart;
+        int64_t m_segmentFrames{0}; ///< Next slot
+
+        // Resource accounting of the open segment (<segment>.stats.json when it is finalized)
+        RecordingStats m_segmentStats;
+        double m_frameWriteUs{0.0}; ///< Pipe write time of the current loop iteration
+
+        // Settings: published snapshot (UI thread) and the one in use (capture loop)
+        mutable std::mutex m_settingsMutex;
+        std::shared_ptr<const CaptureSettings> m_publishedSettings{std::make_shared<CaptureSettings>()};
+        std::atomic<uint64_t> m_settingsVersion{0};
+        std::shared_ptr<const CaptureSettings> m_settings{m_publishedSettings};
+        uint64_t m_adoptedVersion{0};
         
-        // Scaling support
+        // Stage graph from capture to the sinks (rebuilt by the capture loop under m_recordingMutex)
+        FramePipeline m_pipeline;
+        PipelineContext m_pipelineContext;
+
+        // Encoder frame of the open segment (derived from m_settings and the capture size)
         int m_recordingWidth{0};
         int m_recordingHeight{0};
-        bool m_useScaling{false};
+        bool m_yuvInput{false}; ///< The pipeline converts to the encoder's 4:2:0 layout
+        YuvFrame::Layout m_yuvLayout{YuvFrame::Layout::I420};
     };
 
 } // namespace NanoRec
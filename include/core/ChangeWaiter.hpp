@@ -0,0 +1,103 @@
+#pragma once
+
+#include "core/Rect.hpp"
+#include "core/TileChangeMap.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace NanoRec
+{
+
+    /**
+     * @class ChangeWaiter
+     * @brief "Wait until region R settles / changes" answered from the capture loop's tile hashes
+     *
+     * The capture thread publishes every TileChangeMap update; only the frame
+     * number and time of each tile's last change are kept, so waits never read
+     * pixels. While anything watches, the capture loop hashes every frame; the
+     * first frame after a gap only sets a baseline (its tiles count as changed
+     * "now" for stability, but not as a change). Regions are in captured-frame
+     * pixels; an empty region means the whole frame. Detection is bounded by
+     * the capture rate (adaptive rate may be idling at idle_fps).
+     */
+    class ChangeWaiter
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /**
+         * @brief Record an updated change map (capture thread)
+         * @param map Map updated with the frame just captured
+         * @param frameTime When the frame was captured
+         */
+        void publish(const TileChangeMap &map, Clock::time_point frameTime);
+
+        /**
+         * @brief Note a frame whose change map was not updated (capture thread, cheap)
+         */
+        void skipFrame();
+
+        /**
+         * @brief Wake all blocking waits with a failure (capture stopped)
+         */
+        void cancel();
+
+        /**
+         * @brief Ask the capture loop to hash every frame (pair with unwatch())
+         */
+        void watch() { m_watchers.fetch_add(1); }
+        void unwatch() { m_watchers.fetch_sub(1); }
+        bool isWatched() const { return m_watchers.load(std::memory_order_relaxed) > 0; }
+
+        /**
+         * @brief Number of the last published frame (reference point for the queries)
+         */
+        uint64_t getFrameNumber() const;
+
+        /**
+         * @brief Non-blocking: no tile of @p region changed for @p quiet
+         * @param sinceFrame Only true once a frame after this one was published
+         */
+        bool isStable(const Rect &region, std::chrono::milliseconds quiet, uint64_t sinceFrame) const;
+
+        /**
+         * @brief Non-blocking: a tile of @p region changed in a frame after @p sinceFrame
+         */
+        bool hasChanged(const Rect &region, uint64_t sinceFrame) const;
+
+        /**
+         * @brief Block until @p region has not changed for @p quietMs
+         * @return false on timeout or cancel()
+         */
+        bool waitForStable(const Rect &region, int quietMs, int timeoutMs);
+
+        /**
+         * @brief Block until @p region changes
+         * @return false on timeout or cancel()
+         */
+        bool waitForChange(const Rect &region, int timeoutMs);
+
+    private:
+        Rect tileRange(const Rect &region) const;
+        bool isStableLocked(const Rect &region, std::chrono::milliseconds quiet, uint64_t sinceFrame,
+                            Clock::time_point &quietUntil) const;
+        bool hasChangedLocked(const Rect &region, uint64_t sinceFrame) const;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_published;
+        std::atomic<int> m_watchers{0};
+        std::atomic<bool> m_tracking{false}; ///< Previous frame was published (no gap)
+        uint64_t m_frame{0};
+        uint64_t m_cancelled{0}; ///< Bumped by cancel()
+
+        int m_tilesX{0};
+        int m_tilesY{0};
+        std::vector<uint64_t> m_changedFrame;         ///< Per tile: last frame it changed in
+        std::vector<Clock::time_point> m_changedTime; ///< Per tile: last change (or baseline) time
+    };
+
+} // namespace NanoRec
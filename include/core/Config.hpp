@@ -23,6 +23,21 @@ namespace NanoRec
             uint32_t bitrate = 5000; // kbps
             std::string codec = "libx264";
             std::string preset = "fast"; // ultrafast, superfast, veryfast, faster, fast, medium, slow, slower, veryslow
+            std::string pixelFormat = "yuv420p"; // Encoded pixel format
+            std::string captureMethod = "default"; // IScreenCapture::setCaptureMethod() name
+            uint32_t scalerThreads = 1;          // Most threads a pipeline stage is split across (1 = capture thread only)
+            std::string replayFile;              // Capture from a dumped .y4m/raw RGB24 file instead of the screen
+            std::string replayTiming;            // Optional per-frame timestamp trace (microseconds)
+            bool replayMaxRate = false;          // Serve replay frames as fast as the pipeline takes them
+            std::string vncServer;               // Capture a remote desktop over RFB: host:display or host::port
+            uint32_t stripeRows = 0;             // Scale/overlay/convert in stripes of this many rows (0 = whole frames)
+            std::string pipeline;                // Capture stage graph, e.g. "capture > redact > hash > ..." (empty = built-in)
+            bool adaptiveRate = false;           // Full rate on input/motion, decaying to idleFps when quiet
+            uint32_t idleFps = 2;                // Capture rate floor for adaptive rate
+            uint32_t encoderQueueFrames = 0;     // Frames buffered ahead of the encoder (0 = write on the capture thread)
+            bool encoderSpill = false;           // Overflow the encoder queue to disk instead of dropping frames
+            uint32_t encoderSpillMb = 256;       // Spill backlog limit
+            uint32_t encoderRestarts = 0;        // New segments opened per recording when the encoder dies
         };
 
         // Audio Settings
@@ -42,6 +57,21 @@ namespace NanoRec
             bool minimizeOnRecord = false;
             std::string outputDirectory = "./recordings";
             std::string outputFormat = "mp4";
+            bool previewServerEnabled = false; // Localhost MJPEG stream for headless monitoring
+            uint32_t previewServerPort = 8090;
+            uint32_t previewServerFps = 5;
+            bool archiveTranscodeEnabled = false; // Re-encode finished recordings at idle priority
+            std::string archivePreset = "slow";
+            bool autoTuned = false; // Pipeline settings were chosen by the auto-tune benchmark
+            bool overlayEnabled = false; // Burn timestamp + host label into recordings
+            std::string overlayLabel;    // Empty = host name
+            uint32_t overlayScale = 2;
+            std::string redactWindows;          // Comma-separated class/name patterns; empty = off
+            std::string redactMode = "pixelate"; // "pixelate" or "black"
+            uint32_t redactBlockSize = 16;
+            std::string encoderNodes;         // Comma-separated host[:port] of nanorec-encoder-node; empty = local ffmpeg
+            uint32_t encoderMaxInFlight = 8;  // Frames in transit to a node before new ones are dropped
+            std::string encoderSimulation;    // Fault-injecting encoder stand-in, e.g. "spike=250/30,exit=900"; empty = off
         };
 
         /**
@@ -55,6 +85,11 @@ namespace NanoRec
 
         /**
          * @brief Load configuration from file
+         *
+         * INI format: [video], [audio] and [app] sections of `key = value`
+         * lines; lines starting with '#' or ';' are comments (elsewhere both
+         * are part of the value). Keys missing from the file keep
+         * their current values, unknown keys are reported and ignored.
          * @param filepath Path to configuration file
          * @return true if loaded successfully
          */
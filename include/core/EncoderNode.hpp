@@ -0,0 +1,99 @@
+#pragma once
+
+#include "EncoderProtocol.hpp"
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace NanoRec
+{
+
+    /**
+     * @class EncoderNode
+     * @brief Server side of remote encoding (nanorec-encoder-node)
+     *
+     * Accepts RemoteVideoWriter sessions, rebuilds the raw frames from the
+     * block deltas and pipes them into a local FFmpegVideoWriter. Each session
+     * runs on its own thread; sessions beyond maxSessions are refused so the
+     * client moves on to another node. The encoded file is streamed back when
+     * the session finishes and then removed from the work directory.
+     */
+    class EncoderNode
+    {
+    public:
+        struct Options
+        {
+            std::string bindAddress = "0.0.0.0";
+            int port = EncoderLink::DEFAULT_PORT; ///< 0 picks a free port (see getPort())
+            std::string workDirectory = ".";      ///< Where ffmpeg writes while encoding
+            int maxSessions = 0;                  ///< 0 = a quarter of the hardware threads (at least 1)
+            bool keepFiles = false;               ///< Keep encoded files after sending them back
+        };
+
+        explicit EncoderNode(const Options &options);
+        ~EncoderNode();
+
+        EncoderNode(const EncoderNode &) = delete;
+        EncoderNode &operator=(const EncoderNode &) = delete;
+
+        /**
+         * @brief Bind, listen and start accepting sessions
+         * @return false if the address cannot be bound
+         */
+        bool start();
+
+        /**
+         * @brief Abort all sessions and stop listening
+         */
+        void stop();
+
+        bool isRunning() const { return m_running.load(); }
+        int getPort() const { return m_port; }
+        int getMaxSessions() const { return m_maxSessions; }
+        int getActiveSessions() const { return m_activeSessions.load(); }
+
+        /**
+         * @brief Sessions finished with a file sent back
+         */
+        uint64_t getCompletedSessions() const { return m_completedSessions.load(); }
+
+    private:
+        struct Session
+        {
+            std::unique_ptr<EncoderLink> link;
+            std::thread thread;
+            std::atomic<bool> finished{false};
+        };
+
+        void acceptLoop();
+        void runSession(Session &session);
+
+        /**
+         * @brief Join and drop sessions whose thread has returned
+         */
+        void reapSessions();
+
+        /**
+         * @brief Unique path in the work directory for a client-supplied name
+         */
+        std::string reserveOutputPath(const std::string &name);
+
+        Options m_options;
+        int m_maxSessions{1};
+        int m_listenFd{-1};
+        int m_port{0};
+        std::atomic<bool> m_running{false};
+        std::thread m_acceptor;
+
+        std::mutex m_sessionsMutex;
+        std::list<Session> m_sessions;
+        std::atomic<int> m_activeSessions{0};
+        std::atomic<uint64_t> m_completedSessions{0};
+        uint64_t m_nextFileId{0};
+    };
+
+} // namespace NanoRec
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace NanoRec
+{
+
+    /**
+     * @brief Messages between RemoteVideoWriter (capture host) and nanorec-encoder-node
+     *
+     * Every message is a little-endian u32 payload length, a u8 type and the
+     * payload. A session is: Hello -> Status (node load), then either the
+     * connection is dropped (another node was chosen) or Open -> Opened,
+     * Frame... (each answered by an Ack), Finish -> Result, FileData... with
+     * an empty FileData closing the encoded file.
+     */
+    enum class EncoderMessage : uint8_t
+    {
+        Hello = 1, ///< magic, version
+        Status,    ///< version, active sessions, max sessions, hardware threads, codec mask
+        Open,      ///< VideoConfig, frame size, output name
+        Opened,    ///< ok, error text
+        Frame,     ///< sequence, timestamp, block delta (see FrameDelta)
+        Ack,       ///< sequence, ok
+        Finish,    ///< total frame count (trailing dropped frames are padded)
+        Result,    ///< ok, frames encoded, bytes piped, encoder usage, file size
+        FileData,  ///< Chunk of the encoded file (empty = end of file)
+        Error      ///< Text; the node closes the session
+    };
+
+    /**
+     * @brief Compression of the changed blocks of a frame
+     */
+    enum class FrameCodec : uint8_t
+    {
+        None = 0,
+        Lz4 = 1,  ///< Built with liblz4 (NANOREC_HAVE_LZ4)
+        Zlib = 2, ///< Built with zlib (NANOREC_HAVE_ZLIB), level 1
+    };
+
+    /**
+     * @class MessageWriter
+     * @brief Builds one framed message (header reserved up front, filled by finish())
+     */
+    class MessageWriter
+    {
+    public:
+        explicit MessageWriter(EncoderMessage type);
+
+        /**
+         * @brief Start over with a new message, keeping the allocation (large frames)
+         */
+        void reset(EncoderMessage type);
+
+        void put8(uint8_t value) { m_data.push_back(value); }
+        void put32(uint32_t value);
+        void put64(uint64_t value);
+        void putDouble(double value);
+        void putString(const std::string &value);
+        void putBytes(const void *data, size_t size);
+
+        /**
+         * @brief Write the payload length into the header
+         * @return Wire bytes of the whole message
+         */
+        const std::vector<uint8_t> &finish();
+
+    private:
+        std::vector<uint8_t> m_data;
+    };
+
+    /**
+     * @class MessageReader
+     * @brief Bounds-checked reads from a received payload (a short read fails all later reads)
+     */
+    class MessageReader
+    {
+    public:
+        MessageReader(const uint8_t *data, size_t size) : m_data(data), m_end(data + size) {}
+
+        uint8_t get8();
+        uint32_t get32();
+        uint64_t get64();
+        double getDouble();
+        std::string getString();
+
+        /**
+         * @brief Point at the next @p size bytes and skip them
+         * @return nullptr if fewer remain
+         */
+        const uint8_t *getBytes(size_t size);
+
+        size_t remaining() const { return static_cast<size_t>(m_end - m_data); }
+        bool ok() const { return m_ok; }
+
+    private:
+        const uint8_t *m_data;
+        const uint8_t *m_end;
+        bool m_ok{true};
+    };
+
+    /**
+     * @class EncoderLink
+     * @brief Blocking TCP connection carrying EncoderMessage frames
+     *
+     * One thread may send while another receives; wake() unblocks both
+     * (used to abort a session). Not supported on Windows yet.
+     */
+    class EncoderLink
+    {
+    public:
+        static constexpr uint32_t MAGIC = 0x4e52454e; // "NREN"
+        static constexpr uint32_t VERSION = 1;
+        static constexpr int DEFAULT_PORT = 7310;
+        static constexpr uint32_t MAX_MESSAGE = 256u << 20;
+
+        EncoderLink() = default;
+        explicit EncoderLink(int fd) : m_fd(fd) {}
+        ~EncoderLink();
+
+        EncoderLink(const EncoderLink &) = delete;
+        EncoderLink &operator=(const EncoderLink &) = delete;
+
+        /**
+         * @brief Parse "host" or "host:port" ([v6]:port for IPv6)
+         * @return false if malformed
+         */
+        static bool parseAddress(const std::string &address, std::string &host, int &port);
+
+        /**
+         * @brief Connect with a deadline
+         */
+        bool connect(const std::string &host, int port, int timeoutMs);
+
+        bool send(MessageWriter &message);
+
+        /**
+         * @brief Read the next message
+         * @return false on disconnect, timeout or an oversized message
+         */
+        bool receive(EncoderMessage &type, std::vector<uint8_t> &payload);
+
+        /**
+         * @brief Limit how long receive() blocks (0 = forever)
+         */
+        void setReceiveTimeout(int timeoutMs);
+
+        /**
+         * @brief Unblock pending send()/receive() calls; the link stays allocated until close()
+         */
+        void wake();
+        void close();
+
+        bool isOpen() const { return m_fd != -1; }
+
+        /**
+         * @brief Peer address for log messages
+         */
+        std::string peerName() const;
+
+    private:
+        bool sendAll(const void *data, size_t size);
+        bool readExact(void *data, size_t size);
+
+        int m_fd{-1};
+    };
+
+    /**
+     * @class FrameDelta
+     * @brief Block delta of raw frames against the previous one, optionally compressed
+     *
+     * Frames are compared in BLOCK_SIZE byte blocks, which works the same for
+     * RGB24 and the planar YUV inputs; only runs of changed blocks are sent.
+     * Both ends keep the last frame as reference (the node starts from black),
+     * so the first frame of a session is effectively a keyframe.
+     */
+    class FrameDelta
+    {
+    public:
+        static constexpr size_t BLOCK_SIZE = 4096;
+
+        /**
+         * @brief Codecs this build can encode and decode (bit per FrameCodec)
+         */
+        static uint32_t supportedCodecs();
+
+        /**
+         * @brief Best codec in @p mask (LZ4 over zlib over none)
+         */
+        static FrameCodec bestCodec(uint32_t mask);
+
+        static const char *codecName(FrameCodec codec);
+
+        /**
+         * @brief Start a new stream of @p frameSize byte frames from a black reference
+         */
+        void reset(size_t frameSize);
+
+        /**
+         * @brief Append the delta of @p frame to @p out and make it the new reference
+         * @return Number of changed bytes (before compression)
+         */
+        size_t encode(const uint8_t *frame, FrameCodec codec, MessageWriter &out);
+
+        /**
+         * @brief Apply a delta written by encode() to the reference
+         * @return false if the delta is malformed or uses an unsupported codec
+         */
+        bool decode(MessageReader &in);
+
+        const std::vector<uint8_t> &getFrame() const { return m_reference; }
+
+    private:
+        std::vector<uint8_t> m_reference;
+        std::vector<uint32_t> m_runs; ///< first block, block count pairs
+        std::vector<uint8_t> m_changed;
+        std::vector<uint8_t> m_compressed;
+    };
+
+} // namespace NanoRec
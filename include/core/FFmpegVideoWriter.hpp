@@ -9,6 +9,7 @@
 #define NANOREC_FFMPEGVIDEOWRITER_HPP
 
 #include "IVideoWriter.hpp"
+#include <cstdint>
 #include <memory>
 
 #ifdef _WIN32
@@ -27,6 +28,12 @@ namespace NanoRec
      * Spawns FFmpeg as a child process and pipes raw RGB frames to stdin.
      * FFmpeg handles encoding to H.264/MP4 format.
      *
+     * With VideoConfig::timestamps the frames are wrapped in a Matroska
+     * stream instead, each with its presentation time, and the output keeps
+     * those times (variable frame rate). A frame's duration is only sent
+     * once the next frame (or the end time) is known, so ffmpeg takes each
+     * frame one frame late.
+     *
      * @note Requires FFmpeg to be installed and available in system PATH
      */
     class FFmpegVideoWriter : public IVideoWriter
@@ -37,9 +44,21 @@ namespace NanoRec
 
         bool initialize(const VideoConfig& config) override;
         bool writeFrame(const uint8_t* frameData, size_t dataSize) override;
+        bool writeFrameAt(const uint8_t* frameData, size_t dataSize, int64_t pts) override;
+        void setEndTime(int64_t pts) override { m_endPts = pts; }
         bool finalize() override;
         bool isActive() const override;
 
+        /**
+         * @brief Bytes piped to ffmpeg since initialize()
+         */
+        uint64_t getBytesWritten() const override { return m_bytesWritten; }
+
+        /**
+         * @brief ffmpeg's CPU time and peak memory (valid after finalize())
+         */
+        EncoderUsage getEncoderUsage() const override { return m_encoderUsage; }
+
     private:
         /**
          * @brief Check if FFmpeg is available in system PATH
@@ -66,8 +85,21 @@ namespace NanoRec
          */
         bool writeToPipe(const void* data, size_t size);
 
+        /**
+         * @brief Close the block of the previous timestamped frame with its duration
+         * @param untilPts Time the frame is shown until, in frame intervals
+         */
+        bool closePendingBlock(int64_t untilPts);
+
         VideoConfig m_config;
         bool m_active;
+        bool m_pipeBroken{false}; ///< ffmpeg exited mid-recording (isActive() false until re-initialized)
+        uint64_t m_bytesWritten{0};
+        EncoderUsage m_encoderUsage; ///< Filled in when the ffmpeg child exits
+
+        // Timestamped input: the last frame's block waits for its duration
+        int64_t m_pendingPts{-1}; ///< Time of the frame whose duration is still open (-1 = none)
+        int64_t m_endPts{-1};     ///< setEndTime() (-1 = one frame interval after the last frame)
 
 #ifdef _WIN32
         HANDLE m_stdinPipe;
@@ -0,0 +1,270 @@
+#pragma once
+
+#include "capture/IScreenCapture.hpp"
+#include "core/Rect.hpp"
+#include "core/YuvConverter.hpp"
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace NanoRec
+{
+
+    class MjpegPreviewServer;
+    class RedactionFilter;
+    class TextOverlay;
+    class ThreadSafeFrameBuffer;
+    class TileChangeMap;
+
+    enum class FrameKind
+    {
+        Rgb, ///< FrameBuffer, RGB24
+        Yuv  ///< YuvFrame in the encoder's layout
+    };
+
+    /**
+     * @brief Frame passed along one edge of the pipeline
+     *
+     * A view: the pixels stay with the stage (or capture buffer) that
+     * produced them and are valid until the pipeline run returns.
+     */
+    struct PipelineFrame
+    {
+        FrameKind kind = FrameKind::Rgb;
+        FrameBuffer *rgb = nullptr;
+        YuvFrame *yuv = nullptr;
+    };
+
+    /**
+     * @brief Everything the stages need for one frame, filled in by the capture loop
+     *
+     * Null resources make their stages pass frames through unchanged.
+     */
+    struct PipelineContext
+    {
+        // Encoder frame
+        int width = 0;          ///< Recording size
+        int height = 0;
+        bool yuvOutput = false; ///< convert produces @ref layout; otherwise RGB goes on and ffmpeg converts
+        YuvFrame::Layout layout = YuvFrame::Layout::I420;
+        int stripeRows = 16;    ///< Rows per stripe of the fused stripes stage
+
+        // Scheduling
+        int maxThreads = 1;            ///< Bands a stage placed on the worker pool splits into
+        double frameBudgetUs = 33333.0; ///< 1/fps
+
+        // Stage resources
+        RedactionFilter *redaction = nullptr;
+        int originX = 0; ///< Desktop position of the captured area (redaction)
+        int originY = 0;
+        TextOverlay *overlay = nullptr;
+        TileChangeMap *changeMap = nullptr;
+        const std::vector<Rect> *dirty = nullptr; ///< Damage hint for the change map (nullptr = anywhere)
+        ThreadSafeFrameBuffer *preview = nullptr;
+        MjpegPreviewServer *mjpeg = nullptr;
+        std::function<void(const PipelineFrame &)> encoderSink; ///< Receives the encoder frames
+
+        // Demand of this frame
+        bool hashWanted = false;       ///< Adaptive rate, change waits or the activity sidecar read the change map
+        bool previewDue = false;       ///< The preview rate limit allows a frame
+        bool encoderWanted = false;    ///< The segment clock takes a frame
+        bool yuvPreviewWanted = false; ///< Encoder-format preview
+
+        // Results
+        bool hashed = false; ///< The change map was updated from this frame
+    };
+
+    /**
+     * @class PipelineStage
+     * @brief One node type of the capture pipeline
+     *
+     * Stages are synchronous: process() runs on the capture thread and may
+     * split its rows across the worker pool when the scheduler places it
+     * there. New stages are added to FramePipeline::createStage().
+     */
+    class PipelineStage
+    {
+    public:
+        virtual ~PipelineStage() = default;
+
+        virtual FrameKind getInputKind() const { return FrameKind::Rgb; }
+
+        /**
+         * @brief Kind produced (as declared; see passes-through notes of the stage)
+         */
+        virtual FrameKind getOutputKind() const { return getInputKind(); }
+
+        virtual bool accepts(FrameKind kind) const { return kind == getInputKind(); }
+
+        virtual bool isSink() const { return false; }
+
+        /**
+         * @brief Whether process() will change its input this frame
+         *
+         * The stage then gets a private copy while other stages still read the frame.
+         */
+        virtual bool modifiesInput(const PipelineContext &context) const
+        {
+            (void)context;
+            return false;
+        }
+
+        /**
+         * @brief Whether the threads argument of process() is used
+         */
+        virtual bool isParallel() const { return false; }
+
+        /**
+         * @brief Whether the stage must see the frame as captured (only capture, redact and hash may precede it)
+         */
+        virtual bool needsCapturedFrame() const { return false; }
+
+        /**
+         * @brief Whether this frame is needed for the stage's own sake (a stage also runs when a downstream one wants it)
+         */
+        virtual bool wants(const PipelineContext &context) const
+        {
+            (void)context;
+            return false;
+        }
+
+        /**
+         * @brief Process one frame
+         * @param input Frame from the upstream stage
+         * @param output Set by transforms (may be @p input itself); unused by sinks
+         * @param context Frame context
+         * @param threads Bands to split the work into
+         * @return false if the frame could not be processed (stages below are skipped)
+         */
+        virtual bool process(const PipelineFrame &input, PipelineFrame &output, PipelineContext &context,
+                             int threads) = 0;
+    };
+
+    /**
+     * @class FramePipeline
+     * @brief Capture pipeline built from a declarative stage graph
+     *
+     * The spec lists chains of stage names, e.g.
+     * "capture > redact > hash > preview; hash > scale > convert > encoder":
+     * chains are separated by ';', and a chain that starts at an already
+     * declared stage branches off it. Each stage appears once; capture is the
+     * root. Edges are views of the producing stage's frame, so branches share
+     * pixels until a stage that draws in place needs its own copy.
+     *
+     * Every run executes only the stages that feed a sink with demand this
+     * frame. Parallel stages (scale, convert, stripes) start on the capture
+     * thread and move to the worker pool when their measured cost is a
+     * noticeable share of the frame budget, and back when splitting them did
+     * not pay off.
+     */
+    class FramePipeline
+    {
+    public:
+        static const char *const DEFAULT_SPEC;
+
+        /**
+         * @brief Stage of the given type, or nullptr if the name is unknown
+         */
+        static std::unique_ptr<PipelineStage> createStage(const std::string &type);
+
+        /**
+         * @brief Replace the graph
+         * @param spec Graph spec (see class description)
+         * @param fuseStripes Run scale > overlay > convert as one stripes stage
+         * @param error Receives the reason when the spec is rejected
+         * @return false if the spec is invalid (the current graph is kept)
+         */
+        bool build(const std::string &spec, bool fuseStripes, std::string &error);
+
+        bool isBuilt() const { return !m_nodes.empty(); }
+
+        const std::string &getSpec() const { return m_spec; }
+
+        /**
+         * @brief Whether the graph was built with stripe fusion (it applies only where the stages form a plain run)
+         */
+        bool isFused() const { return m_fused; }
+
+        /**
+         * @brief Whether a convert (or stripes) stage feeds the encoder, i.e. it may receive YUV frames
+         */
+        bool convertsForEncoder() const;
+
+        /**
+         * @brief Run the stages with demand for one captured frame
+         * @param captured Frame from the capture source (stages may draw into it when nothing else reads it)
+         * @param context Frame context
+         */
+        void run(FrameBuffer &captured, PipelineContext &context);
+
+        /**
+         * @brief Time the last run spent in the stages feeding @p stage, in microseconds
+         */
+        double getUpstreamUs(const std::string &stage) const;
+
+        struct StageReport
+        {
+            std::string name;
+            bool onPool = false; ///< Placed on the worker pool
+            double costUs = 0.0; ///< Smoothed cost at the current placement
+        };
+
+        /**
+         * @brief Placement and cost of every stage, in declaration order
+         */
+        std::vector<StageReport> getStageReports() const;
+
+        // Scheduler tuning
+        static constexpr double POOL_SHARE = 0.10;   ///< Cost share of the frame budget that moves a stage to the pool
+        static constexpr double POOL_GAIN = 0.8;     ///< The pool must cut the cost below this fraction of inline
+        static constexpr int MIN_SAMPLES = 30;       ///< Frames measured before a placement decision
+        static constexpr int COOLDOWN_FRAMES = 600;  ///< Frames before a stage that did not gain is tried again
+
+    private:
+        struct Node
+        {
+            std::string name;
+            std::unique_ptr<PipelineStage> stage; ///< nullptr for the capture source
+            int parent = -1;
+            std::vector<int> children;
+
+            // Per run
+            bool active = false;
+            PipelineFrame output;
+            FrameBuffer rgbCopy; ///< Private input for stages drawing into a shared frame
+            YuvFrame yuvCopy;
+            double lastUs = 0.0;
+
+            // Placement
+            bool onPool = false;
+            double costUs = 0.0;
+            double inlineCostUs = 0.0; ///< Cost measured before moving to the pool
+            int samples = 0;
+            int cooldown = 0;
+        };
+
+        bool markActive(int index, const PipelineContext &context);
+        void runChildren(int index, PipelineContext &context);
+        void runNode(int index, const PipelineFrame &input, PipelineContext &context);
+        void schedule(Node &node, const PipelineContext &context);
+        void resetPlacement();
+        int findNode(const std::string &name) const;
+
+        void addReader(const void *frame);
+        int releaseReader(const void *frame);
+
+        std::vector<Node> m_nodes; ///< m_nodes[0] is the capture source
+        std::vector<std::pair<const void *, int>> m_readers; ///< Pending readers per frame this run
+        std::string m_spec;
+        bool m_fused{false};
+
+        // Encoder frame of the last run; placements are remeasured when it changes
+        int m_lastWidth{0};
+        int m_lastHeight{0};
+        bool m_lastYuv{false};
+        int m_lastThreads{0};
+    };
+
+} // namespace NanoRec
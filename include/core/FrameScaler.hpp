@@ -18,13 +18,32 @@ namespace NanoRec
          * @param destination Destination frame buffer (must be pre-allocated)
          * @param targetWidth Target width in pixels
          * @param targetHeight Target height in pixels
+         * @param threads Bands of rows run on the shared WorkerPool (1 = calling thread only)
          * @return true if scaling succeeded, false otherwise
          */
         static bool scaleFrame(
             const FrameBuffer &source,
             FrameBuffer &destination,
             int targetWidth,
-            int targetHeight);
+            int targetHeight,
+            int threads = 1);
+
+        /**
+         * @brief Scale one horizontal stripe of the target frame (stripe processing)
+         *
+         * Produces exactly the pixels scaleFrame() would write to target rows
+         * [rowBegin, rowBegin + stripe.height).
+         * @param source Source frame buffer
+         * @param stripe Pre-allocated buffer, as wide as the target frame
+         * @param targetHeight Height of the whole target frame
+         * @param rowBegin First target row of the stripe
+         * @return true if scaling succeeded, false otherwise
+         */
+        static bool scaleStripe(
+            const FrameBuffer &source,
+            FrameBuffer &stripe,
+            int targetHeight,
+            int rowBegin);
 
         /**
          * @brief Calculate scaled dimensions preserving aspect ratio
@@ -41,6 +60,15 @@ namespace NanoRec
             int &outWidth, int &outHeight);
 
     private:
+        /**
+         * @brief Scale target rows [rowBegin, rowEnd) into @p output (which holds row rowBegin first)
+         */
+        static void scaleRows(
+            const FrameBuffer &source,
+            uint8_t *output, size_t outputStride,
+            int targetWidth, int targetHeight,
+            int rowBegin, int rowEnd);
+
         /**
          * @brief Bilinear interpolation for a single pixel
          * @param source Source frame data
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "capture/IScreenCapture.hpp"
+#include "core/Rect.hpp"
+#include "core/TileChangeMap.hpp"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace NanoRec
+{
+
+    /**
+     * @class GifExporter
+     * @brief Animated GIF writer for short clips (bug reports, demos)
+     *
+     * Builds one optimized palette for the whole clip (median cut over a
+     * 15-bit histogram, SIMD nearest-colour lookup table), dithers each frame
+     * in parallel horizontal bands and writes only the rectangle that changed
+     * since the previous frame, as reported by TileChangeMap.
+     */
+    class GifExporter
+    {
+    public:
+        struct Options
+        {
+            int fps = 10;          ///< Playback rate
+            int maxColors = 256;   ///< Palette size (2..256)
+            bool dither = true;    ///< Floyd-Steinberg dithering
+            int threads = 0;       ///< Dithering bands (0 = hardware concurrency)
+        };
+
+        GifExporter();
+
+        /**
+         * @brief Append a frame (copied; all frames must have the same size)
+         * @return true if the frame was accepted
+         */
+        bool addFrame(const FrameBuffer &frame);
+
+        /**
+         * @brief Encode all frames and write the GIF
+         * @param path Output file
+         * @param options Encoding options
+         * @return true if the file was written
+         */
+        bool write(const std::string &path, const Options &options);
+
+        /**
+         * @brief Drop all collected frames
+         */
+        void clear();
+
+        size_t getFrameCount() const { return m_frames.size(); }
+
+        /**
+         * @brief Decode a time range of a recording and export it as GIF
+         * @param input Recording path
+         * @param start Start time in seconds
+         * @param end End time in seconds
+         * @param output GIF path
+         * @param maxWidth Output width limit (aspect preserved)
+         * @param options Encoding options (fps also selects decoded frames)
+         * @return true if the GIF was written
+         */
+        static bool exportRecording(const std::string &input, double start, double end,
+                                    const std::string &output, int maxWidth, const Options &options);
+
+        /**
+         * @brief Nearest palette entry for every 15-bit colour
+         * @param palette RGB palette (up to 256 entries)
+         * @param lookup Receives one index per key (r >> 3) << 10 | (g >> 3) << 5 | (b >> 3),
+         *               measured from the centre of the key's cell; ties go to the lower index
+         */
+        static void buildLookupTable(const std::vector<std::array<uint8_t, 3>> &palette,
+                                     std::vector<uint8_t> &lookup);
+
+    private:
+        struct Frame
+        {
+            FrameBuffer pixels;
+            Rect changed; ///< Area that differs from the previous frame
+        };
+
+        void buildPalette(int maxColors);
+        void quantizeRegion(const FrameBuffer &frame, const Rect &region, bool dither, int threads,
+                            std::vector<uint8_t> &indices) const;
+
+        std::vector<Frame> m_frames;
+        TileChangeMap m_changeMap;
+
+        // Palette (RGB triplets) and 15-bit colour -> palette index lookup
+        std::vector<std::array<uint8_t, 3>> m_palette;
+        std::vector<uint8_t> m_lookup;
+        std::vector<uint32_t> m_histogram;
+        std::vector<std::array<uint64_t, 3>> m_histogramSums;
+    };
+
+} // namespace NanoRec
@@ -11,6 +11,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <string>
+#include <thread>
 
 namespace NanoRec
 {
@@ -25,11 +26,58 @@ namespace NanoRec
         int height;          ///< Video height in pixels
         int fps;             ///< Frames per second
         std::string output;  ///< Output file path
+        std::string preset;      ///< x264 preset (ultrafast ... veryslow)
+        std::string pixelFormat; ///< Encoded pixel format (yuv420p, nv12, ...)
+        std::string inputPixelFormat; ///< Layout of frames passed to writeFrame (rgb24, yuv420p, nv12)
+        bool timestamps;         ///< Frames carry presentation times (writeFrameAt); the output has a variable rate
 
-        VideoConfig() : width(1920), height(1080), fps(30), output("output.mp4") {}
+        VideoConfig() : width(1920), height(1080), fps(30), output("output.mp4"),
+                        preset("medium"), pixelFormat("yuv420p"), inputPixelFormat("rgb24"), timestamps(false) {}
         
         VideoConfig(int w, int h, int f, const std::string& out)
-            : width(w), height(h), fps(f), output(out) {}
+            : width(w), height(h), fps(f), output(out), preset("medium"), pixelFormat("yuv420p"),
+              inputPixelFormat("rgb24"), timestamps(false) {}
+
+        /**
+         * @brief Bytes of one frame passed to writeFrame (depends on inputPixelFormat)
+         */
+        size_t inputFrameSize() const
+        {
+            if (inputPixelFormat == "yuv420p" || inputPixelFormat == "nv12")
+            {
+                // 8-bit 4:2:0: full-size luma plus two half-size chroma planes
+                size_t chroma = static_cast<size_t>((width + 1) / 2) * ((height + 1) / 2);
+                return static_cast<size_t>(width) * height + 2 * chroma;
+            }
+            return static_cast<size_t>(width) * height * 3; // RGB24
+        }
+    };
+
+    /**
+     * @struct EncoderUsage
+     * @brief Resources used by the encoder process (filled in when it exits)
+     */
+    struct EncoderUsage
+    {
+        bool valid{false};
+        double userSeconds{0.0};
+        double systemSeconds{0.0};
+        long peakRssKb{0}; ///< 0 where the platform does not report it
+    };
+
+    /**
+     * @struct WriterQueueStats
+     * @brief Frame queue between the capture thread and the encoder (see BufferedVideoWriter)
+     */
+    struct WriterQueueStats
+    {
+        int capacityFrames{0};      ///< In-memory queue limit
+        int peakFrames{0};          ///< Deepest the in-memory queue got
+        uint64_t dropped{0};        ///< Frames refused because the queue (and spill) was full
+        uint64_t spilledFrames{0};  ///< Frames that overflowed to the spill file
+        uint64_t peakSpillBytes{0}; ///< Largest spill backlog
+        uint64_t writeFailures{0};  ///< Frames the encoder rejected after they were queued
+        bool encoderLost{false};    ///< The encoder went away mid-segment
     };
 
     /**
@@ -51,12 +99,33 @@ namespace NanoRec
 
         /**
          * @brief Write a single frame to the video
-         * @param frameData Raw RGB24 pixel data (width * height * 3 bytes)
+         * @param frameData Raw pixel data in VideoConfig::inputPixelFormat (RGB24: width * height * 3 bytes)
          * @param dataSize Size of frame data in bytes
          * @return true if frame was written successfully, false otherwise
          */
         virtual bool writeFrame(const uint8_t* frameData, size_t dataSize) = 0;
 
+        /**
+         * @brief Write a frame at a presentation time (VideoConfig::timestamps)
+         *
+         * A frame stays on screen until the next one, so slots without a
+         * frame cost nothing. Writers without timestamp support treat the
+         * frame as the next one.
+         * @param pts Presentation time in frame intervals (1/fps) since the segment start; must increase
+         * @return true if frame was written successfully, false otherwise
+         */
+        virtual bool writeFrameAt(const uint8_t* frameData, size_t dataSize, int64_t pts)
+        {
+            (void)pts;
+            return writeFrame(frameData, dataSize);
+        }
+
+        /**
+         * @brief Time the last frame is shown until (VideoConfig::timestamps); call before finalize()
+         * @param pts End of the segment in frame intervals
+         */
+        virtual void setEndTime(int64_t pts) { (void)pts; }
+
         /**
          * @brief Finalize the video and close the file
          * @return true if finalization succeeded, false otherwise
@@ -65,10 +134,43 @@ namespace NanoRec
 
         /**
          * @brief Check if the writer is currently active
+         *
+         * Turns false when the encoder goes away mid-segment (e.g. ffmpeg
+         * exited); finalize() must still be called to reap it.
          * @return true if writer is initialized and ready to write frames
          */
         virtual bool isActive() const = 0;
 
+        /**
+         * @brief Bytes handed to the encoder (pipe or network) since initialize()
+         */
+        virtual uint64_t getBytesWritten() const { return 0; }
+
+        /**
+         * @brief Encoder CPU time and peak memory (valid after finalize(), if known)
+         */
+        virtual EncoderUsage getEncoderUsage() const { return EncoderUsage(); }
+
+        /**
+         * @brief Queue statistics of writers that buffer frames
+         * @return false if the writer does not queue (frames go straight to the encoder)
+         */
+        virtual bool getQueueStats(WriterQueueStats &stats) const
+        {
+            (void)stats;
+            return false;
+        }
+
+        /**
+         * @brief Thread of writers that feed the encoder from their own thread
+         * @return false if frames reach the encoder on the caller's thread
+         */
+        virtual bool getWorkerThread(std::thread::native_handle_type &thread)
+        {
+            (void)thread;
+            return false;
+        }
+
         /**
          * @brief Virtual destructor for proper cleanup
          */
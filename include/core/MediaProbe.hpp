@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace NanoRec
+{
+
+    /**
+     * @struct MediaInfo
+     * @brief Video stream properties of a recording
+     */
+    struct MediaInfo
+    {
+        int width{0};                   ///< Frame width in pixels
+        int height{0};                  ///< Frame height in pixels
+        double fps{0.0};                ///< Average frame rate
+        double duration{0.0};           ///< Duration in seconds
+        std::string codec;              ///< Video codec as named by ffprobe (e.g. "h264")
+        std::string profile;            ///< Codec profile as named by ffprobe (e.g. "High")
+        int level{0};                   ///< Codec level in ffprobe units (H.264: 41 = level 4.1; 0 = unknown)
+        std::string pixelFormat;        ///< Pixel format of the video stream (e.g. "yuv420p")
+        bool hasAudio{false};           ///< The file has at least one audio stream
+        std::vector<double> keyframes;  ///< Keyframe timestamps in seconds (ascending)
+
+        int getFrameCount() const { return static_cast<int>(duration * fps + 0.5); }
+
+        /**
+         * @brief Find the last keyframe at or before a timestamp
+         * @param seconds Target time
+         * @return Keyframe time (0.0 if no index is available)
+         */
+        double keyframeAtOrBefore(double seconds) const;
+
+        /**
+         * @brief Find the first keyframe at or after a timestamp
+         * @param seconds Target time
+         * @return Keyframe time (duration if there is none)
+         */
+        double keyframeAtOrAfter(double seconds) const;
+    };
+
+    /**
+     * @class MediaProbe
+     * @brief Reads recording metadata via ffprobe
+     */
+    class MediaProbe
+    {
+    public:
+        /**
+         * @brief Probe the first video stream (size, rate, codec parameters), audio presence and duration
+         * @param path Media file path
+         * @param info Output metadata
+         * @param withKeyframes Also build the keyframe index (demuxes packets, no decoding)
+         * @return true if probing succeeded
+         */
+        static bool probe(const std::string &path, MediaInfo &info, bool withKeyframes = false);
+
+        /**
+         * @brief Build the keyframe index from packet flags
+         * @param path Media file path
+         * @param keyframes Output keyframe timestamps in seconds
+         * @return true if at least one keyframe was found
+         */
+        static bool readKeyframes(const std::string &path, std::vector<double> &keyframes);
+    };
+
+} // namespace NanoRec
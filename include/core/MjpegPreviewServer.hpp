@@ -0,0 +1,138 @@
+#pragma once
+
+#include "capture/IScreenCapture.hpp"
+#include "core/ChangeWaiter.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace NanoRec
+{
+
+    /**
+     * @brief Localhost HTTP endpoint serving the preview as an MJPEG stream
+     *
+     * The capture thread offers frames through offerFrame(), which never blocks:
+     * it only copies into a staging buffer when a client is connected, a tick is
+     * due and the staging lock is free. The server thread encodes each staged
+     * frame to JPEG once and shares the encoded part across all clients.
+     *
+     * With a ChangeWaiter attached it also answers UI-test waits without
+     * sending any pixels (region in captured-frame pixels, times in ms):
+     *   GET /wait/stable?x=&y=&w=&h=&quiet=500&timeout=10000
+     *   GET /wait/change?x=&y=&w=&h=&timeout=10000
+     * Each replies once with {"result": "stable"|"changed"|"timeout", "waited_ms": N}.
+     */
+    class MjpegPreviewServer
+    {
+    public:
+        MjpegPreviewServer();
+        ~MjpegPreviewServer();
+
+        MjpegPreviewServer(const MjpegPreviewServer &) = delete;
+        MjpegPreviewServer &operator=(const MjpegPreviewServer &) = delete;
+
+        /**
+         * @brief Start listening on 127.0.0.1
+         * @param port TCP port to bind
+         * @param fps Maximum stream rate (frames per second)
+         * @param maxWidth Frames wider than this are downscaled before encoding (0 = never)
+         * @return true if the server is listening
+         */
+        bool start(int port, int fps = 5, int maxWidth = 1280);
+
+        /**
+         * @brief Stop the server and disconnect all clients
+         */
+        void stop();
+
+        /**
+         * @brief Offer a captured frame (called by capture thread, never blocks)
+         * @param frame Captured RGB24 frame
+         */
+        void offerFrame(const FrameBuffer &frame);
+
+        /**
+         * @brief Answer /wait/ requests from this waiter
+         * @param waiter Capture thread's waiter (nullptr: /wait/ returns 503); set before start()
+         */
+        void setChangeWaiter(ChangeWaiter *waiter) { m_changeWaiter = waiter; }
+
+        /**
+         * @brief Check if the server is listening
+         */
+        bool isRunning() const { return m_running.load(); }
+
+        /**
+         * @brief Number of clients currently receiving the stream
+         */
+        int getClientCount() const { return m_clientCount.load(); }
+
+        int getPort() const { return m_port; }
+
+    private:
+        enum class Wait
+        {
+            None,
+            Stable,
+            Change
+        };
+
+        struct Client
+        {
+            int fd{-1};
+            std::string request;
+            bool streaming{false};
+            std::shared_ptr<const std::string> pending; ///< Part being sent (shared across clients)
+            size_t offset{0};
+            bool closeAfterSend{false};
+
+            // Pending /wait/ request (the waiter is watched until it is answered)
+            Wait wait{Wait::None};
+            Rect region;
+            std::chrono::milliseconds quiet{0};
+            std::chrono::steady_clock::time_point waitStart;
+            std::chrono::steady_clock::time_point waitDeadline;
+            uint64_t sinceFrame{0};
+        };
+
+        void serverLoop();
+        void acceptClients();
+        bool readRequest(Client &client);
+        bool flushClient(Client &client);
+        void beginWait(Client &client);
+        void serviceWaits();
+        void endWait(Client &client, const char *result);
+        std::shared_ptr<const std::string> encodeStagedFrame();
+
+        std::thread m_thread;
+        std::atomic<bool> m_running{false};
+        std::atomic<bool> m_shouldStop{false};
+        std::atomic<int> m_clientCount{0};
+
+        int m_listenFd{-1};
+        int m_port{0};
+        int m_quality{70};
+        int m_maxWidth{1280};
+        std::chrono::steady_clock::duration m_tickInterval{std::chrono::milliseconds(200)};
+        ChangeWaiter *m_changeWaiter{nullptr};
+
+        // Staging written by capture thread (try_lock only), consumed by server thread
+        std::mutex m_stagingMutex;
+        FrameBuffer m_staging;
+        uint64_t m_stagingSeq{0};
+        std::atomic<int64_t> m_nextOfferTicks{0};
+
+        // Server thread only
+        std::vector<Client> m_clients;
+        FrameBuffer m_encodeSource;
+        FrameBuffer m_scaled;
+        uint64_t m_encodedSeq{0};
+    };
+
+} // namespace NanoRec
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace NanoRec
+{
+
+    /**
+     * @struct LibraryEntry
+     * @brief One recording in the library index
+     */
+    struct LibraryEntry
+    {
+        std::string filename;     ///< Name inside the library directory
+        uint64_t size{0};         ///< File size in bytes
+        int64_t modified{0};      ///< Last write time (seconds, file clock)
+        bool hasDetails{false};   ///< Metadata and thumbnail are available
+        bool detailsFailed{false};///< Probing failed (e.g. recording still in progress)
+        double duration{0.0};     ///< Seconds
+        int width{0};
+        int height{0};
+        double fps{0.0};
+        int thumbnailSlot{-1};    ///< Slot in the thumbnail atlas (-1 = none)
+    };
+
+    /**
+     * @brief Indexes a recordings directory with lazily extracted thumbnails
+     *
+     * A background thread lists the directory and merges it with the on-disk
+     * index, so a second launch only stats files. Metadata and thumbnails are
+     * extracted (ffprobe / ffmpeg) only for entries passed to requestDetails(),
+     * i.e. rows that are on screen. Thumbnails are stored as fixed-size RGB24
+     * slots in a single atlas file next to the index, keyed by name, size and
+     * modification time.
+     */
+    class RecordingLibrary
+    {
+    public:
+        static constexpr int THUMB_WIDTH = 160;
+        static constexpr int THUMB_HEIGHT = 90;
+        static constexpr size_t THUMB_BYTES = THUMB_WIDTH * THUMB_HEIGHT * 3;
+
+        RecordingLibrary();
+        ~RecordingLibrary();
+
+        RecordingLibrary(const RecordingLibrary &) = delete;
+        RecordingLibrary &operator=(const RecordingLibrary &) = delete;
+
+        /**
+         * @brief Start indexing a directory (returns immediately)
+         * @param directory Recordings directory (created if missing)
+         * @return true if the background indexer started
+         */
+        bool open(const std::string &directory);
+
+        /**
+         * @brief Stop the indexer and flush the index to disk
+         */
+        void close();
+
+        /**
+         * @brief Re-list the directory (picks up new and deleted recordings)
+         */
+        void rescan();
+
+        /**
+         * @brief Replace the set of entries that need metadata and thumbnails
+         *
+         * Called with the visible rows; entries that scrolled out of view
+         * before the worker reached them are dropped.
+         * @param filenames Entries in priority order
+         */
+        void requestDetails(const std::vector<std::string> &filenames);
+
+        /**
+         * @brief Copy the entries if they changed since the given generation
+         * @param entries Output, sorted newest first
+         * @param generation In: generation of the caller's copy; out: current generation
+         * @return true if entries were copied
+         */
+        bool snapshot(std::vector<LibraryEntry> &entries, uint64_t &generation) const;
+
+        /**
+         * @brief Read a thumbnail from the atlas
+         * @param slot Atlas slot (LibraryEntry::thumbnailSlot)
+         * @param rgb Output buffer of THUMB_BYTES
+         * @return true if the thumbnail was read
+         */
+        bool readThumbnail(int slot, uint8_t *rgb) const;
+
+        const std::string &getDirectory() const { return m_directory; }
+        bool isScanning() const { return m_scanning.load(); }
+
+    private:
+        void workerLoop();
+        void scanDirectory();
+        bool extractDetails(LibraryEntry &entry);
+        bool writeThumbnail(int slot, const uint8_t *rgb);
+        int allocateSlot();
+        bool loadIndex();
+        bool saveIndex();
+
+        std::string m_directory;
+        std::string m_indexPath;
+        std::string m_atlasPath;
+
+        std::thread m_thread;
+        mutable std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::vector<LibraryEntry> m_entries;
+        std::unordered_map<std::string, size_t> m_entryByName;
+        std::vector<std::string> m_requests;
+        std::vector<int> m_freeSlots;
+        int m_slotCount{0};
+        uint64_t m_generation{0};
+        bool m_rescanRequested{false};
+        bool m_indexDirty{false};
+
+        mutable std::mutex m_atlasMutex;
+        mutable std::fstream m_atlas;
+
+        std::atomic<bool> m_running{false};
+        std::atomic<bool> m_shouldStop{false};
+        std::atomic<bool> m_scanning{false};
+    };
+
+} // namespace NanoRec
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "capture/IScreenCapture.hpp"
+#include "core/MediaProbe.hpp"
+#include "core/Subprocess.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace NanoRec
+{
+
+    /**
+     * @brief Decodes a recording on a background thread into an LRU frame cache
+     *
+     * Frames are decoded through an ffmpeg pipe (RGB24, optionally downscaled)
+     * starting at the keyframe before the playhead, and prefetched ahead of it.
+     * The UI thread only reads from the cache and never waits for the decoder.
+     */
+    class RecordingPlayer
+    {
+    public:
+        RecordingPlayer();
+        ~RecordingPlayer();
+
+        RecordingPlayer(const RecordingPlayer &) = delete;
+        RecordingPlayer &operator=(const RecordingPlayer &) = delete;
+
+        /**
+         * @brief Open a recording and start the decode thread
+         * @param path Recording file path
+         * @param maxWidth Decode width limit (frames are downscaled to fit, 0 = native)
+         * @param cacheBudgetBytes Maximum bytes held by the frame cache
+         * @return true if the file was probed and decoding started
+         */
+        bool open(const std::string &path, int maxWidth = 1280, size_t cacheBudgetBytes = 512u << 20);
+
+        /**
+         * @brief Stop decoding and drop the cache
+         */
+        void close();
+
+        bool isOpen() const { return m_running.load(); }
+
+        /**
+         * @brief Move the playhead; the decoder reacts at its next frame boundary
+         * @param frameIndex Target frame (clamped to the recording)
+         */
+        void setPlayhead(int frameIndex);
+
+        int getPlayhead() const { return m_playhead.load(); }
+
+        /**
+         * @brief Get the cached frame at or closest before an index
+         * @param frameIndex Requested frame
+         * @param actualIndex Index of the returned frame (-1 if none)
+         * @return Shared frame, or nullptr if nothing suitable is cached yet
+         */
+        std::shared_ptr<const FrameBuffer> getFrame(int frameIndex, int &actualIndex);
+
+        const MediaInfo &getInfo() const { return m_info; }
+        int getFrameCount() const { return m_frameCount.load(); }
+        int getDecodeWidth() const { return m_decodeWidth; }
+        int getDecodeHeight() const { return m_decodeHeight; }
+        size_t getCachedFrameCount() const;
+
+    private:
+        struct CacheEntry
+        {
+            std::shared_ptr<FrameBuffer> frame;
+            std::list<int>::iterator lruPos;
+        };
+
+        void decodeLoop();
+        int findFirstMissing(int from, int to) const;
+        bool restartDecoder(int frameIndex);
+        void insertFrame(int frameIndex, std::shared_ptr<FrameBuffer> frame);
+        std::shared_ptr<FrameBuffer> acquireBuffer();
+
+        std::string m_path;
+        MediaInfo m_info;
+        int m_decodeWidth{0};
+        int m_decodeHeight{0};
+        int m_prefetchFrames{60};
+        size_t m_cacheBudget{0};
+
+        std::thread m_thread;
+        std::atomic<bool> m_running{false};
+        std::atomic<bool> m_shouldStop{false};
+        std::atomic<int> m_playhead{0};
+        std::atomic<int> m_frameCount{0};
+
+        // Cache (guarded by m_cacheMutex)
+        mutable std::mutex m_cacheMutex;
+        std::condition_variable m_wakeDecoder;
+        std::map<int, CacheEntry> m_cache;
+        std::list<int> m_lru; ///< Most recently used at front
+        std::vector<std::shared_ptr<FrameBuffer>> m_pool; ///< Evicted buffers for reuse
+
+        // Decoder process (started/stopped under m_decoderMutex, read by decode thread)
+        std::mutex m_decoderMutex;
+        Subprocess m_decoder;
+        int m_decodePos{-1}; ///< Index of the next frame the decoder will produce
+    };
+
+} // namespace NanoRec
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "core/IVideoWriter.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace NanoRec
+{
+
+    class WorkerPool;
+
+    /**
+     * @class LatencyHistogram
+     * @brief Fixed-size log-scale histogram of durations in microseconds
+     *
+     * Eight buckets per power of two (about 9% resolution) from 1 us to
+     * ~16 s, so hours of frames cost the same 1.5 KB as a short clip.
+     */
+    class LatencyHistogram
+    {
+    public:
+        static constexpr int BUCKETS_PER_OCTAVE = 8;
+        static constexpr int BUCKET_COUNT = 24 * BUCKETS_PER_OCTAVE + 1;
+
+        void add(double microseconds);
+
+        uint64_t getCount() const { return m_count; }
+        double getMean() const { return m_count ? m_sum / m_count : 0.0; }
+        double getMax() const { return m_max; }
+
+        /**
+         * @brief Duration below which @p fraction of the samples fall
+         * @param fraction 0..1 (0.99 = p99)
+         * @return Upper edge of the bucket holding that sample (clamped to the max)
+         */
+        double getPercentile(double fraction) const;
+
+    private:
+        std::array<uint32_t, BUCKET_COUNT> m_buckets{};
+        uint64_t m_count{0};
+        double m_sum{0.0};
+        double m_max{0.0};
+    };
+
+    /**
+     * @class RecordingStats
+     * @brief Resource accounting for one recorded segment, written as a JSON sidecar
+     *
+     * Fed by the capture thread under the recording lock; CPU clocks are
+     * sampled when the segment opens and when it stops taking frames. The
+     * encoder's rusage is only known once ffmpeg has exited, so write() runs
+     * after the writer was finalized.
+     */
+    class RecordingStats
+    {
+    public:
+        enum class Stage
+        {
+            Capture, ///< IScreenCapture::captureFrame
+            Encode,  ///< Pipeline stages feeding the encoder: redaction, change map, scale, overlay, YUV conversion
+            Write,   ///< Pipe write to ffmpeg
+            Frame,   ///< Whole loop iteration up to the write
+            Count
+        };
+
+        /**
+         * @brief Start accounting a segment
+         * @param config Encoder parameters of the segment
+         * @param captureThread Thread that captures and encodes (must be running)
+         * @param writer Initialized writer of the segment (its queue thread, if any, is accounted)
+         * @param workers Pool running the pixel kernels (each worker is accounted)
+         */
+        void begin(const VideoConfig &config, std::thread &captureThread, IVideoWriter &writer, WorkerPool &workers);
+
+        /**
+         * @brief Sample CPU clocks; call when the segment stops taking frames
+         */
+        void end();
+
+        void addStage(Stage stage, double microseconds) { m_stages[static_cast<int>(stage)].add(microseconds); }
+        void countCaptured() { m_captured++; }
+        void countEncoded() { m_encoded++; }
+        void countHeld(int64_t count) { m_held += count; }
+        void countDropped() { m_dropped++; }
+
+        /**
+         * @brief Write the sidecar (after @p writer was finalized)
+         * @param path Sidecar path (see sidecarPath)
+         * @param writer Finalized writer of this segment (bytes piped, encoder rusage)
+         * @return true if the file was written
+         */
+        bool write(const std::string &path, const IVideoWriter &writer) const;
+
+        /**
+         * @brief Sidecar path for a recording (<recording>.stats.json)
+         */
+        static std::string sidecarPath(const std::string &recordingPath);
+
+    private:
+        VideoConfig m_config;
+        std::chrono::steady_clock::time_point m_begin;
+        std::chrono::steady_clock::time_point m_end;
+
+        // CPU seconds at begin/end; negative when the platform cannot report them
+        std::thread::native_handle_type m_captureThread{};
+        bool m_haveCaptureThread{false};
+        double m_captureCpuBegin{-1.0};
+        double m_captureCpuEnd{-1.0};
+        double m_processCpuBegin{-1.0};
+        double m_processCpuEnd{-1.0};
+
+        // Encoder queue thread (BufferedVideoWriter) and pool workers, sampled with the capture thread
+        std::thread::native_handle_type m_queueThread{};
+        bool m_haveQueueThread{false};
+        double m_queueCpuBegin{-1.0};
+        double m_queueCpuEnd{-1.0};
+        std::vector<std::thread::native_handle_type> m_workerThreads;
+        std::vector<double> m_workerCpuBegin;
+        std::vector<double> m_workerCpuEnd;
+
+        int64_t m_captured{0};
+        int64_t m_encoded{0};
+        int64_t m_held{0}; ///< Slots covered by the previous frame (adaptive rate)
+        int64_t m_dropped{0};
+        std::array<LatencyHistogram, static_cast<int>(Stage::Count)> m_stages;
+    };
+
+} // namespace NanoRec
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "core/MediaProbe.hpp"
+#include <string>
+
+namespace NanoRec
+{
+
+    /**
+     * @struct TrimRequest
+     * @brief Parameters for exporting a clip from a recording
+     */
+    struct TrimRequest
+    {
+        std::string input;       ///< Source recording
+        std::string output;      ///< Destination file (.mp4)
+        double start{0.0};       ///< Clip start in seconds
+        double end{0.0};         ///< Clip end in seconds
+        bool frameExact{false};  ///< Re-encode partial GOPs at the edges for exact cut points
+    };
+
+    /**
+     * @class RecordingTrimmer
+     * @brief Exports clips without re-encoding the bulk of the video
+     *
+     * Whole GOPs are stream-copied by a spawned `ffmpeg -c copy`, so export time
+     * depends on clip length, not recording length. Keyframe-aligned cuts copy
+     * the whole clip; frame-exact cuts re-encode only the partial GOPs at each edge
+     * and concatenate them with the copied middle, using the middle's H.264
+     * profile, level and pixel format (other codecs fall back to keyframe-aligned).
+     */
+    class RecordingTrimmer
+    {
+    public:
+        /**
+         * @brief Export a clip
+         * @param request Trim parameters
+         * @return true if the output file was written
+         */
+        static bool trim(const TrimRequest &request);
+
+    private:
+        /**
+         * @brief Whether the partial GOPs can be re-encoded with the copied middle's codec and parameters
+         */
+        static bool canEncodeEdges(const MediaInfo &info);
+
+        static bool copySegment(const std::string &input, double start, double end, const MediaInfo &info,
+                                const std::string &output, const char *format);
+        static bool encodeSegment(const std::string &input, double start, double end,
+                                  const MediaInfo &info, const std::string &output);
+        static bool concatSegments(const std::string &listFile, const std::string &output);
+    };
+
+} // namespace NanoRec
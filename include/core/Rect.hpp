@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+
+namespace NanoRec
+{
+
+    /**
+     * @struct Rect
+     * @brief Axis-aligned pixel rectangle
+     */
+    struct Rect
+    {
+        int x{0};      ///< Left edge in pixels
+        int y{0};      ///< Top edge in pixels
+        int width{0};  ///< Width in pixels
+        int height{0}; ///< Height in pixels
+
+        Rect() = default;
+        Rect(int x_, int y_, int w, int h) : x(x_), y(y_), width(w), height(h) {}
+
+        bool isEmpty() const { return width <= 0 || height <= 0; }
+        int right() const { return x + width; }
+        int bottom() const { return y + height; }
+
+        /**
+         * @brief Smallest rectangle containing both rectangles
+         */
+        Rect united(const Rect &other) const
+        {
+            if (isEmpty())
+                return other;
+            if (other.isEmpty())
+                return *this;
+
+            int left = std::min(x, other.x);
+            int top = std::min(y, other.y);
+            return Rect(left, top, std::max(right(), other.right()) - left,
+                        std::max(bottom(), other.bottom()) - top);
+        }
+
+        /**
+         * @brief Overlapping area of both rectangles (empty if disjoint)
+         */
+        Rect intersected(const Rect &other) const
+        {
+            int left = std::max(x, other.x);
+            int top = std::max(y, other.y);
+            int w = std::min(right(), other.right()) - left;
+            int h = std::min(bottom(), other.bottom()) - top;
+            return (w > 0 && h > 0) ? Rect(left, top, w, h) : Rect();
+        }
+    };
+
+} // namespace NanoRec
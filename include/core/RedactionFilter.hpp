@@ -0,0 +1,110 @@
+#pragma once
+
+#include "capture/IScreenCapture.hpp"
+#include "core/Rect.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace NanoRec
+{
+
+    /**
+     * @brief Hides configured windows (password managers, chat) in captured frames
+     *
+     * A tracker thread on its own X connection follows the window manager's
+     * client list and each client's name, class and geometry through
+     * PropertyNotify / ConfigureNotify / Map / Unmap events, so nothing is
+     * queried per frame. The capture thread calls apply() before handing the
+     * frame to any sink; only the covered rectangles are touched, either
+     * blacked out or pixelated with SIMD block averaging.
+     */
+    class RedactionFilter
+    {
+    public:
+        enum class Mode
+        {
+            Pixelate,
+            Blackout
+        };
+
+        struct Options
+        {
+            /// Case-insensitive substrings; "class:" or "name:" prefixes restrict the match
+            std::vector<std::string> patterns;
+            Mode mode = Mode::Pixelate;
+            int blockSize = 16; ///< Pixelation block size (2..128)
+        };
+
+        RedactionFilter();
+        ~RedactionFilter();
+
+        RedactionFilter(const RedactionFilter &) = delete;
+        RedactionFilter &operator=(const RedactionFilter &) = delete;
+
+        /**
+         * @brief Start tracking windows
+         *
+         * Windows already open are scanned before this returns, so the
+         * first captured frame is redacted too.
+         * @return true if the tracker is running
+         */
+        bool start(const Options &options);
+
+        /**
+         * @brief Stop tracking (apply() becomes a no-op)
+         */
+        void stop();
+
+        bool isRunning() const { return m_running.load(); }
+
+        /**
+         * @brief Redact tracked windows in a frame
+         * @param frame RGB24 frame
+         * @param originX Desktop X of the frame's left edge (monitor offset)
+         * @param originY Desktop Y of the frame's top edge
+         */
+        void apply(FrameBuffer &frame, int originX, int originY);
+
+        /**
+         * @brief Current redacted rectangles in desktop coordinates
+         */
+        std::vector<Rect> getRects() const;
+
+        /**
+         * @brief Replace a rectangle with the average colour of each block
+         */
+        static void pixelate(FrameBuffer &frame, const Rect &rect, int blockSize);
+
+        /**
+         * @brief Fill a rectangle with black
+         */
+        static void blackout(FrameBuffer &frame, const Rect &rect);
+
+        /**
+         * @brief Check a window's class/name against the patterns
+         */
+        static bool matches(const std::vector<std::string> &patterns, const std::string &windowClass,
+                            const std::string &windowName);
+
+    private:
+        struct Tracker;
+
+        void trackerLoop();
+        void publish(std::vector<Rect> rects);
+
+        Options m_options;
+        std::unique_ptr<Tracker> m_tracker;
+        std::thread m_thread;
+        std::atomic<bool> m_running{false};
+        std::atomic<bool> m_shouldStop{false};
+
+        mutable std::mutex m_rectsMutex;
+        std::vector<Rect> m_rects;
+        std::vector<Rect> m_applyRects; ///< Capture-thread copy, avoids reallocating per frame
+    };
+
+} // namespace NanoRec
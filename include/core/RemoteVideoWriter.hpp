@@ -0,0 +1,157 @@
+/**
+ * @file RemoteVideoWriter.hpp
+ * @brief Video writer that offloads encoding to nanorec-encoder-node over TCP
+ * @author NanoRec-CPP Team
+ * @date 2026-10-18
+ */
+
+#ifndef NANOREC_REMOTEVIDEOWRITER_HPP
+#define NANOREC_REMOTEVIDEOWRITER_HPP
+
+#include "EncoderProtocol.hpp"
+#include "IVideoWriter.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace NanoRec
+{
+
+    /**
+     * @class RemoteVideoWriter
+     * @brief Sends raw frames as compressed block deltas to a remote encoder node
+     *
+     * initialize() asks every configured node for its load and opens the
+     * session on the least busy one, so concurrent sessions (and the next
+     * segment while the previous one still drains) spread over the nodes.
+     * writeFrame() only copies the frame into a queue; a sender thread
+     * delta-encodes, compresses and transmits it, and the node acknowledges
+     * each frame once its ffmpeg took it. When maxInFlight frames are queued
+     * or unacknowledged, new frames are dropped instead of stalling capture;
+     * the node repeats the previous frame in their place so playback time is
+     * preserved. writeFrameAt() uses the pts as the frame's sequence, so slots
+     * without a frame are filled the same way. finalize() waits for the node to finish and downloads the
+     * encoded file to VideoConfig::output.
+     */
+    class RemoteVideoWriter : public IVideoWriter
+    {
+    public:
+        struct Options
+        {
+            std::vector<std::string> nodes; ///< host[:port] of encoder nodes
+            int maxInFlight = 8;            ///< Frames queued or unacknowledged before new ones are dropped
+            int connectTimeoutMs = 2000;
+            int finishTimeoutMs = 120000; ///< Encoder drain and file transfer in finalize()
+        };
+
+        /**
+         * @brief Split a comma-separated node list (blank entries skipped)
+         */
+        static std::vector<std::string> parseNodeList(const std::string &list);
+
+        explicit RemoteVideoWriter(const Options &options);
+        ~RemoteVideoWriter() override;
+
+        bool initialize(const VideoConfig &config) override;
+        bool writeFrame(const uint8_t *frameData, size_t dataSize) override;
+        bool writeFrameAt(const uint8_t *frameData, size_t dataSize, int64_t pts) override;
+
+        /**
+         * @brief The node pads the last frame up to this slot
+         */
+        void setEndTime(int64_t pts) override;
+
+        bool finalize() override;
+        bool isActive() const override { return m_active; }
+
+        /**
+         * @brief Compressed bytes sent to the node since initialize()
+         */
+        uint64_t getBytesWritten() const override { return m_bytesSent.load(); }
+
+        /**
+         * @brief The node's ffmpeg CPU time and peak memory (valid after finalize())
+         */
+        EncoderUsage getEncoderUsage() const override { return m_encoderUsage; }
+
+        /**
+         * @brief Node serving the session ("host:port")
+         */
+        const std::string &getNode() const { return m_node; }
+
+        /**
+         * @brief Frames dropped by backpressure (or after the link failed)
+         */
+        uint64_t getDroppedFrames() const;
+
+        /**
+         * @brief Frames the node wrote to ffmpeg, padding included (valid after finalize())
+         */
+        uint64_t getEncodedFrames() const { return m_encodedFrames; }
+
+    private:
+        struct PendingFrame
+        {
+            uint64_t sequence;
+            uint64_t timestampUs; ///< Since the first frame of the session
+            std::vector<uint8_t> data;
+        };
+
+        bool openSession();
+
+        /**
+         * @brief Queue a frame for the sender; pts -1 takes the next slot
+         */
+        bool enqueue(const uint8_t *frameData, size_t dataSize, int64_t pts);
+
+        void sendLoop();
+        void receiveLoop();
+        void fail(const std::string &reason);
+        void closeSession();
+
+        Options m_options;
+        VideoConfig m_config;
+        size_t m_frameSize{0};
+        std::unique_ptr<EncoderLink> m_link;
+        std::string m_node;
+        FrameCodec m_codec{FrameCodec::None};
+        bool m_active{false};
+        std::chrono::steady_clock::time_point m_start;
+
+        std::thread m_sender;
+        std::thread m_receiver;
+
+        // Shared by writeFrame(), the sender and the receiver
+        mutable std::mutex m_mutex;
+        std::condition_variable m_changed;
+        std::deque<PendingFrame> m_queue;
+        std::vector<std::vector<uint8_t>> m_pool; ///< Recycled frame copies
+        int m_inFlight{0};                        ///< Queued plus sent but not acknowledged
+        uint64_t m_nextSequence{0};
+        uint64_t m_dropped{0};
+        bool m_finishing{false};
+        bool m_failed{false};
+        bool m_done{false}; ///< Result and file received
+        std::atomic<uint64_t> m_bytesSent{0};
+
+        FrameDelta m_delta; ///< Sender only
+
+        // Receiver only until m_done
+        bool m_resultOk{false};
+        uint64_t m_encodedFrames{0};
+        EncoderUsage m_encoderUsage;
+        uint64_t m_fileSize{0};
+        uint64_t m_fileReceived{0};
+        std::ofstream m_file;
+        std::string m_partialPath;
+    };
+
+} // namespace NanoRec
+
+#endif // NANOREC_REMOTEVIDEOWRITER_HPP
@@ -0,0 +1,13 @@
+#pragma once
+
+/**
+ * @brief SIMD level of the pixel kernels
+ *
+ * NANOREC_HAVE_SSE2 is defined (and the SSE2 intrinsics included) on x86
+ * builds with SSE2, unless NANOREC_NO_SIMD asks for the scalar fallbacks,
+ * e.g. for test_accuracy_scalar.
+ */
+#if !defined(NANOREC_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define NANOREC_HAVE_SSE2 1
+#endif
@@ -0,0 +1,91 @@
+/**
+ * @file SimulatedVideoWriter.hpp
+ * @brief Encoder stand-in with injectable latency, throughput caps and failures
+ * @author NanoRec-CPP Team
+ * @date 2026-10-18
+ */
+
+#ifndef NANOREC_SIMULATEDVIDEOWRITER_HPP
+#define NANOREC_SIMULATEDVIDEOWRITER_HPP
+
+#include "IVideoWriter.hpp"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace NanoRec
+{
+
+    /**
+     * @class SimulatedVideoWriter
+     * @brief IVideoWriter that encodes nothing but misbehaves on request
+     *
+     * Used to check how the pipeline copes with a slow or dying encoder:
+     * writeFrame() blocks like a full ffmpeg pipe would (fixed latency,
+     * periodic spikes, a byte-rate cap), every Nth write can come back
+     * short, and the "process" can exit after a number of frames, after
+     * which writes fail and isActive() turns false. Nothing is written to
+     * disk. Select it with app.encoder_simulation (see parseSpec()).
+     */
+    class SimulatedVideoWriter : public IVideoWriter
+    {
+    public:
+        struct Options
+        {
+            int latencyUs = 0;             ///< Time every write takes
+            int spikeMs = 0;               ///< Extra stall of every spikeEvery-th write
+            int spikeEvery = 0;            ///< 0 = no spikes
+            double throughputMBps = 0.0;   ///< Byte-rate cap (0 = unlimited)
+            int partialEvery = 0;          ///< Every Nth write is short and fails (0 = never)
+            int64_t exitAfterFrames = -1;  ///< The encoder exits after this many frames (-1 = never)
+            bool failInitialize = false;   ///< initialize() fails (encoder missing)
+
+            /**
+             * @brief Called with every frame the encoder accepted (tests check order and content)
+             */
+            std::function<void(const uint8_t *data, size_t size)> onFrame;
+        };
+
+        /**
+         * @brief Parse "latency=2,spike=250/30,rate=40,partial=50,exit=900"
+         *
+         * latency in ms per write, spike as ms/every-N-frames, rate in MB/s,
+         * partial as every-N-writes, exit after N frames, plus "noinit".
+         * @return false on an unknown key or malformed value
+         */
+        static bool parseSpec(const std::string &spec, Options &options);
+
+        explicit SimulatedVideoWriter(const Options &options);
+
+        bool initialize(const VideoConfig &config) override;
+        bool writeFrame(const uint8_t *frameData, size_t dataSize) override;
+        bool finalize() override;
+        bool isActive() const override { return m_active && !m_exited.load(); }
+
+        uint64_t getBytesWritten() const override { return m_bytesWritten; }
+
+        /**
+         * @brief Frames accepted since initialize()
+         */
+        uint64_t getFramesWritten() const { return m_framesWritten; }
+
+        /**
+         * @brief Short writes injected since initialize()
+         */
+        uint64_t getPartialWrites() const { return m_partialWrites; }
+
+    private:
+        Options m_options;
+        VideoConfig m_config;
+        bool m_active{false};
+        std::atomic<bool> m_exited{false};
+        uint64_t m_writes{0};
+        uint64_t m_framesWritten{0};
+        uint64_t m_partialWrites{0};
+        uint64_t m_bytesWritten{0};
+    };
+
+} // namespace NanoRec
+
+#endif // NANOREC_SIMULATEDVIDEOWRITER_HPP
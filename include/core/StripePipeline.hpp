@@ -0,0 +1,51 @@
+#pragma once
+
+#include "capture/IScreenCapture.hpp"
+#include "core/TextOverlay.hpp"
+#include "core/YuvConverter.hpp"
+#include <vector>
+
+namespace NanoRec
+{
+
+    /**
+     * @class StripePipeline
+     * @brief Scale, overlay and YUV conversion fused per horizontal stripe
+     *
+     * The full-frame path writes a scaled RGB frame, blends the overlay into
+     * it and reads it back for the YUV conversion, streaming the frame
+     * through DRAM three times. Here each stripe of a few dozen encoder rows
+     * is scaled into a small buffer, overlaid and converted while it is still
+     * in L2, so the encoder-format frame is the only full-size output. At
+     * native resolution, stripes without overlay text are converted straight
+     * from the captured frame.
+     *
+     * The output is identical to FrameScaler::scaleFrame() + TextOverlay +
+     * YuvConverter::convert().
+     */
+    class StripePipeline
+    {
+    public:
+        /**
+         * @brief Produce the encoder frame for one captured frame
+         * @param source Captured RGB24 frame (not modified)
+         * @param width Encoder frame width
+         * @param height Encoder frame height
+         * @param overlay Overlay already laid out with prepareFrame(width, height), or nullptr
+         * @param layout Encoder pixel layout
+         * @param destination Encoder-format frame (resized as needed)
+         * @param stripeRows Rows per stripe (rounded up to even)
+         * @param threads Bands of stripes run on the shared WorkerPool (1 = calling thread only)
+         * @return true on success
+         */
+        bool process(const FrameBuffer &source, int width, int height, const TextOverlay *overlay,
+                     YuvFrame::Layout layout, YuvFrame &destination, int stripeRows, int threads = 1);
+
+    private:
+        static void processBand(const FrameBuffer &source, const TextOverlay *overlay, YuvFrame &destination,
+                                int rowBegin, int rowEnd, int stripeRows, FrameBuffer &stripe);
+
+        std::vector<FrameBuffer> m_stripes; ///< One working stripe per band, reused across frames
+    };
+
+} // namespace NanoRec
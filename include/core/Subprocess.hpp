@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#endif
+
+namespace NanoRec
+{
+
+    /**
+     * @class Subprocess
+     * @brief Child process with optional stdin/stdout pipes
+     *
+     * Used to drive ffmpeg/ffprobe for decoding, probing and remuxing.
+     * Arguments are passed as a vector (no shell) on Linux.
+     */
+    class Subprocess
+    {
+    public:
+        enum PipeFlags
+        {
+            PIPE_NONE = 0,
+            PIPE_STDIN = 1,
+            PIPE_STDOUT = 2
+        };
+
+        Subprocess();
+        ~Subprocess();
+
+        Subprocess(const Subprocess &) = delete;
+        Subprocess &operator=(const Subprocess &) = delete;
+
+        /**
+         * @brief Spawn a process
+         * @param args Program name followed by its arguments (looked up in PATH)
+         * @param pipes Combination of PipeFlags
+         * @return true if the process was started
+         */
+        bool start(const std::vector<std::string> &args, int pipes = PIPE_STDOUT);
+
+        /**
+         * @brief Run the next started child at idle CPU and I/O priority
+         *
+         * Linux: SCHED_IDLE and the idle I/O class, applied before exec so every
+         * thread the child creates inherits them. Windows: IDLE_PRIORITY_CLASS.
+         */
+        void setIdlePriority(bool idle) { m_idlePriority = idle; }
+
+        /**
+         * @brief Pause the child (SIGSTOP); no-op on Windows
+         * @return true if the child was paused
+         */
+        bool suspend();
+
+        /**
+         * @brief Resume a paused child (SIGCONT); no-op on Windows
+         */
+        bool resume();
+
+        /**
+         * @brief Read exactly size bytes from the child's stdout
+         * @return true if all bytes were read, false on EOF or error
+         */
+        bool readExact(void *buffer, size_t size);
+
+        /**
+         * @brief Read whatever is available from stdout (blocking)
+         * @return Bytes read, 0 on EOF, -1 on error
+         */
+        long readSome(void *buffer, size_t size);
+
+        /**
+         * @brief Write all bytes to the child's stdin
+         */
+        bool writeAll(const void *data, size_t size);
+
+        /**
+         * @brief Close the child's stdin (signals EOF)
+         */
+        void closeStdin();
+
+        /**
+         * @brief Wait for the child to exit
+         * @return Exit code, or -1 if it did not exit normally
+         */
+        int wait();
+
+        /**
+         * @brief Reap the child if it has already exited (non-blocking)
+         * @param exitCode Receives the exit code (-1 if it did not exit normally)
+         * @return true if the child exited and was reaped
+         */
+        bool tryWait(int &exitCode);
+
+        /**
+         * @brief Forcefully terminate the child and reap it
+         */
+        void kill();
+
+        /**
+         * @brief Send a kill request without reaping the child
+         *
+         * Safe to call from another thread to unblock a reader; the owning
+         * thread still has to call wait() (or kill()) afterwards.
+         */
+        void interrupt();
+
+        /**
+         * @brief Check if a child process is attached
+         */
+        bool isRunning() const;
+
+#ifndef _WIN32
+        pid_t getPid() const { return m_pid; }
+#endif
+
+        /**
+         * @brief Run a process to completion and capture its stdout
+         * @param args Program name followed by its arguments
+         * @param output Captured stdout
+         * @return true if the process exited with code 0
+         */
+        static bool run(const std::vector<std::string> &args, std::string &output);
+
+    private:
+        void closePipes();
+
+        bool m_idlePriority{false};
+
+#ifdef _WIN32
+        HANDLE m_stdin;
+        HANDLE m_stdout;
+        PROCESS_INFORMATION m_processInfo;
+#else
+        int m_stdinFd;
+        int m_stdoutFd;
+        pid_t m_pid;
+#endif
+    };
+
+} // namespace NanoRec
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "capture/IScreenCapture.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace NanoRec
+{
+
+    /**
+     * @brief Burns a wall-clock timestamp and host label into frames
+     *
+     * Glyphs of a built-in 8x8 bitmap font are rasterized once, at the
+     * configured scale, into an atlas of pre-multiplied colour and inverse
+     * alpha (background box, drop shadow and text already composited). The
+     * label is kept as a strip built from atlas cells; when the text changes
+     * only the cells whose character changed are copied. Each frame then
+     * blends the strip with SIMD, so the cost depends on the label size, not
+     * the frame size.
+     */
+    class TextOverlay
+    {
+    public:
+        enum class Corner
+        {
+            TopLeft,
+            TopRight,
+            BottomLeft,
+            BottomRight
+        };
+
+        struct Options
+        {
+            std::string label;              ///< Host label (empty = host name)
+            int scale = 2;                  ///< Glyph scale (8x8 font -> 16x16 cells at 2)
+            Corner corner = Corner::BottomRight;
+            int margin = 8;                 ///< Distance from the frame edges in pixels
+            uint8_t color[3] = {255, 255, 255};
+            uint8_t backgroundAlpha = 160;  ///< Opacity of the black box behind the text
+        };
+
+        TextOverlay();
+
+        /**
+         * @brief Rasterize the glyph atlas for the given options
+         * @return true if the options are valid
+         */
+        bool configure(const Options &options);
+
+        /**
+         * @brief Burn the current time and label into an RGB24 frame
+         */
+        void apply(FrameBuffer &frame);
+
+        /**
+         * @brief Burn arbitrary text into an RGB24 frame
+         */
+        void apply(FrameBuffer &frame, const std::string &text);
+
+        /**
+         * @brief Lay out the current time and label for a frame, for applyStripe()
+         * @param width Frame width
+         * @param height Frame height
+         */
+        void prepareFrame(int width, int height);
+
+        /**
+         * @brief Lay out arbitrary text for a frame, for applyStripe()
+         */
+        void prepareFrame(int width, int height, const std::string &text);
+
+        /**
+         * @brief Blend the prepared text into one horizontal stripe of the frame
+         *
+         * Safe to call from several threads for different stripes.
+         * @param stripe Frame rows [stripeTop, stripeTop + stripe.height)
+         * @param stripeTop Frame row of the stripe's first row
+         */
+        void applyStripe(FrameBuffer &stripe, int stripeTop) const;
+
+        /**
+         * @brief Frame rows [top, bottom) covered by the prepared text (empty if none)
+         */
+        void getPreparedRows(int &top, int &bottom) const;
+
+        /**
+         * @brief Get the host name used as the default label
+         */
+        static std::string getHostName();
+
+    private:
+        static constexpr int FIRST_GLYPH = 32;
+        static constexpr int GLYPH_COUNT = 95;
+
+        std::string timestampText() const;
+        void setText(const std::string &text);
+        void copyCell(size_t index, char c);
+        void blend(FrameBuffer &frame, int x, int y) const;
+
+        Options m_options;
+        int m_cellWidth{0};
+        int m_cellHeight{0};
+
+        // Atlas: GLYPH_COUNT cells, each m_cellWidth x m_cellHeight in RGB24 layout
+        std::vector<uint8_t> m_atlasPremul;
+        std::vector<uint8_t> m_atlasInverse;
+
+        // Label strip (text.size() cells wide) and its position from prepareFrame()
+        std::string m_text;
+        int m_placedX{0};
+        int m_placedY{0};
+        bool m_placed{false};
+        std::vector<uint8_t> m_stripPremul;
+        std::vector<uint8_t> m_stripInverse;
+    };
+
+} // namespace NanoRec
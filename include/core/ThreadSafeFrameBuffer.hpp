@@ -1,6 +1,7 @@
 #pragma once
 
 #include "capture/IScreenCapture.hpp"
+#include "core/YuvConverter.hpp"
 #include <atomic>
 #include <mutex>
 #include <memory>
@@ -11,8 +12,9 @@ namespace NanoRec
     /**
      * @brief Thread-safe double-buffered frame storage
      *
-     * Allows one thread to write frames while another reads them
-     * without blocking. Uses double buffering with atomic swap.
+     * Allows one thread to write frames while another reads them. The writer
+     * fills its buffer without locking; only the swap and the reader's copy
+     * take the lock.
      */
     class ThreadSafeFrameBuffer
     {
@@ -29,6 +31,8 @@ namespace NanoRec
 
         /**
          * @brief Push a new frame (called by capture thread)
+         *
+         * Frames may change size between pushes (the buffers follow).
          * @param frame Frame data to copy
          * @return true if successful
          */
@@ -46,11 +50,31 @@ namespace NanoRec
          */
         bool hasNewFrame() const { return m_hasNewFrame.load(); }
 
+        /**
+         * @brief Publish an encoder-format frame for the YUV preview (called by capture thread)
+         *
+         * Buffers are exchanged rather than copied: the frame's contents move
+         * into the slot and @p frame receives a recycled buffer.
+         */
+        void pushYuvFrame(YuvFrame &frame);
+
+        /**
+         * @brief Take the latest encoder-format frame (called by UI thread)
+         * @param outFrame Receives the frame; its previous buffer is recycled
+         * @return true if a new frame was available
+         */
+        bool getLatestYuvFrame(YuvFrame &outFrame);
+
+        /**
+         * @brief Check if a new encoder-format frame is available
+         */
+        bool hasNewYuvFrame() const { return m_hasNewYuvFrame.load(); }
+
         /**
          * @brief Get frame dimensions
          */
-        int getWidth() const { return m_width; }
-        int getHeight() const { return m_height; }
+        int getWidth() const { return m_width.load(); }
+        int getHeight() const { return m_height.load(); }
 
     private:
         // Double buffer
@@ -61,8 +85,13 @@ namespace NanoRec
 
         std::mutex m_swapMutex;
 
-        int m_width{0};
-        int m_height{0};
+        // Latest encoder-format frame (only published while recording in YUV)
+        YuvFrame m_yuvFrame;
+        std::atomic<bool> m_hasNewYuvFrame{false};
+        std::mutex m_yuvMutex;
+
+        std::atomic<int> m_width{0};
+        std::atomic<int> m_height{0};
     };
 
 } // namespace NanoRec
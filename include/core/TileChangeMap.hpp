@@ -0,0 +1,75 @@
+#pragma once
+
+#include "capture/IScreenCapture.hpp"
+#include "core/Rect.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace NanoRec
+{
+
+    /**
+     * @brief Per-tile change detection for RGB24 frames
+     *
+     * Hashes each TILE_SIZE x TILE_SIZE tile in a single row-major pass and
+     * compares against the previous frame's hashes. Downstream stages use the
+     * result to skip unchanged areas (changed rectangles, activity, waits).
+     */
+    class TileChangeMap
+    {
+    public:
+        static constexpr int TILE_SIZE = 32;
+
+        /**
+         * @brief Hash a new frame and mark tiles that differ from the previous one
+         * @param frame RGB24 frame
+         * @param dirty Areas that may differ from the previous update (nullptr = anywhere);
+         *              tiles outside them keep their hash and count as unchanged
+         * @return Number of changed tiles (all tiles on the first frame or a size change)
+         */
+        int update(const FrameBuffer &frame, const std::vector<Rect> *dirty = nullptr);
+
+        /**
+         * @brief Forget the previous frame (next update marks everything changed)
+         */
+        void reset();
+
+        int getTilesX() const { return m_tilesX; }
+        int getTilesY() const { return m_tilesY; }
+        int getChangedTileCount() const { return m_changedCount; }
+
+        bool isTileChanged(int tx, int ty) const { return m_changed[ty * m_tilesX + tx] != 0; }
+        uint64_t getTileHash(int tx, int ty) const { return m_hashes[ty * m_tilesX + tx]; }
+
+        /**
+         * @brief Fraction of the frame area covered by changed tiles (0..1)
+         */
+        double getChangedFraction() const;
+
+        /**
+         * @brief Bounding box of all changed tiles in pixels (clipped to the frame)
+         */
+        Rect getChangedBounds() const;
+
+        /**
+         * @brief Check whether any tile overlapping a pixel region changed
+         */
+        bool isRegionChanged(const Rect &region) const;
+
+    private:
+        Rect tileRange(const Rect &region) const;
+
+        int m_width{0};
+        int m_height{0};
+        int m_tilesX{0};
+        int m_tilesY{0};
+        int m_changedCount{0};
+        Rect m_changedTiles; ///< Bounds in tile units
+        std::vector<uint64_t> m_hashes;
+        std::vector<uint64_t> m_previous;
+        std::vector<uint8_t> m_changed;
+        std::vector<uint8_t> m_dirty;     ///< Tiles to re-hash (hinted updates only)
+        std::vector<uint8_t> m_dirtyRows; ///< Tile rows with at least one such tile
+    };
+
+} // namespace NanoRec
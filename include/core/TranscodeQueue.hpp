@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace NanoRec
+{
+
+    /**
+     * @brief Background queue that re-encodes finished recordings to save space
+     *
+     * Live recording uses a fast x264 preset; this queue re-encodes each
+     * finished file with a slower preset in a child ffmpeg running at idle CPU
+     * and I/O priority. While the pause condition holds (e.g. a live recording
+     * is close to its frame budget) the child is stopped with SIGSTOP. The
+     * original is replaced only when the new file is smaller.
+     */
+    class TranscodeQueue
+    {
+    public:
+        struct Options
+        {
+            std::string preset = "slow"; ///< x264 preset for the archive encode
+            int crf = 23;                ///< Same quality target as live recording
+        };
+
+        using PauseCondition = std::function<bool()>;
+
+        TranscodeQueue();
+        ~TranscodeQueue();
+
+        TranscodeQueue(const TranscodeQueue &) = delete;
+        TranscodeQueue &operator=(const TranscodeQueue &) = delete;
+
+        /**
+         * @brief Start the worker thread
+         * @param options Encoder settings
+         * @return true if started
+         */
+        bool start(const Options &options);
+
+        /**
+         * @brief Stop the worker; an in-progress job is aborted and the original kept
+         */
+        void stop();
+
+        /**
+         * @brief Set the predicate polled while a job runs (set before start())
+         */
+        void setPauseCondition(PauseCondition condition) { m_pauseCondition = std::move(condition); }
+
+        /**
+         * @brief Queue a finished recording for re-encoding
+         * @return true if the file exists and was queued
+         */
+        bool enqueue(const std::string &path);
+
+        bool isRunning() const { return m_running.load(); }
+        bool isPaused() const { return m_paused.load(); }
+        size_t getPendingCount() const;
+        int getCompletedCount() const { return m_completed.load(); }
+
+        /**
+         * @brief Total bytes saved by all completed jobs
+         */
+        uint64_t getBytesSaved() const { return m_bytesSaved.load(); }
+
+    private:
+        void workerLoop();
+        bool transcode(const std::string &path);
+
+        Options m_options;
+        PauseCondition m_pauseCondition;
+
+        std::thread m_thread;
+        mutable std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::deque<std::string> m_pending;
+
+        std::atomic<bool> m_running{false};
+        std::atomic<bool> m_shouldStop{false};
+        std::atomic<bool> m_paused{false};
+        std::atomic<int> m_completed{0};
+        std::atomic<uint64_t> m_bytesSaved{0};
+    };
+
+} // namespace NanoRec
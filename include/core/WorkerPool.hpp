@@ -0,0 +1,78 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace NanoRec
+{
+
+    /**
+     * @class WorkerPool
+     * @brief Persistent threads for splitting one frame's work into bands
+     *
+     * Replaces spawning and joining threads on every frame. The caller runs
+     * band 0 itself and, while it waits, also runs queued bands, so nested
+     * or concurrent callers never deadlock on a busy pool.
+     */
+    class WorkerPool
+    {
+    public:
+        /**
+         * @param threads Worker threads (0 = every band runs on the calling thread)
+         */
+        explicit WorkerPool(int threads);
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool &) = delete;
+        WorkerPool &operator=(const WorkerPool &) = delete;
+
+        /**
+         * @brief Run task(0) .. task(count - 1) and return when all have finished
+         */
+        void parallelFor(int count, const std::function<void(int)> &task);
+
+        int getThreadCount() const { return static_cast<int>(m_threads.size()); }
+
+        /**
+         * @brief Native handles of the worker threads (e.g. for their CPU clocks)
+         */
+        std::vector<std::thread::native_handle_type> getNativeHandles();
+
+        /**
+         * @brief Pool shared by the pixel kernels (one thread per extra hardware thread)
+         */
+        static WorkerPool &shared();
+
+    private:
+        struct Job
+        {
+            const std::function<void(int)> *task;
+            int remaining;
+        };
+
+        struct Band
+        {
+            Job *job;
+            int index;
+        };
+
+        void workerLoop();
+
+        /**
+         * @brief Run one band (called without m_mutex held) and account for it
+         */
+        void runBand(const Band &band);
+
+        std::vector<std::thread> m_threads;
+        std::mutex m_mutex;
+        std::condition_variable m_work; ///< Bands queued or stopping
+        std::condition_variable m_done; ///< A job's last band finished
+        std::deque<Band> m_queue;
+        bool m_stopping{false};
+    };
+
+} // namespace NanoRec
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "capture/IScreenCapture.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace NanoRec
+{
+
+    /**
+     * @struct YuvFrame
+     * @brief 8-bit 4:2:0 frame in an encoder input layout (BT.601 limited range)
+     *
+     * I420 stores Y, U and V planes; NV12 stores Y and one interleaved UV
+     * plane. Planes are tightly packed; chroma planes are half size, rounded up.
+     */
+    struct YuvFrame
+    {
+        enum class Layout
+        {
+            I420,
+            NV12
+        };
+
+        Layout layout{Layout::I420};
+        int width{0};
+        int height{0};
+        std::vector<uint8_t> data;
+
+        int chromaWidth() const { return (width + 1) / 2; }
+        int chromaHeight() const { return (height + 1) / 2; }
+        size_t lumaSize() const { return static_cast<size_t>(width) * height; }
+        size_t chromaSize() const { return static_cast<size_t>(chromaWidth()) * chromaHeight(); }
+
+        const uint8_t *planeY() const { return data.data(); }
+        const uint8_t *planeU() const { return data.data() + lumaSize(); } ///< U (I420) or UV (NV12)
+        const uint8_t *planeV() const { return data.data() + lumaSize() + chromaSize(); } ///< I420 only
+
+        /**
+         * @brief Size the buffer for a frame (keeps the allocation when unchanged)
+         */
+        void allocate(int w, int h, Layout l)
+        {
+            width = w;
+            height = h;
+            layout = l;
+            data.resize(lumaSize() + 2 * chromaSize());
+        }
+
+        /**
+         * @brief Map an ffmpeg pixel format name to a layout
+         * @return false for formats that are not 8-bit 4:2:0 I420/NV12
+         */
+        static bool layoutFromPixelFormat(const std::string &pixelFormat, Layout &layout)
+        {
+            if (pixelFormat == "yuv420p")
+            {
+                layout = Layout::I420;
+                return true;
+            }
+            if (pixelFormat == "nv12")
+            {
+                layout = Layout::NV12;
+                return true;
+            }
+            return false;
+        }
+    };
+
+    /**
+     * @class YuvConverter
+     * @brief RGB24 to I420/NV12 conversion for the encoder and the YUV preview
+     *
+     * BT.601 limited range with 2x2 averaged (centre-sited) chroma, matching
+     * what ffmpeg's scaler produces from rgb24 input by default.
+     */
+    class YuvConverter
+    {
+    public:
+        /**
+         * @brief Convert an RGB24 frame
+         * @param source RGB24 frame
+         * @param destination Output frame (resized as needed)
+         * @param layout I420 or NV12
+         * @param threads Bands of rows run on the shared WorkerPool (1 = calling thread only)
+         * @return true on success
+         */
+        static bool convert(const FrameBuffer &source, YuvFrame &destination, YuvFrame::Layout layout,
+                            int threads = 1);
+
+        /**
+         * @brief Convert frame rows [rowBegin, rowEnd) (stripe processing)
+         *
+         * Writes exactly what convert() writes for those rows.
+         * @param source RGB24 rows; its first row is frame row @p sourceTop
+         * @param sourceTop Frame row held by the first row of @p source
+         * @param destination Frame already sized with YuvFrame::allocate()
+         * @param rowBegin First frame row (even)
+         * @param rowEnd End row (even, or the frame height)
+         */
+        static void convertStripe(const FrameBuffer &source, int sourceTop, YuvFrame &destination, int rowBegin,
+                                  int rowEnd);
+
+    private:
+        static void convertRows(const FrameBuffer &source, int sourceTop, YuvFrame &destination,
+                                int chromaRowBegin, int chromaRowEnd);
+    };
+
+} // namespace NanoRec
@@ -10,7 +10,8 @@ namespace NanoRec
      * @brief RAII wrapper for OpenGL textures
      *
      * Manages OpenGL texture lifecycle with automatic cleanup.
-     * Supports RGB/RGBA formats and efficient texture updates.
+     * Supports RGB/RGBA formats and efficient texture updates, plus one- and
+     * two-channel textures for YUV planes sampled by shaders.
      */
     class GLTexture
     {
@@ -26,8 +27,8 @@ namespace NanoRec
          * @brief Create texture from image data
          * @param width Texture width in pixels
          * @param height Texture height in pixels
-         * @param data Pointer to RGB/RGBA pixel data
-         * @param channels Number of color channels (3 for RGB, 4 for RGBA)
+         * @param data Pointer to pixel data (may be null to allocate only)
+         * @param channels Number of color channels (1 = R8, 2 = RG8, 3 = RGB, 4 = RGBA)
          * @return true if texture created successfully
          */
         bool create(int width, int height, const uint8_t *data, int channels = 3);
@@ -39,6 +40,17 @@ namespace NanoRec
          */
         bool update(const uint8_t *data);
 
+        /**
+         * @brief Update a sub-rectangle of the texture
+         * @param x Left edge in pixels
+         * @param y Top edge in pixels
+         * @param width Region width
+         * @param height Region height
+         * @param data Tightly packed pixel data for the region
+         * @return true if update successful
+         */
+        bool updateRegion(int x, int y, int width, int height, const uint8_t *data);
+
         /**
          * @brief Get OpenGL texture ID
          * @return Texture ID (0 if not created)
@@ -70,8 +82,8 @@ namespace NanoRec
         int m_width;
         int m_height;
         int m_channels;
-        unsigned int m_format;      // GL_RGB or GL_RGBA
-        unsigned int m_internalFormat; // GL_RGB8 or GL_RGBA8
+        unsigned int m_format;      // GL_RED, GL_RG, GL_RGB or GL_RGBA
+        unsigned int m_internalFormat; // GL_R8, GL_RG8, GL_RGB8 or GL_RGBA8
     };
 
 } // namespace NanoRec
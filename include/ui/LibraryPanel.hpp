@@ -0,0 +1,81 @@
+#pragma once
+
+#include "core/RecordingLibrary.hpp"
+#include "ui/GLTexture.hpp"
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace NanoRec
+{
+
+    /**
+     * @brief ImGui panel listing the recordings in the output directory
+     *
+     * Only visible rows (ImGuiListClipper) are sent to RecordingLibrary for
+     * metadata and thumbnail extraction. Thumbnails are shown from a small GL
+     * atlas texture whose cells are filled from the on-disk atlas on demand
+     * and recycled least-recently-used.
+     */
+    class LibraryPanel
+    {
+    public:
+        using OpenCallback = std::function<void(const std::string &path)>;
+
+        LibraryPanel();
+        ~LibraryPanel();
+
+        LibraryPanel(const LibraryPanel &) = delete;
+        LibraryPanel &operator=(const LibraryPanel &) = delete;
+
+        /**
+         * @brief Start indexing a recordings directory
+         * @return true if indexing started
+         */
+        bool open(const std::string &directory);
+
+        /**
+         * @brief Re-list the directory (e.g. after a recording finished)
+         */
+        void refresh();
+
+        /**
+         * @brief Called with the full path when a recording is activated
+         */
+        void setOpenCallback(OpenCallback callback) { m_onOpen = std::move(callback); }
+
+        /**
+         * @brief Render the panel (call between ImGui::NewFrame and ImGui::Render)
+         * @param visible Window visibility flag
+         */
+        void render(bool *visible);
+
+        /**
+         * @brief Stop indexing and release GL resources (requires current GL context)
+         */
+        void shutdown();
+
+    private:
+        static constexpr int ATLAS_COLUMNS = 8;
+        static constexpr int ATLAS_ROWS = 8;
+
+        int acquireCell(int slot);
+        void invalidateCells();
+
+        RecordingLibrary m_library;
+        std::vector<LibraryEntry> m_entries;
+        uint64_t m_generation{0};
+        std::vector<std::string> m_requested;
+        OpenCallback m_onOpen;
+
+        // GL thumbnail cache: atlas cell -> library slot
+        GLTexture m_atlas;
+        std::vector<uint8_t> m_thumbnail;
+        std::unordered_map<int, int> m_cellBySlot;
+        std::vector<int> m_slotByCell;
+        std::vector<uint64_t> m_cellLastUse;
+        uint64_t m_frameCounter{0};
+    };
+
+} // namespace NanoRec
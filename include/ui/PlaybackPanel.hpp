@@ -0,0 +1,77 @@
+#pragma once
+
+#include "core/ActivityIndex.hpp"
+#include "core/RecordingPlayer.hpp"
+#include "ui/GLTexture.hpp"
+#include <future>
+#include <string>
+#include <vector>
+
+namespace NanoRec
+{
+
+    /**
+     * @brief ImGui panel for reviewing recordings inside NanoRec
+     *
+     * Shows frames from RecordingPlayer's cache through a GLTexture and
+     * drives its playhead from the timeline slider and play/pause state.
+     */
+    class PlaybackPanel
+    {
+    public:
+        PlaybackPanel();
+        ~PlaybackPanel();
+
+        PlaybackPanel(const PlaybackPanel &) = delete;
+        PlaybackPanel &operator=(const PlaybackPanel &) = delete;
+
+        /**
+         * @brief Prefill the file path (e.g. with the last recording)
+         */
+        void setPath(const std::string &path);
+
+        /**
+         * @brief Open a recording for playback
+         * @return true if the recording was opened
+         */
+        bool open(const std::string &path);
+
+        /**
+         * @brief Render the panel (call between ImGui::NewFrame and ImGui::Render)
+         * @param visible Window visibility flag
+         */
+        void render(bool *visible);
+
+        /**
+         * @brief Stop decoding and release GL resources (requires current GL context)
+         */
+        void shutdown();
+
+    private:
+        void uploadFrame();
+        void renderClipExport(double fps, int frameCount);
+        void renderActivity(double fps, int frameCount);
+        void seekSecond(int second, double fps, int frameCount);
+
+        RecordingPlayer m_player;
+        GLTexture m_texture;
+        char m_pathBuffer[512];
+        bool m_playing{false};
+        double m_position{0.0}; ///< Playhead in frames (fractional while playing)
+        double m_lastTime{0.0};
+        int m_uploadedIndex{-1};
+
+        // Activity sidecar (seek without decoding)
+        ActivityIndex m_activity;
+        std::vector<float> m_activityPlot;
+        float m_activityThreshold{0.005f};
+
+        // Clip export (runs on a worker so the UI keeps scrubbing)
+        int m_clipIn{0};
+        int m_clipOut{-1};
+        bool m_frameExact{false};
+        std::future<bool> m_exportResult;
+        std::string m_exportStatus;
+    };
+
+} // namespace NanoRec
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "core/YuvConverter.hpp"
+#include "ui/GLTexture.hpp"
+
+namespace NanoRec
+{
+
+    /**
+     * @brief Displays I420/NV12 frames by converting them to RGB on the GPU
+     *
+     * Uploads the Y plane and the chroma plane(s) as single/dual-channel
+     * textures (1.5 bytes per pixel instead of 3) and renders them through a
+     * BT.601 fragment shader into an RGB texture that ImGui can draw.
+     * All calls require the GL 3.3 context to be current.
+     */
+    class YuvTexture
+    {
+    public:
+        YuvTexture();
+        ~YuvTexture();
+
+        YuvTexture(const YuvTexture &) = delete;
+        YuvTexture &operator=(const YuvTexture &) = delete;
+
+        /**
+         * @brief Upload a frame and convert it into the output texture
+         * @return true if the output texture holds the frame
+         */
+        bool update(const YuvFrame &frame);
+
+        /**
+         * @brief Get the RGB output texture ID
+         * @return Texture ID (0 if nothing was converted yet)
+         */
+        unsigned int getTextureID() const { return m_output.getTextureID(); }
+
+        int getWidth() const { return m_output.getWidth(); }
+        int getHeight() const { return m_output.getHeight(); }
+        bool isValid() const { return m_output.isValid(); }
+
+        /**
+         * @brief Release textures, framebuffer and shader program
+         */
+        void destroy();
+
+    private:
+        bool initializeProgram();
+        bool createTargets(const YuvFrame &frame);
+
+        GLTexture m_planeY;
+        GLTexture m_planeU; ///< U (I420) or interleaved UV (NV12)
+        GLTexture m_planeV; ///< I420 only
+        GLTexture m_output;
+        YuvFrame::Layout m_layout{YuvFrame::Layout::I420};
+
+        unsigned int m_program{0};
+        unsigned int m_framebuffer{0};
+        unsigned int m_vertexArray{0};
+        int m_layoutUniform{-1};
+        bool m_programFailed{false};
+    };
+
+} // namespace NanoRec
@@ -0,0 +1,576 @@
+/**
+ * @file FileReplayCapture.cpp
+ * @brief Replay of dumped raw RGB24 / YUV4MPEG2 captures
+ */
+
+#include "capture/FileReplayCapture.hpp"
+#include "core/Logger.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <regex>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace NanoRec
+{
+
+    static const size_t Y4M_MAX_HEADER = 4096;
+
+    FileReplayCapture::FileReplayCapture(const Options &options)
+        : m_options(options)
+    {
+    }
+
+    FileReplayCapture::~FileReplayCapture()
+    {
+        shutdown();
+    }
+
+    bool FileReplayCapture::parseSizeFromName(const std::string &path, int &width, int &height)
+    {
+        static const std::regex sizePattern("([0-9]{2,5})x([0-9]{2,5})");
+        std::string name = path.substr(path.find_last_of("/\\") + 1);
+
+        std::smatch match;
+        if (!std::regex_search(name, match, sizePattern))
+        {
+            return false;
+        }
+        width = std::stoi(match[1].str());
+        height = std::stoi(match[2].str());
+        return width > 0 && height > 0;
+    }
+
+    bool FileReplayCapture::initialize()
+    {
+        shutdown();
+
+        if (!mapFile())
+        {
+            return false;
+        }
+
+        bool isY4M = m_mappingSize >= 10 && std::memcmp(m_mapping, "YUV4MPEG2 ", 10) == 0;
+        m_format = isY4M ? Format::Y4M : Format::RawRGB24;
+        if (!(isY4M ? indexY4M() : indexRaw()) || !loadTiming())
+        {
+            unmapFile();
+            return false;
+        }
+
+        m_nextFrame = 0;
+        m_lastFrame = static_cast<size_t>(-1);
+        m_cycle = 0;
+        m_started = false;
+        m_initialized = true;
+
+        Logger::info("Replaying " + m_options.path + " (" + std::to_string(m_width) + "x" +
+                     std::to_string(m_height) + ", " + std::to_string(m_frameOffsets.size()) + " frames, " +
+                     (isY4M ? "y4m" : "raw rgb24") + ", " + (m_options.realtime ? "recorded rate" : "maximum rate") +
+                     ")");
+        return true;
+    }
+
+    void FileReplayCapture::shutdown()
+    {
+        unmapFile();
+        m_frameOffsets.clear();
+        m_timestampsUs.clear();
+        m_initialized = false;
+    }
+
+    std::vector<MonitorInfo> FileReplayCapture::enumerateMonitors()
+    {
+        return {MonitorInfo(0, "Replay", 0, 0, m_width, m_height, true)};
+    }
+
+#ifdef _WIN32
+
+    bool FileReplayCapture::mapFile()
+    {
+        HANDLE file = CreateFileA(m_options.path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            Logger::error("Cannot open replay file: " + m_options.path);
+            return false;
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+        {
+            Logger::error("Replay file is empty: " + m_options.path);
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        void *view = mapping ? MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0) : nullptr;
+        if (!view)
+        {
+            Logger::error("Cannot map replay file: " + m_options.path);
+            if (mapping)
+            {
+                CloseHandle(mapping);
+            }
+            CloseHandle(file);
+            return false;
+        }
+
+        m_fileHandle = file;
+        m_mappingHandle = mapping;
+        m_mapping = static_cast<uint8_t *>(view);
+        m_mappingSize = static_cast<size_t>(fileSize.QuadPart);
+        return true;
+    }
+
+    void FileReplayCapture::unmapFile()
+    {
+        if (m_mapping)
+        {
+            UnmapViewOfFile(m_mapping);
+            m_mapping = nullptr;
+        }
+        if (m_mappingHandle)
+        {
+            CloseHandle(m_mappingHandle);
+            m_mappingHandle = nullptr;
+        }
+        if (m_fileHandle)
+        {
+            CloseHandle(m_fileHandle);
+            m_fileHandle = nullptr;
+        }
+        m_mappingSize = 0;
+    }
+
+    void FileReplayCapture::discardPrivatePages(size_t, size_t)
+    {
+        // A fresh copy-on-write view drops every page written through the old one; Windows has
+        // no call that reverts copied pages in place (VirtualFree/DiscardVirtualMemory leave
+        // their contents undefined). The new view goes to the old address when it is free, so
+        // frames borrowed from the old view stay valid.
+        void *base = m_mapping;
+        UnmapViewOfFile(base);
+        m_mapping = static_cast<uint8_t *>(MapViewOfFileEx(m_mappingHandle, FILE_MAP_COPY, 0, 0, 0, base));
+        if (!m_mapping)
+        {
+            m_mapping = static_cast<uint8_t *>(MapViewOfFile(m_mappingHandle, FILE_MAP_COPY, 0, 0, 0));
+        }
+        if (!m_mapping)
+        {
+            Logger::error("Cannot remap replay file, replay stopped: " + m_options.path);
+        }
+    }
+
+#else
+
+    bool FileReplayCapture::mapFile()
+    {
+        int fd = open(m_options.path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            Logger::error("Cannot open replay file: " + m_options.path);
+            return false;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0)
+        {
+            Logger::error("Replay file is empty: " + m_options.path);
+            close(fd);
+            return false;
+        }
+
+        // Private writable mapping: in-place frame edits never reach the file
+        void *mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED)
+        {
+            Logger::error("Cannot map replay file: " + m_options.path);
+            return false;
+        }
+
+        m_mapping = static_cast<uint8_t *>(mapping);
+        m_mappingSize = static_cast<size_t>(info.st_size);
+        madvise(m_mapping, m_mappingSize, MADV_SEQUENTIAL);
+        return true;
+    }
+
+    void FileReplayCapture::unmapFile()
+    {
+        if (m_mapping)
+        {
+            munmap(m_mapping, m_mappingSize);
+            m_mapping = nullptr;
+        }
+        m_mappingSize = 0;
+    }
+
+    void FileReplayCapture::discardPrivatePages(size_t offset, size_t length)
+    {
+        // Private copies are dropped; the next access sees the file contents again
+        size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t begin = offset / pageSize * pageSize;
+        size_t end = std::min(m_mappingSize, offset + length);
+        madvise(m_mapping + begin, end - begin, MADV_DONTNEED);
+    }
+
+#endif
+
+    bool FileReplayCapture::indexRaw()
+    {
+        m_width = m_options.width;
+        m_height = m_options.height;
+        if ((m_width <= 0 || m_height <= 0) && !parseSizeFromName(m_options.path, m_width, m_height))
+        {
+            Logger::error("Raw replay needs a frame size (e.g. capture_1920x1080.rgb): " + m_options.path);
+            return false;
+        }
+
+        size_t frameSize = static_cast<size_t>(m_width) * m_height * 3;
+        size_t frameCount = m_mappingSize / frameSize;
+        if (frameCount == 0)
+        {
+            Logger::error("Replay file is smaller than one " + std::to_string(m_width) + "x" +
+                          std::to_string(m_height) + " frame");
+            return false;
+        }
+        if (m_mappingSize % frameSize != 0)
+        {
+            Logger::warning("Replay file ends with a partial frame; ignoring it");
+        }
+
+        m_frameOffsets.resize(frameCount);
+        for (size_t i = 0; i < frameCount; ++i)
+        {
+            m_frameOffsets[i] = i * frameSize;
+        }
+        return true;
+    }
+
+    bool FileReplayCapture::indexY4M()
+    {
+        const char *text = reinterpret_cast<const char *>(m_mapping);
+        const char *headerEnd = static_cast<const char *>(
+            std::memchr(text, '\n', std::min(m_mappingSize, Y4M_MAX_HEADER)));
+        if (!headerEnd)
+        {
+            Logger::error("Invalid Y4M header: " + m_options.path);
+            return false;
+        }
+
+        std::istringstream header(std::string(text, headerEnd));
+        std::string token;
+        header >> token; // YUV4MPEG2
+
+        std::string colorspace = "420jpeg";
+        int rateNum = 0;
+        int rateDen = 0;
+        m_width = 0;
+        m_height = 0;
+        m_fullRange = false;
+        while (header >> token)
+        {
+            switch (token[0])
+            {
+            case 'W':
+                m_width = std::atoi(token.c_str() + 1);
+                break;
+            case 'H':
+                m_height = std::atoi(token.c_str() + 1);
+                break;
+            case 'F':
+                std::sscanf(token.c_str() + 1, "%d:%d", &rateNum, &rateDen);
+                break;
+            case 'C':
+                colorspace = token.substr(1);
+                break;
+            case 'X':
+                m_fullRange = m_fullRange || token == "XCOLORRANGE=FULL";
+                break;
+            default:
+                break;
+            }
+        }
+
+        m_monochrome = colorspace.rfind("mono", 0) == 0;
+        if (colorspace.rfind("420", 0) == 0)
+        {
+            m_chromaShiftX = 1;
+            m_chromaShiftY = 1;
+        }
+        else if (colorspace.rfind("422", 0) == 0)
+        {
+            m_chromaShiftX = 1;
+            m_chromaShiftY = 0;
+        }
+        else if (colorspace.rfind("444", 0) == 0 && colorspace.find("alpha") == std::string::npos)
+        {
+            m_chromaShiftX = 0;
+            m_chromaShiftY = 0;
+        }
+        else if (!m_monochrome)
+        {
+            Logger::error("Unsupported Y4M colorspace C" + colorspace + " (8-bit 420/422/444/mono only)");
+            return false;
+        }
+
+        if (m_width <= 0 || m_height <= 0)
+        {
+            Logger::error("Y4M header has no frame size: " + m_options.path);
+            return false;
+        }
+        if (rateNum > 0 && rateDen > 0)
+        {
+            m_options.fps = static_cast<double>(rateNum) / rateDen;
+        }
+
+        size_t lumaSize = static_cast<size_t>(m_width) * m_height;
+        size_t chromaWidth = (static_cast<size_t>(m_width) + (1u << m_chromaShiftX) - 1) >> m_chromaShiftX;
+        size_t chromaHeight = (static_cast<size_t>(m_height) + (1u << m_chromaShiftY) - 1) >> m_chromaShiftY;
+        size_t frameSize = lumaSize + (m_monochrome ? 0 : 2 * chromaWidth * chromaHeight);
+
+        // Frame headers may carry parameters, so walk them instead of assuming a fixed stride
+        m_frameOffsets.clear();
+        size_t position = static_cast<size_t>(headerEnd - text) + 1;
+        while (position + 5 <= m_mappingSize && std::memcmp(m_mapping + position, "FRAME", 5) == 0)
+        {
+            const void *lineEnd = std::memchr(m_mapping + position, '\n',
+                                              std::min(m_mappingSize - position, Y4M_MAX_HEADER));
+            if (!lineEnd)
+            {
+                break;
+            }
+
+            size_t pixels = static_cast<size_t>(static_cast<const uint8_t *>(lineEnd) - m_mapping) + 1;
+            if (pixels + frameSize > m_mappingSize)
+            {
+                Logger::warning("Y4M file ends with a partial frame; ignoring it");
+                break;
+            }
+            m_frameOffsets.push_back(pixels);
+            position = pixels + frameSize;
+        }
+
+        if (m_frameOffsets.empty())
+        {
+            Logger::error("Y4M file contains no frames: " + m_options.path);
+            return false;
+        }
+        return true;
+    }
+
+    bool FileReplayCapture::loadTiming()
+    {
+        double fps = m_options.fps > 0.0 ? m_options.fps : 30.0;
+        int64_t intervalUs = static_cast<int64_t>(1000000.0 / fps + 0.5);
+        size_t frameCount = m_frameOffsets.size();
+        m_timestampsUs.clear();
+
+        if (!m_options.timingPath.empty())
+        {
+            std::ifstream trace(m_options.timingPath);
+            if (!trace)
+            {
+                Logger::error("Cannot open timing trace: " + m_options.timingPath);
+                return false;
+            }
+
+            std::string line;
+            while (m_timestampsUs.size() < frameCount && std::getline(trace, line))
+            {
+                if (line.empty() || line[0] == '#')
+                {
+                    continue;
+                }
+
+                int64_t value = std::strtoll(line.c_str(), nullptr, 10);
+                if (!m_timestampsUs.empty() && value < m_timestampsUs.back())
+                {
+                    Logger::warning("Timing trace is not monotonic; using " + std::to_string(fps) + " fps");
+                    m_timestampsUs.clear();
+                    break;
+                }
+                m_timestampsUs.push_back(value);
+            }
+
+            if (!m_timestampsUs.empty())
+            {
+                int64_t first = m_timestampsUs.front();
+                for (int64_t &timestamp : m_timestampsUs)
+                {
+                    timestamp -= first;
+                }
+                if (m_timestampsUs.size() > 1)
+                {
+                    intervalUs = m_timestampsUs.back() / static_cast<int64_t>(m_timestampsUs.size() - 1);
+                }
+            }
+            if (m_timestampsUs.size() < frameCount)
+            {
+                Logger::warning("Timing trace covers " + std::to_string(m_timestampsUs.size()) + " of " +
+                                std::to_string(frameCount) + " frames");
+            }
+        }
+
+        // Frames without trace entries continue at the average interval
+        while (m_timestampsUs.size() < frameCount)
+        {
+            m_timestampsUs.push_back(m_timestampsUs.empty() ? 0 : m_timestampsUs.back() + intervalUs);
+        }
+        m_durationUs = m_timestampsUs.back() + std::max<int64_t>(intervalUs, 1);
+        return true;
+    }
+
+    size_t FileReplayCapture::selectFrame()
+    {
+        size_t frameCount = m_frameOffsets.size();
+        bool wrapped = false;
+        size_t index;
+
+        if (!m_options.realtime)
+        {
+            if (m_nextFrame >= frameCount)
+            {
+                if (!m_options.loop)
+                {
+                    return frameCount;
+                }
+                m_nextFrame = 0;
+                wrapped = true;
+            }
+            index = m_nextFrame++;
+        }
+        else
+        {
+            auto now = std::chrono::steady_clock::now();
+            if (!m_started)
+            {
+                m_startTime = now;
+                m_started = true;
+            }
+
+            int64_t elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(now - m_startTime).count();
+            if (elapsedUs >= m_durationUs && !m_options.loop)
+            {
+                return frameCount;
+            }
+
+            uint64_t cycle = static_cast<uint64_t>(elapsedUs / m_durationUs);
+            wrapped = cycle != m_cycle;
+            m_cycle = cycle;
+
+            int64_t position = elapsedUs % m_durationUs;
+            auto it = std::upper_bound(m_timestampsUs.begin(), m_timestampsUs.end(), position);
+            index = static_cast<size_t>(std::max<std::ptrdiff_t>(it - m_timestampsUs.begin() - 1, 0));
+        }
+
+        // Serving frames again: forget edits made to them by the previous consumer
+        if (wrapped)
+        {
+            discardPrivatePages(0, m_mappingSize);
+        }
+        else if (index == m_lastFrame)
+        {
+            size_t next = index + 1 < frameCount ? m_frameOffsets[index + 1] : m_mappingSize;
+            discardPrivatePages(m_frameOffsets[index], next - m_frameOffsets[index]);
+        }
+        m_lastFrame = index;
+        return index;
+    }
+
+    bool FileReplayCapture::captureFrame(FrameBuffer &buffer)
+    {
+        if (!m_initialized || !m_mapping)
+        {
+            return false;
+        }
+
+        size_t index = selectFrame();
+        if (!m_mapping)
+        {
+            // Remapping failed: drop the frame borrowed from the unmapped view
+            buffer.free();
+            return false;
+        }
+        if (index >= m_frameOffsets.size())
+        {
+            return false;
+        }
+
+        const uint8_t *pixels = m_mapping + m_frameOffsets[index];
+        if (m_format == Format::RawRGB24)
+        {
+            buffer.borrow(const_cast<uint8_t *>(pixels), m_width, m_height, m_width * 3);
+            return true;
+        }
+
+        if (!buffer.owned || buffer.width != m_width || buffer.height != m_height || !buffer.data)
+        {
+            buffer.free();
+            buffer.allocate(m_width, m_height);
+        }
+        convertY4MFrame(pixels, buffer);
+        return true;
+    }
+
+    static inline uint8_t clampByte(int value)
+    {
+        return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+    }
+
+    void FileReplayCapture::convertY4MFrame(const uint8_t *planes, FrameBuffer &buffer) const
+    {
+        int chromaWidth = (m_width + (1 << m_chromaShiftX) - 1) >> m_chromaShiftX;
+        int chromaHeight = (m_height + (1 << m_chromaShiftY) - 1) >> m_chromaShiftY;
+        const uint8_t *planeY = planes;
+        const uint8_t *planeU = planeY + static_cast<size_t>(m_width) * m_height;
+        const uint8_t *planeV = planeU + static_cast<size_t>(chromaWidth) * chromaHeight;
+
+        // BT.601 in 8.8 fixed point
+        int scaleY = m_fullRange ? 256 : 298;
+        int offsetY = m_fullRange ? 0 : 16;
+        int coeffRV = m_fullRange ? 359 : 409;
+        int coeffGU = m_fullRange ? 88 : 100;
+        int coeffGV = m_fullRange ? 183 : 208;
+        int coeffBU = m_fullRange ? 454 : 516;
+
+        for (int y = 0; y < m_height; ++y)
+        {
+            const uint8_t *rowY = planeY + static_cast<size_t>(y) * m_width;
+            const uint8_t *rowU = planeU + static_cast<size_t>(y >> m_chromaShiftY) * chromaWidth;
+            const uint8_t *rowV = planeV + static_cast<size_t>(y >> m_chromaShiftY) * chromaWidth;
+            uint8_t *out = buffer.data + static_cast<size_t>(y) * buffer.stride;
+
+            for (int x = 0; x < m_width; ++x)
+            {
+                int luma = scaleY * (rowY[x] - offsetY) + 128;
+                if (m_monochrome)
+                {
+                    uint8_t gray = clampByte(luma >> 8);
+                    out[x * 3 + 0] = gray;
+                    out[x * 3 + 1] = gray;
+                    out[x * 3 + 2] = gray;
+                    continue;
+                }
+
+                int u = rowU[x >> m_chromaShiftX] - 128;
+                int v = rowV[x >> m_chromaShiftX] - 128;
+                out[x * 3 + 0] = clampByte((luma + coeffRV * v) >> 8);
+                out[x * 3 + 1] = clampByte((luma - coeffGU * u - coeffGV * v) >> 8);
+                out[x * 3 + 2] = clampByte((luma + coeffBU * u) >> 8);
+            }
+        }
+    }
+
+} // namespace NanoRec
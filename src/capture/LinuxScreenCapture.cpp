@@ -12,12 +12,22 @@
 #include <chrono>
 #include <cstring>
 
+#ifdef NANOREC_HAVE_XSHM
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#endif
+
 namespace NanoRec
 {
 
     LinuxScreenCapture::LinuxScreenCapture()
         : m_display(nullptr), m_rootWindow(0), m_screen(0), m_width(0), m_height(0), m_initialized(false),
-          m_selectedMonitor(-1), m_captureX(0), m_captureY(0), m_captureWidth(0), m_captureHeight(0)
+          m_selectedMonitor(-1), m_captureX(0), m_captureY(0), m_captureWidth(0), m_captureHeight(0),
+          m_useShm(false), m_inputEvents(false), m_xiOpcode(-1)
+#ifdef NANOREC_HAVE_XSHM
+          ,
+          m_shmImage(nullptr), m_shmInfo()
+#endif
     {
     }
 
@@ -78,15 +88,40 @@ namespace NanoRec
 
         auto startTime = std::chrono::steady_clock::now();
 
-        // Capture screen using XGetImage (use capture region)
-        XImage *ximage = XGetImage(
-            m_display,
-            m_rootWindow,
-            m_captureX, m_captureY,              // x, y offset
-            m_captureWidth, m_captureHeight,     // width, height
-            AllPlanes,                            // plane mask
-            ZPixmap                               // format
-        );
+        XImage *ximage = nullptr;
+        bool sharedImage = false;
+
+#ifdef NANOREC_HAVE_XSHM
+        // Shared-memory path: the server writes straight into our reused segment
+        if (m_useShm)
+        {
+            bool sizeChanged = m_shmImage &&
+                               (m_shmImage->width != m_captureWidth || m_shmImage->height != m_captureHeight);
+            if ((!m_shmImage || sizeChanged) && !createShmImage())
+            {
+                Logger::log(Logger::Level::WARNING, "XShm image unavailable, falling back to XGetImage");
+                m_useShm = false;
+            }
+            else if (XShmGetImage(m_display, m_rootWindow, m_shmImage, m_captureX, m_captureY, AllPlanes))
+            {
+                ximage = m_shmImage;
+                sharedImage = true;
+            }
+        }
+#endif
+
+        if (!ximage)
+        {
+            // Capture screen using XGetImage (use capture region)
+            ximage = XGetImage(
+                m_display,
+                m_rootWindow,
+                m_captureX, m_captureY,              // x, y offset
+                m_captureWidth, m_captureHeight,     // width, height
+                AllPlanes,                            // plane mask
+                ZPixmap                               // format
+            );
+        }
 
         if (!ximage)
         {
@@ -104,8 +139,11 @@ namespace NanoRec
         // Convert X11 image to RGB24
         convertToRGB24(ximage, buffer);
 
-        // Cleanup X11 image
-        XDestroyImage(ximage);
+        // Cleanup X11 image (the shared image is reused)
+        if (!sharedImage)
+        {
+            XDestroyImage(ximage);
+        }
 
         // Performance measurement
         auto endTime = std::chrono::steady_clock::now();
@@ -301,14 +339,206 @@ namespace NanoRec
         }
     }
 
+    std::vector<std::string> LinuxScreenCapture::getCaptureMethods() const
+    {
+        std::vector<std::string> methods = {"xgetimage"};
+#ifdef NANOREC_HAVE_XSHM
+        if (m_display && XShmQueryExtension(m_display))
+        {
+            methods.push_back("xshm");
+        }
+#endif
+        return methods;
+    }
+
+    bool LinuxScreenCapture::setCaptureMethod(const std::string &method)
+    {
+        if (method == "xgetimage" || method == "default")
+        {
+            m_useShm = false;
+#ifdef NANOREC_HAVE_XSHM
+            destroyShmImage();
+#endif
+            return true;
+        }
+
+#ifdef NANOREC_HAVE_XSHM
+        if (method == "xshm" && m_display && XShmQueryExtension(m_display))
+        {
+            // The image is created lazily on the next capture, once the region is known
+            m_useShm = true;
+            return true;
+        }
+#endif
+
+        Logger::log(Logger::Level::WARNING, "Capture method not supported: " + method);
+        return false;
+    }
+
+#ifdef NANOREC_HAVE_XSHM
+    bool LinuxScreenCapture::createShmImage()
+    {
+        destroyShmImage();
+
+        m_shmImage = XShmCreateImage(m_display, DefaultVisual(m_display, m_screen), DefaultDepth(m_display, m_screen),
+                                     ZPixmap, nullptr, &m_shmInfo, m_captureWidth, m_captureHeight);
+        if (!m_shmImage)
+        {
+            return false;
+        }
+
+        m_shmInfo.shmid = shmget(IPC_PRIVATE, static_cast<size_t>(m_shmImage->bytes_per_line) * m_shmImage->height,
+                                 IPC_CREAT | 0600);
+        if (m_shmInfo.shmid < 0)
+        {
+            XDestroyImage(m_shmImage);
+            m_shmImage = nullptr;
+            return false;
+        }
+
+        m_shmInfo.shmaddr = m_shmImage->data = static_cast<char *>(shmat(m_shmInfo.shmid, nullptr, 0));
+        m_shmInfo.readOnly = False;
+
+        bool attached = m_shmInfo.shmaddr != reinterpret_cast<char *>(-1) && XShmAttach(m_display, &m_shmInfo);
+        XSync(m_display, False);
+
+        // Mark for removal now; the segment lives until both sides detach
+        shmctl(m_shmInfo.shmid, IPC_RMID, nullptr);
+
+        if (!attached)
+        {
+            if (m_shmInfo.shmaddr != reinterpret_cast<char *>(-1))
+            {
+                shmdt(m_shmInfo.shmaddr);
+            }
+            m_shmImage->data = nullptr;
+            XDestroyImage(m_shmImage);
+            m_shmImage = nullptr;
+            return false;
+        }
+
+        return true;
+    }
+
+    void LinuxScreenCapture::destroyShmImage()
+    {
+        if (!m_shmImage)
+        {
+            return;
+        }
+
+        XShmDetach(m_display, &m_shmInfo);
+        XSync(m_display, False);
+        shmdt(m_shmInfo.shmaddr);
+        m_shmImage->data = nullptr; // Not owned by Xlib
+        XDestroyImage(m_shmImage);
+        m_shmImage = nullptr;
+    }
+#endif
+
+    bool LinuxScreenCapture::queryPointer(int &x, int &y, unsigned int &buttons)
+    {
+        if (!m_display)
+        {
+            return false;
+        }
+
+        Window root;
+        Window child;
+        int windowX = 0;
+        int windowY = 0;
+        return XQueryPointer(m_display, m_rootWindow, &root, &child, &x, &y, &windowX, &windowY, &buttons) == True;
+    }
+
+    bool LinuxScreenCapture::setInputEvents(bool enabled)
+    {
+#ifdef NANOREC_HAVE_XINPUT2
+        if (!m_display)
+        {
+            return false;
+        }
+
+        if (m_xiOpcode < 0)
+        {
+            // Raw events arrived with XI 2.0
+            int eventBase = 0;
+            int errorBase = 0;
+            int major = 2;
+            int minor = 0;
+            if (!XQueryExtension(m_display, "XInputExtension", &m_xiOpcode, &eventBase, &errorBase) ||
+                XIQueryVersion(m_display, &major, &minor) != Success)
+            {
+                Logger::log(Logger::Level::WARNING, "XInput2 not available, input-driven capture rate disabled");
+                m_xiOpcode = -1;
+                return false;
+            }
+        }
+
+        // Raw events are reported on the root window regardless of focus or grabs
+        unsigned char bits[XIMaskLen(XI_LASTEVENT)] = {};
+        if (enabled)
+        {
+            XISetMask(bits, XI_RawKeyPress);
+            XISetMask(bits, XI_RawButtonPress);
+            XISetMask(bits, XI_RawMotion);
+        }
+
+        XIEventMask mask;
+        mask.deviceid = XIAllMasterDevices;
+        mask.mask_len = sizeof(bits);
+        mask.mask = bits;
+        XISelectEvents(m_display, m_rootWindow, &mask, 1);
+        XFlush(m_display);
+
+        if (!enabled)
+        {
+            pollInputEvents(); // Discard what is already queued
+        }
+        m_inputEvents = enabled;
+        return true;
+#else
+        (void)enabled;
+        return false;
+#endif
+    }
+
+    int LinuxScreenCapture::pollInputEvents()
+    {
+        if (!m_display || (!m_inputEvents && m_xiOpcode < 0))
+        {
+            return -1;
+        }
+
+        // Nothing else is selected on this connection, so every queued event can be consumed
+        int count = 0;
+        while (XPending(m_display) > 0)
+        {
+            XEvent event;
+            XNextEvent(m_display, &event);
+            if (event.xcookie.type == GenericEvent && event.xcookie.extension == m_xiOpcode)
+            {
+                count++;
+            }
+        }
+        return m_inputEvents ? count : -1;
+    }
+
     void LinuxScreenCapture::shutdown()
     {
+#ifdef NANOREC_HAVE_XSHM
+        if (m_display)
+        {
+            destroyShmImage();
+        }
+#endif
         if (m_display)
         {
             Logger::log(Logger::Level::INFO, "Shutting down X11 screen capture");
             XCloseDisplay(m_display);
             m_display = nullptr;
         }
+        m_inputEvents = false;
+        m_xiOpcode = -1;
         m_initialized = false;
     }
 
@@ -12,6 +12,7 @@
 #include "capture/WindowsScreenCapture.hpp"
 #elif __linux__
 #include "capture/LinuxScreenCapture.hpp"
+#include "capture/XvfbScreenCapture.hpp"
 #else
 #error "Unsupported platform"
 #endif
@@ -25,6 +26,14 @@ namespace NanoRec
         Logger::log(Logger::Level::INFO, "Creating Windows GDI screen capture instance");
         return std::make_unique<WindowsScreenCapture>();
 #elif __linux__
+        // Xvfb with -fbdir: read its framebuffer file directly (falls back to X11 capture itself)
+        std::string framebuffer = XvfbScreenCapture::findFramebuffer();
+        if (!framebuffer.empty())
+        {
+            Logger::log(Logger::Level::INFO, "Creating Xvfb framebuffer screen capture instance (" + framebuffer + ")");
+            return std::make_unique<XvfbScreenCapture>(framebuffer);
+        }
+
         Logger::log(Logger::Level::INFO, "Creating Linux X11 screen capture instance");
         return std::make_unique<LinuxScreenCapture>();
 #else
@@ -0,0 +1,972 @@
+/**
+ * @file VncScreenCapture.cpp
+ * @brief Screen capture source that records a remote desktop over RFB (VNC)
+ * @author NanoRec-CPP Team
+ * @date 2026-10-18
+ */
+
+#include "capture/VncScreenCapture.hpp"
+#include "core/Logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#ifdef NANOREC_HAVE_ZLIB
+#include <zlib.h>
+#else
+struct z_stream_s
+{
+};
+#endif
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace NanoRec
+{
+
+    namespace
+    {
+
+        // Client and server message types (RFC 6143)
+        constexpr uint8_t MSG_SET_PIXEL_FORMAT = 0;
+        constexpr uint8_t MSG_SET_ENCODINGS = 2;
+        constexpr uint8_t MSG_UPDATE_REQUEST = 3;
+        constexpr uint8_t MSG_FRAMEBUFFER_UPDATE = 0;
+        constexpr uint8_t MSG_SET_COLOUR_MAP = 1;
+        constexpr uint8_t MSG_BELL = 2;
+        constexpr uint8_t MSG_CUT_TEXT = 3;
+
+        constexpr int32_t ENCODING_RAW = 0;
+        constexpr int32_t ENCODING_COPYRECT = 1;
+        constexpr int32_t ENCODING_ZRLE = 16;
+        constexpr int32_t ENCODING_DESKTOP_SIZE = -223;
+
+        constexpr uint32_t SECURITY_NONE = 1;
+        constexpr int ZRLE_TILE = 64;
+        constexpr size_t MAX_PENDING_RECTS = 256;
+        constexpr size_t MAX_ZRLE_BYTES = size_t(1) << 28; // Inflated size of one rectangle
+
+        uint16_t readU16(const uint8_t *p) { return static_cast<uint16_t>((p[0] << 8) | p[1]); }
+
+        uint32_t readU32(const uint8_t *p)
+        {
+            return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+                   (static_cast<uint32_t>(p[2]) << 8) | p[3];
+        }
+
+        void writeU16(uint8_t *p, uint16_t value)
+        {
+            p[0] = static_cast<uint8_t>(value >> 8);
+            p[1] = static_cast<uint8_t>(value);
+        }
+
+        void writeU32(uint8_t *p, uint32_t value)
+        {
+            writeU16(p, static_cast<uint16_t>(value >> 16));
+            writeU16(p + 2, static_cast<uint16_t>(value));
+        }
+
+        /**
+         * @brief Bounds-checked reader over an inflated ZRLE rectangle
+         */
+        struct ZrleReader
+        {
+            const uint8_t *p;
+            const uint8_t *end;
+
+            bool has(size_t n) const { return static_cast<size_t>(end - p) >= n; }
+
+            // CPIXEL of our 32bpp depth-24 little-endian format: B, G, R
+            bool pixel(uint8_t rgb[3])
+            {
+                if (!has(3))
+                    return false;
+                rgb[0] = p[2];
+                rgb[1] = p[1];
+                rgb[2] = p[0];
+                p += 3;
+                return true;
+            }
+
+            bool byte(uint8_t &value)
+            {
+                if (!has(1))
+                    return false;
+                value = *p++;
+                return true;
+            }
+
+            // Run lengths are 1 + the sum of bytes up to and including the first one below 255
+            bool runLength(int &length)
+            {
+                length = 1;
+                uint8_t value = 255;
+                while (value == 255)
+                {
+                    if (!byte(value))
+                        return false;
+                    length += value;
+                }
+                return true;
+            }
+        };
+
+    } // namespace
+
+    VncScreenCapture::VncScreenCapture(const Options &options) : m_options(options)
+    {
+    }
+
+    VncScreenCapture::~VncScreenCapture()
+    {
+        shutdown();
+    }
+
+    bool VncScreenCapture::parseAddress(const std::string &address, std::string &host, int &port)
+    {
+        std::string hostPart = address;
+        std::string portPart;
+        bool rawPort = false;
+
+        // "[v6]:port", "host::port" (always a port), "host:N" (display below 100, else port)
+        if (!address.empty() && address[0] == '[')
+        {
+            size_t close = address.find(']');
+            if (close == std::string::npos)
+                return false;
+            hostPart = address.substr(1, close - 1);
+            if (close + 1 < address.size())
+            {
+                if (address[close + 1] != ':')
+                    return false;
+                portPart = address.substr(close + 2);
+            }
+        }
+        else if (size_t colon = address.find(':'); colon != std::string::npos)
+        {
+            rawPort = address.compare(colon, 2, "::") == 0;
+            size_t portStart = colon + (rawPort ? 2 : 1);
+            if (address.find(':', portStart) != std::string::npos)
+                return false; // Bare IPv6 addresses need brackets
+            hostPart = address.substr(0, colon);
+            portPart = address.substr(portStart);
+        }
+
+        if (hostPart.empty())
+            return false;
+
+        int number = rawPort ? 5900 : 0;
+        if (!portPart.empty())
+        {
+            if (portPart.size() > 5 || portPart.find_first_not_of("0123456789") != std::string::npos)
+                return false;
+            number = std::stoi(portPart);
+        }
+        if (!rawPort && number < 100)
+        {
+            number += 5900;
+        }
+        if (number <= 0 || number > 65535)
+            return false;
+
+        host = hostPart;
+        port = number;
+        return true;
+    }
+
+    bool VncScreenCapture::initialize()
+    {
+        if (m_connected.load())
+        {
+            return true;
+        }
+        shutdown();
+
+        if (!connectSocket())
+        {
+            return false;
+        }
+        if (!handshake())
+        {
+            shutdown();
+            return false;
+        }
+
+#ifdef NANOREC_HAVE_ZLIB
+        m_zlib = std::make_unique<z_stream_s>();
+        if (inflateInit(m_zlib.get()) != Z_OK)
+        {
+            Logger::error("VNC: failed to initialize zlib");
+            m_zlib.reset();
+            shutdown();
+            return false;
+        }
+#endif
+
+        // Receive the first full frame before capture starts
+        m_connected.store(true);
+        m_fullUpdate.store(false);
+        m_requestPending.store(true);
+        m_receiver = std::thread(&VncScreenCapture::receiveLoop, this);
+        if (!requestUpdate(false))
+        {
+            shutdown();
+            return false;
+        }
+
+        std::unique_lock<std::mutex> lock(m_frameMutex);
+        bool ready = m_updated.wait_for(lock, std::chrono::milliseconds(m_options.connectTimeoutMs),
+                                        [this]
+                                        { return m_updates > 0 || !m_connected.load(); });
+        if (!ready || m_updates == 0)
+        {
+            lock.unlock();
+            Logger::error("VNC: no framebuffer update from " + m_options.host + ":" + std::to_string(m_options.port));
+            shutdown();
+            return false;
+        }
+
+        Logger::info("VNC: connected to '" + m_desktopName + "' at " + m_options.host + ":" +
+                     std::to_string(m_options.port) + " (" + std::to_string(m_width.load()) + "x" +
+                     std::to_string(m_height.load()) + ")");
+        return true;
+    }
+
+    bool VncScreenCapture::handshake()
+    {
+        // ProtocolVersion: speak the highest of 3.3/3.7/3.8 the server offers
+        char version[13] = {};
+        int major = 0;
+        int minor = 0;
+        if (!readExact(version, 12) || std::sscanf(version, "RFB %03d.%03d\n", &major, &minor) != 2 || major != 3)
+        {
+            Logger::error("VNC: " + m_options.host + ":" + std::to_string(m_options.port) + " is not an RFB server");
+            return false;
+        }
+        minor = minor >= 8 ? 8 : (minor == 7 ? 7 : 3);
+        std::string reply = "RFB 003.00" + std::to_string(minor) + "\n";
+        if (!sendAll(reply.data(), reply.size()))
+        {
+            return false;
+        }
+
+        // Security: only "None" (3.3 servers choose, later ones offer a list)
+        uint8_t buffer[24];
+        if (minor == 3)
+        {
+            if (!readExact(buffer, 4))
+                return false;
+            uint32_t type = readU32(buffer);
+            if (type != SECURITY_NONE)
+            {
+                std::string reason = "authentication required";
+                if (type == 0)
+                {
+                    readReason(reason);
+                }
+                Logger::error("VNC: connection refused: " + reason + " (only servers without a password are supported)");
+                return false;
+            }
+        }
+        else
+        {
+            uint8_t count = 0;
+            if (!readExact(&count, 1))
+                return false;
+            if (count == 0)
+            {
+                std::string reason;
+                readReason(reason);
+                Logger::error("VNC: connection refused: " + reason);
+                return false;
+            }
+            std::vector<uint8_t> types(count);
+            if (!readExact(types.data(), count))
+                return false;
+            if (std::find(types.begin(), types.end(), SECURITY_NONE) == types.end())
+            {
+                Logger::error("VNC: server requires authentication (only servers without a password are supported)");
+                return false;
+            }
+            uint8_t choice = SECURITY_NONE;
+            if (!sendAll(&choice, 1))
+                return false;
+
+            // 3.7 sends no SecurityResult for None
+            if (minor == 8)
+            {
+                if (!readExact(buffer, 4))
+                    return false;
+                if (readU32(buffer) != 0)
+                {
+                    std::string reason;
+                    readReason(reason);
+                    Logger::error("VNC: security handshake failed: " + reason);
+                    return false;
+                }
+            }
+        }
+
+        // ClientInit / ServerInit
+        uint8_t shared = m_options.shared ? 1 : 0;
+        if (!sendAll(&shared, 1) || !readExact(buffer, 24))
+            return false;
+        int width = readU16(buffer);
+        int height = readU16(buffer + 2);
+        uint32_t nameLength = readU32(buffer + 20);
+        if (nameLength > 4096)
+        {
+            Logger::error("VNC: malformed ServerInit");
+            return false;
+        }
+        m_desktopName.assign(nameLength, '\0');
+        if (nameLength > 0 && !readExact(m_desktopName.data(), nameLength))
+            return false;
+        resizeFrame(width, height);
+
+        // 32bpp depth 24 little-endian true colour: pixels arrive as B, G, R, X whatever the server uses
+        uint8_t pixelFormat[20] = {MSG_SET_PIXEL_FORMAT, 0, 0, 0, 32, 24, 0, 1};
+        writeU16(pixelFormat + 8, 255);
+        writeU16(pixelFormat + 10, 255);
+        writeU16(pixelFormat + 12, 255);
+        pixelFormat[14] = 16;
+        pixelFormat[15] = 8;
+        pixelFormat[16] = 0;
+
+        std::vector<int32_t> encodings;
+#ifdef NANOREC_HAVE_ZLIB
+        encodings.push_back(ENCODING_ZRLE);
+#endif
+        encodings.push_back(ENCODING_COPYRECT);
+        encodings.push_back(ENCODING_RAW);
+        encodings.push_back(ENCODING_DESKTOP_SIZE);
+
+        std::vector<uint8_t> setEncodings(4 + 4 * encodings.size());
+        setEncodings[0] = MSG_SET_ENCODINGS;
+        writeU16(setEncodings.data() + 2, static_cast<uint16_t>(encodings.size()));
+        for (size_t i = 0; i < encodings.size(); ++i)
+        {
+            writeU32(setEncodings.data() + 4 + 4 * i, static_cast<uint32_t>(encodings[i]));
+        }
+
+        if (!sendAll(pixelFormat, sizeof(pixelFormat)) || !sendAll(setEncodings.data(), setEncodings.size()))
+            return false;
+
+#ifndef _WIN32
+        // The handshake had a deadline; the receiver blocks until data or shutdown()
+        timeval none{};
+        setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO, &none, sizeof(none));
+#endif
+        return true;
+    }
+
+    bool VncScreenCapture::readReason(std::string &reason)
+    {
+        uint8_t length[4];
+        if (!readExact(length, 4))
+            return false;
+        reason.assign(std::min<uint32_t>(readU32(length), 4096), '\0');
+        return reason.empty() || readExact(reason.data(), reason.size());
+    }
+
+    bool VncScreenCapture::requestUpdate(bool incremental)
+    {
+        uint8_t request[10] = {MSG_UPDATE_REQUEST, static_cast<uint8_t>(incremental ? 1 : 0)};
+        writeU16(request + 6, static_cast<uint16_t>(m_width.load()));
+        writeU16(request + 8, static_cast<uint16_t>(m_height.load()));
+        return sendAll(request, sizeof(request));
+    }
+
+    bool VncScreenCapture::captureFrame(FrameBuffer &buffer)
+    {
+        if (!m_connected.load())
+        {
+            return false;
+        }
+
+        // Pull model: ask for what changes next, at most one request in flight
+        if (!m_requestPending.exchange(true))
+        {
+            requestUpdate(!m_fullUpdate.exchange(false));
+        }
+
+        std::lock_guard<std::mutex> lock(m_frameMutex);
+        if (!m_frame.data)
+        {
+            return false;
+        }
+
+        bool reallocated = false;
+        if (!buffer.data || !buffer.owned || buffer.width != m_frame.width || buffer.height != m_frame.height)
+        {
+            buffer.allocate(m_frame.width, m_frame.height);
+            reallocated = true;
+        }
+
+        // Copied rather than borrowed: redaction and the overlay draw into the captured frame
+        size_t rowBytes = static_cast<size_t>(m_frame.width) * 3;
+        for (int y = 0; y < m_frame.height; ++y)
+        {
+            std::memcpy(buffer.data + static_cast<size_t>(y) * buffer.stride,
+                        m_frame.data + static_cast<size_t>(y) * m_frame.stride, rowBytes);
+        }
+
+        m_lastDirty.swap(m_pendingDirty);
+        m_pendingDirty.clear();
+        m_lastDirtyKnown = m_pendingComplete && !reallocated;
+        m_pendingComplete = true;
+        return true;
+    }
+
+    bool VncScreenCapture::getDirtyRects(std::vector<Rect> &rects) const
+    {
+        if (!m_lastDirtyKnown)
+        {
+            return false;
+        }
+        rects.insert(rects.end(), m_lastDirty.begin(), m_lastDirty.end());
+        return true;
+    }
+
+    std::vector<MonitorInfo> VncScreenCapture::enumerateMonitors()
+    {
+        std::string name = m_desktopName.empty() ? "VNC" : m_desktopName;
+        return {MonitorInfo(0, name, 0, 0, m_width.load(), m_height.load(), true)};
+    }
+
+    void VncScreenCapture::resizeFrame(int width, int height)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_frameMutex);
+            m_frame.allocate(width, height);
+            std::memset(m_frame.data, 0, m_frame.size);
+            m_pendingDirty.clear();
+            m_pendingComplete = false;
+        }
+        m_width.store(width);
+        m_height.store(height);
+        m_fullUpdate.store(true);
+    }
+
+    void VncScreenCapture::markDirty(const Rect &rect)
+    {
+        // Caller holds m_frameMutex; a slow consumer gets one bounding box instead of a growing list
+        m_pendingDirty.push_back(rect);
+        if (m_pendingDirty.size() > MAX_PENDING_RECTS)
+        {
+            Rect bounds;
+            for (const Rect &dirty : m_pendingDirty)
+            {
+                bounds = bounds.united(dirty);
+            }
+            m_pendingDirty.assign(1, bounds);
+        }
+    }
+
+    void VncScreenCapture::receiveLoop()
+    {
+        bool ok = true;
+        while (ok && m_connected.load())
+        {
+            uint8_t type = 0;
+            uint8_t header[8];
+            if (!readExact(&type, 1))
+            {
+                break;
+            }
+
+            switch (type)
+            {
+            case MSG_FRAMEBUFFER_UPDATE:
+                ok = readFramebufferUpdate();
+                break;
+            case MSG_SET_COLOUR_MAP:
+                // Only sent for colour-mapped formats; skip the entries
+                ok = readExact(header, 5);
+                if (ok)
+                {
+                    m_scratch.resize(static_cast<size_t>(readU16(header + 3)) * 6);
+                    ok = m_scratch.empty() || readExact(m_scratch.data(), m_scratch.size());
+                }
+                break;
+            case MSG_BELL:
+                break;
+            case MSG_CUT_TEXT:
+                ok = readExact(header, 7);
+                if (ok)
+                {
+                    uint32_t length = readU32(header + 3);
+                    m_scratch.resize(std::min<uint32_t>(length, 1 << 20));
+                    while (ok && length > 0)
+                    {
+                        size_t chunk = std::min<size_t>(length, m_scratch.size());
+                        ok = readExact(m_scratch.data(), chunk);
+                        length -= static_cast<uint32_t>(chunk);
+                    }
+                }
+                break;
+            default:
+                Logger::error("VNC: unexpected server message " + std::to_string(type));
+                ok = false;
+                break;
+            }
+        }
+
+        if (m_connected.exchange(false))
+        {
+            Logger::warning("VNC: connection to " + m_options.host + ":" + std::to_string(m_options.port) + " lost");
+        }
+        m_updated.notify_all();
+    }
+
+    bool VncScreenCapture::readFramebufferUpdate()
+    {
+        uint8_t header[12];
+        if (!readExact(header, 3))
+            return false;
+        int rectCount = readU16(header + 1);
+
+        for (int i = 0; i < rectCount; ++i)
+        {
+            if (!readExact(header, 12))
+                return false;
+            Rect rect(readU16(header), readU16(header + 2), readU16(header + 4), readU16(header + 6));
+            int32_t encoding = static_cast<int32_t>(readU32(header + 8));
+
+            if (encoding == ENCODING_DESKTOP_SIZE)
+            {
+                resizeFrame(rect.width, rect.height);
+                continue;
+            }
+
+            // Everything else must lie inside the framebuffer
+            if (rect.right() > m_width.load() || rect.bottom() > m_height.load())
+            {
+                Logger::error("VNC: rectangle outside the framebuffer");
+                return false;
+            }
+
+            bool ok = false;
+            switch (encoding)
+            {
+            case ENCODING_RAW:
+                ok = decodeRaw(rect);
+                break;
+            case ENCODING_COPYRECT:
+                ok = decodeCopyRect(rect);
+                break;
+            case ENCODING_ZRLE:
+                ok = decodeZrle(rect);
+                break;
+            default:
+                Logger::error("VNC: unsupported encoding " + std::to_string(encoding));
+                break;
+            }
+            if (!ok)
+                return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_frameMutex);
+            m_updates++;
+        }
+        m_requestPending.store(false);
+        m_updated.notify_all();
+        return true;
+    }
+
+    bool VncScreenCapture::decodeRaw(const Rect &rect)
+    {
+        m_scratch.resize(static_cast<size_t>(rect.width) * rect.height * 4);
+        if (!m_scratch.empty() && !readExact(m_scratch.data(), m_scratch.size()))
+            return false;
+
+        std::lock_guard<std::mutex> lock(m_frameMutex);
+        const uint8_t *src = m_scratch.data();
+        for (int y = 0; y < rect.height; ++y)
+        {
+            uint8_t *dst = m_frame.data + static_cast<size_t>(rect.y + y) * m_frame.stride + rect.x * 3;
+            for (int x = 0; x < rect.width; ++x, src += 4, dst += 3)
+            {
+                dst[0] = src[2];
+                dst[1] = src[1];
+                dst[2] = src[0];
+            }
+        }
+        markDirty(rect);
+        return true;
+    }
+
+    bool VncScreenCapture::decodeCopyRect(const Rect &rect)
+    {
+        uint8_t source[4];
+        if (!readExact(source, 4))
+            return false;
+        int srcX = readU16(source);
+        int srcY = readU16(source + 2);
+        if (srcX + rect.width > m_width.load() || srcY + rect.height > m_height.load())
+        {
+            Logger::error("VNC: CopyRect source outside the framebuffer");
+            return false;
+        }
+
+        // Overlapping moves: walk rows away from the destination (memmove handles each row)
+        std::lock_guard<std::mutex> lock(m_frameMutex);
+        size_t rowBytes = static_cast<size_t>(rect.width) * 3;
+        bool upward = srcY < rect.y;
+        for (int i = 0; i < rect.height; ++i)
+        {
+            int row = upward ? rect.height - 1 - i : i;
+            std::memmove(m_frame.data + static_cast<size_t>(rect.y + row) * m_frame.stride + rect.x * 3,
+                         m_frame.data + static_cast<size_t>(srcY + row) * m_frame.stride + srcX * 3, rowBytes);
+        }
+        markDirty(rect);
+        return true;
+    }
+
+    bool VncScreenCapture::decodeZrle(const Rect &rect)
+    {
+        uint8_t length[4];
+        if (!readExact(length, 4))
+            return false;
+        uint32_t compressedSize = readU32(length);
+        if (!inflateZrle(compressedSize))
+            return false;
+
+        ZrleReader in{m_scratch.data(), m_scratch.data() + m_scratch.size()};
+        uint8_t palette[128][3];
+        uint8_t color[3];
+
+        std::lock_guard<std::mutex> lock(m_frameMutex);
+        for (int ty = rect.y; ty < rect.bottom(); ty += ZRLE_TILE)
+        {
+            for (int tx = rect.x; tx < rect.right(); tx += ZRLE_TILE)
+            {
+                int tileW = std::min(ZRLE_TILE, rect.right() - tx);
+                int tileH = std::min(ZRLE_TILE, rect.bottom() - ty);
+                int pixels = tileW * tileH;
+                auto put = [&](int index, const uint8_t rgb[3])
+                {
+                    uint8_t *dst = m_frame.data + static_cast<size_t>(ty + index / tileW) * m_frame.stride +
+                                   (tx + index % tileW) * 3;
+                    dst[0] = rgb[0];
+                    dst[1] = rgb[1];
+                    dst[2] = rgb[2];
+                };
+
+                uint8_t subencoding = 0;
+                if (!in.byte(subencoding))
+                    return false;
+
+                if (subencoding == 0)
+                {
+                    for (int i = 0; i < pixels; ++i)
+                    {
+                        if (!in.pixel(color))
+                            return false;
+                        put(i, color);
+                    }
+                }
+                else if (subencoding == 1)
+                {
+                    if (!in.pixel(color))
+                        return false;
+                    for (int i = 0; i < pixels; ++i)
+                    {
+                        put(i, color);
+                    }
+                }
+                else if (subencoding <= 16)
+                {
+                    // Packed palette: 1/2/4-bit indices, MSB first, rows padded to a byte
+                    int size = subencoding;
+                    for (int i = 0; i < size; ++i)
+                    {
+                        if (!in.pixel(palette[i]))
+                            return false;
+                    }
+                    int bits = size == 2 ? 1 : (size <= 4 ? 2 : 4);
+                    int rowBytes = (tileW * bits + 7) / 8;
+                    if (!in.has(static_cast<size_t>(rowBytes) * tileH))
+                        return false;
+                    for (int y = 0; y < tileH; ++y)
+                    {
+                        const uint8_t *row = in.p + static_cast<size_t>(y) * rowBytes;
+                        for (int x = 0; x < tileW; ++x)
+                        {
+                            int bit = x * bits;
+                            int index = (row[bit / 8] >> (8 - bits - bit % 8)) & ((1 << bits) - 1);
+                            if (index >= size)
+                                return false;
+                            put(y * tileW + x, palette[index]);
+                        }
+                    }
+                    in.p += static_cast<size_t>(rowBytes) * tileH;
+                }
+                else if (subencoding == 128)
+                {
+                    int i = 0;
+                    while (i < pixels)
+                    {
+                        int run = 0;
+                        if (!in.pixel(color) || !in.runLength(run) || run > pixels - i)
+                            return false;
+                        for (; run > 0; --run)
+                        {
+                            put(i++, color);
+                        }
+                    }
+                }
+                else if (subencoding >= 130)
+                {
+                    // Palette RLE: index with the top bit set is followed by a run length
+                    int size = subencoding - 128;
+                    for (int i = 0; i < size; ++i)
+                    {
+                        if (!in.pixel(palette[i]))
+                            return false;
+                    }
+                    int i = 0;
+                    while (i < pixels)
+                    {
+                        uint8_t index = 0;
+                        int run = 1;
+                        if (!in.byte(index))
+                            return false;
+                        if ((index & 128) && (!in.runLength(run) || run > pixels - i))
+                            return false;
+                        index &= 127;
+                        if (index >= size)
+                            return false;
+                        for (; run > 0; --run)
+                        {
+                            put(i++, palette[index]);
+                        }
+                    }
+                }
+                else
+                {
+                    Logger::error("VNC: invalid ZRLE subencoding " + std::to_string(subencoding));
+                    return false;
+                }
+            }
+        }
+        markDirty(rect);
+        return true;
+    }
+
+    bool VncScreenCapture::inflateZrle(size_t compressedSize)
+    {
+#ifdef NANOREC_HAVE_ZLIB
+        m_compressed.resize(compressedSize);
+        if (compressedSize > 0 && !readExact(m_compressed.data(), compressedSize))
+            return false;
+
+        // Each rectangle ends on a sync flush of the connection-wide stream; output size is unknown up front
+        z_stream_s *stream = m_zlib.get();
+        stream->next_in = m_compressed.data();
+        stream->avail_in = static_cast<uInt>(compressedSize);
+        m_scratch.resize(std::max<size_t>(compressedSize * 4, 64 * 1024));
+        size_t produced = 0;
+        do
+        {
+            if (produced == m_scratch.size())
+            {
+                if (m_scratch.size() >= MAX_ZRLE_BYTES)
+                {
+                    Logger::error("VNC: ZRLE rectangle too large");
+                    return false;
+                }
+                m_scratch.resize(m_scratch.size() * 2);
+            }
+            stream->next_out = m_scratch.data() + produced;
+            stream->avail_out = static_cast<uInt>(m_scratch.size() - produced);
+            int result = inflate(stream, Z_SYNC_FLUSH);
+            produced = m_scratch.size() - stream->avail_out;
+            if (result == Z_BUF_ERROR)
+            {
+                break; // No further progress possible: all input consumed and flushed
+            }
+            if (result != Z_OK)
+            {
+                Logger::error("VNC: corrupt ZRLE data");
+                return false;
+            }
+        } while (stream->avail_in > 0 || stream->avail_out == 0);
+        m_scratch.resize(produced);
+        return true;
+#else
+        (void)compressedSize;
+        Logger::error("VNC: server sent ZRLE without being asked");
+        return false;
+#endif
+    }
+
+    void VncScreenCapture::shutdown()
+    {
+        m_connected.store(false);
+#ifndef _WIN32
+        if (m_socket != -1)
+        {
+            ::shutdown(m_socket, SHUT_RDWR); // Wakes the receiver's blocking read
+        }
+#endif
+        if (m_receiver.joinable())
+        {
+            m_receiver.join();
+        }
+#ifndef _WIN32
+        if (m_socket != -1)
+        {
+            close(m_socket);
+            m_socket = -1;
+        }
+#endif
+#ifdef NANOREC_HAVE_ZLIB
+        if (m_zlib)
+        {
+            inflateEnd(m_zlib.get());
+        }
+#endif
+        m_zlib.reset();
+        m_requestPending.store(false);
+        m_fullUpdate.store(true);
+
+        std::lock_guard<std::mutex> lock(m_frameMutex);
+        m_updates = 0;
+        m_pendingDirty.clear();
+        m_pendingComplete = false;
+        m_lastDirty.clear();
+        m_lastDirtyKnown = false;
+    }
+
+#ifdef _WIN32
+
+    bool VncScreenCapture::connectSocket()
+    {
+        Logger::warning("VNC capture is not supported on Windows yet");
+        return false;
+    }
+
+    bool VncScreenCapture::readExact(void *, size_t) { return false; }
+    bool VncScreenCapture::sendAll(const void *, size_t) { return false; }
+
+#else
+
+    bool VncScreenCapture::connectSocket()
+    {
+        std::string where = m_options.host + ":" + std::to_string(m_options.port);
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo *addresses = nullptr;
+        int error = getaddrinfo(m_options.host.c_str(), std::to_string(m_options.port).c_str(), &hints, &addresses);
+        if (error != 0)
+        {
+            Logger::error("VNC: cannot resolve " + m_options.host + ": " + gai_strerror(error));
+            return false;
+        }
+
+        // Non-blocking connect so an unreachable host fails within the timeout
+        for (addrinfo *address = addresses; address && m_socket == -1; address = address->ai_next)
+        {
+            int fd = socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC, address->ai_protocol);
+            if (fd == -1)
+                continue;
+
+            int flags = fcntl(fd, F_GETFL, 0);
+            fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+            int result = connect(fd, address->ai_addr, address->ai_addrlen);
+            if (result == -1 && errno == EINPROGRESS)
+            {
+                pollfd pfd{fd, POLLOUT, 0};
+                int socketError = ETIMEDOUT;
+                socklen_t length = sizeof(socketError);
+                if (poll(&pfd, 1, m_options.connectTimeoutMs) == 1)
+                {
+                    getsockopt(fd, SOL_SOCKET, SO_ERROR, &socketError, &length);
+                }
+                result = socketError == 0 ? 0 : -1;
+                errno = socketError;
+            }
+            if (result == 0)
+            {
+                fcntl(fd, F_SETFL, flags);
+                m_socket = fd;
+            }
+            else
+            {
+                error = errno;
+                close(fd);
+            }
+        }
+        freeaddrinfo(addresses);
+
+        if (m_socket == -1)
+        {
+            Logger::error("VNC: cannot connect to " + where + ": " + strerror(error));
+            return false;
+        }
+
+        // Requests are tiny and latency bound; the handshake gets the connect deadline
+        int noDelay = 1;
+        setsockopt(m_socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        timeval timeout{};
+        timeout.tv_sec = m_options.connectTimeoutMs / 1000;
+        timeout.tv_usec = (m_options.connectTimeoutMs % 1000) * 1000;
+        setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        return true;
+    }
+
+    bool VncScreenCapture::readExact(void *data, size_t size)
+    {
+        uint8_t *out = static_cast<uint8_t *>(data);
+        while (size > 0)
+        {
+            ssize_t received = recv(m_socket, out, size, 0);
+            if (received > 0)
+            {
+                out += received;
+                size -= static_cast<size_t>(received);
+            }
+            else if (received == 0 || errno != EINTR)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool VncScreenCapture::sendAll(const void *data, size_t size)
+    {
+        const uint8_t *in = static_cast<const uint8_t *>(data);
+        while (size > 0)
+        {
+            ssize_t sent = send(m_socket, in, size, MSG_NOSIGNAL);
+            if (sent > 0)
+            {
+                in += sent;
+                size -= static_cast<size_t>(sent);
+            }
+            else if (sent == -1 && errno != EINTR)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+#endif
+
+} // namespace NanoRec
@@ -144,6 +144,22 @@ namespace NanoRec
         return true;
     }
 
+    bool WindowsScreenCapture::queryPointer(int &x, int &y, unsigned int &buttons)
+    {
+        POINT point;
+        if (!GetCursorPos(&point))
+        {
+            return false;
+        }
+
+        x = point.x;
+        y = point.y;
+        buttons = ((GetAsyncKeyState(VK_LBUTTON) & 0x8000) ? 1u : 0u) |
+                  ((GetAsyncKeyState(VK_RBUTTON) & 0x8000) ? 2u : 0u) |
+                  ((GetAsyncKeyState(VK_MBUTTON) & 0x8000) ? 4u : 0u);
+        return true;
+    }
+
     void WindowsScreenCapture::shutdown()
     {
         if (m_memoryDC)
@@ -0,0 +1,378 @@
+/**
+ * @file XvfbScreenCapture.cpp
+ * @brief Capture straight from Xvfb's memory-mapped framebuffer file
+ * @author NanoRec-CPP Team
+ * @date 2026-10-18
+ */
+
+#ifdef __linux__
+
+#include "capture/XvfbScreenCapture.hpp"
+#include "core/Logger.hpp"
+#include <X11/XWDFile.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace NanoRec
+{
+
+    namespace
+    {
+
+        // XWD headers are written most significant byte first
+        uint32_t readBigEndian(const uint8_t *data, int field)
+        {
+            const uint8_t *p = data + field * 4;
+            return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+                   (static_cast<uint32_t>(p[2]) << 8) | p[3];
+        }
+
+        /**
+         * @brief Pixel layout of an XWD framebuffer file
+         * @return false if the header is not a ZPixmap in a layout we convert (24/32-bit BGR(X))
+         */
+        bool parseXwdHeader(const uint8_t *data, size_t size, int &width, int &height, int &bytesPerLine,
+                            int &bytesPerPixel, size_t &pixelOffset, std::string &error)
+        {
+            if (size < sz_XWDheader)
+            {
+                error = "file too small for an XWD header";
+                return false;
+            }
+
+            // Field order of XWDFileHeader
+            uint32_t headerSize = readBigEndian(data, 0);
+            uint32_t version = readBigEndian(data, 1);
+            uint32_t format = readBigEndian(data, 2);
+            width = static_cast<int>(readBigEndian(data, 4));
+            height = static_cast<int>(readBigEndian(data, 5));
+            uint32_t byteOrder = readBigEndian(data, 7);
+            uint32_t bitsPerPixel = readBigEndian(data, 11);
+            bytesPerLine = static_cast<int>(readBigEndian(data, 12));
+            uint32_t visualClass = readBigEndian(data, 13);
+            uint32_t redMask = readBigEndian(data, 14);
+            uint32_t greenMask = readBigEndian(data, 15);
+            uint32_t blueMask = readBigEndian(data, 16);
+            uint32_t colors = readBigEndian(data, 19);
+
+            if (version != XWD_FILE_VERSION || format != ZPixmap)
+            {
+                error = "not an XWD ZPixmap file";
+                return false;
+            }
+
+            // Xvfb fills in the visual once its colormap is installed
+            if ((bitsPerPixel != 32 && bitsPerPixel != 24) || byteOrder != LSBFirst || visualClass != TrueColor ||
+                redMask != 0xff0000 || greenMask != 0x00ff00 || blueMask != 0x0000ff)
+            {
+                error = "unsupported pixel layout (" + std::to_string(bitsPerPixel) + " bpp)";
+                return false;
+            }
+
+            bytesPerPixel = static_cast<int>(bitsPerPixel / 8);
+            pixelOffset = static_cast<size_t>(headerSize) + static_cast<size_t>(colors) * sz_XWDColor;
+            if (width <= 0 || height <= 0 || bytesPerLine < width * bytesPerPixel ||
+                pixelOffset + static_cast<size_t>(bytesPerLine) * height > size)
+            {
+                error = "framebuffer size does not match the file";
+                return false;
+            }
+            return true;
+        }
+
+        // NUL-separated arguments of a process (empty if it is gone or unreadable)
+        std::vector<std::string> processArguments(const std::filesystem::path &procDir)
+        {
+            std::ifstream file(procDir / "cmdline", std::ios::binary);
+            std::string cmdline((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+            std::vector<std::string> arguments;
+            size_t start = 0;
+            while (start < cmdline.size())
+            {
+                size_t end = cmdline.find('\0', start);
+                if (end == std::string::npos)
+                {
+                    end = cmdline.size();
+                }
+                arguments.push_back(cmdline.substr(start, end - start));
+                start = end + 1;
+            }
+            return arguments;
+        }
+
+    } // namespace
+
+    XvfbScreenCapture::XvfbScreenCapture(const std::string &framebufferPath)
+        : m_path(framebufferPath), m_fd(-1), m_mapping(nullptr), m_mappingSize(0), m_pixels(nullptr),
+          m_screenWidth(0), m_screenHeight(0), m_bytesPerLine(0), m_bytesPerPixel(0), m_regionX(0), m_regionY(0),
+          m_useFramebuffer(false)
+    {
+    }
+
+    XvfbScreenCapture::~XvfbScreenCapture()
+    {
+        shutdown();
+    }
+
+    std::string XvfbScreenCapture::findFramebuffer()
+    {
+        if (const char *path = std::getenv("NANOREC_XVFB_FRAMEBUFFER"))
+        {
+            return path;
+        }
+
+        // Only local displays (":99", ":99.0", "unix:99") can have a file we can read
+        const char *display = std::getenv("DISPLAY");
+        if (!display)
+        {
+            return "";
+        }
+        std::string name = display;
+        if (name.rfind("unix:", 0) == 0)
+        {
+            name = name.substr(4);
+        }
+        if (name.size() < 2 || name[0] != ':' || !std::isdigit(static_cast<unsigned char>(name[1])))
+        {
+            return "";
+        }
+        size_t dot = name.find('.');
+        std::string displayArgument = name.substr(0, dot);
+        std::string screen = dot == std::string::npos ? "0" : name.substr(dot + 1);
+
+        // The server's command line is the only place the directory is recorded
+        std::error_code error;
+        for (const auto &entry : std::filesystem::directory_iterator("/proc", error))
+        {
+            const std::string pid = entry.path().filename().string();
+            if (!std::all_of(pid.begin(), pid.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); }))
+            {
+                continue;
+            }
+
+            std::vector<std::string> arguments = processArguments(entry.path());
+            if (arguments.empty() || std::filesystem::path(arguments[0]).filename() != "Xvfb" ||
+                std::find(arguments.begin(), arguments.end(), displayArgument) == arguments.end())
+            {
+                continue;
+            }
+
+            auto fbdir = std::find(arguments.begin(), arguments.end(), "-fbdir");
+            if (fbdir == arguments.end() || std::next(fbdir) == arguments.end())
+            {
+                return ""; // Our Xvfb, but its framebuffer lives in anonymous memory
+            }
+            return (std::filesystem::path(*std::next(fbdir)) / ("Xvfb_screen" + screen)).string();
+        }
+        return "";
+    }
+
+    bool XvfbScreenCapture::initialize()
+    {
+        if (!m_x11.initialize())
+        {
+            return false;
+        }
+
+        // The X11 capture starts on the whole screen, which is what the file holds
+        m_screenWidth = m_x11.getWidth();
+        m_screenHeight = m_x11.getHeight();
+        m_useFramebuffer = mapFramebuffer();
+        updateRegion();
+        if (m_useFramebuffer)
+        {
+            Logger::info("Capturing from the Xvfb framebuffer: " + m_path);
+        }
+        return true;
+    }
+
+    bool XvfbScreenCapture::mapFramebuffer()
+    {
+        unmapFramebuffer();
+
+        m_fd = open(m_path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (m_fd < 0)
+        {
+            Logger::warning("Cannot open Xvfb framebuffer " + m_path + ", using X11 capture");
+            return false;
+        }
+
+        struct stat info;
+        if (fstat(m_fd, &info) != 0 || info.st_size == 0)
+        {
+            Logger::warning("Xvfb framebuffer is empty: " + m_path + ", using X11 capture");
+            unmapFramebuffer();
+            return false;
+        }
+
+        // Shared, read-only: we see the server's writes and can never disturb them
+        void *mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, m_fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            Logger::warning("Cannot map Xvfb framebuffer " + m_path + ", using X11 capture");
+            unmapFramebuffer();
+            return false;
+        }
+        m_mapping = static_cast<uint8_t *>(mapping);
+        m_mappingSize = static_cast<size_t>(info.st_size);
+
+        int width = 0;
+        int height = 0;
+        size_t pixelOffset = 0;
+        std::string error;
+        if (!parseXwdHeader(m_mapping, m_mappingSize, width, height, m_bytesPerLine, m_bytesPerPixel, pixelOffset,
+                            error))
+        {
+            Logger::warning("Xvfb framebuffer " + m_path + ": " + error + ", using X11 capture");
+            unmapFramebuffer();
+            return false;
+        }
+
+        // Guards against a file from another display or screen
+        if (width != m_screenWidth || height != m_screenHeight)
+        {
+            Logger::warning("Xvfb framebuffer " + m_path + " is " + std::to_string(width) + "x" +
+                            std::to_string(height) + ", display is " + std::to_string(m_screenWidth) + "x" +
+                            std::to_string(m_screenHeight) + ", using X11 capture");
+            unmapFramebuffer();
+            return false;
+        }
+
+        m_pixels = m_mapping + pixelOffset;
+        return true;
+    }
+
+    void XvfbScreenCapture::unmapFramebuffer()
+    {
+        if (m_mapping)
+        {
+            munmap(m_mapping, m_mappingSize);
+            m_mapping = nullptr;
+        }
+        if (m_fd >= 0)
+        {
+            close(m_fd);
+            m_fd = -1;
+        }
+        m_mappingSize = 0;
+        m_pixels = nullptr;
+    }
+
+    void XvfbScreenCapture::updateRegion()
+    {
+        m_regionX = 0;
+        m_regionY = 0;
+        int monitorId = m_x11.getCurrentMonitor();
+        std::vector<MonitorInfo> monitors = m_x11.enumerateMonitors();
+        if (monitorId >= 0 && monitorId < static_cast<int>(monitors.size()))
+        {
+            m_regionX = monitors[monitorId].x;
+            m_regionY = monitors[monitorId].y;
+        }
+    }
+
+    bool XvfbScreenCapture::selectMonitor(int monitorId)
+    {
+        if (!m_x11.selectMonitor(monitorId))
+        {
+            return false;
+        }
+        updateRegion();
+        return true;
+    }
+
+    bool XvfbScreenCapture::captureFrame(FrameBuffer &buffer)
+    {
+        if (!m_useFramebuffer)
+        {
+            return m_x11.captureFrame(buffer);
+        }
+
+        // Touching pages past the end of a truncated file would raise SIGBUS
+        struct stat info;
+        if (fstat(m_fd, &info) != 0 || static_cast<size_t>(info.st_size) < m_mappingSize)
+        {
+            Logger::warning("Xvfb framebuffer went away, falling back to X11 capture");
+            unmapFramebuffer();
+            m_useFramebuffer = false;
+            return m_x11.captureFrame(buffer);
+        }
+
+        int width = m_x11.getWidth();
+        int height = m_x11.getHeight();
+        if (m_regionX < 0 || m_regionY < 0 || m_regionX + width > m_screenWidth ||
+            m_regionY + height > m_screenHeight)
+        {
+            return m_x11.captureFrame(buffer); // Monitor outside the screen the file holds
+        }
+
+        if (buffer.width != width || buffer.height != height || !buffer.data)
+        {
+            buffer.allocate(width, height);
+        }
+
+        // BGR(X) rows of the selected monitor straight into RGB24
+        for (int y = 0; y < height; ++y)
+        {
+            const uint8_t *src = m_pixels + static_cast<size_t>(m_regionY + y) * m_bytesPerLine +
+                                 static_cast<size_t>(m_regionX) * m_bytesPerPixel;
+            uint8_t *dest = buffer.data + static_cast<size_t>(y) * buffer.stride;
+            for (int x = 0; x < width; ++x)
+            {
+                dest[0] = src[2];
+                dest[1] = src[1];
+                dest[2] = src[0];
+                src += m_bytesPerPixel;
+                dest += 3;
+            }
+        }
+        return true;
+    }
+
+    std::vector<std::string> XvfbScreenCapture::getCaptureMethods() const
+    {
+        std::vector<std::string> methods = m_x11.getCaptureMethods();
+        if (m_mapping)
+        {
+            methods.insert(methods.begin(), "xvfb");
+        }
+        return methods;
+    }
+
+    bool XvfbScreenCapture::setCaptureMethod(const std::string &method)
+    {
+        if ((method == "xvfb" || method == "default") && m_mapping)
+        {
+            m_useFramebuffer = true;
+            return true;
+        }
+        if (method == "xvfb")
+        {
+            Logger::warning("Capture method not available: xvfb");
+            return false;
+        }
+
+        m_useFramebuffer = false;
+        return m_x11.setCaptureMethod(method);
+    }
+
+    void XvfbScreenCapture::shutdown()
+    {
+        unmapFramebuffer();
+        m_useFramebuffer = false;
+        m_x11.shutdown();
+    }
+
+} // namespace NanoRec
+
+#endif // __linux__
@@ -0,0 +1,358 @@
+#include "core/ActivityIndex.hpp"
+#include "core/Logger.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace NanoRec
+{
+
+    // Sidecar layout (little-endian):
+    //   header: "NRACTIDX", u32 version, u32 width, u32 height, u32 fps
+    //   records (one per second): u16 mean change, u16 peak change (fraction * 65535),
+    //   u16 bounds x, y, w, h, u16 input samples, u16 frames
+    static const char MAGIC[8] = {'N', 'R', 'A', 'C', 'T', 'I', 'D', 'X'};
+    static const uint32_t VERSION = 1;
+    static const size_t HEADER_SIZE = 24;
+    static const size_t RECORD_SIZE = 16;
+
+    static void putU16(uint8_t *out, uint32_t value)
+    {
+        value = std::min<uint32_t>(value, 0xFFFF);
+        out[0] = static_cast<uint8_t>(value);
+        out[1] = static_cast<uint8_t>(value >> 8);
+    }
+
+    static void putU32(uint8_t *out, uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            out[i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    }
+
+    static uint32_t getU16(const uint8_t *in)
+    {
+        return in[0] | (static_cast<uint32_t>(in[1]) << 8);
+    }
+
+    static uint32_t getU32(const uint8_t *in)
+    {
+        return in[0] | (static_cast<uint32_t>(in[1]) << 8) | (static_cast<uint32_t>(in[2]) << 16) |
+               (static_cast<uint32_t>(in[3]) << 24);
+    }
+
+    static uint32_t encodeFraction(double fraction)
+    {
+        return static_cast<uint32_t>(std::clamp(fraction, 0.0, 1.0) * 65535.0 + 0.5);
+    }
+
+    // --- Writer ---
+
+    ActivityIndexWriter::~ActivityIndexWriter()
+    {
+        close();
+    }
+
+    bool ActivityIndexWriter::open(const std::string &path, int width, int height, int fps)
+    {
+        close();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_file = std::fopen(path.c_str(), "wb");
+        if (!m_file)
+        {
+            Logger::warning("Cannot create activity index: " + path);
+            return false;
+        }
+
+        uint8_t header[HEADER_SIZE];
+        std::memcpy(header, MAGIC, sizeof(MAGIC));
+        putU32(header + 8, VERSION);
+        putU32(header + 12, static_cast<uint32_t>(width));
+        putU32(header + 16, static_cast<uint32_t>(height));
+        putU32(header + 20, static_cast<uint32_t>(fps));
+        std::fwrite(header, 1, sizeof(header), m_file);
+
+        m_width = width;
+        m_height = height;
+        m_fps = std::max(1, fps);
+        m_current = ActivitySecond();
+        m_fractionSum = 0.0;
+        m_measuredFrames = 0;
+        m_firstFrame = true;
+        return true;
+    }
+
+    void ActivityIndexWriter::addFrame(const TileChangeMap &changes, bool inputActive, bool inputSampled)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_file)
+        {
+            return;
+        }
+
+        // The first frame of a recording is all "changed"; it has nothing to compare against
+        double fraction = m_firstFrame ? -1.0 : changes.getChangedFraction();
+        account(fraction, changes.getChangedTileCount() > 0 ? changes.getChangedBounds() : Rect(), inputActive,
+                inputSampled);
+    }
+
+    void ActivityIndexWriter::addFrame(const std::vector<Rect> &damage, bool inputActive, bool inputSampled)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_file)
+        {
+            return;
+        }
+
+        // Overlapping rectangles count twice; the fraction is clamped by account()
+        Rect frame(0, 0, m_width, m_height);
+        Rect bounds;
+        double area = 0.0;
+        for (const Rect &rect : damage)
+        {
+            Rect clipped = rect.intersected(frame);
+            if (!clipped.isEmpty())
+            {
+                area += static_cast<double>(clipped.width) * clipped.height;
+                bounds = bounds.united(clipped);
+            }
+        }
+        double pixels = static_cast<double>(m_width) * m_height;
+        account(pixels > 0.0 ? area / pixels : 0.0, bounds, inputActive, inputSampled);
+    }
+
+    void ActivityIndexWriter::addFrame(bool inputActive, bool inputSampled)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_file)
+        {
+            return;
+        }
+        account(-1.0, Rect(), inputActive, inputSampled);
+    }
+
+    bool ActivityIndexWriter::wantsChangeSample()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_file && m_measuredFrames == 0;
+    }
+
+    void ActivityIndexWriter::account(double fraction, const Rect &bounds, bool inputActive, bool inputSampled)
+    {
+        if (fraction >= 0.0)
+        {
+            fraction = std::min(1.0, fraction);
+            m_fractionSum += fraction;
+            m_measuredFrames++;
+            m_current.peakFraction = std::max(m_current.peakFraction, static_cast<float>(fraction));
+            if (!bounds.isEmpty())
+            {
+                m_current.changedBounds = m_current.changedBounds.united(bounds);
+            }
+        }
+        m_firstFrame = false;
+        if (inputSampled && inputActive)
+        {
+            m_current.inputSamples++;
+        }
+
+        if (++m_current.frames >= m_fps)
+        {
+            flushSecond();
+        }
+    }
+
+    void ActivityIndexWriter::addRepeatedFrames(int64_t count)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_file)
+        {
+            return;
+        }
+
+        // Repeats are known to be unchanged: they lower the mean and advance the clock
+        for (int64_t i = 0; i < count; ++i)
+        {
+            m_measuredFrames++;
+            if (++m_current.frames >= m_fps)
+            {
+                flushSecond();
+            }
+        }
+    }
+
+    void ActivityIndexWriter::flushSecond()
+    {
+        if (m_current.frames == 0)
+        {
+            return;
+        }
+
+        uint8_t record[RECORD_SIZE];
+        putU16(record + 0, encodeFraction(m_measuredFrames > 0 ? m_fractionSum / m_measuredFrames : 0.0));
+        putU16(record + 2, encodeFraction(m_current.peakFraction));
+        putU16(record + 4, static_cast<uint32_t>(std::max(0, m_current.changedBounds.x)));
+        putU16(record + 6, static_cast<uint32_t>(std::max(0, m_current.changedBounds.y)));
+        putU16(record + 8, static_cast<uint32_t>(std::max(0, m_current.changedBounds.width)));
+        putU16(record + 10, static_cast<uint32_t>(std::max(0, m_current.changedBounds.height)));
+        putU16(record + 12, static_cast<uint32_t>(m_current.inputSamples));
+        putU16(record + 14, static_cast<uint32_t>(m_current.frames));
+        std::fwrite(record, 1, sizeof(record), m_file);
+
+        m_current = ActivitySecond();
+        m_fractionSum = 0.0;
+        m_measuredFrames = 0;
+    }
+
+    void ActivityIndexWriter::close()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_file)
+        {
+            return;
+        }
+
+        flushSecond();
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+
+    // --- Reader ---
+
+    std::string ActivityIndex::sidecarPath(const std::string &recordingPath)
+    {
+        return recordingPath + ".activity";
+    }
+
+    void ActivityIndex::clear()
+    {
+        m_width = 0;
+        m_height = 0;
+        m_fps = 0;
+        m_seconds.clear();
+    }
+
+    bool ActivityIndex::load(const std::string &recordingPath)
+    {
+        clear();
+
+        std::FILE *file = std::fopen(sidecarPath(recordingPath).c_str(), "rb");
+        if (!file)
+        {
+            return false;
+        }
+
+        uint8_t header[HEADER_SIZE];
+        bool valid = std::fread(header, 1, sizeof(header), file) == sizeof(header) &&
+                     std::memcmp(header, MAGIC, sizeof(MAGIC)) == 0 && getU32(header + 8) == VERSION;
+        if (!valid)
+        {
+            std::fclose(file);
+            Logger::warning("Ignoring invalid activity index for " + recordingPath);
+            return false;
+        }
+
+        m_width = static_cast<int>(getU32(header + 12));
+        m_height = static_cast<int>(getU32(header + 16));
+        m_fps = static_cast<int>(getU32(header + 20));
+
+        uint8_t record[RECORD_SIZE];
+        while (std::fread(record, 1, sizeof(record), file) == sizeof(record))
+        {
+            ActivitySecond second;
+            second.changedFraction = getU16(record + 0) / 65535.0f;
+            second.peakFraction = getU16(record + 2) / 65535.0f;
+            second.changedBounds = Rect(static_cast<int>(getU16(record + 4)), static_cast<int>(getU16(record + 6)),
+                                        static_cast<int>(getU16(record + 8)), static_cast<int>(getU16(record + 10)));
+            second.inputSamples = static_cast<int>(getU16(record + 12));
+            second.frames = static_cast<int>(getU16(record + 14));
+            m_seconds.push_back(second);
+        }
+        std::fclose(file);
+        return !m_seconds.empty();
+    }
+
+    bool ActivityIndex::active(int second, float minFraction) const
+    {
+        return second >= 0 && second < static_cast<int>(m_seconds.size()) && m_seconds[second].isActive(minFraction);
+    }
+
+    int ActivityIndex::findNext(int second, float minFraction) const
+    {
+        int count = static_cast<int>(m_seconds.size());
+        int s = std::max(0, second);
+        while (s < count && active(s, minFraction))
+        {
+            ++s;
+        }
+        while (s < count && !active(s, minFraction))
+        {
+            ++s;
+        }
+        return s < count ? s : -1;
+    }
+
+    int ActivityIndex::findPrevious(int second, float minFraction) const
+    {
+        int s = std::min(second, static_cast<int>(m_seconds.size())) - 1;
+        while (s >= 0 && !active(s, minFraction))
+        {
+            --s;
+        }
+        if (s < 0)
+        {
+            return -1;
+        }
+        while (s > 0 && active(s - 1, minFraction))
+        {
+            --s;
+        }
+        return s;
+    }
+
+    bool ActivityIndex::findSpan(int second, float minFraction, int maxGap, int &first, int &last) const
+    {
+        // Nearest active second within maxGap, preferring the current one and later ones
+        int anchor = -1;
+        for (int distance = 0; distance <= maxGap && anchor < 0; ++distance)
+        {
+            if (active(second + distance, minFraction))
+            {
+                anchor = second + distance;
+            }
+            else if (active(second - distance, minFraction))
+            {
+                anchor = second - distance;
+            }
+        }
+        if (anchor < 0)
+        {
+            return false;
+        }
+
+        auto extend = [&](int from, int step)
+        {
+            int edge = from;
+            int gap = 0;
+            for (int s = from + step; s >= 0 && s < static_cast<int>(m_seconds.size()) && gap <= maxGap; s += step)
+            {
+                if (active(s, minFraction))
+                {
+                    edge = s;
+                    gap = 0;
+                }
+                else
+                {
+                    ++gap;
+                }
+            }
+            return edge;
+        };
+
+        first = extend(anchor, -1);
+        last = extend(anchor, 1);
+        return true;
+    }
+
+} // namespace NanoRec
@@ -3,8 +3,21 @@
 #include "core/ThreadSafeFrameBuffer.hpp"
 #include "core/CaptureThread.hpp"
 #include "core/ImageWriter.hpp"
+#include "core/Config.hpp"
+#include "core/AutoTuner.hpp"
+#include "core/MjpegPreviewServer.hpp"
+#include "core/RedactionFilter.hpp"
+#include "core/RemoteVideoWriter.hpp"
+#include "core/SimulatedVideoWriter.hpp"
+#include "core/TextOverlay.hpp"
+#include "core/TranscodeQueue.hpp"
+#include "capture/FileReplayCapture.hpp"
 #include "capture/ScreenCaptureFactory.hpp"
+#include "capture/VncScreenCapture.hpp"
 #include "ui/GLTexture.hpp"
+#include "ui/LibraryPanel.hpp"
+#include "ui/PlaybackPanel.hpp"
+#include "ui/YuvTexture.hpp"
 #include "core/Version.hpp" // This was in the original and not in the snippet, keeping it.
 
 #include <GLFW/glfw3.h>
@@ -12,6 +25,8 @@
 #include <backends/imgui_impl_glfw.h>
 #include <backends/imgui_impl_opengl3.h>
 #include <chrono>
+#include <filesystem>
+#include <future>
 #include <iomanip>
 #include <sstream>
 
@@ -23,6 +38,9 @@ namespace NanoRec
         Logger::error("GLFW Error " + std::to_string(error) + ": " + description);
     }
 
+    // Settings file in the working directory; written by the first-run auto-tune
+    static const char *CONFIG_PATH = "nanorec.ini";
+
     // Private implementation (PIMPL pattern)
     struct Application::Impl
     {
@@ -55,10 +73,128 @@ namespace NanoRec
         std::unique_ptr<IScreenCapture> screenCapture;
         ThreadSafeFrameBuffer frameBuffer;
         CaptureThread captureThread;
+        MjpegPreviewServer previewServer;
+        TranscodeQueue transcodeQueue;
+        TextOverlay overlay;
+        RedactionFilter redactionFilter;
         FrameBuffer displayFrame;  // For UI display
         GLTexture previewTexture;
         bool hasPreviewFrame = false;
 
+        // Encoder-format preview while recording yuv420p/nv12 (GPU converts to RGB)
+        YuvFrame yuvFrame;
+        YuvTexture yuvPreview;
+        bool yuvPreviewActive = false;
+
+        // Recording review
+        PlaybackPanel playbackPanel;
+        bool showPlayer = false;
+        std::string lastRecordingFilename;
+        LibraryPanel libraryPanel;
+        bool showLibrary = false;
+
+        // Pipeline auto-tune (runs instead of the capture thread until done)
+        std::unique_ptr<AutoTuner> autoTuner;
+        std::future<bool> autoTuneResult;
+        PipelineCandidate autoTuneBest;
+
+        // Live capture settings (applied by the capture thread without a restart)
+        int previewFps = 0;         // 0 = every captured frame
+        bool overlayEnabled = true;
+
+        /**
+         * @brief Publish the UI's current capture settings to the capture thread
+         *
+         * Picked up at the next frame boundary; while recording, a change of
+         * encoded resolution or format continues in a new segment file.
+         */
+        void publishCaptureSettings()
+        {
+            CaptureSettings settings = captureThread.getSettings();
+            settings.monitor = selectedMonitorId;
+            getTargetResolution(settings.targetWidth, settings.targetHeight);
+
+            const Config::VideoConfig &videoConfig = Config::getInstance().getVideoConfig();
+            settings.preset = videoConfig.preset;
+            settings.pixelFormat = videoConfig.pixelFormat;
+            settings.scalerThreads = static_cast<int>(videoConfig.scalerThreads);
+            settings.stripeRows = static_cast<int>(videoConfig.stripeRows);
+            settings.pipeline = videoConfig.pipeline.empty() ? FramePipeline::DEFAULT_SPEC : videoConfig.pipeline;
+            settings.adaptiveRate = videoConfig.adaptiveRate;
+            settings.idleFps = static_cast<int>(videoConfig.idleFps);
+            settings.encoderQueueFrames = static_cast<int>(videoConfig.encoderQueueFrames);
+            settings.encoderSpill = videoConfig.encoderSpill;
+            settings.encoderSpillMb = static_cast<int>(videoConfig.encoderSpillMb);
+            settings.encoderRestarts = static_cast<int>(videoConfig.encoderRestarts);
+            settings.previewFps = previewFps;
+            settings.overlayEnabled = overlayEnabled;
+            captureThread.applySettings(settings);
+        }
+
+        void getTargetResolution(int &targetWidth, int &targetHeight) const
+        {
+            switch (resolutionMode)
+            {
+                case ResolutionMode::Native:
+                    targetWidth = 0;  // 0 = native
+                    targetHeight = 0;
+                    break;
+                case ResolutionMode::HD_1080p:
+                    targetWidth = 1920;
+                    targetHeight = 1080;
+                    break;
+                case ResolutionMode::HD_720p:
+                    targetWidth = 1280;
+                    targetHeight = 720;
+                    break;
+                case ResolutionMode::Custom:
+                    targetWidth = customWidth;
+                    targetHeight = customHeight;
+                    break;
+            }
+        }
+
+        void startAutoTune()
+        {
+            int targetWidth = 0, targetHeight = 0;
+            getTargetResolution(targetWidth, targetHeight);
+
+            AutoTuner::Options options;
+            options.outputWidth = targetWidth;
+            options.outputHeight = targetHeight;
+
+            autoTuner = std::make_unique<AutoTuner>(screenCapture.get());
+            autoTuneResult = std::async(std::launch::async, [this, options]()
+                                        { return autoTuner->run(options, autoTuneBest); });
+            statusText = "Auto-tuning capture pipeline...";
+        }
+
+        // Called every frame; applies the result and hands the capture backend back to the capture thread
+        void pollAutoTune()
+        {
+            if (!autoTuneResult.valid() ||
+                autoTuneResult.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                return;
+            }
+
+            Config &config = Config::getInstance();
+            if (autoTuneResult.get())
+            {
+                AutoTuner::apply(autoTuneBest, config);
+                config.save(CONFIG_PATH);
+                statusText = "Auto-tuned: " + autoTuneBest.describe();
+            }
+            else
+            {
+                statusText = "Auto-tune failed; using current settings";
+            }
+            autoTuner.reset();
+
+            publishCaptureSettings();
+            captureThread.start(screenCapture.get(), &frameBuffer);
+        }
+
         bool initializeGLFW()
         {
             Logger::info("Initializing GLFW...");
@@ -172,6 +308,9 @@ namespace NanoRec
         {
             Logger::info("Initializing dependencies...");
 
+            // Missing file on first launch is expected (defaults + auto-tune)
+            Config::getInstance().load(CONFIG_PATH);
+
             if (!initializeGLFW())
             {
                 return false;
@@ -192,8 +331,31 @@ namespace NanoRec
                 return false;
             }
 
-            // Initialize screen capture
-            screenCapture = createScreenCapture();
+            // Initialize screen capture (or replay a dumped capture for reproducible runs, or a remote desktop)
+            const Config::VideoConfig &videoConfig = Config::getInstance().getVideoConfig();
+            if (!videoConfig.replayFile.empty())
+            {
+                FileReplayCapture::Options replayOptions;
+                replayOptions.path = videoConfig.replayFile;
+                replayOptions.timingPath = videoConfig.replayTiming;
+                replayOptions.fps = videoConfig.fps;
+                replayOptions.realtime = !videoConfig.replayMaxRate;
+                screenCapture = std::make_unique<FileReplayCapture>(replayOptions);
+            }
+            else if (!videoConfig.vncServer.empty())
+            {
+                VncScreenCapture::Options vncOptions;
+                if (!VncScreenCapture::parseAddress(videoConfig.vncServer, vncOptions.host, vncOptions.port))
+                {
+                    Logger::error("Invalid vnc_server address: " + videoConfig.vncServer);
+                    return false;
+                }
+                screenCapture = std::make_unique<VncScreenCapture>(vncOptions);
+            }
+            else
+            {
+                screenCapture = createScreenCapture();
+            }
             if (!screenCapture)
             {
                 Logger::error("Failed to create screen capture");
@@ -217,7 +379,108 @@ namespace NanoRec
             // Initialize thread-safe frame buffer
             frameBuffer.initialize(screenCapture->getWidth(), screenCapture->getHeight());
 
-            // Start capture thread
+            // Optional MJPEG preview endpoint (failure is not fatal)
+            const Config::AppConfig &appConfig = Config::getInstance().getAppConfig();
+            previewServer.setChangeWaiter(&captureThread.getChangeWaiter());
+            if (appConfig.previewServerEnabled &&
+                previewServer.start(static_cast<int>(appConfig.previewServerPort),
+                                    static_cast<int>(appConfig.previewServerFps)))
+            {
+                captureThread.setPreviewServer(&previewServer);
+            }
+
+            // Compliance burn-in of wall-clock time and host label
+            if (appConfig.overlayEnabled)
+            {
+                TextOverlay::Options overlayOptions;
+                overlayOptions.label = appConfig.overlayLabel;
+                overlayOptions.scale = static_cast<int>(appConfig.overlayScale);
+                if (overlay.configure(overlayOptions))
+                {
+                    captureThread.setOverlay(&overlay);
+                }
+            }
+
+            // Privacy redaction of configured windows (applies to every sink)
+            if (!appConfig.redactWindows.empty())
+            {
+                RedactionFilter::Options redactOptions;
+                std::stringstream patterns(appConfig.redactWindows);
+                std::string pattern;
+                while (std::getline(patterns, pattern, ','))
+                {
+                    pattern.erase(0, pattern.find_first_not_of(" \t"));
+                    pattern.erase(pattern.find_last_not_of(" \t") + 1);
+                    if (!pattern.empty())
+                    {
+                        redactOptions.patterns.push_back(pattern);
+                    }
+                }
+                redactOptions.mode = appConfig.redactMode == "black" ? RedactionFilter::Mode::Blackout
+                                                                     : RedactionFilter::Mode::Pixelate;
+                redactOptions.blockSize = static_cast<int>(appConfig.redactBlockSize);
+                if (redactionFilter.start(redactOptions))
+                {
+                    captureThread.setRedactionFilter(&redactionFilter);
+                }
+            }
+
+            // Fault-injecting encoder for overload drills (takes precedence over real encoders)
+            SimulatedVideoWriter::Options simulationOptions;
+            bool simulateEncoder = !appConfig.encoderSimulation.empty() &&
+                                   SimulatedVideoWriter::parseSpec(appConfig.encoderSimulation, simulationOptions);
+            if (!appConfig.encoderSimulation.empty() && !simulateEncoder)
+            {
+                Logger::error("Invalid encoder_simulation: " + appConfig.encoderSimulation);
+            }
+            if (simulateEncoder)
+            {
+                captureThread.setVideoWriterFactory([simulationOptions]
+                                                    { return std::make_unique<SimulatedVideoWriter>(simulationOptions); });
+                Logger::warning("Encoder simulation active: " + appConfig.encoderSimulation);
+            }
+            // Offload encoding to remote nodes (each segment picks the least busy one)
+            else if (!appConfig.encoderNodes.empty())
+            {
+                RemoteVideoWriter::Options remoteOptions;
+                remoteOptions.nodes = RemoteVideoWriter::parseNodeList(appConfig.encoderNodes);
+                remoteOptions.maxInFlight = static_cast<int>(std::max<uint32_t>(1, appConfig.encoderMaxInFlight));
+                captureThread.setVideoWriterFactory([remoteOptions]
+                                                    { return std::make_unique<RemoteVideoWriter>(remoteOptions); });
+                Logger::info("Remote encoding on " + std::to_string(remoteOptions.nodes.size()) + " node(s)");
+            }
+
+            // Recordings library (indexes in the background)
+            libraryPanel.setOpenCallback([this](const std::string &path)
+                                         {
+                                             playbackPanel.open(path);
+                                             showPlayer = true; });
+            libraryPanel.open(appConfig.outputDirectory);
+
+            // Optional archive re-encode; yields to live recording near its frame budget
+            if (appConfig.archiveTranscodeEnabled)
+            {
+                transcodeQueue.setPauseCondition([this]()
+                                                 { return captureThread.isRecording() &&
+                                                          captureThread.getBudgetUsage() > 0.8; });
+                TranscodeQueue::Options transcodeOptions;
+                transcodeOptions.preset = appConfig.archivePreset;
+                transcodeQueue.start(transcodeOptions);
+            }
+
+            // First run: benchmark the pipeline before capturing; the capture
+            // thread is started by pollAutoTune() once the winner is applied
+            Config &config = Config::getInstance();
+            if (!config.getAppConfig().autoTuned)
+            {
+                startAutoTune();
+                return true;
+            }
+
+            screenCapture->setCaptureMethod(config.getVideoConfig().captureMethod);
+
+            // Start capture thread (config-driven settings such as adaptive rate apply from the first frame)
+            publishCaptureSettings();
             if (!captureThread.start(screenCapture.get(), &frameBuffer))
             {
                 Logger::error("Failed to start capture thread");
@@ -245,15 +508,24 @@ namespace NanoRec
             
             // FPS display
             double fps = captureThread.getCurrentFPS();
-            ImGui::Text("Capture FPS: %.1f", fps);
+            ImGui::Text("Capture FPS: %.1f%s", fps, captureThread.isIdle() ? " (idle)" : "");
             
             ImGui::Separator();
             ImGui::Spacing();
 
+            // Auto-tune owns the capture backend while it runs
+            bool autoTuning = autoTuneResult.valid();
+            if (autoTuning)
+            {
+                ImGui::ProgressBar(autoTuner ? autoTuner->getProgress() : 0.0f, ImVec2(280, 0));
+            }
+            ImGui::BeginDisabled(autoTuning);
+
             // Resolution selection
             ImGui::Separator();
             ImGui::Text("Output Resolution:");
             
+            ResolutionMode previousMode = resolutionMode;
             if (ImGui::RadioButton("Native (No Scaling)", resolutionMode == ResolutionMode::Native))
                 resolutionMode = ResolutionMode::Native;
             if (ImGui::RadioButton("1080p (1920x1080)", resolutionMode == ResolutionMode::HD_1080p))
@@ -262,16 +534,25 @@ namespace NanoRec
                 resolutionMode = ResolutionMode::HD_720p;
             if (ImGui::RadioButton("Custom", resolutionMode == ResolutionMode::Custom))
                 resolutionMode = ResolutionMode::Custom;
+            bool resolutionChanged = resolutionMode != previousMode;
             
-            // Custom resolution inputs
+            // Custom resolution inputs (applied when editing finishes, not per keystroke)
             if (resolutionMode == ResolutionMode::Custom)
             {
                 ImGui::Indent();
                 ImGui::InputInt("Width", &customWidth);
+                resolutionChanged |= ImGui::IsItemDeactivatedAfterEdit();
                 ImGui::InputInt("Height", &customHeight);
+                resolutionChanged |= ImGui::IsItemDeactivatedAfterEdit();
                 ImGui::Unindent();
             }
 
+            // While recording this rolls over to a new segment at the new size
+            if (resolutionChanged)
+            {
+                publishCaptureSettings();
+            }
+
             ImGui::Spacing();
             ImGui::Separator();
 
@@ -285,33 +566,23 @@ namespace NanoRec
                     auto time_t = std::chrono::system_clock::to_time_t(now);
                     std::stringstream ss;
                     ss << "recording_" << std::put_time(std::localtime(&time_t), "%Y%m%d_%H%M%S") << ".mp4";
-                    std::string filename = ss.str();
+
+                    // Record into the configured output directory (indexed by the library)
+                    std::filesystem::path outputDirectory(Config::getInstance().getAppConfig().outputDirectory);
+                    std::error_code dirError;
+                    std::filesystem::create_directories(outputDirectory, dirError);
+                    std::string filename = (outputDirectory / ss.str()).string();
 
                     // Determine target resolution
                     int targetWidth = 0, targetHeight = 0;
-                    switch (resolutionMode)
-                    {
-                        case ResolutionMode::Native:
-                            targetWidth = 0;  // 0 = native
-                            targetHeight = 0;
-                            break;
-                        case ResolutionMode::HD_1080p:
-                            targetWidth = 1920;
-                            targetHeight = 1080;
-                            break;
-                        case ResolutionMode::HD_720p:
-                            targetWidth = 1280;
-                            targetHeight = 720;
-                            break;
-                        case ResolutionMode::Custom:
-                            targetWidth = customWidth;
-                            targetHeight = customHeight;
-                            break;
-                    }
+                    getTargetResolution(targetWidth, targetHeight);
+
+                    publishCaptureSettings();
 
                     if (captureThread.startRecording(filename, 30, targetWidth, targetHeight))
                     {
                         isRecording = true;
+                        lastRecordingFilename = filename;
                         statusText = "Recording: " + filename;
                         Logger::info("Recording started: " + filename);
                     }
@@ -329,6 +600,22 @@ namespace NanoRec
                     captureThread.stopRecording();
                     isRecording = false;
                     statusText = "Recording stopped";
+
+                    // Settings changes during the recording may have split it into segments
+                    std::vector<std::string> segments = captureThread.getSegments();
+                    if (!segments.empty())
+                    {
+                        lastRecordingFilename = segments.back();
+                    }
+                    playbackPanel.setPath(lastRecordingFilename);
+                    if (transcodeQueue.isRunning())
+                    {
+                        for (const std::string &segment : segments)
+                        {
+                            transcodeQueue.enqueue(segment);
+                        }
+                    }
+                    libraryPanel.refresh();
                     Logger::info("Recording stopped");
                 }
             }
@@ -339,7 +626,12 @@ namespace NanoRec
             // Screenshot button
             if (ImGui::Button("Take Screenshot", ImVec2(280, 30)))
             {
-                // Use the display frame that's already being used for preview
+                // Use the display frame that's already being used for preview; the YUV
+                // preview doesn't refresh it, so take the latest capture directly
+                if (yuvPreviewActive)
+                {
+                    frameBuffer.getLatestFrame(displayFrame);
+                }
                 if (hasPreviewFrame && displayFrame.data && displayFrame.width > 0 && displayFrame.height > 0)
                 {
                     std::string filename = ImageWriter::generateTimestampedFilename();
@@ -377,24 +669,9 @@ namespace NanoRec
                 {
                     if (selectedMonitorId != -1)  // Only update if changing
                     {
+                        // Switched by the capture thread at its next frame boundary
                         selectedMonitorId = -1;
-                        if (screenCapture)
-                        {
-                            // Stop capture thread
-                            captureThread.stop();
-                            
-                            // Select new monitor
-                            screenCapture->selectMonitor(-1);
-                            
-                            // Reinitialize frame buffer for new dimensions
-                            frameBuffer.initialize(screenCapture->getWidth(), screenCapture->getHeight());
-                            
-                            // Restart capture thread
-                            captureThread.start(screenCapture.get(), &frameBuffer);
-                            
-                            // Clear preview to force update
-                            hasPreviewFrame = false;
-                        }
+                        publishCaptureSettings();
                     }
                 }
 
@@ -407,23 +684,7 @@ namespace NanoRec
                         if (selectedMonitorId != static_cast<int>(i))  // Only update if changing
                         {
                             selectedMonitorId = static_cast<int>(i);
-                            if (screenCapture)
-                            {
-                                // Stop capture thread
-                                captureThread.stop();
-                                
-                                // Select new monitor
-                                screenCapture->selectMonitor(selectedMonitorId);
-                                
-                                // Reinitialize frame buffer for new dimensions
-                                frameBuffer.initialize(screenCapture->getWidth(), screenCapture->getHeight());
-                                
-                                // Restart capture thread
-                                captureThread.start(screenCapture.get(), &frameBuffer);
-                                
-                                // Clear preview to force update
-                                hasPreviewFrame = false;
-                            }
+                            publishCaptureSettings();
                         }
                     }
                 }
@@ -437,6 +698,43 @@ namespace NanoRec
             static bool showPreview = true;
             ImGui::Checkbox("Show Preview", &showPreview);
 
+            // Cheap settings: applied on the next captured frame
+            if (ImGui::SliderInt("Preview FPS", &previewFps, 0, 60, previewFps == 0 ? "every frame" : "%d"))
+            {
+                publishCaptureSettings();
+            }
+            if (Config::getInstance().getAppConfig().overlayEnabled &&
+                ImGui::Checkbox("Burn-in Overlay", &overlayEnabled))
+            {
+                publishCaptureSettings();
+            }
+            if (ImGui::Checkbox("Adaptive Rate", &Config::getInstance().getVideoConfig().adaptiveRate))
+            {
+                publishCaptureSettings();
+            }
+            if (ImGui::IsItemHovered())
+            {
+                ImGui::SetTooltip("Full rate on input or motion, down to %u FPS when idle",
+                                  Config::getInstance().getVideoConfig().idleFps);
+            }
+            ImGui::Checkbox("Show Player", &showPlayer);
+            ImGui::Checkbox("Show Library", &showLibrary);
+
+            if (transcodeQueue.isRunning())
+            {
+                ImGui::Text("Archive: %zu queued%s, saved %.1f MB", transcodeQueue.getPendingCount(),
+                            transcodeQueue.isPaused() ? " (paused)" : "",
+                            transcodeQueue.getBytesSaved() / (1024.0 * 1024.0));
+            }
+
+            if (!isRecording && ImGui::Button("Run Auto-Tune", ImVec2(280, 30)))
+            {
+                captureThread.stop();
+                startAutoTune();
+            }
+
+            ImGui::EndDisabled();
+
             ImGui::Spacing();
 
             // Quit button
@@ -449,7 +747,8 @@ namespace NanoRec
             ImGui::End();
 
             // Preview window
-            if (showPreview && hasPreviewFrame && previewTexture.isValid())
+            const bool showYuv = yuvPreviewActive && yuvPreview.isValid();
+            if (showPreview && (showYuv || (hasPreviewFrame && previewTexture.isValid())))
             {
                 ImGui::SetNextWindowPos(ImVec2(320, 10), ImGuiCond_FirstUseEver);
                 ImGui::SetNextWindowSize(ImVec2(640, 400), ImGuiCond_FirstUseEver);
@@ -459,8 +758,12 @@ namespace NanoRec
                 // Get available content region
                 ImVec2 contentRegion = ImGui::GetContentRegionAvail();
 
+                unsigned int textureID = showYuv ? yuvPreview.getTextureID() : previewTexture.getTextureID();
+                int textureWidth = showYuv ? yuvPreview.getWidth() : previewTexture.getWidth();
+                int textureHeight = showYuv ? yuvPreview.getHeight() : previewTexture.getHeight();
+
                 // Calculate scaled size to fit in window while maintaining aspect ratio
-                float textureAspect = (float)previewTexture.getWidth() / (float)previewTexture.getHeight();
+                float textureAspect = (float)textureWidth / (float)textureHeight;
                 float windowAspect = contentRegion.x / contentRegion.y;
 
                 ImVec2 imageSize;
@@ -478,14 +781,27 @@ namespace NanoRec
                 }
 
                 // Display texture
-                ImGui::Image((void *)(intptr_t)previewTexture.getTextureID(), imageSize);
+                ImGui::Image((void *)(intptr_t)textureID, imageSize);
 
                 // Show resolution info
-                ImGui::Text("Resolution: %dx%d", previewTexture.getWidth(), previewTexture.getHeight());
+                ImGui::Text("Resolution: %dx%d%s", textureWidth, textureHeight,
+                            showYuv ? " (encoder frames, YUV)" : "");
 
                 ImGui::End();
             }
 
+            // Playback window
+            if (showPlayer)
+            {
+                playbackPanel.render(&showPlayer);
+            }
+
+            // Recordings library window
+            if (showLibrary)
+            {
+                libraryPanel.render(&showLibrary);
+            }
+
             // Render ImGui
             ImGui::Render();
             ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
@@ -501,8 +817,29 @@ namespace NanoRec
                 // Poll events
                 glfwPollEvents();
 
+                pollAutoTune();
+
+                // The capture thread ends a recording itself when the encoder dies and no restarts are left
+                if (isRecording && !captureThread.isRecording())
+                {
+                    captureThread.stopRecording();
+                    isRecording = false;
+                    statusText = "Recording stopped: encoder failed";
+                }
+
+                // While recording yuv420p/nv12, show the encoder's own frames: half the
+                // upload of RGB, converted by a shader instead of on the CPU
+                if (!captureThread.isRecording())
+                {
+                    yuvPreviewActive = false;
+                }
+                else if (frameBuffer.getLatestYuvFrame(yuvFrame))
+                {
+                    yuvPreviewActive = yuvPreview.update(yuvFrame);
+                }
+
                 // Get latest frame from capture thread for preview
-                if (frameBuffer.hasNewFrame())
+                if (!yuvPreviewActive && frameBuffer.hasNewFrame())
                 {
                     if (frameBuffer.getLatestFrame(displayFrame))
                     {
@@ -550,9 +887,21 @@ namespace NanoRec
 
         void cleanup()
         {
+            // Let a running auto-tune release the capture backend
+            if (autoTuneResult.valid())
+            {
+                autoTuner->cancel();
+                autoTuneResult.wait();
+            }
+
             // Stop capture thread
             Logger::info("Stopping capture thread...");
             captureThread.stop();
+            captureThread.setPreviewServer(nullptr);
+            previewServer.stop();
+            transcodeQueue.stop();
+            captureThread.setRedactionFilter(nullptr);
+            redactionFilter.stop();
 
             // Shutdown screen capture
             if (screenCapture)
@@ -563,6 +912,10 @@ namespace NanoRec
             // Cleanup ImGui
             if (window)
             {
+                playbackPanel.shutdown();
+                libraryPanel.shutdown();
+                yuvPreview.destroy();
+
                 Logger::info("Shutting down ImGui...");
                 ImGui_ImplOpenGL3_Shutdown();
                 ImGui_ImplGlfw_Shutdown();
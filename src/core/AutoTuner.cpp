@@ -0,0 +1,298 @@
+#include "core/AutoTuner.hpp"
+#include "core/FFmpegVideoWriter.hpp"
+#include "core/FrameScaler.hpp"
+#include "core/Logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+namespace NanoRec
+{
+
+    std::string PipelineCandidate::describe() const
+    {
+        return captureMethod + ", " + std::to_string(scalerThreads) + " scaler thread(s), " + pixelFormat + ", " +
+               preset;
+    }
+
+    AutoTuner::AutoTuner(IScreenCapture *capture)
+        : m_capture(capture)
+    {
+    }
+
+    void AutoTuner::apply(const PipelineCandidate &candidate, Config &config)
+    {
+        Config::VideoConfig &video = config.getVideoConfig();
+        video.captureMethod = candidate.captureMethod;
+        video.scalerThreads = static_cast<uint32_t>(candidate.scalerThreads);
+        video.pixelFormat = candidate.pixelFormat;
+        video.preset = candidate.preset;
+        config.getAppConfig().autoTuned = true;
+    }
+
+    const PipelineMeasurement *AutoTuner::pickBest(size_t firstIndex, bool requireSustained) const
+    {
+        const PipelineMeasurement *best = nullptr;
+        for (size_t i = firstIndex; i < m_measurements.size(); ++i)
+        {
+            const PipelineMeasurement &measurement = m_measurements[i];
+            if (requireSustained && !measurement.sustained)
+            {
+                continue;
+            }
+            if (!best || measurement.fps > best->fps)
+            {
+                best = &measurement;
+            }
+        }
+        return best;
+    }
+
+    bool AutoTuner::run(const Options &options, PipelineCandidate &best)
+    {
+        if (!m_capture || options.targetFps <= 0)
+        {
+            Logger::error("Auto-tune: invalid capture backend or target");
+            return false;
+        }
+
+        m_measurements.clear();
+        m_cancelled.store(false);
+        m_progress.store(0.0f);
+
+        int outputWidth = options.outputWidth > 0 ? options.outputWidth : m_capture->getWidth();
+        int outputHeight = options.outputHeight > 0 ? options.outputHeight : m_capture->getHeight();
+        bool scaling = outputWidth != m_capture->getWidth() || outputHeight != m_capture->getHeight();
+
+        std::vector<std::string> methods = m_capture->getCaptureMethods();
+
+        // Scaler threads only matter when the output is scaled
+        std::vector<int> threadCounts = {1};
+        if (scaling)
+        {
+            int hardwareThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+            for (int threads : {2, 4, hardwareThreads})
+            {
+                if (threads <= hardwareThreads &&
+                    std::find(threadCounts.begin(), threadCounts.end(), threads) == threadCounts.end())
+                {
+                    threadCounts.push_back(threads);
+                }
+            }
+        }
+
+        size_t total = (methods.size() > 1 ? methods.size() : 0) + (threadCounts.size() > 1 ? threadCounts.size() : 0) +
+                       options.presets.size() * options.pixelFormats.size();
+        size_t done = 0;
+
+        Logger::info("Auto-tune: benchmarking " + std::to_string(total) + " pipeline configurations at " +
+                     std::to_string(outputWidth) + "x" + std::to_string(outputHeight) + ", target " +
+                     std::to_string(options.targetFps) + " FPS");
+
+        auto runStage = [&](const std::vector<PipelineCandidate> &candidates) -> const PipelineMeasurement *
+        {
+            size_t stageStart = m_measurements.size();
+            for (const PipelineCandidate &candidate : candidates)
+            {
+                if (m_cancelled.load())
+                {
+                    return nullptr;
+                }
+
+                PipelineMeasurement result;
+                if (measure(candidate, options, result))
+                {
+                    m_measurements.push_back(result);
+                }
+                m_progress.store(static_cast<float>(++done) / static_cast<float>(std::max<size_t>(total, 1)));
+            }
+            return pickBest(stageStart, false);
+        };
+
+        PipelineCandidate current;
+        current.captureMethod = methods.empty() ? "default" : methods.front();
+
+        // Stage 1: capture path
+        if (methods.size() > 1)
+        {
+            std::vector<PipelineCandidate> candidates;
+            for (const std::string &method : methods)
+            {
+                PipelineCandidate candidate = current;
+                candidate.captureMethod = method;
+                candidates.push_back(candidate);
+            }
+            if (const PipelineMeasurement *winner = runStage(candidates))
+            {
+                current.captureMethod = winner->candidate.captureMethod;
+            }
+        }
+
+        // Stage 2: scaler threads
+        if (threadCounts.size() > 1)
+        {
+            std::vector<PipelineCandidate> candidates;
+            for (int threads : threadCounts)
+            {
+                PipelineCandidate candidate = current;
+                candidate.scalerThreads = threads;
+                candidates.push_back(candidate);
+            }
+            if (const PipelineMeasurement *winner = runStage(candidates))
+            {
+                current.scalerThreads = winner->candidate.scalerThreads;
+            }
+        }
+
+        // Stage 3: encoder preset x output pixel format
+        {
+            std::vector<PipelineCandidate> candidates;
+            for (const std::string &preset : options.presets)
+            {
+                for (const std::string &pixelFormat : options.pixelFormats)
+                {
+                    PipelineCandidate candidate = current;
+                    candidate.preset = preset;
+                    candidate.pixelFormat = pixelFormat;
+                    candidates.push_back(candidate);
+                }
+            }
+            runStage(candidates);
+        }
+
+        if (m_cancelled.load())
+        {
+            Logger::warning("Auto-tune cancelled");
+            return false;
+        }
+
+        const PipelineMeasurement *winner = pickBest(0, true);
+        if (!winner)
+        {
+            winner = pickBest(0, false);
+            if (!winner)
+            {
+                Logger::error("Auto-tune: no configuration could be measured");
+                return false;
+            }
+            Logger::warning("Auto-tune: no configuration sustains " + std::to_string(options.targetFps) +
+                            " FPS; using the fastest one");
+        }
+
+        best = winner->candidate;
+        m_capture->setCaptureMethod(best.captureMethod);
+        m_progress.store(1.0f);
+
+        std::ostringstream fps;
+        fps << std::fixed << std::setprecision(1) << winner->fps;
+        Logger::info("Auto-tune selected: " + best.describe() + " (" + fps.str() + " FPS)");
+        return true;
+    }
+
+    bool AutoTuner::measure(const PipelineCandidate &candidate, const Options &options, PipelineMeasurement &result)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        if (!m_capture->setCaptureMethod(candidate.captureMethod))
+        {
+            return false;
+        }
+
+        int outputWidth = options.outputWidth > 0 ? options.outputWidth : m_capture->getWidth();
+        int outputHeight = options.outputHeight > 0 ? options.outputHeight : m_capture->getHeight();
+        bool scaling = outputWidth != m_capture->getWidth() || outputHeight != m_capture->getHeight();
+
+        std::string tempPath = (std::filesystem::temp_directory_path() / "nanorec_autotune.mp4").string();
+
+        VideoConfig config(outputWidth, outputHeight, options.targetFps, tempPath);
+        config.preset = candidate.preset;
+        config.pixelFormat = candidate.pixelFormat;
+
+        FFmpegVideoWriter writer;
+        if (!writer.initialize(config))
+        {
+            return false;
+        }
+
+        FrameBuffer captured;
+        FrameBuffer scaled;
+
+        // Warm-up lets ffmpeg start and fill the pipe before timing starts
+        const double warmupSeconds = 0.25;
+        auto start = Clock::now();
+        auto measureStart = start;
+        bool measuring = false;
+        int frames = 0;
+        double captureSeconds = 0.0;
+        double scaleSeconds = 0.0;
+
+        while (!m_cancelled.load())
+        {
+            auto now = Clock::now();
+            double elapsed = std::chrono::duration<double>(now - start).count();
+            if (!measuring && elapsed >= warmupSeconds)
+            {
+                measuring = true;
+                measureStart = now;
+                frames = 0;
+                captureSeconds = 0.0;
+                scaleSeconds = 0.0;
+            }
+            if (elapsed >= warmupSeconds + options.secondsPerCandidate)
+            {
+                break;
+            }
+
+            auto t0 = Clock::now();
+            if (!m_capture->captureFrame(captured))
+            {
+                break;
+            }
+            auto t1 = Clock::now();
+
+            const FrameBuffer *frame = &captured;
+            if (scaling && FrameScaler::scaleFrame(captured, scaled, outputWidth, outputHeight, candidate.scalerThreads))
+            {
+                frame = &scaled;
+            }
+            auto t2 = Clock::now();
+
+            if (!writer.writeFrame(frame->data, frame->size))
+            {
+                break;
+            }
+
+            frames++;
+            captureSeconds += std::chrono::duration<double>(t1 - t0).count();
+            scaleSeconds += std::chrono::duration<double>(t2 - t1).count();
+        }
+
+        double measuredSeconds = std::chrono::duration<double>(Clock::now() - measureStart).count();
+        writer.finalize();
+
+        std::error_code ec;
+        std::filesystem::remove(tempPath, ec);
+
+        if (!measuring || frames == 0 || measuredSeconds <= 0.0)
+        {
+            return false;
+        }
+
+        result.candidate = candidate;
+        result.fps = frames / measuredSeconds;
+        result.captureMs = captureSeconds * 1000.0 / frames;
+        result.scaleMs = scaleSeconds * 1000.0 / frames;
+        result.sustained = result.fps >= options.targetFps * options.headroom;
+
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(1) << "Auto-tune: " << candidate.describe() << ": " << result.fps
+             << " FPS (capture " << result.captureMs << " ms, scale " << result.scaleMs << " ms)"
+             << (result.sustained ? "" : " - below target");
+        Logger::info(line.str());
+        return true;
+    }
+
+} // namespace NanoRec
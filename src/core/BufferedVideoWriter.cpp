@@ -0,0 +1,320 @@
+/**
+ * @file BufferedVideoWriter.cpp
+ * @brief Bounded frame queue that keeps a slow encoder off the capture thread
+ * @author NanoRec-CPP Team
+ * @date 2026-10-18
+ */
+
+#include "core/BufferedVideoWriter.hpp"
+#include "core/Logger.hpp"
+#include <algorithm>
+#include <filesystem>
+
+namespace NanoRec
+{
+
+    BufferedVideoWriter::BufferedVideoWriter(std::unique_ptr<IVideoWriter> encoder, const Options &options)
+        : m_encoder(std::move(encoder)), m_options(options)
+    {
+        m_options.maxQueuedFrames = std::max(1, m_options.maxQueuedFrames);
+    }
+
+    BufferedVideoWriter::~BufferedVideoWriter()
+    {
+        // Not finalized: abandon the backlog instead of feeding it to the encoder
+        if (m_worker.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_queue.clear();
+                m_spillRead = m_spillWritten;
+                m_spillPts.clear();
+                m_finishing = true;
+            }
+            m_changed.notify_all();
+            m_worker.join();
+        }
+        m_spillOut.close();
+        m_spillIn.close();
+        if (!m_spillPath.empty())
+        {
+            std::error_code ec;
+            std::filesystem::remove(m_spillPath, ec);
+        }
+    }
+
+    bool BufferedVideoWriter::initialize(const VideoConfig &config)
+    {
+        if (m_active || !m_encoder || !m_encoder->initialize(config))
+        {
+            return false;
+        }
+
+        m_config = config;
+        m_spillPath = config.output + ".spill";
+        m_queue.clear();
+        m_finishing = false;
+        m_endPts = -1;
+        m_spilling = false;
+        m_spillWritten = 0;
+        m_spillRead = 0;
+        m_spillPts.clear();
+        m_stats = WriterQueueStats();
+        m_stats.capacityFrames = m_options.maxQueuedFrames;
+        m_active = true;
+        m_worker = std::thread(&BufferedVideoWriter::workerLoop, this);
+        return true;
+    }
+
+    bool BufferedVideoWriter::writeFrame(const uint8_t *frameData, size_t dataSize)
+    {
+        return enqueue(frameData, dataSize, -1);
+    }
+
+    bool BufferedVideoWriter::writeFrameAt(const uint8_t *frameData, size_t dataSize, int64_t pts)
+    {
+        return enqueue(frameData, dataSize, pts);
+    }
+
+    void BufferedVideoWriter::setEndTime(int64_t pts)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_endPts = pts;
+    }
+
+    bool BufferedVideoWriter::enqueue(const uint8_t *frameData, size_t dataSize, int64_t pts)
+    {
+        QueuedFrame frame;
+        frame.pts = pts;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_active || m_finishing || m_stats.encoderLost || frameData == nullptr)
+            {
+                m_stats.dropped++;
+                return false;
+            }
+
+            // Once frames wait on disk, later ones follow them there to keep the order
+            if (m_spilling || static_cast<int>(m_queue.size()) >= m_options.maxQueuedFrames)
+            {
+                if (m_options.spill && spillFrame(frameData, dataSize, pts))
+                {
+                    m_changed.notify_all();
+                    return true;
+                }
+                m_stats.dropped++;
+                return false;
+            }
+
+            if (!m_pool.empty())
+            {
+                frame.data = std::move(m_pool.back());
+                m_pool.pop_back();
+            }
+        }
+
+        // Only this thread adds frames, so the slot checked above is still free
+        frame.data.assign(frameData, frameData + dataSize);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.push_back(std::move(frame));
+            m_stats.peakFrames = std::max(m_stats.peakFrames, static_cast<int>(m_queue.size()));
+        }
+        m_changed.notify_all();
+        return true;
+    }
+
+    bool BufferedVideoWriter::spillFrame(const uint8_t *frameData, size_t dataSize, int64_t pts)
+    {
+        if (!m_spilling)
+        {
+            // The previous backlog was fully replayed, so the file can start over
+            m_spillOut.close();
+            m_spillOut.clear();
+            m_spillOut.open(m_spillPath, std::ios::binary | std::ios::trunc);
+            if (!m_spillOut)
+            {
+                Logger::warning("Cannot create encoder spill file " + m_spillPath + ", dropping frames instead");
+                m_options.spill = false;
+                return false;
+            }
+            m_spillWritten = 0;
+            m_spillRead = 0;
+            m_spillFrameSize = dataSize;
+            m_spilling = true;
+        }
+
+        uint64_t backlog = (m_spillWritten - m_spillRead + 1) * m_spillFrameSize;
+        if (dataSize != m_spillFrameSize || backlog > m_options.maxSpillBytes)
+        {
+            return false;
+        }
+
+        m_spillOut.write(reinterpret_cast<const char *>(frameData), static_cast<std::streamsize>(dataSize));
+        m_spillOut.flush();
+        if (!m_spillOut)
+        {
+            Logger::warning("Encoder spill file " + m_spillPath + " is full, dropping frames instead");
+            m_options.spill = false;
+            return false;
+        }
+
+        m_spillWritten++;
+        m_spillPts.push_back(pts);
+        m_stats.spilledFrames++;
+        m_stats.peakSpillBytes = std::max<uint64_t>(m_stats.peakSpillBytes, backlog);
+        return true;
+    }
+
+    void BufferedVideoWriter::workerLoop()
+    {
+        QueuedFrame frame;
+        for (;;)
+        {
+            bool fromSpill = false;
+            uint64_t spillIndex = 0;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_changed.wait(lock, [this]
+                               { return !m_queue.empty() || m_spillRead < m_spillWritten || m_finishing; });
+
+                // Memory frames are always older than spilled ones
+                if (!m_queue.empty())
+                {
+                    frame = std::move(m_queue.front());
+                    m_queue.pop_front();
+                }
+                else if (m_spillRead < m_spillWritten)
+                {
+                    fromSpill = true;
+                    spillIndex = m_spillRead;
+                    frame.data.resize(m_spillFrameSize);
+                    frame.pts = m_spillPts.front();
+                }
+                else
+                {
+                    return;
+                }
+            }
+
+            bool ok = true;
+            if (fromSpill)
+            {
+                // Reopened per backlog: the file is truncated and rewritten between backlogs
+                if (!m_spillIn.is_open())
+                {
+                    m_spillIn.open(m_spillPath, std::ios::binary);
+                }
+                m_spillIn.clear();
+                m_spillIn.seekg(static_cast<std::streamoff>(spillIndex * frame.data.size()));
+                m_spillIn.read(reinterpret_cast<char *>(frame.data.data()),
+                               static_cast<std::streamsize>(frame.data.size()));
+                ok = m_spillIn.gcount() == static_cast<std::streamsize>(frame.data.size());
+            }
+            if (ok)
+            {
+                ok = frame.pts >= 0 ? m_encoder->writeFrameAt(frame.data.data(), frame.data.size(), frame.pts)
+                                    : m_encoder->writeFrame(frame.data.data(), frame.data.size());
+            }
+            bool lost = !ok && !m_encoder->isActive();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (fromSpill && !m_spillPts.empty()) // Emptied by the destructor abandoning the backlog
+            {
+                m_spillPts.pop_front();
+            }
+            if (fromSpill && ++m_spillRead == m_spillWritten)
+            {
+                m_spilling = false;
+                m_spillIn.close();
+            }
+            if (!ok)
+            {
+                m_stats.writeFailures++;
+            }
+            if (lost && !m_stats.encoderLost)
+            {
+                // Nothing will take the backlog any more
+                uint64_t backlog = m_queue.size() + (m_spillWritten - m_spillRead);
+                m_stats.encoderLost = true;
+                m_stats.dropped += backlog;
+                m_queue.clear();
+                m_spillRead = m_spillWritten;
+                m_spillPts.clear();
+                m_spilling = false;
+                m_spillIn.close();
+                Logger::error("Encoder lost: " + m_config.output + " (" + std::to_string(backlog) +
+                              " queued frames discarded)");
+            }
+            if (static_cast<int>(m_pool.size()) < m_options.maxQueuedFrames)
+            {
+                m_pool.push_back(std::move(frame.data));
+            }
+            frame.data.clear();
+        }
+    }
+
+    bool BufferedVideoWriter::finalize()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_active)
+            {
+                return true;
+            }
+            m_finishing = true;
+        }
+        m_changed.notify_all();
+        if (m_worker.joinable())
+        {
+            m_worker.join();
+        }
+
+        // The worker is gone, so the encoder is ours again
+        if (m_endPts >= 0)
+        {
+            m_encoder->setEndTime(m_endPts);
+        }
+        bool ok = m_encoder->finalize();
+        m_spillOut.close();
+        m_spillIn.close();
+        std::error_code ec;
+        std::filesystem::remove(m_spillPath, ec);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_active = false;
+        if (m_stats.dropped > 0 || m_stats.spilledFrames > 0 || m_stats.writeFailures > 0)
+        {
+            Logger::warning("Encoder queue for " + m_config.output + ": peak " + std::to_string(m_stats.peakFrames) +
+                            "/" + std::to_string(m_stats.capacityFrames) + " frames, " +
+                            std::to_string(m_stats.dropped) + " dropped, " + std::to_string(m_stats.spilledFrames) +
+                            " spilled (peak " + std::to_string(m_stats.peakSpillBytes >> 20) + " MB), " +
+                            std::to_string(m_stats.writeFailures) + " rejected by the encoder");
+        }
+        return ok && !m_stats.encoderLost;
+    }
+
+    bool BufferedVideoWriter::isActive() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_active && !m_stats.encoderLost;
+    }
+
+    bool BufferedVideoWriter::getQueueStats(WriterQueueStats &stats) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        stats = m_stats;
+        return true;
+    }
+
+    bool BufferedVideoWriter::getWorkerThread(std::thread::native_handle_type &thread)
+    {
+        if (!m_worker.joinable())
+        {
+            return false;
+        }
+        thread = m_worker.native_handle();
+        return true;
+    }
+
+} // namespace NanoRec
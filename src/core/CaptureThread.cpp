@@ -1,15 +1,66 @@
 #include "core/CaptureThread.hpp"
+#include "core/BufferedVideoWriter.hpp"
 #include "core/Logger.hpp"
-#include "core/FrameScaler.hpp"
+#include "core/WorkerPool.hpp"
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <filesystem>
 #include <iomanip>
 #include <sstream>
 
 namespace NanoRec
 {
 
+    // Adaptive rate: full rate for this long after the last input or motion, then the interval stretches
+    static constexpr auto ACTIVE_HOLD = std::chrono::milliseconds(1500);
+    static constexpr double IDLE_DECAY = 1.5; ///< Interval growth per quiet frame
+    // Changed area that counts as motion; a blinking caret or a tray clock stays below it
+    static constexpr double MOTION_FRACTION = 0.005;
+
+    // Segment 1 keeps the requested name; later ones become <stem>_partN<ext>
+    static std::string segmentPath(const std::string &filename, size_t index)
+    {
+        if (index <= 1)
+        {
+            return filename;
+        }
+
+        std::filesystem::path path(filename);
+        return (path.parent_path() / path.stem()).string() + "_part" + std::to_string(index) +
+               path.extension().string();
+    }
+
+    // Desktop position of the captured area, for mapping redacted window rectangles
+    static void captureOrigin(IScreenCapture *capture, int &originX, int &originY)
+    {
+        originX = 0;
+        originY = 0;
+        int monitorIndex = capture->getCurrentMonitor();
+        if (monitorIndex >= 0)
+        {
+            std::vector<MonitorInfo> monitors = capture->enumerateMonitors();
+            if (monitorIndex < static_cast<int>(monitors.size()))
+            {
+                originX = monitors[monitorIndex].x;
+                originY = monitors[monitorIndex].y;
+            }
+        }
+    }
+
+    static bool sameEncoderConfig(const VideoConfig &a, const VideoConfig &b)
+    {
+        return a.width == b.width && a.height == b.height && a.fps == b.fps && a.preset == b.preset &&
+               a.pixelFormat == b.pixelFormat && a.inputPixelFormat == b.inputPixelFormat && a.timestamps == b.timestamps;
+    }
+
     CaptureThread::CaptureThread()
     {
+        // Default graph until the capture loop adopts the published settings
+        std::string error;
+        m_pipeline.build(FramePipeline::DEFAULT_SPEC, false, error);
+        m_pipelineContext.changeMap = &m_changeMap;
+        m_pipelineContext.encoderSink = [this](const PipelineFrame &frame) { writeEncoderFrame(frame); };
     }
 
     CaptureThread::~CaptureThread()
@@ -53,11 +104,8 @@ namespace NanoRec
         Logger::info("Stopping capture thread...");
         m_shouldStop.store(true);
 
-        // Stop recording if active
-        if (m_recording.load())
-        {
-            stopRecording();
-        }
+        // Stop recording if active (also waits for segments still finalizing)
+        stopRecording();
 
         // Wait for thread to finish
         if (m_thread.joinable())
@@ -65,6 +113,9 @@ namespace NanoRec
             m_thread.join();
         }
 
+        // No more frames: pending waits would only run into their timeouts
+        m_changeWaiter.cancel();
+
         m_running.store(false);
         Logger::info("Capture thread stopped");
     }
@@ -84,66 +135,393 @@ namespace NanoRec
             return false;
         }
 
+        // Publish rate and size so the capture loop paces frames to match the writer
+        CaptureSettings settings = getSettings();
+        settings.fps = fps;
+        settings.targetWidth = targetWidth;
+        settings.targetHeight = targetHeight;
+        applySettings(settings);
+
+        std::lock_guard<std::mutex> lock(m_recordingMutex);
         m_recordingFilename = filename;
-        m_recordingFPS = fps;
+        m_segments.clear();
+        m_encoderRestarts = 0;
+        if (!openSegment(*getSettingsSnapshot()))
+        {
+            return false;
+        }
 
-        // Get capture dimensions
-        int captureWidth = m_screenCapture->getWidth();
-        int captureHeight = m_screenCapture->getHeight();
+        m_recording.store(true);
+        return true;
+    }
 
-        // Determine recording dimensions
-        if (targetWidth == 0 || targetHeight == 0)
+    bool CaptureThread::setEncoderSettings(const std::string &preset, const std::string &pixelFormat,
+                                           int scalerThreads)
+    {
+        CaptureSettings settings = getSettings();
+        settings.preset = preset;
+        settings.pixelFormat = pixelFormat;
+        settings.scalerThreads = scalerThreads;
+        applySettings(settings);
+        return true;
+    }
+
+    void CaptureThread::applySettings(const CaptureSettings &settings)
+    {
+        auto snapshot = std::make_shared<CaptureSettings>(settings);
+        snapshot->fps = std::max(1, snapshot->fps);
+        snapshot->scalerThreads = std::max(1, snapshot->scalerThreads);
+        snapshot->previewFps = std::max(0, snapshot->previewFps);
+        snapshot->stripeRows = std::max(0, snapshot->stripeRows);
+        snapshot->idleFps = std::max(1, snapshot->idleFps);
+
+        std::lock_guard<std::mutex> lock(m_settingsMutex);
+        m_publishedSettings = std::move(snapshot);
+        m_settingsVersion.fetch_add(1);
+    }
+
+    CaptureSettings CaptureThread::getSettings() const
+    {
+        return *getSettingsSnapshot();
+    }
+
+    std::shared_ptr<const CaptureSettings> CaptureThread::getSettingsSnapshot() const
+    {
+        std::lock_guard<std::mutex> lock(m_settingsMutex);
+        return m_publishedSettings;
+    }
+
+    std::vector<std::string> CaptureThread::getSegments() const
+    {
+        std::lock_guard<std::mutex> lock(m_recordingMutex);
+        return m_segments;
+    }
+
+    void CaptureThread::stopRecording()
+    {
+        std::vector<std::future<void>> retired;
+        std::unique_ptr<IVideoWriter> writer;
+        RecordingStats stats;
+        std::string statsPath;
+        std::string stoppedMessage;
         {
-            // Use native resolution
-            m_recordingWidth = captureWidth;
-            m_recordingHeight = captureHeight;
-            m_useScaling = false;
+            std::lock_guard<std::mutex> lock(m_recordingMutex);
+            retired.swap(m_retiredWriters);
+            if (!m_recording.load() && retired.empty())
+            {
+                return;
+            }
+
+            m_recording.store(false);
+            if (m_videoWriter)
+            {
+                endSegmentClock();
+            }
+            m_activityWriter.close();
+
+            // Finalizing waits for ffmpeg; like retireWriter, take the writer and finish it unlocked
+            if (m_videoWriter)
+            {
+                m_segmentStats.end();
+                writer = std::move(m_videoWriter);
+                stats = m_segmentStats;
+                statsPath = RecordingStats::sidecarPath(m_segmentConfig.output);
+                stoppedMessage = "Recording stopped: " + m_recordingFilename +
+                                 (m_segments.size() > 1 ? " (" + std::to_string(m_segments.size()) + " segments)" : "");
+            }
         }
-        else
+
+        if (writer)
+        {
+            writer->finalize();
+            stats.write(statsPath, *writer);
+            writer.reset();
+            Logger::info(stoppedMessage);
+        }
+
+        // Earlier segments may still be flushing
+        for (std::future<void> &writer : retired)
         {
-            // Use target resolution with scaling
-            m_recordingWidth = targetWidth;
-            m_recordingHeight = targetHeight;
-            m_useScaling = (targetWidth != captureWidth || targetHeight != captureHeight);
+            writer.wait();
+        }
+    }
+
+    void CaptureThread::setVideoWriterFactory(VideoWriterFactory factory)
+    {
+        std::lock_guard<std::mutex> lock(m_recordingMutex);
+        m_videoWriterFactory = std::move(factory);
+    }
+
+    VideoConfig CaptureThread::segmentConfig(const CaptureSettings &settings, const std::string &filename) const
+    {
+        // Target 0x0 records at the capture resolution
+        int width = settings.targetWidth;
+        int height = settings.targetHeight;
+        if (width == 0 || height == 0)
+        {
+            width = m_screenCapture->getWidth();
+            height = m_screenCapture->getHeight();
         }
 
-        // Create video writer
-        m_videoWriter = std::make_unique<FFmpegVideoWriter>();
+        VideoConfig config(width, height, settings.fps, filename);
+        config.preset = settings.preset;
+        config.pixelFormat = settings.pixelFormat;
 
-        VideoConfig config(m_recordingWidth, m_recordingHeight, fps, filename);
-        if (!m_videoWriter->initialize(config))
+        // Adaptive rate skips slots while idle; frame times let the previous frame cover them
+        config.timestamps = settings.adaptiveRate;
+
+        // 4:2:0 formats are converted by the pipeline so the preview can show the encoder's frames as-is
+        YuvFrame::Layout layout;
+        if (YuvFrame::layoutFromPixelFormat(config.pixelFormat, layout) && m_pipeline.convertsForEncoder())
+        {
+            config.inputPixelFormat = config.pixelFormat;
+        }
+        return config;
+    }
+
+    bool CaptureThread::openSegment(const CaptureSettings &settings)
+    {
+        std::string filename = segmentPath(m_recordingFilename, m_segments.size() + 1);
+        VideoConfig config = segmentConfig(settings, filename);
+
+        // Get capture dimensions
+        int captureWidth = m_screenCapture->getWidth();
+        int captureHeight = m_screenCapture->getHeight();
+        m_recordingWidth = config.width;
+        m_recordingHeight = config.height;
+        m_yuvInput = YuvFrame::layoutFromPixelFormat(config.inputPixelFormat, m_yuvLayout);
+
+        // Create video writer; with a queue, encoder stalls cost dropped (or spilled) frames instead of capture time
+        m_videoWriter = m_videoWriterFactory ? m_videoWriterFactory() : std::make_unique<FFmpegVideoWriter>();
+        if (m_videoWriter && settings.encoderQueueFrames > 0)
+        {
+            BufferedVideoWriter::Options queueOptions;
+            queueOptions.maxQueuedFrames = settings.encoderQueueFrames;
+            queueOptions.spill = settings.encoderSpill;
+            queueOptions.maxSpillBytes = static_cast<uint64_t>(std::max(1, settings.encoderSpillMb)) << 20;
+            m_videoWriter = std::make_unique<BufferedVideoWriter>(std::move(m_videoWriter), queueOptions);
+        }
+        if (!m_videoWriter || !m_videoWriter->initialize(config))
         {
             Logger::error("Failed to initialize video writer");
             m_videoWriter.reset();
             return false;
         }
 
-        m_recording.store(true);
-        
-        std::string scalingInfo = m_useScaling ? 
+        // Activity sidecar is best effort; recording goes ahead without it
+        m_activityWriter.open(ActivityIndex::sidecarPath(filename), captureWidth, captureHeight, config.fps);
+
+        m_segments.push_back(filename);
+        m_segmentConfig = config;
+        m_segmentStart = std::chrono::steady_clock::now();
+        m_segmentFrames = 0;
+        m_segmentStats.begin(config, m_thread, *m_videoWriter, WorkerPool::shared());
+
+        bool scaled = config.width != captureWidth || config.height != captureHeight;
+        std::string scalingInfo = scaled ? 
             " (scaled from " + std::to_string(captureWidth) + "x" + std::to_string(captureHeight) + ")" : "";
         
         Logger::info("Recording started: " + filename + " (" + 
                     std::to_string(m_recordingWidth) + "x" + std::to_string(m_recordingHeight) + 
-                    " @ " + std::to_string(fps) + " FPS)" + scalingInfo);
+                    " @ " + std::to_string(config.fps) + " FPS)" + scalingInfo);
         return true;
     }
 
-    void CaptureThread::stopRecording()
+    void CaptureThread::retireWriter()
     {
-        if (!m_recording.load())
+        m_activityWriter.close();
+
+        // Drop segments that finished flushing
+        m_retiredWriters.erase(std::remove_if(m_retiredWriters.begin(), m_retiredWriters.end(),
+                                              [](const std::future<void> &writer)
+                                              { return writer.wait_for(std::chrono::seconds(0)) ==
+                                                       std::future_status::ready; }),
+                               m_retiredWriters.end());
+
+        // ffmpeg drains its queue and writes the trailer off the capture thread; its rusage follows
+        if (m_videoWriter)
         {
-            return;
+            m_segmentStats.end();
+            m_retiredWriters.push_back(std::async(std::launch::async,
+                                                  [writer = std::move(m_videoWriter), stats = m_segmentStats,
+                                                   path = RecordingStats::sidecarPath(m_segmentConfig.output)]()
+                                                  {
+                                                      writer->finalize();
+                                                      stats.write(path, *writer);
+                                                  }));
         }
+    }
 
+    void CaptureThread::recoverEncoder()
+    {
+        // The dead writer is finalized in the background like any finished segment
+        Logger::error("Encoder stopped unexpectedly: " + m_segmentConfig.output);
+        retireWriter();
+        if (m_encoderRestarts < m_settings->encoderRestarts)
+        {
+            m_encoderRestarts++;
+            Logger::warning("Restarting encoder (" + std::to_string(m_encoderRestarts) + "/" +
+                            std::to_string(m_settings->encoderRestarts) + "), continuing in a new segment");
+            if (openSegment(*m_settings))
+            {
+                return;
+            }
+        }
+        Logger::error("Recording stopped: encoder unavailable");
         m_recording.store(false);
+    }
 
-        if (m_videoWriter)
+    bool CaptureThread::advanceSegmentClock(const CaptureSettings &settings)
+    {
+        // At a fixed rate every captured frame is the next video frame
+        auto now = std::chrono::steady_clock::now();
+        m_segmentStats.countCaptured();
+        if (!settings.adaptiveRate || m_segmentFrames == 0)
         {
-            m_videoWriter->finalize();
-            m_videoWriter.reset();
-            Logger::info("Recording stopped: " + m_recordingFilename);
+            if (m_segmentFrames == 0)
+            {
+                m_segmentStart = now;
+            }
+            return true;
+        }
+
+        double elapsed = std::chrono::duration<double>(now - m_segmentStart).count();
+        int64_t slot = static_cast<int64_t>(elapsed * m_segmentConfig.fps);
+        if (slot < m_segmentFrames)
+        {
+            m_segmentStats.countDropped();
+            return false; // Slot already written (e.g. input woke the loop early)
+        }
+
+        skipSlots(slot - m_segmentFrames);
+        return true;
+    }
+
+    void CaptureThread::rebuildPipeline(const CaptureSettings &settings)
+    {
+        bool stripes = settings.stripeRows > 0;
+        if (m_pipeline.getSpec() == settings.pipeline && m_pipeline.isFused() == stripes)
+        {
+            return;
+        }
+
+        std::string error;
+        if (m_pipeline.build(settings.pipeline, stripes, error))
+        {
+            Logger::info("Pipeline: " + settings.pipeline + (stripes ? " (stripe mode)" : ""));
+            return;
+        }
+
+        // Keep the running graph; stripe mode still follows the setting
+        Logger::error("Invalid pipeline \"" + settings.pipeline + "\": " + error + ", keeping \"" +
+                      m_pipeline.getSpec() + "\"");
+        if (m_pipeline.isFused() != stripes)
+        {
+            std::string spec = m_pipeline.getSpec();
+            m_pipeline.build(spec, stripes, error);
+        }
+    }
+
+    void CaptureThread::writeEncoderFrame(const PipelineFrame &frame)
+    {
+        // The segment was opened for the other kind (a rebuilt graph rolls over at its adoption)
+        if ((frame.kind == FrameKind::Yuv) != m_yuvInput)
+        {
+            return;
+        }
+
+        if (frame.kind == FrameKind::Yuv)
+        {
+            writeSegmentFrame(frame.yuv->data.data(), frame.yuv->data.size());
+        }
+        else
+        {
+            writeSegmentFrame(frame.rgb->data, frame.rgb->size);
+        }
+    }
+
+    void CaptureThread::writeSegmentFrame(const uint8_t *data, size_t size)
+    {
+        auto writeStart = std::chrono::steady_clock::now();
+        bool written = m_segmentConfig.timestamps ? m_videoWriter->writeFrameAt(data, size, m_segmentFrames)
+                                                  : m_videoWriter->writeFrame(data, size);
+        if (written)
+        {
+            m_segmentStats.countEncoded();
+        }
+        else
+        {
+            m_segmentStats.countDropped();
+        }
+        m_segmentFrames++;
+
+        double writeUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - writeStart).count();
+        m_segmentStats.addStage(RecordingStats::Stage::Write, writeUs);
+        m_frameWriteUs += writeUs;
+    }
+
+    void CaptureThread::skipSlots(int64_t count)
+    {
+        if (count <= 0)
+        {
+            return;
+        }
+
+        // Nothing is sent: the next frame's time tells the encoder how long the last one stays on screen
+        m_segmentFrames += count;
+        m_activityWriter.addRepeatedFrames(count);
+        m_segmentStats.countHeld(count);
+    }
+
+    void CaptureThread::endSegmentClock()
+    {
+        if (!m_segmentConfig.timestamps || m_segmentFrames == 0)
+        {
+            return;
         }
+
+        // The last captured frame lasts until the file is closed
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_segmentStart).count();
+        skipSlots(std::llround(elapsed * m_segmentConfig.fps) - m_segmentFrames);
+        m_videoWriter->setEndTime(m_segmentFrames);
+    }
+
+    bool CaptureThread::adoptSettings()
+    {
+        std::shared_ptr<const CaptureSettings> next;
+        {
+            std::lock_guard<std::mutex> lock(m_settingsMutex);
+            next = m_publishedSettings;
+            m_adoptedVersion = m_settingsVersion.load();
+        }
+
+        bool monitorChanged = false;
+        if (next->monitor != CaptureSettings::CURRENT_MONITOR && next->monitor != m_screenCapture->getCurrentMonitor())
+        {
+            monitorChanged = m_screenCapture->selectMonitor(next->monitor);
+        }
+        m_settings = std::move(next);
+
+        // Before comparing encoder configs: the graph decides whether the encoder gets YUV
+        rebuildPipeline(*m_settings);
+
+        // Only a different encoded stream needs a new file; everything else applies in place
+        if (m_recording.load() && m_videoWriter)
+        {
+            VideoConfig config = segmentConfig(*m_settings, m_segmentConfig.output);
+            if (!sameEncoderConfig(config, m_segmentConfig))
+            {
+                Logger::info("Recording parameters changed, starting a new segment");
+                endSegmentClock();
+                retireWriter();
+                if (!openSegment(*m_settings))
+                {
+                    Logger::error("Failed to open next segment, recording stopped");
+                    m_recording.store(false);
+                }
+            }
+        }
+        return monitorChanged;
     }
 
     void CaptureThread::captureLoop()
@@ -152,40 +530,242 @@ namespace NanoRec
 
         FrameBuffer captureBuffer;
         captureBuffer.allocate(m_screenCapture->getWidth(), m_screenCapture->getHeight());
-        
-        FrameBuffer scaledBuffer;  // For scaled recording
+        m_pipelineContext.preview = m_frameBuffer;
+
+        // Settings published before the thread started (e.g. a monitor) apply immediately
+        m_adoptedVersion = 0;
+
+        int originX = 0;
+        int originY = 0;
+        captureOrigin(m_screenCapture, originX, originY);
 
         auto lastFrameTime = std::chrono::high_resolution_clock::now();
         int frameCount = 0;
         auto fpsUpdateTime = lastFrameTime;
+        auto lastPreviewPush = lastFrameTime - std::chrono::hours(1);
+
+        // Pointer sampled at most every 100 ms for the activity index
+        auto lastPointerSample = lastFrameTime;
+        int pointerX = 0;
+        int pointerY = 0;
+        unsigned int pointerButtons = 0;
+        bool havePointer = false;
+
+        // Adaptive rate: capture interval, stretched toward 1/idleFps while input and motion are quiet
+        bool listening = false;
+        double captureIntervalMs = 0.0;
+        auto lastActivity = std::chrono::steady_clock::now();
+        bool pendingInput = false;
+        int idlePointerX = 0;
+        int idlePointerY = 0;
+        unsigned int idlePointerButtons = 0;
+        bool haveIdlePointer = false;
+        auto inputSeen = [&]()
+        {
+            int events = m_screenCapture->pollInputEvents();
+            if (events >= 0)
+            {
+                return events > 0;
+            }
+
+            // No event source: compare pointer samples (keyboard-only input is left to change detection)
+            int x = 0;
+            int y = 0;
+            unsigned int buttons = 0;
+            if (!m_screenCapture->queryPointer(x, y, buttons))
+            {
+                return false;
+            }
+            bool moved = haveIdlePointer && (x != idlePointerX || y != idlePointerY || buttons != idlePointerButtons);
+            idlePointerX = x;
+            idlePointerY = y;
+            idlePointerButtons = buttons;
+            haveIdlePointer = true;
+            return moved;
+        };
+
+        // Damage the source reported since the last change-map update: only those tiles are re-hashed
+        std::vector<Rect> sourceDirty;
+        std::vector<Rect> frameDirty;
+        bool dirtyKnown = false;
 
         while (!m_shouldStop.load())
         {
             auto frameStart = std::chrono::high_resolution_clock::now();
 
+            // Adopt a newer settings snapshot at the frame boundary (no thread restart)
+            if (m_settingsVersion.load() != m_adoptedVersion)
+            {
+                std::lock_guard<std::mutex> lock(m_recordingMutex);
+                if (adoptSettings())
+                {
+                    captureBuffer.free();
+                    captureBuffer.allocate(m_screenCapture->getWidth(), m_screenCapture->getHeight());
+                    captureOrigin(m_screenCapture, originX, originY);
+                }
+            }
+            const CaptureSettings &settings = *m_settings;
+
+            if (settings.adaptiveRate != listening)
+            {
+                listening = settings.adaptiveRate;
+                if (!m_screenCapture->setInputEvents(listening) && listening)
+                {
+                    Logger::info("Adaptive rate: no input events from this source, polling the pointer instead");
+                }
+                captureIntervalMs = 1000.0 / settings.fps;
+                lastActivity = std::chrono::steady_clock::now();
+                m_idle.store(false);
+            }
+
             // Capture frame
+            bool activity = false;
+            bool changeMapUpdated = false;
+            auto captureStart = std::chrono::steady_clock::now();
             if (m_screenCapture->captureFrame(captureBuffer))
             {
-                // Push to frame buffer for preview
-                m_frameBuffer->pushFrame(captureBuffer);
+                auto captureEnd = std::chrono::steady_clock::now();
 
-                // Write to video if recording
-                if (m_recording.load() && m_videoWriter)
+                frameDirty.clear();
+                bool frameDamage = m_screenCapture->getDirtyRects(frameDirty);
+                if (dirtyKnown && frameDamage)
                 {
-                    if (m_useScaling)
+                    sourceDirty.insert(sourceDirty.end(), frameDirty.begin(), frameDirty.end());
+                    if (sourceDirty.size() > 256)
                     {
-                        // Scale frame before encoding
-                        if (FrameScaler::scaleFrame(captureBuffer, scaledBuffer, 
-                                                   m_recordingWidth, m_recordingHeight))
+                        Rect bounds;
+                        for (const Rect &rect : sourceDirty)
                         {
-                            m_videoWriter->writeFrame(scaledBuffer.data, scaledBuffer.size);
+                            bounds = bounds.united(rect);
                         }
+                        sourceDirty.assign(1, bounds);
+                    }
+                }
+                else
+                {
+                    dirtyKnown = false;
+                    sourceDirty.clear();
+                }
+
+                // Demand of this frame: the pipeline runs only the stages feeding a sink that wants it
+                PipelineContext &context = m_pipelineContext;
+                context.redaction = m_redactionFilter.load();
+                context.originX = originX;
+                context.originY = originY;
+                context.overlay = settings.overlayEnabled ? m_overlay.load() : nullptr;
+                context.mjpeg = m_previewServer.load();
+                context.stripeRows = settings.stripeRows;
+                context.maxThreads = settings.scalerThreads;
+                context.frameBudgetUs = 1e6 / settings.fps;
+                context.previewDue = settings.previewFps <= 0 ||
+                                     frameStart - lastPreviewPush >= std::chrono::microseconds(1000000 / settings.previewFps);
+                if (context.previewDue)
+                {
+                    lastPreviewPush = frameStart;
+                }
+
+                // Redaction repaints areas the source never reported
+                context.dirty = dirtyKnown && !context.redaction ? &sourceDirty : nullptr;
+
+                // Encoder demand (held so stopRecording can't finalize mid-frame)
+                std::unique_lock<std::mutex> recordingLock(m_recordingMutex, std::defer_lock);
+                if (m_recording.load())
+                {
+                    recordingLock.lock();
+                }
+                bool encoding =
+                    recordingLock.owns_lock() && m_recording.load() && m_videoWriter && advanceSegmentClock(settings);
+                context.encoderWanted = encoding;
+                context.yuvPreviewWanted = encoding;
+                context.width = encoding ? m_recordingWidth : settings.targetWidth;
+                context.height = encoding ? m_recordingHeight : settings.targetHeight;
+                context.yuvOutput = encoding && m_yuvInput;
+                context.layout = m_yuvLayout;
+
+                // Adaptive rate and change waits read the hashes of the captured content; without damage
+                // from the source, the activity sidecar gets one hashed frame per second
+                context.hashWanted = settings.adaptiveRate || m_changeWaiter.isWatched() ||
+                                     (encoding && !frameDamage && m_activityWriter.wantsChangeSample());
+
+                int64_t framesBefore = m_segmentFrames;
+                m_frameWriteUs = 0.0;
+                m_pipeline.run(captureBuffer, context);
+
+                if (context.hashed)
+                {
+                    sourceDirty.clear();
+                    dirtyKnown = true;
+                    changeMapUpdated = true;
+                }
+
+                // Input keeps the rate up; so does motion nobody typed (video, builds scrolling past)
+                if (settings.adaptiveRate)
+                {
+                    activity = pendingInput || inputSeen() ||
+                               (changeMapUpdated && m_changeMap.getChangedFraction() >= MOTION_FRACTION);
+                    pendingInput = false;
+                }
+
+                if (encoding)
+                {
+                    bool inputSampled = false;
+                    bool inputActive = false;
+                    if (frameStart - lastPointerSample >= std::chrono::milliseconds(100))
+                    {
+                        int x = 0;
+                        int y = 0;
+                        unsigned int buttons = 0;
+                        if (m_screenCapture->queryPointer(x, y, buttons))
+                        {
+                            inputSampled = true;
+                            inputActive = havePointer && (x != pointerX || y != pointerY || buttons != pointerButtons);
+                            pointerX = x;
+                            pointerY = y;
+                            pointerButtons = buttons;
+                            havePointer = true;
+                        }
+                        lastPointerSample = frameStart;
+                    }
+                    // The sidecar uses change data the frame already has, plus its per-second sample
+                    if (context.hashed)
+                    {
+                        m_activityWriter.addFrame(m_changeMap, inputActive, inputSampled);
+                    }
+                    else if (frameDamage)
+                    {
+                        m_activityWriter.addFrame(frameDirty, inputActive, inputSampled);
                     }
                     else
                     {
-                        // Write directly without scaling
-                        m_videoWriter->writeFrame(captureBuffer.data, captureBuffer.size);
+                        m_activityWriter.addFrame(inputActive, inputSampled);
                     }
+
+                    // A stage failed: the frame never reached the encoder
+                    if (m_segmentFrames == framesBefore)
+                    {
+                        m_segmentStats.countDropped();
+                    }
+
+                    auto encodeEnd = std::chrono::steady_clock::now();
+                    m_segmentStats.addStage(RecordingStats::Stage::Capture,
+                                            std::chrono::duration<double, std::micro>(captureEnd - captureStart).count());
+                    m_segmentStats.addStage(RecordingStats::Stage::Encode, m_pipeline.getUpstreamUs("encoder"));
+                    m_segmentStats.addStage(RecordingStats::Stage::Frame,
+                                            std::chrono::duration<double, std::micro>(encodeEnd - captureStart).count());
+
+                    if (!m_videoWriter->isActive())
+                    {
+                        recoverEncoder();
+                    }
+                }
+
+                if (changeMapUpdated)
+                {
+                    m_changeWaiter.publish(m_changeMap, captureEnd);
+                }
+                else
+                {
+                    m_changeWaiter.skipFrame();
                 }
 
                 frameCount++;
@@ -202,18 +782,68 @@ namespace NanoRec
                 fpsUpdateTime = now;
             }
 
+            // Adaptive rate: snap back to full rate on activity, decay once the hold time has passed
+            double captureRate = settings.fps;
+            if (settings.adaptiveRate)
+            {
+                auto steadyNow = std::chrono::steady_clock::now();
+                if (activity)
+                {
+                    lastActivity = steadyNow;
+                    captureIntervalMs = 1000.0 / settings.fps;
+                }
+                else if (steadyNow - lastActivity >= ACTIVE_HOLD)
+                {
+                    captureIntervalMs = std::min(captureIntervalMs * IDLE_DECAY, 1000.0 / settings.idleFps);
+                }
+                bool idle = captureIntervalMs > 1000.0 / settings.fps;
+                captureRate = idle ? 1000.0 / captureIntervalMs : settings.fps;
+                m_idle.store(idle);
+            }
+
             // Target frame time for desired FPS
-            int targetFrameTimeMs = 1000 / m_recordingFPS;
+            int targetFrameTimeMs = static_cast<int>(1000.0 / captureRate);
             auto frameEnd = std::chrono::high_resolution_clock::now();
             auto frameDuration = std::chrono::duration_cast<std::chrono::milliseconds>(frameEnd - frameStart).count();
 
+            // Smoothed budget usage, polled by background jobs that must yield to capture
+            double frameUs = static_cast<double>(
+                std::chrono::duration_cast<std::chrono::microseconds>(frameEnd - frameStart).count());
+            double usage = frameUs * captureRate / 1e6;
+            m_budgetUsage.store(m_budgetUsage.load() * 0.9 + usage * 0.1);
+
             // Sleep if we're ahead of schedule
             if (frameDuration < targetFrameTimeMs)
             {
-                std::this_thread::sleep_for(std::chrono::milliseconds(targetFrameTimeMs - frameDuration));
+                if (!m_idle.load())
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(targetFrameTimeMs - frameDuration));
+                }
+                else
+                {
+                    // Idle: sleep in full-rate slices so input is answered within one frame
+                    auto wake = frameEnd + std::chrono::milliseconds(targetFrameTimeMs - frameDuration);
+                    auto slice = std::chrono::milliseconds(1000 / settings.fps);
+                    while (!m_shouldStop.load() && std::chrono::high_resolution_clock::now() < wake)
+                    {
+                        std::this_thread::sleep_for(std::min<std::chrono::high_resolution_clock::duration>(
+                            slice, wake - std::chrono::high_resolution_clock::now()));
+                        if (inputSeen())
+                        {
+                            pendingInput = true;
+                            break;
+                        }
+                    }
+                }
             }
         }
 
+        if (listening)
+        {
+            m_screenCapture->setInputEvents(false);
+        }
+        m_idle.store(false);
+
         Logger::info("Capture loop ended");
     }
 
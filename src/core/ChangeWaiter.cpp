@@ -0,0 +1,193 @@
+#include "core/ChangeWaiter.hpp"
+#include <algorithm>
+
+namespace NanoRec
+{
+
+    void ChangeWaiter::publish(const TileChangeMap &map, Clock::time_point frameTime)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            // After a gap the map compared against a stale frame: baseline only, no changes
+            bool baseline = !m_tracking.load();
+            size_t tileCount = static_cast<size_t>(map.getTilesX()) * map.getTilesY();
+            if (map.getTilesX() != m_tilesX || map.getTilesY() != m_tilesY)
+            {
+                m_tilesX = map.getTilesX();
+                m_tilesY = map.getTilesY();
+                m_changedFrame.assign(tileCount, 0);
+                m_changedTime.assign(tileCount, frameTime);
+            }
+
+            m_frame++;
+            for (int ty = 0; ty < m_tilesY; ++ty)
+            {
+                for (int tx = 0; tx < m_tilesX; ++tx)
+                {
+                    size_t index = static_cast<size_t>(ty) * m_tilesX + tx;
+                    if (baseline)
+                    {
+                        m_changedTime[index] = frameTime;
+                    }
+                    else if (map.isTileChanged(tx, ty))
+                    {
+                        m_changedFrame[index] = m_frame;
+                        m_changedTime[index] = frameTime;
+                    }
+                }
+            }
+            m_tracking.store(true);
+        }
+        m_published.notify_all();
+    }
+
+    void ChangeWaiter::skipFrame()
+    {
+        if (m_tracking.load(std::memory_order_relaxed))
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tracking.store(false);
+        }
+    }
+
+    void ChangeWaiter::cancel()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_cancelled++;
+            m_tracking.store(false);
+        }
+        m_published.notify_all();
+    }
+
+    uint64_t ChangeWaiter::getFrameNumber() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_frame;
+    }
+
+    Rect ChangeWaiter::tileRange(const Rect &region) const
+    {
+        Rect frame(0, 0, m_tilesX * TileChangeMap::TILE_SIZE, m_tilesY * TileChangeMap::TILE_SIZE);
+        Rect clipped = region.isEmpty() ? frame : region.intersected(frame);
+        if (clipped.isEmpty())
+        {
+            return Rect();
+        }
+
+        int tx0 = clipped.x / TileChangeMap::TILE_SIZE;
+        int ty0 = clipped.y / TileChangeMap::TILE_SIZE;
+        int tx1 = (clipped.right() - 1) / TileChangeMap::TILE_SIZE;
+        int ty1 = (clipped.bottom() - 1) / TileChangeMap::TILE_SIZE;
+        return Rect(tx0, ty0, tx1 - tx0 + 1, ty1 - ty0 + 1);
+    }
+
+    bool ChangeWaiter::isStableLocked(const Rect &region, std::chrono::milliseconds quiet, uint64_t sinceFrame,
+                                      Clock::time_point &quietUntil) const
+    {
+        // The current state is only known once a frame captured after the request arrived
+        quietUntil = Clock::time_point::max();
+        if (m_frame <= sinceFrame || !m_tracking.load())
+        {
+            return false;
+        }
+
+        // A region outside the frame never changes
+        Clock::time_point lastChange = Clock::time_point::min();
+        Rect tiles = tileRange(region);
+        for (int ty = tiles.y; ty < tiles.bottom(); ++ty)
+        {
+            for (int tx = tiles.x; tx < tiles.right(); ++tx)
+            {
+                lastChange = std::max(lastChange, m_changedTime[static_cast<size_t>(ty) * m_tilesX + tx]);
+            }
+        }
+
+        if (lastChange == Clock::time_point::min())
+        {
+            return true;
+        }
+        quietUntil = lastChange + quiet;
+        return Clock::now() >= quietUntil;
+    }
+
+    bool ChangeWaiter::hasChangedLocked(const Rect &region, uint64_t sinceFrame) const
+    {
+        Rect tiles = tileRange(region);
+        for (int ty = tiles.y; ty < tiles.bottom(); ++ty)
+        {
+            for (int tx = tiles.x; tx < tiles.right(); ++tx)
+            {
+                if (m_changedFrame[static_cast<size_t>(ty) * m_tilesX + tx] > sinceFrame)
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    bool ChangeWaiter::isStable(const Rect &region, std::chrono::milliseconds quiet, uint64_t sinceFrame) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Clock::time_point quietUntil;
+        return isStableLocked(region, quiet, sinceFrame, quietUntil);
+    }
+
+    bool ChangeWaiter::hasChanged(const Rect &region, uint64_t sinceFrame) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return hasChangedLocked(region, sinceFrame);
+    }
+
+    bool ChangeWaiter::waitForStable(const Rect &region, int quietMs, int timeoutMs)
+    {
+        watch();
+        auto deadline = Clock::now() + std::chrono::milliseconds(std::max(0, timeoutMs));
+        auto quiet = std::chrono::milliseconds(std::max(0, quietMs));
+        bool stable = false;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            uint64_t sinceFrame = m_frame;
+            uint64_t cancelled = m_cancelled;
+            for (;;)
+            {
+                // Stability can arrive between frames, so also wake when the quiet period would end
+                Clock::time_point quietUntil;
+                stable = isStableLocked(region, quiet, sinceFrame, quietUntil);
+                if (stable || m_cancelled != cancelled || Clock::now() >= deadline)
+                {
+                    break;
+                }
+                m_published.wait_until(lock, std::min(deadline, quietUntil));
+            }
+        }
+        unwatch();
+        return stable;
+    }
+
+    bool ChangeWaiter::waitForChange(const Rect &region, int timeoutMs)
+    {
+        watch();
+        auto deadline = Clock::now() + std::chrono::milliseconds(std::max(0, timeoutMs));
+        bool changed = false;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            uint64_t sinceFrame = m_frame;
+            uint64_t cancelled = m_cancelled;
+            for (;;)
+            {
+                changed = hasChangedLocked(region, sinceFrame);
+                if (changed || m_cancelled != cancelled || Clock::now() >= deadline)
+                {
+                    break;
+                }
+                m_published.wait_until(lock, deadline);
+            }
+        }
+        unwatch();
+        return changed;
+    }
+
+} // namespace NanoRec
@@ -6,6 +6,107 @@
 namespace NanoRec
 {
 
+    // Single list of persisted settings, shared by load() and save()
+    template <typename Video, typename Audio, typename App, typename Visitor>
+    static void visitFields(Video &video, Audio &audio, App &app, Visitor &&visit)
+    {
+        visit("video", "width", video.width);
+        visit("video", "height", video.height);
+        visit("video", "fps", video.fps);
+        visit("video", "bitrate", video.bitrate);
+        visit("video", "codec", video.codec);
+        visit("video", "preset", video.preset);
+        visit("video", "pixel_format", video.pixelFormat);
+        visit("video", "capture_method", video.captureMethod);
+        visit("video", "scaler_threads", video.scalerThreads);
+        visit("video", "replay_file", video.replayFile);
+        visit("video", "replay_timing", video.replayTiming);
+        visit("video", "replay_max_rate", video.replayMaxRate);
+        visit("video", "vnc_server", video.vncServer);
+        visit("video", "stripe_rows", video.stripeRows);
+        visit("video", "pipeline", video.pipeline);
+        visit("video", "adaptive_rate", video.adaptiveRate);
+        visit("video", "idle_fps", video.idleFps);
+        visit("video", "encoder_queue_frames", video.encoderQueueFrames);
+        visit("video", "encoder_spill", video.encoderSpill);
+        visit("video", "encoder_spill_mb", video.encoderSpillMb);
+        visit("video", "encoder_restarts", video.encoderRestarts);
+
+        visit("audio", "sample_rate", audio.sampleRate);
+        visit("audio", "channels", audio.channels);
+        visit("audio", "bitrate", audio.bitrate);
+        visit("audio", "capture_microphone", audio.captureMicrophone);
+        visit("audio", "capture_system", audio.captureSystem);
+
+        visit("app", "show_preview", app.showPreview);
+        visit("app", "minimize_on_record", app.minimizeOnRecord);
+        visit("app", "output_directory", app.outputDirectory);
+        visit("app", "output_format", app.outputFormat);
+        visit("app", "preview_server_enabled", app.previewServerEnabled);
+        visit("app", "preview_server_port", app.previewServerPort);
+        visit("app", "preview_server_fps", app.previewServerFps);
+        visit("app", "archive_transcode_enabled", app.archiveTranscodeEnabled);
+        visit("app", "archive_preset", app.archivePreset);
+        visit("app", "auto_tuned", app.autoTuned);
+        visit("app", "overlay_enabled", app.overlayEnabled);
+        visit("app", "overlay_label", app.overlayLabel);
+        visit("app", "overlay_scale", app.overlayScale);
+        visit("app", "redact_windows", app.redactWindows);
+        visit("app", "redact_mode", app.redactMode);
+        visit("app", "redact_block_size", app.redactBlockSize);
+        visit("app", "encoder_nodes", app.encoderNodes);
+        visit("app", "encoder_max_in_flight", app.encoderMaxInFlight);
+        visit("app", "encoder_simulation", app.encoderSimulation);
+    }
+
+    static std::string trim(const std::string &text)
+    {
+        size_t begin = text.find_first_not_of(" \t\r");
+        if (begin == std::string::npos)
+        {
+            return "";
+        }
+        size_t end = text.find_last_not_of(" \t\r");
+        return text.substr(begin, end - begin + 1);
+    }
+
+    static bool parseValue(const std::string &text, std::string &value)
+    {
+        value = text;
+        return true;
+    }
+
+    static bool parseValue(const std::string &text, bool &value)
+    {
+        if (text == "true" || text == "1" || text == "yes")
+        {
+            value = true;
+            return true;
+        }
+        if (text == "false" || text == "0" || text == "no")
+        {
+            value = false;
+            return true;
+        }
+        return false;
+    }
+
+    static bool parseValue(const std::string &text, uint32_t &value)
+    {
+        std::istringstream ss(text);
+        unsigned long parsed = 0;
+        if (text.empty() || text[0] == '-' || !(ss >> parsed) || !ss.eof() || parsed > UINT32_MAX)
+        {
+            return false;
+        }
+        value = static_cast<uint32_t>(parsed);
+        return true;
+    }
+
+    static std::string formatValue(const std::string &value) { return value; }
+    static std::string formatValue(bool value) { return value ? "true" : "false"; }
+    static std::string formatValue(uint32_t value) { return std::to_string(value); }
+
     Config &Config::getInstance()
     {
         static Config instance;
@@ -26,6 +127,21 @@ namespace NanoRec
         m_videoConfig.bitrate = 5000;
         m_videoConfig.codec = "libx264";
         m_videoConfig.preset = "fast";
+        m_videoConfig.pixelFormat = "yuv420p";
+        m_videoConfig.captureMethod = "default";
+        m_videoConfig.scalerThreads = 1;
+        m_videoConfig.replayFile.clear();
+        m_videoConfig.replayTiming.clear();
+        m_videoConfig.replayMaxRate = false;
+        m_videoConfig.vncServer.clear();
+        m_videoConfig.stripeRows = 0;
+        m_videoConfig.pipeline.clear();
+        m_videoConfig.adaptiveRate = false;
+        m_videoConfig.idleFps = 2;
+        m_videoConfig.encoderQueueFrames = 0;
+        m_videoConfig.encoderSpill = false;
+        m_videoConfig.encoderSpillMb = 256;
+        m_videoConfig.encoderRestarts = 0;
 
         // Audio defaults
         m_audioConfig.sampleRate = 44100;
@@ -39,6 +155,21 @@ namespace NanoRec
         m_appConfig.minimizeOnRecord = false;
         m_appConfig.outputDirectory = "./recordings";
         m_appConfig.outputFormat = "mp4";
+        m_appConfig.previewServerEnabled = false;
+        m_appConfig.previewServerPort = 8090;
+        m_appConfig.previewServerFps = 5;
+        m_appConfig.archiveTranscodeEnabled = false;
+        m_appConfig.archivePreset = "slow";
+        m_appConfig.autoTuned = false;
+        m_appConfig.overlayEnabled = false;
+        m_appConfig.overlayLabel.clear();
+        m_appConfig.overlayScale = 2;
+        m_appConfig.redactWindows.clear();
+        m_appConfig.redactMode = "pixelate";
+        m_appConfig.redactBlockSize = 16;
+        m_appConfig.encoderNodes.clear();
+        m_appConfig.encoderMaxInFlight = 8;
+        m_appConfig.encoderSimulation.clear();
 
         Logger::debug("Configuration reset to defaults");
     }
@@ -53,10 +184,61 @@ namespace NanoRec
             return false;
         }
 
-        // TODO: Implement proper config file parsing (JSON/INI format)
-        // For now, just use defaults
+        std::string section;
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(file, line))
+        {
+            lineNumber++;
+
+            // Only whole lines are comments: values may contain '#' and ';' (labels, pipeline chains)
+            line = trim(line);
+            if (line.empty() || line.front() == '#' || line.front() == ';')
+            {
+                continue;
+            }
+
+            if (line.front() == '[' && line.back() == ']')
+            {
+                section = trim(line.substr(1, line.size() - 2));
+                continue;
+            }
+
+            size_t equals = line.find('=');
+            if (equals == std::string::npos)
+            {
+                Logger::warning(filepath + ":" + std::to_string(lineNumber) + ": expected key = value");
+                continue;
+            }
+
+            std::string key = trim(line.substr(0, equals));
+            std::string value = trim(line.substr(equals + 1));
+
+            bool known = false;
+            bool valid = true;
+            visitFields(m_videoConfig, m_audioConfig, m_appConfig,
+                        [&](const char *fieldSection, const char *fieldKey, auto &field)
+                        {
+                            if (!known && section == fieldSection && key == fieldKey)
+                            {
+                                known = true;
+                                valid = parseValue(value, field);
+                            }
+                        });
+
+            if (!known)
+            {
+                Logger::warning(filepath + ":" + std::to_string(lineNumber) + ": unknown setting [" +
+                                section + "] " + key);
+            }
+            else if (!valid)
+            {
+                Logger::warning(filepath + ":" + std::to_string(lineNumber) + ": invalid value for " + key +
+                                ": " + value);
+            }
+        }
+
         Logger::info("Configuration loaded from: " + filepath);
-        file.close();
         return true;
     }
 
@@ -69,13 +251,28 @@ namespace NanoRec
             return false;
         }
 
-        // TODO: Implement proper config file writing (JSON/INI format)
-        // For now, just create a basic file
         file << "# NanoRec-CPP Configuration File\n";
-        file << "# This is a placeholder - proper config format will be implemented\n";
 
-        Logger::info("Configuration saved to: " + filepath);
+        std::string section;
+        visitFields(m_videoConfig, m_audioConfig, m_appConfig,
+                    [&](const char *fieldSection, const char *fieldKey, const auto &field)
+                    {
+                        if (section != fieldSection)
+                        {
+                            section = fieldSection;
+                            file << "\n[" << section << "]\n";
+                        }
+                        file << fieldKey << " = " << formatValue(field) << "\n";
+                    });
+
         file.close();
+        if (file.fail())
+        {
+            Logger::error("Failed to write config file: " + filepath);
+            return false;
+        }
+
+        Logger::info("Configuration saved to: " + filepath);
         return true;
     }
 
@@ -0,0 +1,440 @@
+#include "core/EncoderNode.hpp"
+#include "core/FFmpegVideoWriter.hpp"
+#include "core/Logger.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace NanoRec
+{
+
+    namespace
+    {
+        constexpr size_t FILE_CHUNK = 1 << 20;
+        constexpr uint32_t MAX_DIMENSION = 16384;
+
+        bool sendError(EncoderLink &link, const std::string &text)
+        {
+            MessageWriter error(EncoderMessage::Error);
+            error.putString(text);
+            return link.send(error);
+        }
+
+        bool sendOpened(EncoderLink &link, bool ok, const std::string &error)
+        {
+            MessageWriter opened(EncoderMessage::Opened);
+            opened.put8(ok ? 1 : 0);
+            opened.putString(error);
+            return link.send(opened);
+        }
+
+        /**
+         * @brief Keep a client-supplied file name inside the work directory
+         */
+        std::string sanitizeName(const std::string &name)
+        {
+            std::string base = std::filesystem::path(name).filename().string();
+            std::string clean;
+            for (char c : base)
+            {
+                bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '.' ||
+                            c == '-' || c == '_';
+                clean += safe ? c : '_';
+            }
+            clean.erase(0, clean.find_first_not_of('.'));
+            return clean.empty() ? "recording.mp4" : clean;
+        }
+    } // namespace
+
+    EncoderNode::EncoderNode(const Options &options) : m_options(options)
+    {
+        m_maxSessions = options.maxSessions > 0
+                            ? options.maxSessions
+                            : std::max(1, static_cast<int>(std::thread::hardware_concurrency()) / 4);
+    }
+
+    EncoderNode::~EncoderNode()
+    {
+        stop();
+    }
+
+    std::string EncoderNode::reserveOutputPath(const std::string &name)
+    {
+        std::lock_guard<std::mutex> lock(m_sessionsMutex);
+        std::filesystem::path path(sanitizeName(name));
+        std::string prefix = "session" + std::to_string(m_nextFileId++) + "-";
+        return (std::filesystem::path(m_options.workDirectory) / (prefix + path.string())).string();
+    }
+
+    void EncoderNode::reapSessions()
+    {
+        std::lock_guard<std::mutex> lock(m_sessionsMutex);
+        for (auto it = m_sessions.begin(); it != m_sessions.end();)
+        {
+            if (it->finished.load())
+            {
+                it->thread.join();
+                it = m_sessions.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+#ifdef _WIN32
+
+    bool EncoderNode::start()
+    {
+        Logger::error("The encoder node is not supported on Windows yet");
+        return false;
+    }
+
+    void EncoderNode::stop() {}
+    void EncoderNode::acceptLoop() {}
+    void EncoderNode::runSession(Session &) {}
+
+#else
+
+    bool EncoderNode::start()
+    {
+        if (m_running)
+        {
+            return true;
+        }
+
+        std::error_code ec;
+        std::filesystem::create_directories(m_options.workDirectory, ec);
+
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE;
+        addrinfo *addresses = nullptr;
+        const char *host = m_options.bindAddress.empty() ? nullptr : m_options.bindAddress.c_str();
+        int error = getaddrinfo(host, std::to_string(m_options.port).c_str(), &hints, &addresses);
+        if (error != 0)
+        {
+            Logger::error("Encoder node: cannot resolve " + m_options.bindAddress + ": " + gai_strerror(error));
+            return false;
+        }
+
+        for (addrinfo *address = addresses; address && m_listenFd == -1; address = address->ai_next)
+        {
+            int fd = socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC, address->ai_protocol);
+            if (fd == -1)
+                continue;
+
+            int reuse = 1;
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+            if (bind(fd, address->ai_addr, address->ai_addrlen) == 0 && listen(fd, 16) == 0)
+            {
+                m_listenFd = fd;
+            }
+            else
+            {
+                error = errno;
+                ::close(fd);
+            }
+        }
+        freeaddrinfo(addresses);
+
+        if (m_listenFd == -1)
+        {
+            Logger::error("Encoder node: cannot listen on " + m_options.bindAddress + ":" +
+                          std::to_string(m_options.port) + ": " + strerror(error));
+            return false;
+        }
+
+        sockaddr_storage bound{};
+        socklen_t length = sizeof(bound);
+        getsockname(m_listenFd, reinterpret_cast<sockaddr *>(&bound), &length);
+        m_port = ntohs(bound.ss_family == AF_INET6 ? reinterpret_cast<sockaddr_in6 *>(&bound)->sin6_port
+                                                   : reinterpret_cast<sockaddr_in *>(&bound)->sin_port);
+
+        m_running = true;
+        m_acceptor = std::thread(&EncoderNode::acceptLoop, this);
+        Logger::info("Encoder node listening on " + m_options.bindAddress + ":" + std::to_string(m_port) + " (" +
+                     std::to_string(m_maxSessions) + " sessions, codecs mask " +
+                     std::to_string(FrameDelta::supportedCodecs()) + ")");
+        return true;
+    }
+
+    void EncoderNode::stop()
+    {
+        if (!m_running.exchange(false))
+        {
+            return;
+        }
+        if (m_acceptor.joinable())
+        {
+            m_acceptor.join();
+        }
+        ::close(m_listenFd);
+        m_listenFd = -1;
+
+        {
+            std::lock_guard<std::mutex> lock(m_sessionsMutex);
+            for (Session &session : m_sessions)
+            {
+                session.link->wake();
+            }
+        }
+        std::lock_guard<std::mutex> lock(m_sessionsMutex);
+        for (Session &session : m_sessions)
+        {
+            session.thread.join();
+        }
+        m_sessions.clear();
+        Logger::info("Encoder node stopped");
+    }
+
+    void EncoderNode::acceptLoop()
+    {
+        while (m_running)
+        {
+            // Poll so stop() is noticed without closing the socket under accept()
+            pollfd pfd{m_listenFd, POLLIN, 0};
+            int ready = poll(&pfd, 1, 200);
+            reapSessions();
+            if (ready <= 0)
+            {
+                continue;
+            }
+
+            int fd = accept4(m_listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd == -1)
+            {
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock(m_sessionsMutex);
+            Session &session = m_sessions.emplace_back();
+            session.link = std::make_unique<EncoderLink>(fd);
+            session.thread = std::thread(
+                [this, &session]
+                {
+                    runSession(session);
+                    session.finished = true;
+                });
+        }
+    }
+
+    void EncoderNode::runSession(Session &session)
+    {
+        EncoderLink &link = *session.link;
+        std::string peer = link.peerName();
+        EncoderMessage type;
+        std::vector<uint8_t> payload;
+
+        // Handshake: report load; the client may hang up to pick another node
+        link.setReceiveTimeout(10000);
+        if (!link.receive(type, payload) || type != EncoderMessage::Hello)
+        {
+            return;
+        }
+        MessageReader hello(payload.data(), payload.size());
+        if (hello.get32() != EncoderLink::MAGIC || hello.get32() != EncoderLink::VERSION)
+        {
+            sendError(link, "protocol version mismatch");
+            return;
+        }
+
+        MessageWriter status(EncoderMessage::Status);
+        status.put32(EncoderLink::VERSION);
+        status.put32(static_cast<uint32_t>(m_activeSessions.load()));
+        status.put32(static_cast<uint32_t>(m_maxSessions));
+        status.put32(std::thread::hardware_concurrency());
+        status.put32(FrameDelta::supportedCodecs());
+        if (!link.send(status) || !link.receive(type, payload) || type != EncoderMessage::Open)
+        {
+            return;
+        }
+
+        MessageReader open(payload.data(), payload.size());
+        VideoConfig config;
+        config.width = static_cast<int>(open.get32());
+        config.height = static_cast<int>(open.get32());
+        config.fps = static_cast<int>(open.get32());
+        config.preset = open.getString();
+        config.pixelFormat = open.getString();
+        config.inputPixelFormat = open.getString();
+        std::string name = open.getString();
+        uint64_t frameSize = open.get64();
+        if (!open.ok() || config.width <= 0 || config.height <= 0 || config.fps <= 0 ||
+            static_cast<uint32_t>(config.width) > MAX_DIMENSION || static_cast<uint32_t>(config.height) > MAX_DIMENSION ||
+            frameSize != config.inputFrameSize())
+        {
+            sendOpened(link, false, "invalid video configuration");
+            return;
+        }
+
+        // Claim a slot (the Status snapshot may be stale by now)
+        int active = m_activeSessions.fetch_add(1);
+        if (active >= m_maxSessions)
+        {
+            m_activeSessions.fetch_sub(1);
+            sendOpened(link, false, "node busy");
+            return;
+        }
+
+        config.output = reserveOutputPath(name);
+        FFmpegVideoWriter writer;
+        if (!writer.initialize(config))
+        {
+            m_activeSessions.fetch_sub(1);
+            sendOpened(link, false, "ffmpeg failed to start");
+            return;
+        }
+        if (!sendOpened(link, true, ""))
+        {
+            writer.finalize();
+            m_activeSessions.fetch_sub(1);
+            std::error_code ec;
+            std::filesystem::remove(config.output, ec);
+            return;
+        }
+        Logger::info("Encoder node: session from " + peer + " -> " + config.output);
+
+        // Frames: sequence gaps are frames the client dropped; repeat the previous one
+        link.setReceiveTimeout(0);
+        FrameDelta delta;
+        delta.reset(frameSize);
+        uint64_t nextSequence = 0;
+        uint64_t framesWritten = 0;
+        bool ok = true;
+        bool finished = false;
+        MessageWriter ack(EncoderMessage::Ack);
+
+        auto writeUpTo = [&](uint64_t sequence)
+        {
+            for (; nextSequence < sequence && ok; ++nextSequence)
+            {
+                ok = writer.writeFrame(delta.getFrame().data(), delta.getFrame().size());
+                framesWritten += ok ? 1 : 0;
+            }
+        };
+
+        while (ok && link.receive(type, payload))
+        {
+            MessageReader in(payload.data(), payload.size());
+            if (type == EncoderMessage::Frame)
+            {
+                uint64_t sequence = in.get64();
+                in.get64(); // Capture timestamp (frames are paced by sequence)
+                if (!in.ok() || sequence < nextSequence)
+                {
+                    sendError(link, "frame out of order");
+                    ok = false;
+                    break;
+                }
+                writeUpTo(sequence);
+                if (!delta.decode(in))
+                {
+                    sendError(link, "malformed frame delta");
+                    ok = false;
+                    break;
+                }
+                writeUpTo(sequence + 1);
+
+                ack.reset(EncoderMessage::Ack);
+                ack.put64(sequence);
+                ack.put8(ok ? 1 : 0);
+                if (!link.send(ack))
+                {
+                    ok = false;
+                }
+            }
+            else if (type == EncoderMessage::Finish)
+            {
+                uint64_t total = in.get64();
+                if (total >= nextSequence)
+                {
+                    writeUpTo(total);
+                }
+                finished = true;
+                break;
+            }
+            else
+            {
+                sendError(link, "unexpected message");
+                ok = false;
+            }
+        }
+
+        bool encoded = writer.finalize() && ok && finished;
+        m_activeSessions.fetch_sub(1);
+
+        std::error_code ec;
+        uint64_t fileSize = encoded ? std::filesystem::file_size(config.output, ec) : 0;
+        if (ec)
+        {
+            encoded = false;
+            fileSize = 0;
+        }
+
+        if (finished)
+        {
+            EncoderUsage usage = writer.getEncoderUsage();
+            MessageWriter result(EncoderMessage::Result);
+            result.put8(encoded ? 1 : 0);
+            result.put64(framesWritten);
+            result.put64(writer.getBytesWritten());
+            result.put8(usage.valid ? 1 : 0);
+            result.putDouble(usage.userSeconds);
+            result.putDouble(usage.systemSeconds);
+            result.put64(static_cast<uint64_t>(std::max(0L, usage.peakRssKb)));
+            result.put64(fileSize);
+            bool sent = link.send(result);
+
+            std::ifstream file(config.output, std::ios::binary);
+            std::vector<char> chunk(FILE_CHUNK);
+            MessageWriter data(EncoderMessage::FileData);
+            while (sent && encoded && file)
+            {
+                file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+                std::streamsize count = file.gcount();
+                if (count <= 0)
+                {
+                    break;
+                }
+                data.reset(EncoderMessage::FileData);
+                data.putBytes(chunk.data(), static_cast<size_t>(count));
+                sent = link.send(data);
+            }
+            data.reset(EncoderMessage::FileData);
+            sent = sent && link.send(data);
+
+            if (sent && encoded)
+            {
+                m_completedSessions.fetch_add(1);
+            }
+            Logger::info("Encoder node: session from " + peer + " finished, " + std::to_string(framesWritten) +
+                         " frames, " + std::to_string(fileSize / 1024) + " KB" + (sent ? "" : " (transfer failed)"));
+        }
+        else
+        {
+            Logger::warning("Encoder node: session from " + peer + " aborted");
+        }
+
+        if (!m_options.keepFiles)
+        {
+            std::filesystem::remove(config.output, ec);
+        }
+    }
+
+#endif
+
+} // namespace NanoRec
@@ -0,0 +1,566 @@
+#include "core/EncoderProtocol.hpp"
+#include "core/Logger.hpp"
+#include <algorithm>
+#include <cstring>
+
+#ifdef NANOREC_HAVE_LZ4
+#include <lz4.h>
+#endif
+#ifdef NANOREC_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace NanoRec
+{
+
+    // ---- MessageWriter / MessageReader ----
+
+    MessageWriter::MessageWriter(EncoderMessage type) : m_data(5, 0)
+    {
+        m_data[4] = static_cast<uint8_t>(type);
+    }
+
+    void MessageWriter::reset(EncoderMessage type)
+    {
+        m_data.assign(5, 0);
+        m_data[4] = static_cast<uint8_t>(type);
+    }
+
+    void MessageWriter::put32(uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            m_data.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    void MessageWriter::put64(uint64_t value)
+    {
+        put32(static_cast<uint32_t>(value));
+        put32(static_cast<uint32_t>(value >> 32));
+    }
+
+    void MessageWriter::putDouble(double value)
+    {
+        uint64_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        put64(bits);
+    }
+
+    void MessageWriter::putString(const std::string &value)
+    {
+        put32(static_cast<uint32_t>(value.size()));
+        putBytes(value.data(), value.size());
+    }
+
+    void MessageWriter::putBytes(const void *data, size_t size)
+    {
+        const uint8_t *bytes = static_cast<const uint8_t *>(data);
+        m_data.insert(m_data.end(), bytes, bytes + size);
+    }
+
+    const std::vector<uint8_t> &MessageWriter::finish()
+    {
+        uint32_t length = static_cast<uint32_t>(m_data.size() - 5);
+        for (int i = 0; i < 4; ++i)
+        {
+            m_data[i] = static_cast<uint8_t>(length >> (8 * i));
+        }
+        return m_data;
+    }
+
+    const uint8_t *MessageReader::getBytes(size_t size)
+    {
+        if (!m_ok || remaining() < size)
+        {
+            m_ok = false;
+            return nullptr;
+        }
+        const uint8_t *data = m_data;
+        m_data += size;
+        return data;
+    }
+
+    uint8_t MessageReader::get8()
+    {
+        const uint8_t *p = getBytes(1);
+        return p ? p[0] : 0;
+    }
+
+    uint32_t MessageReader::get32()
+    {
+        const uint8_t *p = getBytes(4);
+        if (!p)
+            return 0;
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+               (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    uint64_t MessageReader::get64()
+    {
+        uint64_t low = get32();
+        return low | (static_cast<uint64_t>(get32()) << 32);
+    }
+
+    double MessageReader::getDouble()
+    {
+        uint64_t bits = get64();
+        double value = 0.0;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    std::string MessageReader::getString()
+    {
+        uint32_t size = get32();
+        const uint8_t *p = getBytes(size);
+        return p ? std::string(reinterpret_cast<const char *>(p), size) : std::string();
+    }
+
+    // ---- FrameDelta ----
+
+    uint32_t FrameDelta::supportedCodecs()
+    {
+        uint32_t mask = 1u << static_cast<int>(FrameCodec::None);
+#ifdef NANOREC_HAVE_LZ4
+        mask |= 1u << static_cast<int>(FrameCodec::Lz4);
+#endif
+#ifdef NANOREC_HAVE_ZLIB
+        mask |= 1u << static_cast<int>(FrameCodec::Zlib);
+#endif
+        return mask;
+    }
+
+    FrameCodec FrameDelta::bestCodec(uint32_t mask)
+    {
+        mask &= supportedCodecs();
+        for (FrameCodec codec : {FrameCodec::Lz4, FrameCodec::Zlib})
+        {
+            if (mask & (1u << static_cast<int>(codec)))
+            {
+                return codec;
+            }
+        }
+        return FrameCodec::None;
+    }
+
+    const char *FrameDelta::codecName(FrameCodec codec)
+    {
+        switch (codec)
+        {
+        case FrameCodec::Lz4:
+            return "lz4";
+        case FrameCodec::Zlib:
+            return "zlib";
+        default:
+            return "none";
+        }
+    }
+
+    void FrameDelta::reset(size_t frameSize)
+    {
+        m_reference.assign(frameSize, 0);
+        m_runs.clear();
+        m_changed.clear();
+    }
+
+    size_t FrameDelta::encode(const uint8_t *frame, FrameCodec codec, MessageWriter &out)
+    {
+        // Runs of changed blocks; the reference takes the new bytes as they are found
+        m_runs.clear();
+        m_changed.clear();
+        size_t size = m_reference.size();
+        uint32_t blocks = static_cast<uint32_t>((size + BLOCK_SIZE - 1) / BLOCK_SIZE);
+        for (uint32_t block = 0; block < blocks; ++block)
+        {
+            size_t offset = static_cast<size_t>(block) * BLOCK_SIZE;
+            size_t length = std::min(BLOCK_SIZE, size - offset);
+            if (std::memcmp(frame + offset, m_reference.data() + offset, length) == 0)
+            {
+                continue;
+            }
+            if (!m_runs.empty() && m_runs[m_runs.size() - 2] + m_runs.back() == block)
+            {
+                m_runs.back()++;
+            }
+            else
+            {
+                m_runs.push_back(block);
+                m_runs.push_back(1);
+            }
+            m_changed.insert(m_changed.end(), frame + offset, frame + offset + length);
+            std::memcpy(m_reference.data() + offset, frame + offset, length);
+        }
+
+        // Tiny deltas (cursor blinks, repeated frames) are not worth compressing
+        size_t compressed = 0;
+        if (m_changed.size() >= 256)
+        {
+            switch (codec)
+            {
+#ifdef NANOREC_HAVE_LZ4
+            case FrameCodec::Lz4:
+            {
+                int bound = LZ4_compressBound(static_cast<int>(m_changed.size()));
+                m_compressed.resize(static_cast<size_t>(bound));
+                int written = LZ4_compress_default(reinterpret_cast<const char *>(m_changed.data()),
+                                                   reinterpret_cast<char *>(m_compressed.data()),
+                                                   static_cast<int>(m_changed.size()), bound);
+                compressed = written > 0 ? static_cast<size_t>(written) : 0;
+                break;
+            }
+#endif
+#ifdef NANOREC_HAVE_ZLIB
+            case FrameCodec::Zlib:
+            {
+                uLongf written = compressBound(static_cast<uLong>(m_changed.size()));
+                m_compressed.resize(written);
+                if (compress2(m_compressed.data(), &written, m_changed.data(), static_cast<uLong>(m_changed.size()),
+                              1) == Z_OK)
+                {
+                    compressed = written;
+                }
+                break;
+            }
+#endif
+            default:
+                break;
+            }
+        }
+
+        // Raw when compression failed or did not pay
+        if (compressed == 0 || compressed >= m_changed.size())
+        {
+            codec = FrameCodec::None;
+        }
+        const std::vector<uint8_t> &payload = codec == FrameCodec::None ? m_changed : m_compressed;
+        size_t payloadSize = codec == FrameCodec::None ? m_changed.size() : compressed;
+
+        out.put8(static_cast<uint8_t>(codec));
+        out.put32(static_cast<uint32_t>(m_runs.size() / 2));
+        for (uint32_t value : m_runs)
+        {
+            out.put32(value);
+        }
+        out.put32(static_cast<uint32_t>(m_changed.size()));
+        out.put32(static_cast<uint32_t>(payloadSize));
+        out.putBytes(payload.data(), payloadSize);
+        return m_changed.size();
+    }
+
+    bool FrameDelta::decode(MessageReader &in)
+    {
+        FrameCodec codec = static_cast<FrameCodec>(in.get8());
+        uint32_t runCount = in.get32();
+        if (!in.ok() || runCount > m_reference.size() / BLOCK_SIZE + 1)
+        {
+            return false;
+        }
+
+        m_runs.resize(static_cast<size_t>(runCount) * 2);
+        size_t expected = 0;
+        for (uint32_t &value : m_runs)
+        {
+            value = in.get32();
+        }
+        for (size_t i = 0; i < m_runs.size(); i += 2)
+        {
+            size_t offset = static_cast<size_t>(m_runs[i]) * BLOCK_SIZE;
+            size_t length = static_cast<size_t>(m_runs[i + 1]) * BLOCK_SIZE;
+            if (offset >= m_reference.size() || m_runs[i + 1] == 0)
+            {
+                return false;
+            }
+            expected += std::min(length, m_reference.size() - offset);
+        }
+
+        uint32_t rawSize = in.get32();
+        uint32_t payloadSize = in.get32();
+        const uint8_t *payload = in.getBytes(payloadSize);
+        if (!in.ok() || rawSize != expected)
+        {
+            return false;
+        }
+
+        const uint8_t *changed = payload;
+        switch (codec)
+        {
+        case FrameCodec::None:
+            if (payloadSize != rawSize)
+                return false;
+            break;
+#ifdef NANOREC_HAVE_LZ4
+        case FrameCodec::Lz4:
+            m_changed.resize(rawSize);
+            if (LZ4_decompress_safe(reinterpret_cast<const char *>(payload), reinterpret_cast<char *>(m_changed.data()),
+                                    static_cast<int>(payloadSize), static_cast<int>(rawSize)) != static_cast<int>(rawSize))
+                return false;
+            changed = m_changed.data();
+            break;
+#endif
+#ifdef NANOREC_HAVE_ZLIB
+        case FrameCodec::Zlib:
+        {
+            m_changed.resize(rawSize);
+            uLongf length = rawSize;
+            if (uncompress(m_changed.data(), &length, payload, payloadSize) != Z_OK || length != rawSize)
+                return false;
+            changed = m_changed.data();
+            break;
+        }
+#endif
+        default:
+            return false;
+        }
+
+        for (size_t i = 0; i < m_runs.size(); i += 2)
+        {
+            size_t offset = static_cast<size_t>(m_runs[i]) * BLOCK_SIZE;
+            size_t length = std::min(static_cast<size_t>(m_runs[i + 1]) * BLOCK_SIZE, m_reference.size() - offset);
+            std::memcpy(m_reference.data() + offset, changed, length);
+            changed += length;
+        }
+        return true;
+    }
+
+    // ---- EncoderLink ----
+
+    EncoderLink::~EncoderLink()
+    {
+        close();
+    }
+
+    bool EncoderLink::parseAddress(const std::string &address, std::string &host, int &port)
+    {
+        std::string hostPart = address;
+        std::string portPart;
+        if (!address.empty() && address[0] == '[')
+        {
+            size_t close = address.find(']');
+            if (close == std::string::npos || (close + 1 < address.size() && address[close + 1] != ':'))
+                return false;
+            hostPart = address.substr(1, close - 1);
+            portPart = close + 1 < address.size() ? address.substr(close + 2) : "";
+        }
+        else if (size_t colon = address.find(':'); colon != std::string::npos)
+        {
+            if (address.find(':', colon + 1) != std::string::npos)
+                return false; // Bare IPv6 addresses need brackets
+            hostPart = address.substr(0, colon);
+            portPart = address.substr(colon + 1);
+        }
+
+        int number = DEFAULT_PORT;
+        if (!portPart.empty())
+        {
+            if (portPart.size() > 5 || portPart.find_first_not_of("0123456789") != std::string::npos)
+                return false;
+            number = std::stoi(portPart);
+        }
+        if (hostPart.empty() || number <= 0 || number > 65535)
+            return false;
+
+        host = hostPart;
+        port = number;
+        return true;
+    }
+
+#ifdef _WIN32
+
+    bool EncoderLink::connect(const std::string &, int, int)
+    {
+        Logger::warning("Remote encoding is not supported on Windows yet");
+        return false;
+    }
+
+    bool EncoderLink::send(MessageWriter &) { return false; }
+    bool EncoderLink::receive(EncoderMessage &, std::vector<uint8_t> &) { return false; }
+    void EncoderLink::setReceiveTimeout(int) {}
+    void EncoderLink::wake() {}
+    void EncoderLink::close() {}
+    std::string EncoderLink::peerName() const { return ""; }
+    bool EncoderLink::sendAll(const void *, size_t) { return false; }
+    bool EncoderLink::readExact(void *, size_t) { return false; }
+
+#else
+
+    bool EncoderLink::connect(const std::string &host, int port, int timeoutMs)
+    {
+        close();
+
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo *addresses = nullptr;
+        int error = getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses);
+        if (error != 0)
+        {
+            Logger::error("Encoder node: cannot resolve " + host + ": " + gai_strerror(error));
+            return false;
+        }
+
+        // Non-blocking connect so a node that is down fails within the timeout
+        for (addrinfo *address = addresses; address && m_fd == -1; address = address->ai_next)
+        {
+            int fd = socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC, address->ai_protocol);
+            if (fd == -1)
+                continue;
+
+            int flags = fcntl(fd, F_GETFL, 0);
+            fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+            int result = ::connect(fd, address->ai_addr, address->ai_addrlen);
+            if (result == -1 && errno == EINPROGRESS)
+            {
+                pollfd pfd{fd, POLLOUT, 0};
+                int socketError = ETIMEDOUT;
+                socklen_t length = sizeof(socketError);
+                if (poll(&pfd, 1, timeoutMs) == 1)
+                {
+                    getsockopt(fd, SOL_SOCKET, SO_ERROR, &socketError, &length);
+                }
+                result = socketError == 0 ? 0 : -1;
+                errno = socketError;
+            }
+            if (result == 0)
+            {
+                fcntl(fd, F_SETFL, flags);
+                m_fd = fd;
+            }
+            else
+            {
+                error = errno;
+                ::close(fd);
+            }
+        }
+        freeaddrinfo(addresses);
+
+        if (m_fd == -1)
+        {
+            Logger::warning("Encoder node " + host + ":" + std::to_string(port) + " unreachable: " + strerror(error));
+            return false;
+        }
+
+        // Acks are latency bound
+        int noDelay = 1;
+        setsockopt(m_fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        return true;
+    }
+
+    bool EncoderLink::send(MessageWriter &message)
+    {
+        const std::vector<uint8_t> &data = message.finish();
+        return m_fd != -1 && sendAll(data.data(), data.size());
+    }
+
+    bool EncoderLink::receive(EncoderMessage &type, std::vector<uint8_t> &payload)
+    {
+        uint8_t header[5];
+        if (m_fd == -1 || !readExact(header, sizeof(header)))
+        {
+            return false;
+        }
+
+        uint32_t length = static_cast<uint32_t>(header[0]) | (static_cast<uint32_t>(header[1]) << 8) |
+                          (static_cast<uint32_t>(header[2]) << 16) | (static_cast<uint32_t>(header[3]) << 24);
+        if (length > MAX_MESSAGE)
+        {
+            Logger::error("Encoder link: oversized message from " + peerName());
+            return false;
+        }
+        type = static_cast<EncoderMessage>(header[4]);
+        payload.resize(length);
+        return length == 0 || readExact(payload.data(), length);
+    }
+
+    void EncoderLink::setReceiveTimeout(int timeoutMs)
+    {
+        timeval timeout{};
+        timeout.tv_sec = timeoutMs / 1000;
+        timeout.tv_usec = (timeoutMs % 1000) * 1000;
+        setsockopt(m_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+
+    void EncoderLink::wake()
+    {
+        if (m_fd != -1)
+        {
+            ::shutdown(m_fd, SHUT_RDWR);
+        }
+    }
+
+    void EncoderLink::close()
+    {
+        if (m_fd != -1)
+        {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+    std::string EncoderLink::peerName() const
+    {
+        sockaddr_storage address{};
+        socklen_t length = sizeof(address);
+        char host[NI_MAXHOST] = "?";
+        char port[NI_MAXSERV] = "?";
+        if (m_fd != -1 && getpeername(m_fd, reinterpret_cast<sockaddr *>(&address), &length) == 0)
+        {
+            getnameinfo(reinterpret_cast<sockaddr *>(&address), length, host, sizeof(host), port, sizeof(port),
+                        NI_NUMERICHOST | NI_NUMERICSERV);
+        }
+        return std::string(host) + ":" + port;
+    }
+
+    bool EncoderLink::sendAll(const void *data, size_t size)
+    {
+        const uint8_t *in = static_cast<const uint8_t *>(data);
+        while (size > 0)
+        {
+            ssize_t sent = ::send(m_fd, in, size, MSG_NOSIGNAL);
+            if (sent > 0)
+            {
+                in += sent;
+                size -= static_cast<size_t>(sent);
+            }
+            else if (sent == -1 && errno != EINTR)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool EncoderLink::readExact(void *data, size_t size)
+    {
+        uint8_t *out = static_cast<uint8_t *>(data);
+        while (size > 0)
+        {
+            ssize_t received = recv(m_fd, out, size, 0);
+            if (received > 0)
+            {
+                out += received;
+                size -= static_cast<size_t>(received);
+            }
+            else if (received == 0 || errno != EINTR)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+#endif
+
+} // namespace NanoRec
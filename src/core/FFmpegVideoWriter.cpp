@@ -7,20 +7,178 @@
 
 #include "core/FFmpegVideoWriter.hpp"
 #include "core/Logger.hpp"
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 #include <cstring>
+#include <vector>
 
 #ifdef _WIN32
 #include <windows.h>
 #else
+#include <sys/resource.h>
 #include <sys/wait.h>
 #include <signal.h>
 #include <errno.h>
+#include <fcntl.h>
 #endif
 
 namespace NanoRec
 {
 
+    // Matroska (EBML) framing of timestamped input; every size is 8 bytes wide so it can be written ahead of the data
+    namespace Mkv
+    {
+        constexpr uint32_t EBML = 0x1A45DFA3;
+        constexpr uint32_t SEGMENT = 0x18538067;
+        constexpr uint32_t INFO = 0x1549A966;
+        constexpr uint32_t TIMECODE_SCALE = 0x2AD7B1;
+        constexpr uint32_t TRACKS = 0x1654AE6B;
+        constexpr uint32_t TRACK_ENTRY = 0xAE;
+        constexpr uint32_t VIDEO = 0xE0;
+        constexpr uint32_t CLUSTER = 0x1F43B675;
+        constexpr uint32_t CLUSTER_TIMECODE = 0xE7;
+        constexpr uint32_t BLOCK_GROUP = 0xA0;
+        constexpr uint32_t BLOCK = 0xA1;
+        constexpr uint32_t BLOCK_DURATION = 0x9B;
+
+        constexpr size_t SIZE_BYTES = 8;
+        constexpr size_t UINT_ELEMENT = 1 + SIZE_BYTES + 8; ///< One-byte ID, size, 8-byte value
+        constexpr size_t BLOCK_HEADER = 4;                  ///< Track number, relative time, flags
+        constexpr uint64_t TICKS_PER_SECOND = 1000000;      ///< TIMECODE_SCALE of 1000 ns
+
+        static void appendId(std::vector<uint8_t> &out, uint32_t id)
+        {
+            // IDs carry their own length marker: drop the leading zero bytes
+            int bytes = id > 0xFFFFFF ? 4 : id > 0xFFFF ? 3 : id > 0xFF ? 2 : 1;
+            for (int i = bytes - 1; i >= 0; --i)
+            {
+                out.push_back(static_cast<uint8_t>(id >> (8 * i)));
+            }
+        }
+
+        static void appendSize(std::vector<uint8_t> &out, uint64_t size)
+        {
+            out.push_back(0x01);
+            for (int i = 6; i >= 0; --i)
+            {
+                out.push_back(static_cast<uint8_t>(size >> (8 * i)));
+            }
+        }
+
+        static void appendUInt(std::vector<uint8_t> &out, uint32_t id, uint64_t value)
+        {
+            appendId(out, id);
+            appendSize(out, 8);
+            for (int i = 7; i >= 0; --i)
+            {
+                out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+            }
+        }
+
+        static void appendBytes(std::vector<uint8_t> &out, uint32_t id, const std::string &bytes)
+        {
+            appendId(out, id);
+            appendSize(out, bytes.size());
+            out.insert(out.end(), bytes.begin(), bytes.end());
+        }
+
+        static void appendMaster(std::vector<uint8_t> &out, uint32_t id, const std::vector<uint8_t> &children)
+        {
+            appendId(out, id);
+            appendSize(out, children.size());
+            out.insert(out.end(), children.begin(), children.end());
+        }
+
+        /**
+         * @brief Stream header: EBML header, a segment of unknown size, and one raw video track
+         */
+        static std::vector<uint8_t> header(const VideoConfig &config)
+        {
+            std::vector<uint8_t> ebml;
+            appendUInt(ebml, 0x4286, 1); // EBMLVersion
+            appendUInt(ebml, 0x42F7, 1); // EBMLReadVersion
+            appendUInt(ebml, 0x42F2, 4); // EBMLMaxIDLength
+            appendUInt(ebml, 0x42F3, 8); // EBMLMaxSizeLength
+            appendBytes(ebml, 0x4282, "matroska");
+            appendUInt(ebml, 0x4287, 4); // DocTypeVersion
+            appendUInt(ebml, 0x4285, 2); // DocTypeReadVersion
+
+            std::vector<uint8_t> info;
+            appendUInt(info, TIMECODE_SCALE, 1000000000 / TICKS_PER_SECOND);
+            appendBytes(info, 0x4D80, "NanoRec"); // MuxingApp
+            appendBytes(info, 0x5741, "NanoRec"); // WritingApp
+
+            // The raw layout is named by its fourcc, like ffmpeg's rawvideo tags
+            std::string fourcc = "RGB";
+            fourcc.push_back(24);
+            if (config.inputPixelFormat == "yuv420p")
+            {
+                fourcc = "I420";
+            }
+            else if (config.inputPixelFormat == "nv12")
+            {
+                fourcc = "NV12";
+            }
+            std::vector<uint8_t> video;
+            appendUInt(video, 0xB0, static_cast<uint64_t>(config.width));  // PixelWidth
+            appendUInt(video, 0xBA, static_cast<uint64_t>(config.height)); // PixelHeight
+            appendBytes(video, 0x2EB524, fourcc);                          // ColourSpace
+
+            std::vector<uint8_t> track;
+            appendUInt(track, 0xD7, 1);   // TrackNumber
+            appendUInt(track, 0x73C5, 1); // TrackUID
+            appendUInt(track, 0x83, 1);   // TrackType: video
+            appendBytes(track, 0x86, "V_UNCOMPRESSED");
+            appendUInt(track, 0x23E383, 1000000000ull / static_cast<uint64_t>(config.fps)); // DefaultDuration (ns)
+            appendMaster(track, VIDEO, video);
+
+            std::vector<uint8_t> tracks;
+            appendMaster(tracks, TRACK_ENTRY, track);
+
+            std::vector<uint8_t> out;
+            appendMaster(out, EBML, ebml);
+            appendId(out, SEGMENT);
+            out.push_back(0x01); // Unknown size: the stream ends when the pipe closes
+            out.insert(out.end(), 7, 0xFF);
+            appendMaster(out, INFO, info);
+            appendMaster(out, TRACKS, tracks);
+            return out;
+        }
+
+        /**
+         * @brief Everything of a frame's cluster up to the pixels; the block duration follows them
+         */
+        static std::vector<uint8_t> blockStart(uint64_t timecode, size_t dataSize)
+        {
+            uint64_t blockSize = BLOCK_HEADER + dataSize;
+            uint64_t groupSize = 1 + SIZE_BYTES + blockSize + UINT_ELEMENT;
+            uint64_t clusterSize = UINT_ELEMENT + 1 + SIZE_BYTES + groupSize;
+
+            std::vector<uint8_t> out;
+            appendId(out, CLUSTER);
+            appendSize(out, clusterSize);
+            appendUInt(out, CLUSTER_TIMECODE, timecode);
+            appendId(out, BLOCK_GROUP);
+            appendSize(out, groupSize);
+            appendId(out, BLOCK);
+            appendSize(out, blockSize);
+            out.push_back(0x81); // Track 1
+            out.push_back(0);    // Time relative to the cluster
+            out.push_back(0);
+            out.push_back(0);    // Flags
+            return out;
+        }
+
+        /**
+         * @brief Time in stream ticks of a pts in frame intervals
+         */
+        static uint64_t ticks(int64_t pts, int fps)
+        {
+            return static_cast<uint64_t>(std::llround(static_cast<double>(pts) * TICKS_PER_SECOND / fps));
+        }
+    }
+
     FFmpegVideoWriter::FFmpegVideoWriter()
         : m_active(false)
 #ifdef _WIN32
@@ -99,6 +257,10 @@ namespace NanoRec
         }
 
         m_config = config;
+        m_bytesWritten = 0;
+        m_pipeBroken = false;
+        m_pendingPts = -1;
+        m_endPts = -1;
 
         // Spawn FFmpeg process
         if (!spawnFFmpegProcess())
@@ -107,6 +269,16 @@ namespace NanoRec
             return false;
         }
 
+        if (m_config.timestamps)
+        {
+            std::vector<uint8_t> header = Mkv::header(m_config);
+            if (!writeToPipe(header.data(), header.size()))
+            {
+                terminateFFmpegProcess();
+                return false;
+            }
+        }
+
         m_active = true;
         Logger::log(Logger::Level::INFO, "FFmpeg video writer initialized: " + 
             std::to_string(config.width) + "x" + std::to_string(config.height) + 
@@ -136,11 +308,20 @@ namespace NanoRec
 
         // Build FFmpeg command
         std::ostringstream cmd;
-        cmd << "ffmpeg -y -f rawvideo -pixel_format rgb24 "
-            << "-video_size " << m_config.width << "x" << m_config.height << " "
-            << "-framerate " << m_config.fps << " "
-            << "-i pipe:0 "
-            << "-c:v libx264 -preset medium -crf 23 -pix_fmt yuv420p "
+        cmd << "ffmpeg -y ";
+        if (m_config.timestamps)
+        {
+            cmd << "-f matroska ";
+        }
+        else
+        {
+            cmd << "-f rawvideo -pixel_format " << m_config.inputPixelFormat << " "
+                << "-video_size " << m_config.width << "x" << m_config.height << " "
+                << "-framerate " << m_config.fps << " ";
+        }
+        cmd << "-i pipe:0 "
+            << "-c:v libx264 -preset " << m_config.preset << " -crf 23 -pix_fmt " << m_config.pixelFormat << " "
+            << (m_config.timestamps ? "-fps_mode vfr " : "")
             << "\"" << m_config.output << "\"";
 
         std::string cmdStr = cmd.str();
@@ -176,8 +357,10 @@ namespace NanoRec
 
 #else
         // Linux implementation using fork/exec
+        // Close-on-exec: another writer's ffmpeg (overlapping segments, encoder node
+        // sessions) must not inherit this pipe, or this ffmpeg never sees EOF
         int pipeFds[2];
-        if (pipe(pipeFds) == -1)
+        if (pipe2(pipeFds, O_CLOEXEC) == -1)
         {
             Logger::log(Logger::Level::ERROR_LEVEL, "Failed to create pipe: " + 
                 std::string(strerror(errno)));
@@ -205,20 +388,39 @@ namespace NanoRec
             std::string videoSize = std::to_string(m_config.width) + "x" + std::to_string(m_config.height);
             std::string framerate = std::to_string(m_config.fps);
 
-            execlp("ffmpeg", "ffmpeg",
-                "-y",
-                "-f", "rawvideo",
-                "-pixel_format", "rgb24",
-                "-video_size", videoSize.c_str(),
-                "-framerate", framerate.c_str(),
-                "-i", "pipe:0",
-                "-c:v", "libx264",
-                "-preset", "medium",
-                "-crf", "23",
-                "-pix_fmt", "yuv420p",
-                m_config.output.c_str(),
-                nullptr
-            );
+            if (m_config.timestamps)
+            {
+                // The Matroska input carries the frame times; vfr keeps them instead of filling a fixed rate
+                execlp("ffmpeg", "ffmpeg",
+                    "-y",
+                    "-f", "matroska",
+                    "-i", "pipe:0",
+                    "-c:v", "libx264",
+                    "-preset", m_config.preset.c_str(),
+                    "-crf", "23",
+                    "-pix_fmt", m_config.pixelFormat.c_str(),
+                    "-fps_mode", "vfr",
+                    m_config.output.c_str(),
+                    nullptr
+                );
+            }
+            else
+            {
+                execlp("ffmpeg", "ffmpeg",
+                    "-y",
+                    "-f", "rawvideo",
+                    "-pixel_format", m_config.inputPixelFormat.c_str(),
+                    "-video_size", videoSize.c_str(),
+                    "-framerate", framerate.c_str(),
+                    "-i", "pipe:0",
+                    "-c:v", "libx264",
+                    "-preset", m_config.preset.c_str(),
+                    "-crf", "23",
+                    "-pix_fmt", m_config.pixelFormat.c_str(),
+                    m_config.output.c_str(),
+                    nullptr
+                );
+            }
 
             // If exec fails
             Logger::log(Logger::Level::ERROR_LEVEL, "Failed to exec FFmpeg: " + 
@@ -250,7 +452,7 @@ namespace NanoRec
         }
 
         // Verify expected frame size
-        size_t expectedSize = m_config.width * m_config.height * 3; // RGB24
+        size_t expectedSize = m_config.inputFrameSize();
         if (dataSize != expectedSize)
         {
             Logger::log(Logger::Level::WARNING, 
@@ -258,9 +460,56 @@ namespace NanoRec
                 ", got " + std::to_string(dataSize));
         }
 
+        if (m_config.timestamps)
+        {
+            return writeFrameAt(frameData, dataSize, m_pendingPts + 1);
+        }
         return writeToPipe(frameData, dataSize);
     }
 
+    bool FFmpegVideoWriter::writeFrameAt(const uint8_t* frameData, size_t dataSize, int64_t pts)
+    {
+        if (!m_active || !m_config.timestamps)
+        {
+            return writeFrame(frameData, dataSize);
+        }
+
+        if (frameData == nullptr || dataSize == 0)
+        {
+            Logger::log(Logger::Level::ERROR_LEVEL, "Invalid frame data");
+            return false;
+        }
+
+        if (pts <= m_pendingPts)
+        {
+            Logger::log(Logger::Level::WARNING, "Frame time " + std::to_string(pts) + " does not follow " +
+                std::to_string(m_pendingPts) + ", frame skipped");
+            return false;
+        }
+
+        if (m_pendingPts >= 0 && !closePendingBlock(pts))
+        {
+            return false;
+        }
+
+        std::vector<uint8_t> start = Mkv::blockStart(Mkv::ticks(pts, m_config.fps), dataSize);
+        if (!writeToPipe(start.data(), start.size()) || !writeToPipe(frameData, dataSize))
+        {
+            return false;
+        }
+        m_pendingPts = pts;
+        return true;
+    }
+
+    bool FFmpegVideoWriter::closePendingBlock(int64_t untilPts)
+    {
+        std::vector<uint8_t> duration;
+        Mkv::appendUInt(duration, Mkv::BLOCK_DURATION,
+                        Mkv::ticks(untilPts, m_config.fps) - Mkv::ticks(m_pendingPts, m_config.fps));
+        m_pendingPts = -1;
+        return writeToPipe(duration.data(), duration.size());
+    }
+
     bool FFmpegVideoWriter::writeToPipe(const void* data, size_t size)
     {
 #ifdef _WIN32
@@ -269,9 +518,12 @@ namespace NanoRec
         
         if (!success || bytesWritten != size)
         {
+            DWORD error = GetLastError();
+            m_pipeBroken = !success && (error == ERROR_BROKEN_PIPE || error == ERROR_NO_DATA);
             Logger::log(Logger::Level::ERROR_LEVEL, "Failed to write to FFmpeg pipe");
             return false;
         }
+        m_bytesWritten += bytesWritten;
         return true;
 
 #else
@@ -279,6 +531,8 @@ namespace NanoRec
         
         if (bytesWritten == -1)
         {
+            // EPIPE: ffmpeg is gone, every further write would fail too
+            m_pipeBroken = errno == EPIPE;
             Logger::log(Logger::Level::ERROR_LEVEL, "Failed to write to FFmpeg pipe: " + 
                 std::string(strerror(errno)));
             return false;
@@ -292,6 +546,7 @@ namespace NanoRec
             return false;
         }
         
+        m_bytesWritten += size;
         return true;
 #endif
     }
@@ -305,6 +560,12 @@ namespace NanoRec
 
         Logger::log(Logger::Level::INFO, "Finalizing video encoding...");
 
+        // The last frame lasts until the end time (at least one frame interval)
+        if (m_pendingPts >= 0 && !m_pipeBroken)
+        {
+            closePendingBlock(std::max(m_endPts, m_pendingPts + 1));
+        }
+
         terminateFFmpegProcess();
         m_active = false;
 
@@ -325,6 +586,16 @@ namespace NanoRec
         {
             // Wait for FFmpeg to finish encoding
             WaitForSingleObject(m_processInfo.hProcess, 5000); // 5 second timeout
+
+            FILETIME created, exited, kernel, user;
+            if (GetProcessTimes(m_processInfo.hProcess, &created, &exited, &kernel, &user))
+            {
+                auto seconds = [](const FILETIME &time)
+                { return ((static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime) / 1e7; };
+                m_encoderUsage.valid = true;
+                m_encoderUsage.userSeconds = seconds(user);
+                m_encoderUsage.systemSeconds = seconds(kernel);
+            }
             CloseHandle(m_processInfo.hProcess);
             CloseHandle(m_processInfo.hThread);
             ZeroMemory(&m_processInfo, sizeof(m_processInfo));
@@ -339,9 +610,16 @@ namespace NanoRec
 
         if (m_processId != -1)
         {
-            // Wait for FFmpeg to finish encoding
-            int status;
-            waitpid(m_processId, &status, 0);
+            // Wait for FFmpeg to finish encoding (wait4 also reports what it cost)
+            int status = 0;
+            struct rusage usage;
+            if (wait4(m_processId, &status, 0, &usage) == m_processId)
+            {
+                m_encoderUsage.valid = true;
+                m_encoderUsage.userSeconds = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6;
+                m_encoderUsage.systemSeconds = usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+                m_encoderUsage.peakRssKb = usage.ru_maxrss;
+            }
             
             if (WIFEXITED(status))
             {
@@ -360,7 +638,7 @@ namespace NanoRec
 
     bool FFmpegVideoWriter::isActive() const
     {
-        return m_active;
+        return m_active && !m_pipeBroken;
     }
 
 } // namespace NanoRec
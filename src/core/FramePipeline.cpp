@@ -0,0 +1,775 @@
+#include "core/FramePipeline.hpp"
+#include "core/FrameScaler.hpp"
+#include "core/Logger.hpp"
+#include "core/MjpegPreviewServer.hpp"
+#include "core/RedactionFilter.hpp"
+#include "core/StripePipeline.hpp"
+#include "core/TextOverlay.hpp"
+#include "core/ThreadSafeFrameBuffer.hpp"
+#include "core/TileChangeMap.hpp"
+#include "core/WorkerPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+
+namespace NanoRec
+{
+
+    const char *const FramePipeline::DEFAULT_SPEC =
+        "capture > redact > hash > preview; hash > mjpeg; hash > scale > overlay > convert > encoder; "
+        "convert > yuvpreview";
+
+    static std::string trim(const std::string &text)
+    {
+        size_t begin = text.find_first_not_of(" \t\r\n");
+        if (begin == std::string::npos)
+        {
+            return "";
+        }
+        size_t end = text.find_last_not_of(" \t\r\n");
+        return text.substr(begin, end - begin + 1);
+    }
+
+    static std::vector<std::string> split(const std::string &text, char separator)
+    {
+        std::vector<std::string> parts;
+        std::stringstream stream(text);
+        std::string part;
+        while (std::getline(stream, part, separator))
+        {
+            parts.push_back(trim(part));
+        }
+        return parts;
+    }
+
+    // Row-wise copy into a tightly packed frame (the source may be a borrowed, padded mapping)
+    static void copyFrame(const FrameBuffer &source, FrameBuffer &destination)
+    {
+        if (!destination.data || destination.width != source.width || destination.height != source.height)
+        {
+            destination.allocate(source.width, source.height);
+        }
+        size_t rowBytes = static_cast<size_t>(source.width) * 3;
+        for (int y = 0; y < source.height; ++y)
+        {
+            std::memcpy(destination.data + static_cast<size_t>(y) * destination.stride,
+                        source.data + static_cast<size_t>(y) * source.stride, rowBytes);
+        }
+    }
+
+    static const void *frameKey(const PipelineFrame &frame)
+    {
+        return frame.kind == FrameKind::Rgb ? static_cast<const void *>(frame.rgb)
+                                            : static_cast<const void *>(frame.yuv);
+    }
+
+    // Window redaction, drawn into the captured frame before anything else sees it
+    class RedactStage : public PipelineStage
+    {
+    public:
+        bool needsCapturedFrame() const override { return true; }
+        bool modifiesInput(const PipelineContext &context) const override { return context.redaction != nullptr; }
+
+        bool process(const PipelineFrame &input, PipelineFrame &output, PipelineContext &context, int) override
+        {
+            if (context.redaction)
+            {
+                context.redaction->apply(*input.rgb, context.originX, context.originY);
+            }
+            output = input;
+            return true;
+        }
+    };
+
+    // Tile hashes of the captured content (adaptive rate, change waits, activity index)
+    class HashStage : public PipelineStage
+    {
+    public:
+        bool needsCapturedFrame() const override { return true; }
+        bool wants(const PipelineContext &context) const override { return context.hashWanted; }
+
+        bool process(const PipelineFrame &input, PipelineFrame &output, PipelineContext &context, int) override
+        {
+            if (context.hashWanted && context.changeMap)
+            {
+                context.changeMap->update(*input.rgb, context.dirty);
+                context.hashed = true;
+            }
+            output = input;
+            return true;
+        }
+    };
+
+    // Resize to the recording size; passes frames through at native size
+    class ScaleStage : public PipelineStage
+    {
+    public:
+        bool isParallel() const override { return true; }
+
+        bool process(const PipelineFrame &input, PipelineFrame &output, PipelineContext &context,
+                     int threads) override
+        {
+            if (context.width <= 0 || context.height <= 0 ||
+                (input.rgb->width == context.width && input.rgb->height == context.height))
+            {
+                output = input;
+                return true;
+            }
+            if (!FrameScaler::scaleFrame(*input.rgb, m_scaled, context.width, context.height, threads))
+            {
+                return false;
+            }
+            output = PipelineFrame{FrameKind::Rgb, &m_scaled, nullptr};
+            return true;
+        }
+
+    private:
+        FrameBuffer m_scaled;
+    };
+
+    // Timestamp/label burn-in; placed after scale so the text keeps its pixel size
+    class OverlayStage : public PipelineStage
+    {
+    public:
+        bool modifiesInput(const PipelineContext &context) const override { return context.overlay != nullptr; }
+
+        bool process(const PipelineFrame &input, PipelineFrame &output, PipelineContext &context, int) override
+        {
+            if (context.overlay)
+            {
+                context.overlay->apply(*input.rgb);
+            }
+            output = input;
+            return true;
+        }
+    };
+
+    // RGB to the encoder's 4:2:0 layout; RGB passes through for formats ffmpeg converts itself
+    class ConvertStage : public PipelineStage
+    {
+    public:
+        FrameKind getOutputKind() const override { return FrameKind::Yuv; }
+        bool isParallel() const override { return true; }
+
+        bool process(const PipelineFrame &input, PipelineFrame &output, PipelineContext &context,
+                     int threads) override
+        {
+            if (!context.yuvOutput)
+            {
+                output = input;
+                return true;
+            }
+            if (!YuvConverter::convert(*input.rgb, m_frame, context.layout, threads))
+            {
+                return false;
+            }
+            output = PipelineFrame{FrameKind::Yuv, nullptr, &m_frame};
+            return true;
+        }
+
+    private:
+        YuvFrame m_frame;
+    };
+
+    // scale > overlay > convert fused into cache-sized stripes (only the encoder frame is materialized)
+    class StripesStage : public PipelineStage
+    {
+    public:
+        FrameKind getOutputKind() const override { return FrameKind::Yuv; }
+        bool isParallel() const override { return true; }
+
+        bool process(const PipelineFrame &input, PipelineFrame &output, PipelineContext &context,
+                     int threads) override
+        {
+            const FrameBuffer &source = *input.rgb;
+            int width = context.width > 0 ? context.width : source.width;
+            int height = context.height > 0 ? context.height : source.height;
+            if (context.yuvOutput)
+            {
+                if (context.overlay)
+                {
+                    context.overlay->prepareFrame(width, height);
+                }
+                if (!m_stripes.process(source, width, height, context.overlay, context.layout, m_frame,
+                                       context.stripeRows, threads))
+                {
+                    return false;
+                }
+                output = PipelineFrame{FrameKind::Yuv, nullptr, &m_frame};
+                return true;
+            }
+
+            // No YUV layout: whole-frame scale and overlay into a frame of our own
+            if (source.width == width && source.height == height)
+            {
+                copyFrame(source, m_scaled);
+            }
+            else if (!FrameScaler::scaleFrame(source, m_scaled, width, height, threads))
+            {
+                return false;
+            }
+            if (context.overlay)
+            {
+                context.overlay->apply(m_scaled);
+            }
+            output = PipelineFrame{FrameKind::Rgb, &m_scaled, nullptr};
+            return true;
+        }
+
+    private:
+        StripePipeline m_stripes;
+        FrameBuffer m_scaled;
+        YuvFrame m_frame;
+    };
+
+    // UI preview (rate-limited by the capture loop)
+    class PreviewStage : public PipelineStage
+    {
+    public:
+        bool isSink() const override { return true; }
+        bool wants(const PipelineContext &context) const override { return context.preview && context.previewDue; }
+
+        bool process(const PipelineFrame &input, PipelineFrame &, PipelineContext &context, int) override
+        {
+            context.preview->pushFrame(*input.rgb);
+            return true;
+        }
+    };
+
+    // MJPEG preview server (no-op without connected clients)
+    class MjpegStage : public PipelineStage
+    {
+    public:
+        bool isSink() const override { return true; }
+        bool wants(const PipelineContext &context) const override { return context.mjpeg != nullptr; }
+
+        bool process(const PipelineFrame &input, PipelineFrame &, PipelineContext &context, int) override
+        {
+            context.mjpeg->offerFrame(*input.rgb);
+            return true;
+        }
+    };
+
+    // Encoder-format preview; takes the frame's buffer (see ThreadSafeFrameBuffer::pushYuvFrame)
+    class YuvPreviewStage : public PipelineStage
+    {
+    public:
+        FrameKind getInputKind() const override { return FrameKind::Yuv; }
+        bool isSink() const override { return true; }
+        bool modifiesInput(const PipelineContext &) const override { return true; }
+
+        bool wants(const PipelineContext &context) const override
+        {
+            return context.preview && context.yuvPreviewWanted;
+        }
+
+        bool process(const PipelineFrame &input, PipelineFrame &, PipelineContext &context, int) override
+        {
+            if (input.kind != FrameKind::Yuv)
+            {
+                return false; // convert passed RGB through
+            }
+            context.preview->pushYuvFrame(*input.yuv);
+            return true;
+        }
+    };
+
+    // Recording: hands RGB or YUV frames to the open segment
+    class EncoderStage : public PipelineStage
+    {
+    public:
+        bool accepts(FrameKind) const override { return true; }
+        bool isSink() const override { return true; }
+        bool wants(const PipelineContext &context) const override { return context.encoderWanted; }
+
+        bool process(const PipelineFrame &input, PipelineFrame &, PipelineContext &context, int) override
+        {
+            if (context.encoderSink)
+            {
+                context.encoderSink(input);
+            }
+            return true;
+        }
+    };
+
+    std::unique_ptr<PipelineStage> FramePipeline::createStage(const std::string &type)
+    {
+        if (type == "redact")
+        {
+            return std::make_unique<RedactStage>();
+        }
+        if (type == "hash")
+        {
+            return std::make_unique<HashStage>();
+        }
+        if (type == "scale")
+        {
+            return std::make_unique<ScaleStage>();
+        }
+        if (type == "overlay")
+        {
+            return std::make_unique<OverlayStage>();
+        }
+        if (type == "convert")
+        {
+            return std::make_unique<ConvertStage>();
+        }
+        if (type == "stripes")
+        {
+            return std::make_unique<StripesStage>();
+        }
+        if (type == "preview")
+        {
+            return std::make_unique<PreviewStage>();
+        }
+        if (type == "mjpeg")
+        {
+            return std::make_unique<MjpegStage>();
+        }
+        if (type == "yuvpreview")
+        {
+            return std::make_unique<YuvPreviewStage>();
+        }
+        if (type == "encoder")
+        {
+            return std::make_unique<EncoderStage>();
+        }
+        return nullptr;
+    }
+
+    bool FramePipeline::build(const std::string &spec, bool fuseStripes, std::string &error)
+    {
+        struct Declaration
+        {
+            std::string name;
+            int parent;
+        };
+        std::vector<Declaration> declarations;
+        auto find = [&](const std::string &name)
+        {
+            for (size_t i = 0; i < declarations.size(); ++i)
+            {
+                if (declarations[i].name == name)
+                {
+                    return static_cast<int>(i);
+                }
+            }
+            return -1;
+        };
+        auto ancestors = [&](int index)
+        {
+            std::vector<int> result;
+            for (int parent = declarations[index].parent; parent >= 0; parent = declarations[parent].parent)
+            {
+                result.push_back(parent);
+            }
+            return result;
+        };
+
+        // Parse: each chain starts at capture or at a stage declared earlier
+        for (const std::string &chain : split(spec, ';'))
+        {
+            if (chain.empty())
+            {
+                continue;
+            }
+            std::vector<std::string> names = split(chain, '>');
+            if (std::find(names.begin(), names.end(), std::string()) != names.end())
+            {
+                error = "empty stage name in \"" + chain + "\"";
+                return false;
+            }
+
+            int previous = find(names[0]);
+            if (declarations.empty())
+            {
+                if (names[0] != "capture")
+                {
+                    error = "the graph must start at capture";
+                    return false;
+                }
+                declarations.push_back(Declaration{"capture", -1});
+                previous = 0;
+            }
+            else if (previous < 0)
+            {
+                error = "\"" + chain + "\" must start at a stage declared before it";
+                return false;
+            }
+
+            for (size_t i = 1; i < names.size(); ++i)
+            {
+                if (names[i] == "capture")
+                {
+                    error = "capture is the only source and cannot have an input";
+                    return false;
+                }
+                if (find(names[i]) >= 0)
+                {
+                    error = names[i] + " appears twice (a stage has one input; branch with \"" + names[i - 1] +
+                            " > ...\" chains instead)";
+                    return false;
+                }
+                if (!createStage(names[i]))
+                {
+                    error = "unknown stage \"" + names[i] + "\"";
+                    return false;
+                }
+                declarations.push_back(Declaration{names[i], previous});
+                previous = static_cast<int>(declarations.size()) - 1;
+            }
+        }
+        if (declarations.empty())
+        {
+            error = "empty pipeline spec";
+            return false;
+        }
+
+        auto childrenOf = [&](int index)
+        {
+            std::vector<int> children;
+            for (size_t i = 0; i < declarations.size(); ++i)
+            {
+                if (declarations[i].parent == index)
+                {
+                    children.push_back(static_cast<int>(i));
+                }
+            }
+            return children;
+        };
+
+        // Stripe mode: an unbranched scale [> overlay] > convert run becomes one stripes stage
+        int scale = find("scale");
+        if (fuseStripes && scale >= 0 && find("stripes") < 0)
+        {
+            std::vector<int> run{scale};
+            std::vector<int> next = childrenOf(scale);
+            if (next.size() == 1 && declarations[next[0]].name == "overlay")
+            {
+                run.push_back(next[0]);
+                next = childrenOf(next[0]);
+            }
+            if (next.size() == 1 && declarations[next[0]].name == "convert")
+            {
+                run.push_back(next[0]);
+                for (Declaration &declaration : declarations)
+                {
+                    if (declaration.parent == run.back())
+                    {
+                        declaration.parent = scale;
+                    }
+                }
+                declarations[scale].name = "stripes";
+
+                std::vector<int> remap(declarations.size(), -1);
+                std::vector<Declaration> kept;
+                for (size_t i = 0; i < declarations.size(); ++i)
+                {
+                    if (std::find(run.begin() + 1, run.end(), static_cast<int>(i)) == run.end())
+                    {
+                        remap[i] = static_cast<int>(kept.size());
+                        kept.push_back(declarations[i]);
+                    }
+                }
+                for (Declaration &declaration : kept)
+                {
+                    if (declaration.parent >= 0)
+                    {
+                        declaration.parent = remap[declaration.parent];
+                    }
+                }
+                declarations.swap(kept);
+            }
+        }
+
+        // Check edges and placement rules before touching the current graph
+        std::vector<Node> nodes(declarations.size());
+        nodes[0].name = "capture";
+        for (size_t i = 1; i < declarations.size(); ++i)
+        {
+            Node &node = nodes[i];
+            node.name = declarations[i].name;
+            node.parent = declarations[i].parent;
+            node.stage = createStage(node.name);
+            nodes[node.parent].children.push_back(static_cast<int>(i));
+
+            const Node &parent = nodes[node.parent];
+            if (parent.stage && parent.stage->isSink())
+            {
+                error = parent.name + " is a sink and cannot feed " + node.name;
+                return false;
+            }
+            FrameKind kind = parent.stage ? parent.stage->getOutputKind() : FrameKind::Rgb;
+            if (!node.stage->accepts(kind))
+            {
+                error = node.name + " cannot take " + (kind == FrameKind::Rgb ? "RGB" : "YUV") + " frames from " +
+                        parent.name;
+                return false;
+            }
+
+            std::vector<int> above = ancestors(static_cast<int>(i));
+            if (node.stage->needsCapturedFrame())
+            {
+                for (int ancestor : above)
+                {
+                    const std::string &name = declarations[ancestor].name;
+                    if (name != "capture" && name != "redact" && name != "hash")
+                    {
+                        error = node.name + " must see captured frames and cannot follow " + name;
+                        return false;
+                    }
+                }
+            }
+            if (node.stage->isSink() &&
+                std::none_of(above.begin(), above.end(),
+                             [&](int ancestor) { return declarations[ancestor].name == "redact"; }))
+            {
+                error = node.name + " would see unredacted frames (it must be below redact)";
+                return false;
+            }
+        }
+        for (const char *required : {"redact", "hash", "encoder"})
+        {
+            if (find(required) < 0)
+            {
+                error = std::string("the graph has no ") + required + " stage";
+                return false;
+            }
+        }
+
+        m_nodes = std::move(nodes);
+        m_spec = spec;
+        m_fused = fuseStripes;
+        m_readers.clear();
+        resetPlacement();
+        return true;
+    }
+
+    bool FramePipeline::convertsForEncoder() const
+    {
+        int encoder = findNode("encoder");
+        for (int parent = encoder >= 0 ? m_nodes[encoder].parent : -1; parent >= 0; parent = m_nodes[parent].parent)
+        {
+            if (m_nodes[parent].name == "convert" || m_nodes[parent].name == "stripes")
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void FramePipeline::run(FrameBuffer &captured, PipelineContext &context)
+    {
+        context.hashed = false;
+        if (m_nodes.empty())
+        {
+            return;
+        }
+
+        // Costs measured for another frame size, format or split say little about this one
+        if (context.width != m_lastWidth || context.height != m_lastHeight || context.yuvOutput != m_lastYuv ||
+            context.maxThreads != m_lastThreads)
+        {
+            m_lastWidth = context.width;
+            m_lastHeight = context.height;
+            m_lastYuv = context.yuvOutput;
+            m_lastThreads = context.maxThreads;
+            resetPlacement();
+        }
+
+        for (Node &node : m_nodes)
+        {
+            node.lastUs = 0.0;
+        }
+        m_nodes[0].output = PipelineFrame{FrameKind::Rgb, &captured, nullptr};
+        m_readers.clear();
+        if (markActive(0, context))
+        {
+            runChildren(0, context);
+        }
+    }
+
+    bool FramePipeline::markActive(int index, const PipelineContext &context)
+    {
+        Node &node = m_nodes[index];
+        bool active = node.stage && node.stage->wants(context);
+        for (int child : node.children)
+        {
+            active = markActive(child, context) || active;
+        }
+        node.active = active;
+        return active;
+    }
+
+    void FramePipeline::runChildren(int index, PipelineContext &context)
+    {
+        // Count every reader first, so a stage drawing in place knows whether a sibling still needs the pixels
+        const Node &node = m_nodes[index];
+        for (int child : node.children)
+        {
+            if (m_nodes[child].active)
+            {
+                addReader(frameKey(node.output));
+            }
+        }
+        for (int child : node.children)
+        {
+            if (m_nodes[child].active)
+            {
+                runNode(child, node.output, context);
+            }
+        }
+    }
+
+    void FramePipeline::runNode(int index, const PipelineFrame &input, PipelineContext &context)
+    {
+        Node &node = m_nodes[index];
+        auto start = std::chrono::steady_clock::now();
+
+        PipelineFrame frame = input;
+        bool shared = releaseReader(frameKey(input)) > 0;
+        if (shared && node.stage->modifiesInput(context))
+        {
+            if (frame.kind == FrameKind::Rgb)
+            {
+                copyFrame(*frame.rgb, node.rgbCopy);
+                frame.rgb = &node.rgbCopy;
+            }
+            else
+            {
+                node.yuvCopy = *frame.yuv;
+                frame.yuv = &node.yuvCopy;
+            }
+        }
+
+        PipelineFrame output = frame;
+        int threads = node.onPool ? std::max(1, context.maxThreads) : 1;
+        bool ok = node.stage->process(frame, output, context, threads);
+        node.lastUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        if (!ok)
+        {
+            return;
+        }
+
+        if (node.stage->isParallel())
+        {
+            schedule(node, context);
+        }
+        node.output = output;
+        runChildren(index, context);
+    }
+
+    void FramePipeline::schedule(Node &node, const PipelineContext &context)
+    {
+        node.costUs = node.samples == 0 ? node.lastUs : node.costUs * 0.9 + node.lastUs * 0.1;
+        node.samples++;
+        if (node.cooldown > 0)
+        {
+            node.cooldown--;
+        }
+
+        // One thread allowed (or a single-core machine): everything stays on the capture thread
+        if (context.maxThreads <= 1 || WorkerPool::shared().getThreadCount() == 0)
+        {
+            node.onPool = false;
+            return;
+        }
+        if (node.samples < MIN_SAMPLES)
+        {
+            return;
+        }
+
+        if (!node.onPool)
+        {
+            if (node.cooldown == 0 && node.costUs > POOL_SHARE * context.frameBudgetUs)
+            {
+                Logger::info("Pipeline: " + node.name + " moved to the worker pool (" +
+                             std::to_string(static_cast<int>(node.costUs)) + " us per frame on the capture thread)");
+                node.onPool = true;
+                node.inlineCostUs = node.costUs;
+                node.samples = 0;
+            }
+        }
+        else if (node.costUs > POOL_GAIN * node.inlineCostUs)
+        {
+            Logger::info("Pipeline: " + node.name + " back on the capture thread (" +
+                         std::to_string(static_cast<int>(node.costUs)) + " us on the pool vs " +
+                         std::to_string(static_cast<int>(node.inlineCostUs)) + " us inline)");
+            node.onPool = false;
+            node.cooldown = COOLDOWN_FRAMES;
+            node.samples = 0;
+        }
+    }
+
+    void FramePipeline::resetPlacement()
+    {
+        for (Node &node : m_nodes)
+        {
+            node.onPool = false;
+            node.costUs = 0.0;
+            node.inlineCostUs = 0.0;
+            node.samples = 0;
+            node.cooldown = 0;
+        }
+    }
+
+    double FramePipeline::getUpstreamUs(const std::string &stage) const
+    {
+        double total = 0.0;
+        int index = findNode(stage);
+        for (int parent = index >= 0 ? m_nodes[index].parent : -1; parent > 0; parent = m_nodes[parent].parent)
+        {
+            total += m_nodes[parent].lastUs;
+        }
+        return total;
+    }
+
+    std::vector<FramePipeline::StageReport> FramePipeline::getStageReports() const
+    {
+        std::vector<StageReport> reports;
+        for (size_t i = 1; i < m_nodes.size(); ++i)
+        {
+            reports.push_back(StageReport{m_nodes[i].name, m_nodes[i].onPool, m_nodes[i].costUs});
+        }
+        return reports;
+    }
+
+    int FramePipeline::findNode(const std::string &name) const
+    {
+        for (size_t i = 0; i < m_nodes.size(); ++i)
+        {
+            if (m_nodes[i].name == name)
+            {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    void FramePipeline::addReader(const void *frame)
+    {
+        for (auto &reader : m_readers)
+        {
+            if (reader.first == frame)
+            {
+                reader.second++;
+                return;
+            }
+        }
+        m_readers.emplace_back(frame, 1);
+    }
+
+    int FramePipeline::releaseReader(const void *frame)
+    {
+        for (auto &reader : m_readers)
+        {
+            if (reader.first == frame)
+            {
+                return --reader.second;
+            }
+        }
+        return 0;
+    }
+
+} // namespace NanoRec
@@ -1,8 +1,10 @@
 #include "core/FrameScaler.hpp"
 #include "core/Logger.hpp"
+#include "core/WorkerPool.hpp"
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <vector>
 
 namespace NanoRec
 {
@@ -11,7 +13,8 @@ namespace NanoRec
         const FrameBuffer &source,
         FrameBuffer &destination,
         int targetWidth,
-        int targetHeight)
+        int targetHeight,
+        int threads)
     {
         if (!source.data || source.width <= 0 || source.height <= 0)
         {
@@ -32,12 +35,53 @@ namespace NanoRec
             destination.allocate(targetWidth, targetHeight);
         }
 
+        // Split rows into bands; each band is independent
+        threads = std::clamp(threads, 1, std::max(1, targetHeight / 16));
+        int rowsPerBand = (targetHeight + threads - 1) / threads;
+        WorkerPool::shared().parallelFor(threads,
+                                         [&](int band)
+                                         {
+                                             int rowBegin = std::min(targetHeight, band * rowsPerBand);
+                                             int rowEnd = std::min(targetHeight, rowBegin + rowsPerBand);
+                                             scaleRows(source,
+                                                       destination.data +
+                                                           static_cast<size_t>(rowBegin) * destination.stride,
+                                                       destination.stride, targetWidth, targetHeight, rowBegin,
+                                                       rowEnd);
+                                         });
+
+        return true;
+    }
+
+    bool FrameScaler::scaleStripe(
+        const FrameBuffer &source,
+        FrameBuffer &stripe,
+        int targetHeight,
+        int rowBegin)
+    {
+        if (!source.data || !stripe.data || stripe.width <= 0 || rowBegin < 0 ||
+            rowBegin + stripe.height > targetHeight)
+        {
+            Logger::error("Invalid stripe for scaling");
+            return false;
+        }
+
+        scaleRows(source, stripe.data, stripe.stride, stripe.width, targetHeight, rowBegin, rowBegin + stripe.height);
+        return true;
+    }
+
+    void FrameScaler::scaleRows(
+        const FrameBuffer &source,
+        uint8_t *output, size_t outputStride,
+        int targetWidth, int targetHeight,
+        int rowBegin, int rowEnd)
+    {
         // Calculate scaling ratios
         float xRatio = static_cast<float>(source.width) / targetWidth;
         float yRatio = static_cast<float>(source.height) / targetHeight;
 
         // Perform bilinear scaling
-        for (int y = 0; y < targetHeight; ++y)
+        for (int y = rowBegin; y < rowEnd; ++y)
         {
             for (int x = 0; x < targetWidth; ++x)
             {
@@ -46,16 +90,14 @@ namespace NanoRec
                 float srcY = y * yRatio;
 
                 // Get destination pixel pointer
-                int dstIdx = (y * targetWidth + x) * 3;
+                uint8_t *dst = output + static_cast<size_t>(y - rowBegin) * outputStride + static_cast<size_t>(x) * 3;
 
                 // Sample each color channel with bilinear interpolation
-                destination.data[dstIdx + 0] = bilinearSample(source.data, source.width, source.height, srcX, srcY, 0); // R
-                destination.data[dstIdx + 1] = bilinearSample(source.data, source.width, source.height, srcX, srcY, 1); // G
-                destination.data[dstIdx + 2] = bilinearSample(source.data, source.width, source.height, srcX, srcY, 2); // B
+                dst[0] = bilinearSample(source.data, source.width, source.height, srcX, srcY, 0); // R
+                dst[1] = bilinearSample(source.data, source.width, source.height, srcX, srcY, 1); // G
+                dst[2] = bilinearSample(source.data, source.width, source.height, srcX, srcY, 2); // B
             }
         }
-
-        return true;
     }
 
     void FrameScaler::calculateScaledDimensions(
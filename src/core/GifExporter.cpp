@@ -0,0 +1,600 @@
+#include "core/GifExporter.hpp"
+#include "core/FrameScaler.hpp"
+#include "core/Logger.hpp"
+#include "core/MediaProbe.hpp"
+#include "core/Simd.hpp"
+#include "core/Subprocess.hpp"
+#include "core/WorkerPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+namespace NanoRec
+{
+
+    static constexpr int HISTOGRAM_BINS = 1 << 15; // 5 bits per channel
+
+    static inline int colorKey(int r, int g, int b)
+    {
+        return ((r >> 3) << 10) | ((g >> 3) << 5) | (b >> 3);
+    }
+
+    GifExporter::GifExporter()
+        : m_histogram(HISTOGRAM_BINS, 0), m_histogramSums(HISTOGRAM_BINS, {0, 0, 0})
+    {
+    }
+
+    void GifExporter::clear()
+    {
+        m_frames.clear();
+        m_changeMap.reset();
+        std::fill(m_histogram.begin(), m_histogram.end(), 0);
+        std::fill(m_histogramSums.begin(), m_histogramSums.end(), std::array<uint64_t, 3>{0, 0, 0});
+    }
+
+    bool GifExporter::addFrame(const FrameBuffer &frame)
+    {
+        if (!frame.data || frame.width <= 0 || frame.height <= 0 || frame.width > 65535 || frame.height > 65535)
+        {
+            Logger::error("Invalid frame for GIF export");
+            return false;
+        }
+
+        if (!m_frames.empty() &&
+            (frame.width != m_frames[0].pixels.width || frame.height != m_frames[0].pixels.height))
+        {
+            Logger::error("GIF frames must all have the same size");
+            return false;
+        }
+
+        Frame stored;
+        stored.pixels.allocate(frame.width, frame.height);
+        for (int y = 0; y < frame.height; ++y)
+        {
+            std::memcpy(stored.pixels.data + y * stored.pixels.stride, frame.data + y * frame.stride,
+                        static_cast<size_t>(frame.width) * 3);
+        }
+
+        m_changeMap.update(stored.pixels);
+        stored.changed = m_changeMap.getChangedBounds();
+
+        // Histogram only what will actually be written, sampled on a 2x2 grid
+        const Rect &region = stored.changed;
+        for (int y = region.y; y < region.bottom(); y += 2)
+        {
+            const uint8_t *px = stored.pixels.data + y * stored.pixels.stride + region.x * 3;
+            for (int x = region.x; x < region.right(); x += 2, px += 6)
+            {
+                int key = colorKey(px[0], px[1], px[2]);
+                m_histogram[key]++;
+                m_histogramSums[key][0] += px[0];
+                m_histogramSums[key][1] += px[1];
+                m_histogramSums[key][2] += px[2];
+            }
+        }
+
+        m_frames.push_back(std::move(stored));
+        return true;
+    }
+
+    void GifExporter::buildPalette(int maxColors)
+    {
+        struct Bin
+        {
+            uint16_t key;
+            uint32_t count;
+            uint8_t c[3];
+        };
+
+        std::vector<Bin> bins;
+        for (int key = 0; key < HISTOGRAM_BINS; ++key)
+        {
+            if (m_histogram[key])
+            {
+                bins.push_back({static_cast<uint16_t>(key), m_histogram[key],
+                                {static_cast<uint8_t>(key >> 10), static_cast<uint8_t>((key >> 5) & 31),
+                                 static_cast<uint8_t>(key & 31)}});
+            }
+        }
+
+        // Median cut: repeatedly split the box with the widest channel range
+        struct Box
+        {
+            size_t begin, end;
+        };
+        std::vector<Box> boxes;
+        if (!bins.empty())
+        {
+            boxes.push_back({0, bins.size()});
+        }
+
+        auto boxRange = [&](const Box &box, int &axis)
+        {
+            int lo[3] = {31, 31, 31}, hi[3] = {0, 0, 0};
+            for (size_t i = box.begin; i < box.end; ++i)
+            {
+                for (int c = 0; c < 3; ++c)
+                {
+                    lo[c] = std::min<int>(lo[c], bins[i].c[c]);
+                    hi[c] = std::max<int>(hi[c], bins[i].c[c]);
+                }
+            }
+            axis = 0;
+            for (int c = 1; c < 3; ++c)
+            {
+                if (hi[c] - lo[c] > hi[axis] - lo[axis])
+                    axis = c;
+            }
+            return hi[axis] - lo[axis];
+        };
+
+        while (static_cast<int>(boxes.size()) < maxColors)
+        {
+            int bestBox = -1, bestAxis = 0, bestRange = 0;
+            for (size_t b = 0; b < boxes.size(); ++b)
+            {
+                int axis;
+                int range = boxRange(boxes[b], axis);
+                if (boxes[b].end - boxes[b].begin > 1 && range > bestRange)
+                {
+                    bestBox = static_cast<int>(b);
+                    bestAxis = axis;
+                    bestRange = range;
+                }
+            }
+            if (bestBox < 0)
+            {
+                break;
+            }
+
+            Box box = boxes[bestBox];
+            std::sort(bins.begin() + box.begin, bins.begin() + box.end,
+                      [bestAxis](const Bin &a, const Bin &b) { return a.c[bestAxis] < b.c[bestAxis]; });
+
+            uint64_t total = 0;
+            for (size_t i = box.begin; i < box.end; ++i)
+                total += bins[i].count;
+
+            uint64_t running = 0;
+            size_t split = box.begin + 1;
+            for (size_t i = box.begin; i < box.end - 1; ++i)
+            {
+                running += bins[i].count;
+                split = i + 1;
+                if (running * 2 >= total)
+                    break;
+            }
+
+            boxes[bestBox] = {box.begin, split};
+            boxes.push_back({split, box.end});
+        }
+
+        // Palette entry = count-weighted mean of the exact pixel values in the box
+        m_palette.clear();
+        for (const Box &box : boxes)
+        {
+            uint64_t count = 0, sum[3] = {0, 0, 0};
+            for (size_t i = box.begin; i < box.end; ++i)
+            {
+                count += m_histogram[bins[i].key];
+                for (int c = 0; c < 3; ++c)
+                    sum[c] += m_histogramSums[bins[i].key][c];
+            }
+            m_palette.push_back({static_cast<uint8_t>(sum[0] / count), static_cast<uint8_t>(sum[1] / count),
+                                 static_cast<uint8_t>(sum[2] / count)});
+        }
+
+        if (m_palette.empty())
+        {
+            m_palette.push_back({0, 0, 0});
+        }
+    }
+
+    void GifExporter::buildLookupTable(const std::vector<std::array<uint8_t, 3>> &palette,
+                                       std::vector<uint8_t> &lookup)
+    {
+        lookup.assign(HISTOGRAM_BINS, 0);
+        const int paletteSize = static_cast<int>(palette.size());
+        if (paletteSize == 0)
+        {
+            return;
+        }
+
+#ifdef NANOREC_HAVE_SSE2
+        // Palette as (r,g) and (b,0) int16 pairs so _mm_madd_epi16 yields dr^2+dg^2 and db^2
+        const int padded = (paletteSize + 3) & ~3;
+        std::vector<int16_t> rg(padded * 2, 0), b0(padded * 2, 0);
+        for (int i = 0; i < padded; ++i)
+        {
+            const auto &p = palette[std::min(i, paletteSize - 1)];
+            rg[i * 2] = p[0];
+            rg[i * 2 + 1] = p[1];
+            b0[i * 2] = p[2];
+        }
+
+        for (int key = 0; key < HISTOGRAM_BINS; ++key)
+        {
+            int r = ((key >> 10) << 3) | 4, g = (((key >> 5) & 31) << 3) | 4, b = ((key & 31) << 3) | 4;
+            __m128i colorRG = _mm_set_epi16(g, r, g, r, g, r, g, r);
+            __m128i colorB0 = _mm_set_epi16(0, b, 0, b, 0, b, 0, b);
+
+            __m128i best = _mm_set1_epi32(0x7FFFFFFF);
+            __m128i bestIdx = _mm_setzero_si128();
+            __m128i idx = _mm_set_epi32(3, 2, 1, 0);
+            const __m128i four = _mm_set1_epi32(4);
+
+            for (int i = 0; i < padded; i += 4)
+            {
+                __m128i dRG = _mm_sub_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&rg[i * 2])), colorRG);
+                __m128i dB = _mm_sub_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&b0[i * 2])), colorB0);
+                __m128i dist = _mm_add_epi32(_mm_madd_epi16(dRG, dRG), _mm_madd_epi16(dB, dB));
+
+                __m128i closer = _mm_cmplt_epi32(dist, best);
+                best = _mm_or_si128(_mm_and_si128(closer, dist), _mm_andnot_si128(closer, best));
+                bestIdx = _mm_or_si128(_mm_and_si128(closer, idx), _mm_andnot_si128(closer, bestIdx));
+                idx = _mm_add_epi32(idx, four);
+            }
+
+            alignas(16) int32_t dists[4], indices[4];
+            _mm_store_si128(reinterpret_cast<__m128i *>(dists), best);
+            _mm_store_si128(reinterpret_cast<__m128i *>(indices), bestIdx);
+
+            int winner = 0;
+            for (int lane = 1; lane < 4; ++lane)
+            {
+                if (dists[lane] < dists[winner] || (dists[lane] == dists[winner] && indices[lane] < indices[winner]))
+                    winner = lane;
+            }
+            lookup[key] = static_cast<uint8_t>(indices[winner]);
+        }
+#else
+        for (int key = 0; key < HISTOGRAM_BINS; ++key)
+        {
+            int r = ((key >> 10) << 3) | 4, g = (((key >> 5) & 31) << 3) | 4, b = ((key & 31) << 3) | 4;
+            int best = 0x7FFFFFFF, bestIdx = 0;
+            for (int i = 0; i < paletteSize; ++i)
+            {
+                int dr = palette[i][0] - r, dg = palette[i][1] - g, db = palette[i][2] - b;
+                int dist = dr * dr + dg * dg + db * db;
+                if (dist < best)
+                {
+                    best = dist;
+                    bestIdx = i;
+                }
+            }
+            lookup[key] = static_cast<uint8_t>(bestIdx);
+        }
+#endif
+    }
+
+    void GifExporter::quantizeRegion(const FrameBuffer &frame, const Rect &region, bool dither, int threads,
+                                     std::vector<uint8_t> &indices) const
+    {
+        indices.resize(static_cast<size_t>(region.width) * region.height);
+
+        // Each band diffuses error only within itself, so bands run independently
+        auto processBand = [&](int y0, int y1)
+        {
+            std::vector<int16_t> errCur((region.width + 2) * 3, 0), errNext((region.width + 2) * 3, 0);
+
+            for (int y = y0; y < y1; ++y)
+            {
+                const uint8_t *src = frame.data + (region.y + y) * frame.stride + region.x * 3;
+                uint8_t *dst = indices.data() + static_cast<size_t>(y) * region.width;
+
+                if (!dither)
+                {
+                    for (int x = 0; x < region.width; ++x, src += 3)
+                        dst[x] = m_lookup[colorKey(src[0], src[1], src[2])];
+                    continue;
+                }
+
+                std::fill(errNext.begin(), errNext.end(), 0);
+                for (int x = 0; x < region.width; ++x, src += 3)
+                {
+                    int16_t *e = &errCur[(x + 1) * 3];
+                    int v[3];
+                    for (int c = 0; c < 3; ++c)
+                        v[c] = std::clamp(src[c] + e[c] / 16, 0, 255);
+
+                    uint8_t index = m_lookup[colorKey(v[0], v[1], v[2])];
+                    dst[x] = index;
+
+                    const auto &p = m_palette[index];
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        int err = v[c] - p[c];
+                        errCur[(x + 2) * 3 + c] += static_cast<int16_t>(err * 7);
+                        errNext[x * 3 + c] += static_cast<int16_t>(err * 3);
+                        errNext[(x + 1) * 3 + c] += static_cast<int16_t>(err * 5);
+                        errNext[(x + 2) * 3 + c] += static_cast<int16_t>(err);
+                    }
+                }
+                std::swap(errCur, errNext);
+            }
+        };
+
+        int bandCount = std::clamp(threads, 1, std::max(1, region.height / 16));
+        if (bandCount == 1)
+        {
+            processBand(0, region.height);
+            return;
+        }
+
+        int rowsPerBand = (region.height + bandCount - 1) / bandCount;
+        WorkerPool::shared().parallelFor(bandCount,
+                                         [&](int band)
+                                         {
+                                             int y0 = std::min(region.height, band * rowsPerBand);
+                                             int y1 = std::min(region.height, y0 + rowsPerBand);
+                                             if (y0 < y1)
+                                                 processBand(y0, y1);
+                                         });
+    }
+
+    namespace
+    {
+
+    /**
+     * @brief Variable-width LZW encoder emitting GIF data sub-blocks
+     */
+    class GifLzwWriter
+    {
+    public:
+        GifLzwWriter(std::vector<uint8_t> &out, int minCodeSize)
+            : m_out(out), m_minCodeSize(minCodeSize), m_clearCode(1 << minCodeSize),
+              m_dictionary(static_cast<size_t>(4096) << minCodeSize, 0)
+        {
+        }
+
+        void encode(const uint8_t *indices, size_t count)
+        {
+            m_out.push_back(static_cast<uint8_t>(m_minCodeSize));
+
+            resetDictionary();
+            writeCode(m_clearCode);
+
+            int current = indices[0];
+            for (size_t i = 1; i < count; ++i)
+            {
+                int next = indices[i];
+                uint16_t &entry = m_dictionary[(static_cast<size_t>(current) << m_minCodeSize) + next];
+                if (entry)
+                {
+                    current = entry;
+                    continue;
+                }
+
+                writeCode(current);
+                entry = static_cast<uint16_t>(++m_maxCode);
+                if (m_maxCode >= (1 << m_codeSize))
+                    m_codeSize++;
+
+                if (m_maxCode == 4095)
+                {
+                    writeCode(m_clearCode);
+                    resetDictionary();
+                }
+                current = next;
+            }
+
+            writeCode(current);
+            writeCode(m_clearCode + 1); // End of information
+            flushBits();
+            flushBlock();
+            m_out.push_back(0); // Block terminator
+        }
+
+    private:
+        void resetDictionary()
+        {
+            std::fill(m_dictionary.begin(), m_dictionary.end(), 0);
+            m_codeSize = m_minCodeSize + 1;
+            m_maxCode = m_clearCode + 1;
+        }
+
+        void writeCode(int code)
+        {
+            m_bitBuffer |= static_cast<uint32_t>(code) << m_bitCount;
+            m_bitCount += m_codeSize;
+            while (m_bitCount >= 8)
+            {
+                pushByte(static_cast<uint8_t>(m_bitBuffer & 0xFF));
+                m_bitBuffer >>= 8;
+                m_bitCount -= 8;
+            }
+        }
+
+        void flushBits()
+        {
+            if (m_bitCount > 0)
+                pushByte(static_cast<uint8_t>(m_bitBuffer & 0xFF));
+            m_bitBuffer = 0;
+            m_bitCount = 0;
+        }
+
+        void pushByte(uint8_t byte)
+        {
+            m_block[m_blockSize++] = byte;
+            if (m_blockSize == 255)
+                flushBlock();
+        }
+
+        void flushBlock()
+        {
+            if (m_blockSize == 0)
+                return;
+            m_out.push_back(static_cast<uint8_t>(m_blockSize));
+            m_out.insert(m_out.end(), m_block, m_block + m_blockSize);
+            m_blockSize = 0;
+        }
+
+        std::vector<uint8_t> &m_out;
+        int m_minCodeSize;
+        int m_clearCode;
+        int m_codeSize{0};
+        int m_maxCode{0};
+        std::vector<uint16_t> m_dictionary;
+        uint32_t m_bitBuffer{0};
+        int m_bitCount{0};
+        uint8_t m_block[255];
+        int m_blockSize{0};
+    };
+
+    } // namespace
+
+    static void putU16(std::vector<uint8_t> &out, int value)
+    {
+        out.push_back(static_cast<uint8_t>(value & 0xFF));
+        out.push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
+    }
+
+    bool GifExporter::write(const std::string &path, const Options &options)
+    {
+        if (m_frames.empty())
+        {
+            Logger::error("No frames to export");
+            return false;
+        }
+
+        auto exportStart = std::chrono::steady_clock::now();
+        const int width = m_frames[0].pixels.width;
+        const int height = m_frames[0].pixels.height;
+        const int fps = std::max(1, options.fps);
+        const int threads = options.threads > 0 ? options.threads
+                                                : std::max(1u, std::thread::hardware_concurrency());
+
+        buildPalette(std::clamp(options.maxColors, 2, 256));
+        buildLookupTable(m_palette, m_lookup);
+
+        int tableBits = 1;
+        while ((1 << tableBits) < static_cast<int>(m_palette.size()))
+            tableBits++;
+
+        std::vector<uint8_t> out;
+        out.reserve(1 << 20);
+
+        // Header, logical screen descriptor and global colour table
+        const char *header = "GIF89a";
+        out.insert(out.end(), header, header + 6);
+        putU16(out, width);
+        putU16(out, height);
+        out.push_back(static_cast<uint8_t>(0x80 | (7 << 4) | (tableBits - 1)));
+        out.push_back(0); // Background colour
+        out.push_back(0); // Pixel aspect ratio
+        for (int i = 0; i < (1 << tableBits); ++i)
+        {
+            const auto &p = m_palette[std::min<size_t>(i, m_palette.size() - 1)];
+            out.insert(out.end(), p.begin(), p.end());
+        }
+
+        // Loop forever
+        const uint8_t loop[] = {0x21, 0xFF, 0x0B, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0',
+                                0x03, 0x01, 0x00, 0x00, 0x00};
+        out.insert(out.end(), loop, loop + sizeof(loop));
+
+        std::vector<uint8_t> indices;
+        size_t written = 0;
+        for (size_t i = 0; i < m_frames.size(); ++i)
+        {
+            const Frame &frame = m_frames[i];
+            if (frame.changed.isEmpty() && i > 0)
+            {
+                continue; // Unchanged frames only extend the previous frame's delay
+            }
+
+            // Delay runs until the next frame that changes anything
+            size_t next = i + 1;
+            while (next < m_frames.size() && m_frames[next].changed.isEmpty())
+                next++;
+            int delay = static_cast<int>(std::lround(next * 100.0 / fps) - std::lround(i * 100.0 / fps));
+
+            Rect region = frame.changed.isEmpty() ? Rect(0, 0, width, height) : frame.changed;
+
+            // Graphic control extension: disposal "do not dispose" keeps earlier pixels
+            out.insert(out.end(), {0x21, 0xF9, 0x04, 0x04});
+            putU16(out, std::max(delay, 2));
+            out.insert(out.end(), {0x00, 0x00});
+
+            // Image descriptor for the changed rectangle only
+            out.push_back(0x2C);
+            putU16(out, region.x);
+            putU16(out, region.y);
+            putU16(out, region.width);
+            putU16(out, region.height);
+            out.push_back(0x00);
+
+            quantizeRegion(frame.pixels, region, options.dither, threads, indices);
+            GifLzwWriter(out, std::max(2, tableBits)).encode(indices.data(), indices.size());
+            written++;
+        }
+
+        out.push_back(0x3B); // Trailer
+
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char *>(out.data()), static_cast<std::streamsize>(out.size()));
+        if (!file)
+        {
+            Logger::error("Failed to write GIF file: " + path);
+            return false;
+        }
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::steady_clock::now() - exportStart)
+                           .count();
+        Logger::info("GIF saved: " + path + " (" + std::to_string(width) + "x" + std::to_string(height) + ", " +
+                     std::to_string(m_frames.size()) + " frames, " + std::to_string(written) + " written, " +
+                     std::to_string(m_palette.size()) + " colors, " + std::to_string(out.size() / 1024) +
+                     " KB) in " + std::to_string(elapsed) + " ms");
+        return true;
+    }
+
+    bool GifExporter::exportRecording(const std::string &input, double start, double end,
+                                      const std::string &output, int maxWidth, const Options &options)
+    {
+        MediaInfo info;
+        if (end <= start || !MediaProbe::probe(input, info))
+        {
+            return false;
+        }
+
+        int width = info.width, height = info.height;
+        if (maxWidth > 0 && width > maxWidth)
+        {
+            FrameScaler::calculateScaledDimensions(info.width, info.height, maxWidth,
+                                                   info.height * maxWidth / info.width, width, height);
+        }
+
+        std::ostringstream seek, duration;
+        seek << std::fixed << std::setprecision(6) << start;
+        duration << std::fixed << std::setprecision(6) << (end - start);
+
+        Subprocess decoder;
+        if (!decoder.start({"ffmpeg", "-v", "error", "-nostdin",
+                            "-ss", seek.str(), "-i", input, "-t", duration.str(),
+                            "-vf", "fps=" + std::to_string(std::max(1, options.fps)) + ",scale=" +
+                                       std::to_string(width) + ":" + std::to_string(height),
+                            "-f", "rawvideo", "-pix_fmt", "rgb24", "pipe:1"},
+                           Subprocess::PIPE_STDOUT))
+        {
+            return false;
+        }
+
+        GifExporter exporter;
+        FrameBuffer frame;
+        frame.allocate(width, height);
+        while (decoder.readExact(frame.data, frame.size))
+        {
+            exporter.addFrame(frame);
+        }
+        decoder.wait();
+
+        return exporter.write(output, options);
+    }
+
+} // namespace NanoRec
@@ -0,0 +1,158 @@
+#include "core/MediaProbe.hpp"
+#include "core/Logger.hpp"
+#include "core/Subprocess.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+
+namespace NanoRec
+{
+
+    double MediaInfo::keyframeAtOrBefore(double seconds) const
+    {
+        auto it = std::upper_bound(keyframes.begin(), keyframes.end(), seconds);
+        if (it == keyframes.begin())
+        {
+            return 0.0;
+        }
+        return *(it - 1);
+    }
+
+    double MediaInfo::keyframeAtOrAfter(double seconds) const
+    {
+        auto it = std::lower_bound(keyframes.begin(), keyframes.end(), seconds);
+        if (it == keyframes.end())
+        {
+            return duration;
+        }
+        return *it;
+    }
+
+    static double parseRate(const std::string &rate)
+    {
+        // ffprobe reports rates as "num/den"
+        size_t slash = rate.find('/');
+        if (slash == std::string::npos)
+        {
+            return std::atof(rate.c_str());
+        }
+
+        double num = std::atof(rate.substr(0, slash).c_str());
+        double den = std::atof(rate.substr(slash + 1).c_str());
+        return den > 0.0 ? num / den : 0.0;
+    }
+
+    bool MediaProbe::probe(const std::string &path, MediaInfo &info, bool withKeyframes)
+    {
+        // Sections are kept ([STREAM] ... [/STREAM]) to tell the video stream from audio ones
+        std::string output;
+        if (!Subprocess::run({"ffprobe", "-v", "error",
+                              "-show_entries",
+                              "stream=codec_type,codec_name,profile,level,pix_fmt,width,height,avg_frame_rate"
+                              ":format=duration",
+                              "-of", "default",
+                              path},
+                             output))
+        {
+            Logger::error("ffprobe failed for: " + path);
+            return false;
+        }
+
+        info = MediaInfo();
+
+        std::istringstream lines(output);
+        std::string line;
+        std::map<std::string, std::string> stream;
+        bool inStream = false;
+        bool videoFound = false;
+        while (std::getline(lines, line))
+        {
+            if (line == "[STREAM]")
+            {
+                stream.clear();
+                inStream = true;
+                continue;
+            }
+            if (line == "[/STREAM]")
+            {
+                inStream = false;
+                if (stream["codec_type"] == "audio")
+                {
+                    info.hasAudio = true;
+                }
+                else if (stream["codec_type"] == "video" && !videoFound)
+                {
+                    videoFound = true;
+                    info.width = std::atoi(stream["width"].c_str());
+                    info.height = std::atoi(stream["height"].c_str());
+                    info.fps = parseRate(stream["avg_frame_rate"]);
+                    info.codec = stream["codec_name"];
+                    info.profile = stream["profile"] == "unknown" ? "" : stream["profile"];
+                    info.level = std::max(0, std::atoi(stream["level"].c_str()));
+                    info.pixelFormat = stream["pix_fmt"] == "unknown" ? "" : stream["pix_fmt"];
+                }
+                continue;
+            }
+
+            size_t eq = line.find('=');
+            if (eq == std::string::npos)
+            {
+                continue;
+            }
+
+            std::string key = line.substr(0, eq);
+            std::string value = line.substr(eq + 1);
+            if (inStream)
+                stream[key] = value;
+            else if (key == "duration")
+                info.duration = std::atof(value.c_str());
+        }
+
+        if (info.width <= 0 || info.height <= 0 || info.fps <= 0.0)
+        {
+            Logger::error("No usable video stream in: " + path);
+            return false;
+        }
+
+        if (withKeyframes && !readKeyframes(path, info.keyframes))
+        {
+            Logger::warning("No keyframe index for " + path + ", seeking will decode from start");
+        }
+
+        return true;
+    }
+
+    bool MediaProbe::readKeyframes(const std::string &path, std::vector<double> &keyframes)
+    {
+        // Packet flags come from the demuxer, so this never decodes a frame
+        std::string output;
+        if (!Subprocess::run({"ffprobe", "-v", "error",
+                              "-select_streams", "v:0",
+                              "-show_entries", "packet=pts_time,flags",
+                              "-of", "csv=print_section=0",
+                              path},
+                             output))
+        {
+            return false;
+        }
+
+        keyframes.clear();
+
+        std::istringstream lines(output);
+        std::string line;
+        while (std::getline(lines, line))
+        {
+            size_t comma = line.find(',');
+            if (comma == std::string::npos || comma + 1 >= line.size() || line[comma + 1] != 'K')
+            {
+                continue;
+            }
+            keyframes.push_back(std::atof(line.substr(0, comma).c_str()));
+        }
+
+        std::sort(keyframes.begin(), keyframes.end());
+        return !keyframes.empty();
+    }
+
+} // namespace NanoRec
@@ -0,0 +1,525 @@
+#include "core/MjpegPreviewServer.hpp"
+#include "core/FrameScaler.hpp"
+#include "core/Logger.hpp"
+#include "stb_image_write.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+namespace NanoRec
+{
+
+    static const char *BOUNDARY = "nanorecframe";
+
+    static void appendToString(void *context, void *data, int size)
+    {
+        static_cast<std::string *>(context)->append(static_cast<const char *>(data), size);
+    }
+
+    static int64_t steadyTicks()
+    {
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+    }
+
+    MjpegPreviewServer::MjpegPreviewServer()
+    {
+    }
+
+    MjpegPreviewServer::~MjpegPreviewServer()
+    {
+        stop();
+    }
+
+    bool MjpegPreviewServer::start(int port, int fps, int maxWidth)
+    {
+        if (m_running.load())
+        {
+            Logger::error("Preview server already running");
+            return false;
+        }
+
+        if (port <= 0 || port > 65535 || fps <= 0)
+        {
+            Logger::error("Invalid preview server configuration");
+            return false;
+        }
+
+#ifdef _WIN32
+        Logger::warning("MJPEG preview server is not supported on Windows yet");
+        return false;
+#else
+        m_listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        if (m_listenFd == -1)
+        {
+            Logger::error("Failed to create preview server socket: " + std::string(strerror(errno)));
+            return false;
+        }
+
+        int reuse = 1;
+        setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // Never expose the desktop beyond localhost
+
+        if (bind(m_listenFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == -1 ||
+            listen(m_listenFd, 8) == -1)
+        {
+            Logger::error("Failed to bind preview server to port " + std::to_string(port) + ": " +
+                          std::string(strerror(errno)));
+            close(m_listenFd);
+            m_listenFd = -1;
+            return false;
+        }
+
+        fcntl(m_listenFd, F_SETFL, fcntl(m_listenFd, F_GETFL) | O_NONBLOCK);
+
+        m_port = port;
+        m_maxWidth = maxWidth;
+        m_tickInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::microseconds(1000000 / fps));
+        m_shouldStop.store(false);
+        m_running.store(true);
+        m_thread = std::thread(&MjpegPreviewServer::serverLoop, this);
+
+        Logger::info("MJPEG preview server listening on http://127.0.0.1:" + std::to_string(port) +
+                     "/ (" + std::to_string(fps) + " FPS)");
+        return true;
+#endif
+    }
+
+    void MjpegPreviewServer::stop()
+    {
+        if (!m_running.load())
+        {
+            return;
+        }
+
+        m_shouldStop.store(true);
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+
+#ifndef _WIN32
+        for (Client &client : m_clients)
+        {
+            if (client.wait != Wait::None)
+            {
+                m_changeWaiter->unwatch();
+            }
+            close(client.fd);
+        }
+        m_clients.clear();
+
+        if (m_listenFd != -1)
+        {
+            close(m_listenFd);
+            m_listenFd = -1;
+        }
+#endif
+
+        m_clientCount.store(0);
+        m_running.store(false);
+        Logger::info("MJPEG preview server stopped");
+    }
+
+    void MjpegPreviewServer::offerFrame(const FrameBuffer &frame)
+    {
+        // Nothing is copied or encoded unless someone is watching
+        if (m_clientCount.load(std::memory_order_relaxed) == 0 || !frame.data)
+        {
+            return;
+        }
+
+        int64_t now = steadyTicks();
+        if (now < m_nextOfferTicks.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        // Never wait for the server thread: skip this tick if it holds the staging buffer
+        std::unique_lock<std::mutex> lock(m_stagingMutex, std::try_to_lock);
+        if (!lock.owns_lock())
+        {
+            return;
+        }
+
+        if (m_staging.width != frame.width || m_staging.height != frame.height || !m_staging.data)
+        {
+            m_staging.free();
+            m_staging.allocate(frame.width, frame.height);
+        }
+
+        std::memcpy(m_staging.data, frame.data, std::min(frame.size, m_staging.size));
+        m_stagingSeq++;
+        m_nextOfferTicks.store(now + m_tickInterval.count(), std::memory_order_relaxed);
+    }
+
+    std::shared_ptr<const std::string> MjpegPreviewServer::encodeStagedFrame()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_stagingMutex);
+            if (m_stagingSeq == m_encodedSeq || !m_staging.data)
+            {
+                return nullptr;
+            }
+
+            // Swap instead of copying so the capture thread's critical section stays tiny
+            std::swap(m_staging, m_encodeSource);
+            m_encodedSeq = m_stagingSeq;
+        }
+
+        const FrameBuffer *source = &m_encodeSource;
+        if (m_maxWidth > 0 && m_encodeSource.width > m_maxWidth)
+        {
+            int targetHeight = (m_encodeSource.height * m_maxWidth / m_encodeSource.width) & ~1;
+            if (FrameScaler::scaleFrame(m_encodeSource, m_scaled, m_maxWidth, targetHeight))
+            {
+                source = &m_scaled;
+            }
+        }
+
+        std::string jpeg;
+        jpeg.reserve(source->size / 8);
+        if (!stbi_write_jpg_to_func(appendToString, &jpeg, source->width, source->height, 3,
+                                    source->data, m_quality))
+        {
+            Logger::warning("Failed to encode preview frame as JPEG");
+            return nullptr;
+        }
+
+        auto part = std::make_shared<std::string>();
+        part->reserve(jpeg.size() + 128);
+        *part += "--";
+        *part += BOUNDARY;
+        *part += "\r\nContent-Type: image/jpeg\r\nContent-Length: " + std::to_string(jpeg.size()) + "\r\n\r\n";
+        *part += jpeg;
+        *part += "\r\n";
+        return part;
+    }
+
+#ifdef _WIN32
+
+    void MjpegPreviewServer::serverLoop() {}
+    void MjpegPreviewServer::acceptClients() {}
+    bool MjpegPreviewServer::readRequest(Client &) { return false; }
+    bool MjpegPreviewServer::flushClient(Client &) { return false; }
+    void MjpegPreviewServer::beginWait(Client &) {}
+    void MjpegPreviewServer::serviceWaits() {}
+    void MjpegPreviewServer::endWait(Client &, const char *) {}
+
+#else
+
+    void MjpegPreviewServer::acceptClients()
+    {
+        while (true)
+        {
+            int fd = accept(m_listenFd, nullptr, nullptr);
+            if (fd == -1)
+            {
+                return;
+            }
+
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            Client client;
+            client.fd = fd;
+            m_clients.push_back(std::move(client));
+        }
+    }
+
+    bool MjpegPreviewServer::readRequest(Client &client)
+    {
+        char buffer[1024];
+        ssize_t n = recv(client.fd, buffer, sizeof(buffer), 0);
+        if (n == 0 || (n == -1 && errno != EAGAIN && errno != EWOULDBLOCK))
+        {
+            return false; // Disconnected
+        }
+
+        if (n <= 0 || client.streaming || client.wait != Wait::None || client.closeAfterSend)
+        {
+            return true; // Answered clients may send anything; we ignore it
+        }
+
+        client.request.append(buffer, n);
+        if (client.request.size() > 8192)
+        {
+            return false;
+        }
+
+        if (client.request.find("\r\n\r\n") == std::string::npos)
+        {
+            return true; // Headers not complete yet
+        }
+
+        if (client.request.rfind("GET /wait/", 0) == 0)
+        {
+            beginWait(client);
+            return true;
+        }
+
+        if (client.request.rfind("GET / ", 0) != 0 && client.request.rfind("GET /stream ", 0) != 0)
+        {
+            auto response = std::make_shared<const std::string>(
+                "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+            client.pending = response;
+            client.offset = 0;
+            flushClient(client);
+            return false;
+        }
+
+        client.streaming = true;
+        client.pending = std::make_shared<const std::string>(
+            std::string("HTTP/1.0 200 OK\r\n"
+                        "Cache-Control: no-cache\r\n"
+                        "Connection: close\r\n"
+                        "Content-Type: multipart/x-mixed-replace; boundary=") +
+            BOUNDARY + "\r\n\r\n");
+        client.offset = 0;
+        m_clientCount.fetch_add(1);
+        Logger::info("Preview client connected (" + std::to_string(m_clientCount.load()) + " total)");
+        return true;
+    }
+
+    bool MjpegPreviewServer::flushClient(Client &client)
+    {
+        while (client.pending && client.offset < client.pending->size())
+        {
+            ssize_t n = send(client.fd, client.pending->data() + client.offset,
+                             client.pending->size() - client.offset, MSG_NOSIGNAL);
+            if (n == -1)
+            {
+                return errno == EAGAIN || errno == EWOULDBLOCK;
+            }
+            client.offset += static_cast<size_t>(n);
+        }
+
+        client.pending.reset();
+        client.offset = 0;
+        return true;
+    }
+
+    // Integer query parameter (e.g. "quiet" in "/wait/stable?quiet=500&w=10"), or fallback
+    static int queryInt(const std::string &query, const std::string &name, int fallback)
+    {
+        size_t pos = 0;
+        while (pos < query.size())
+        {
+            size_t end = query.find('&', pos);
+            if (end == std::string::npos)
+            {
+                end = query.size();
+            }
+            if (query.compare(pos, name.size() + 1, name + "=") == 0)
+            {
+                return std::atoi(query.c_str() + pos + name.size() + 1);
+            }
+            pos = end + 1;
+        }
+        return fallback;
+    }
+
+    void MjpegPreviewServer::beginWait(Client &client)
+    {
+        // "GET /wait/stable?x=0&y=0&w=200&h=50&quiet=500 HTTP/1.1"
+        size_t targetEnd = client.request.find(' ', 4);
+        std::string target = client.request.substr(4, targetEnd == std::string::npos ? 0 : targetEnd - 4);
+        size_t queryStart = target.find('?');
+        std::string path = target.substr(0, queryStart);
+        std::string query = queryStart == std::string::npos ? "" : target.substr(queryStart + 1);
+
+        auto reply = [&client](const std::string &status, const std::string &body)
+        {
+            client.pending = std::make_shared<const std::string>(
+                "HTTP/1.0 " + status + "\r\nContent-Type: application/json\r\nContent-Length: " +
+                std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body);
+            client.offset = 0;
+            client.closeAfterSend = true;
+        };
+
+        Wait wait = path == "/wait/stable" ? Wait::Stable : path == "/wait/change" ? Wait::Change : Wait::None;
+        if (wait == Wait::None)
+        {
+            reply("404 Not Found", "{\"error\": \"unknown wait\"}\n");
+            return;
+        }
+        if (!m_changeWaiter)
+        {
+            reply("503 Service Unavailable", "{\"error\": \"no capture attached\"}\n");
+            return;
+        }
+
+        int quietMs = queryInt(query, "quiet", 500);
+        int timeoutMs = queryInt(query, "timeout", 10000);
+        if (quietMs < 0 || timeoutMs < 0 || timeoutMs > 600000)
+        {
+            reply("400 Bad Request", "{\"error\": \"quiet and timeout must be 0..600000 ms\"}\n");
+            return;
+        }
+
+        client.wait = wait;
+        client.region = Rect(queryInt(query, "x", 0), queryInt(query, "y", 0), queryInt(query, "w", 0),
+                             queryInt(query, "h", 0));
+        client.quiet = std::chrono::milliseconds(quietMs);
+        client.waitStart = std::chrono::steady_clock::now();
+        client.waitDeadline = client.waitStart + std::chrono::milliseconds(timeoutMs);
+        m_changeWaiter->watch();
+        client.sinceFrame = m_changeWaiter->getFrameNumber();
+    }
+
+    void MjpegPreviewServer::endWait(Client &client, const char *result)
+    {
+        auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() -
+                                                                            client.waitStart);
+        std::string body = std::string("{\"result\": \"") + result +
+                           "\", \"waited_ms\": " + std::to_string(waited.count()) + "}\n";
+        client.pending = std::make_shared<const std::string>(
+            "HTTP/1.0 200 OK\r\nContent-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) +
+            "\r\nConnection: close\r\n\r\n" + body);
+        client.offset = 0;
+        client.closeAfterSend = true;
+        client.wait = Wait::None;
+        m_changeWaiter->unwatch();
+    }
+
+    void MjpegPreviewServer::serviceWaits()
+    {
+        auto now = std::chrono::steady_clock::now();
+        for (Client &client : m_clients)
+        {
+            if (client.wait == Wait::Stable && m_changeWaiter->isStable(client.region, client.quiet, client.sinceFrame))
+            {
+                endWait(client, "stable");
+            }
+            else if (client.wait == Wait::Change && m_changeWaiter->hasChanged(client.region, client.sinceFrame))
+            {
+                endWait(client, "changed");
+            }
+            else if (client.wait != Wait::None && now >= client.waitDeadline)
+            {
+                endWait(client, "timeout");
+            }
+        }
+    }
+
+    void MjpegPreviewServer::serverLoop()
+    {
+        std::vector<pollfd> fds;
+        auto nextTick = std::chrono::steady_clock::now();
+
+        while (!m_shouldStop.load())
+        {
+            fds.clear();
+            fds.push_back({m_listenFd, POLLIN, 0});
+            for (const Client &client : m_clients)
+            {
+                short events = POLLIN;
+                if (client.pending)
+                {
+                    events |= POLLOUT;
+                }
+                fds.push_back({client.fd, events, 0});
+            }
+
+            // Pending waits are re-checked every 10 ms (the waiter is fed at capture rate)
+            bool waiting = std::any_of(m_clients.begin(), m_clients.end(),
+                                       [](const Client &c) { return c.wait != Wait::None; });
+            auto now = std::chrono::steady_clock::now();
+            int timeoutMs = static_cast<int>(std::clamp<int64_t>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(nextTick - now).count(), 0,
+                waiting ? 10 : 100));
+
+            if (poll(fds.data(), fds.size(), timeoutMs) == -1 && errno != EINTR)
+            {
+                Logger::error("Preview server poll failed: " + std::string(strerror(errno)));
+                break;
+            }
+
+            // Service existing clients (fds[i + 1] belongs to m_clients[i])
+            for (size_t i = 0; i < m_clients.size(); ++i)
+            {
+                Client &client = m_clients[i];
+                short revents = fds[i + 1].revents;
+                bool alive = !(revents & (POLLERR | POLLNVAL));
+
+                if (alive && (revents & (POLLIN | POLLHUP)))
+                {
+                    alive = readRequest(client);
+                }
+                if (alive && client.pending)
+                {
+                    alive = flushClient(client);
+                }
+                if (alive && client.closeAfterSend && !client.pending)
+                {
+                    alive = false;
+                }
+
+                if (!alive)
+                {
+                    if (client.streaming)
+                    {
+                        m_clientCount.fetch_sub(1);
+                        Logger::info("Preview client disconnected");
+                    }
+                    if (client.wait != Wait::None)
+                    {
+                        m_changeWaiter->unwatch();
+                    }
+                    close(client.fd);
+                    client.fd = -1;
+                }
+            }
+
+            m_clients.erase(std::remove_if(m_clients.begin(), m_clients.end(),
+                                           [](const Client &c) { return c.fd == -1; }),
+                            m_clients.end());
+
+            if (fds[0].revents & POLLIN)
+            {
+                acceptClients();
+            }
+
+            serviceWaits();
+
+            // One encode per tick, shared by every client that is ready for it
+            now = std::chrono::steady_clock::now();
+            if (now >= nextTick)
+            {
+                nextTick = now + m_tickInterval;
+
+                if (m_clientCount.load() > 0)
+                {
+                    std::shared_ptr<const std::string> part = encodeStagedFrame();
+                    if (part)
+                    {
+                        for (Client &client : m_clients)
+                        {
+                            // Slow clients still sending an older frame simply skip this one
+                            if (client.streaming && !client.pending)
+                            {
+                                client.pending = part;
+                                client.offset = 0;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+#endif
+
+} // namespace NanoRec
@@ -0,0 +1,508 @@
+#include "core/RecordingLibrary.hpp"
+#include "core/Logger.hpp"
+#include "core/MediaProbe.hpp"
+#include "core/Subprocess.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <sstream>
+#include <unordered_set>
+
+namespace NanoRec
+{
+
+    static const char *INDEX_MAGIC = "NANOREC_LIBRARY";
+    static const int INDEX_VERSION = 1;
+
+    static bool isVideoFile(const std::filesystem::path &path)
+    {
+        std::string ext = path.extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c)
+                       { return static_cast<char>(std::tolower(c)); });
+        return ext == ".mp4" || ext == ".mkv" || ext == ".mov" || ext == ".webm" || ext == ".avi";
+    }
+
+    RecordingLibrary::RecordingLibrary() = default;
+
+    RecordingLibrary::~RecordingLibrary()
+    {
+        close();
+    }
+
+    bool RecordingLibrary::open(const std::string &directory)
+    {
+        namespace fs = std::filesystem;
+
+        close();
+
+        std::error_code ec;
+        fs::path cacheDir = fs::path(directory) / ".nanorec";
+        fs::create_directories(cacheDir, ec);
+        if (ec)
+        {
+            Logger::error("Failed to create library cache directory: " + cacheDir.string());
+            return false;
+        }
+
+        m_directory = directory;
+        m_indexPath = (cacheDir / "library.idx").string();
+        m_atlasPath = (cacheDir / "thumbnails.rgb").string();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_entries.clear();
+            m_entryByName.clear();
+            m_requests.clear();
+            m_freeSlots.clear();
+            m_slotCount = 0;
+            m_generation++;
+            m_rescanRequested = false;
+            m_indexDirty = false;
+        }
+
+        m_shouldStop.store(false);
+        m_running.store(true);
+        m_scanning.store(true);
+        m_thread = std::thread(&RecordingLibrary::workerLoop, this);
+        return true;
+    }
+
+    void RecordingLibrary::close()
+    {
+        if (!m_running.load())
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_shouldStop.store(true);
+        }
+        m_cv.notify_all();
+
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+
+        std::lock_guard<std::mutex> atlasLock(m_atlasMutex);
+        if (m_atlas.is_open())
+        {
+            m_atlas.close();
+        }
+        m_running.store(false);
+    }
+
+    void RecordingLibrary::rescan()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_rescanRequested = true;
+        }
+        m_cv.notify_one();
+    }
+
+    void RecordingLibrary::requestDetails(const std::vector<std::string> &filenames)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_requests = filenames;
+        }
+        m_cv.notify_one();
+    }
+
+    bool RecordingLibrary::snapshot(std::vector<LibraryEntry> &entries, uint64_t &generation) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (generation == m_generation)
+        {
+            return false;
+        }
+        entries = m_entries;
+        generation = m_generation;
+        return true;
+    }
+
+    bool RecordingLibrary::readThumbnail(int slot, uint8_t *rgb) const
+    {
+        if (slot < 0 || rgb == nullptr)
+        {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(m_atlasMutex);
+        if (!m_atlas.is_open())
+        {
+            return false;
+        }
+
+        m_atlas.clear();
+        m_atlas.seekg(static_cast<std::streamoff>(slot) * THUMB_BYTES);
+        m_atlas.read(reinterpret_cast<char *>(rgb), THUMB_BYTES);
+        return m_atlas.gcount() == static_cast<std::streamsize>(THUMB_BYTES);
+    }
+
+    bool RecordingLibrary::writeThumbnail(int slot, const uint8_t *rgb)
+    {
+        std::lock_guard<std::mutex> lock(m_atlasMutex);
+        if (!m_atlas.is_open())
+        {
+            return false;
+        }
+
+        m_atlas.clear();
+        m_atlas.seekp(static_cast<std::streamoff>(slot) * THUMB_BYTES);
+        m_atlas.write(reinterpret_cast<const char *>(rgb), THUMB_BYTES);
+        m_atlas.flush();
+        return !m_atlas.fail();
+    }
+
+    int RecordingLibrary::allocateSlot()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_freeSlots.empty())
+        {
+            // Lowest free slot first keeps the atlas file compact
+            auto lowest = std::min_element(m_freeSlots.begin(), m_freeSlots.end());
+            int slot = *lowest;
+            m_freeSlots.erase(lowest);
+            return slot;
+        }
+        return m_slotCount++;
+    }
+
+    void RecordingLibrary::workerLoop()
+    {
+        auto scanStart = std::chrono::steady_clock::now();
+
+        {
+            std::lock_guard<std::mutex> lock(m_atlasMutex);
+            // Create the atlas if missing, then open it for random access
+            if (!std::filesystem::exists(m_atlasPath))
+            {
+                std::ofstream(m_atlasPath, std::ios::binary);
+            }
+            m_atlas.open(m_atlasPath, std::ios::in | std::ios::out | std::ios::binary);
+            if (!m_atlas.is_open())
+            {
+                Logger::warning("Thumbnail atlas unavailable: " + m_atlasPath);
+            }
+        }
+
+        loadIndex();
+        scanDirectory();
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::steady_clock::now() - scanStart)
+                           .count();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Logger::info("Library indexed " + std::to_string(m_entries.size()) + " recordings in " +
+                         std::to_string(elapsed) + " ms (" + m_directory + ")");
+        }
+
+        while (true)
+        {
+            LibraryEntry entry;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                if (m_requests.empty() && m_indexDirty)
+                {
+                    // Idle: persist what was extracted so far
+                    lock.unlock();
+                    saveIndex();
+                    lock.lock();
+                }
+
+                m_cv.wait(lock, [this]
+                          { return m_shouldStop.load() || m_rescanRequested || !m_requests.empty(); });
+                if (m_shouldStop.load())
+                {
+                    break;
+                }
+
+                if (m_rescanRequested)
+                {
+                    m_rescanRequested = false;
+                    lock.unlock();
+                    scanDirectory();
+                    continue;
+                }
+
+                std::string name = m_requests.front();
+                m_requests.erase(m_requests.begin());
+
+                auto it = m_entryByName.find(name);
+                if (it == m_entryByName.end())
+                {
+                    continue;
+                }
+                const LibraryEntry &current = m_entries[it->second];
+                if (current.hasDetails || current.detailsFailed)
+                {
+                    continue;
+                }
+                entry = current;
+            }
+
+            bool extracted = extractDetails(entry);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_entryByName.find(entry.filename);
+            if (it != m_entryByName.end() && m_entries[it->second].size == entry.size &&
+                m_entries[it->second].modified == entry.modified)
+            {
+                m_entries[it->second] = entry;
+                m_generation++;
+                m_indexDirty = m_indexDirty || extracted;
+            }
+            else if (entry.thumbnailSlot >= 0)
+            {
+                // Entry vanished or changed during extraction
+                m_freeSlots.push_back(entry.thumbnailSlot);
+            }
+        }
+
+        saveIndex();
+    }
+
+    void RecordingLibrary::scanDirectory()
+    {
+        namespace fs = std::filesystem;
+
+        m_scanning.store(true);
+
+        std::unordered_map<std::string, LibraryEntry> known;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (const LibraryEntry &entry : m_entries)
+            {
+                known.emplace(entry.filename, entry);
+            }
+        }
+
+        std::vector<LibraryEntry> entries;
+        std::error_code ec;
+        for (fs::directory_iterator it(m_directory, ec), end; !ec && it != end; it.increment(ec))
+        {
+            std::error_code statError;
+            if (!it->is_regular_file(statError) || !isVideoFile(it->path()))
+            {
+                continue;
+            }
+
+            LibraryEntry entry;
+            entry.filename = it->path().filename().string();
+            entry.size = it->file_size(statError);
+            entry.modified = std::chrono::duration_cast<std::chrono::seconds>(
+                                 it->last_write_time(statError).time_since_epoch())
+                                 .count();
+            if (statError)
+            {
+                continue;
+            }
+
+            auto cached = known.find(entry.filename);
+            if (cached != known.end() && cached->second.size == entry.size &&
+                cached->second.modified == entry.modified)
+            {
+                entry = cached->second;
+                entry.detailsFailed = false; // Retry failed probes on rescan
+            }
+            entries.push_back(std::move(entry));
+        }
+
+        if (ec)
+        {
+            Logger::warning("Failed to list recordings directory: " + m_directory);
+        }
+
+        std::sort(entries.begin(), entries.end(), [](const LibraryEntry &a, const LibraryEntry &b)
+                  { return a.modified != b.modified ? a.modified > b.modified : a.filename < b.filename; });
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // Slots of deleted or modified recordings become reusable
+        std::unordered_set<int> usedSlots;
+        for (const LibraryEntry &entry : entries)
+        {
+            if (entry.thumbnailSlot >= 0)
+            {
+                usedSlots.insert(entry.thumbnailSlot);
+            }
+        }
+        m_freeSlots.clear();
+        for (int slot = 0; slot < m_slotCount; ++slot)
+        {
+            if (usedSlots.count(slot) == 0)
+            {
+                m_freeSlots.push_back(slot);
+            }
+        }
+
+        m_indexDirty = m_indexDirty || entries.size() != m_entries.size() || !m_freeSlots.empty();
+        m_entries = std::move(entries);
+        m_entryByName.clear();
+        for (size_t i = 0; i < m_entries.size(); ++i)
+        {
+            m_entryByName[m_entries[i].filename] = i;
+        }
+        m_generation++;
+        m_scanning.store(false);
+    }
+
+    bool RecordingLibrary::extractDetails(LibraryEntry &entry)
+    {
+        std::string path = (std::filesystem::path(m_directory) / entry.filename).string();
+
+        MediaInfo info;
+        if (!MediaProbe::probe(path, info))
+        {
+            entry.detailsFailed = true;
+            return false;
+        }
+
+        entry.duration = info.duration;
+        entry.width = info.width;
+        entry.height = info.height;
+        entry.fps = info.fps;
+        entry.hasDetails = true;
+
+        // Grab a frame a little way in (the first frame is often a blank desktop)
+        double seekTime = std::min(info.duration * 0.1, 5.0);
+        std::ostringstream seek;
+        seek << seekTime;
+
+        std::string filter = "scale=" + std::to_string(THUMB_WIDTH) + ":" + std::to_string(THUMB_HEIGHT) +
+                             ":force_original_aspect_ratio=decrease,pad=" + std::to_string(THUMB_WIDTH) +
+                             ":" + std::to_string(THUMB_HEIGHT) + ":(ow-iw)/2:(oh-ih)/2";
+
+        Subprocess process;
+        if (!process.start({"ffmpeg", "-v", "error", "-nostdin",
+                            "-ss", seek.str(), "-i", path,
+                            "-frames:v", "1", "-vf", filter,
+                            "-f", "rawvideo", "-pix_fmt", "rgb24", "pipe:1"},
+                           Subprocess::PIPE_STDOUT))
+        {
+            return true;
+        }
+
+        std::vector<uint8_t> thumbnail(THUMB_BYTES);
+        bool haveFrame = process.readExact(thumbnail.data(), thumbnail.size());
+        process.wait();
+        if (!haveFrame)
+        {
+            Logger::warning("Failed to extract thumbnail: " + path);
+            return true;
+        }
+
+        int slot = allocateSlot();
+        if (writeThumbnail(slot, thumbnail.data()))
+        {
+            entry.thumbnailSlot = slot;
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_freeSlots.push_back(slot);
+        }
+        return true;
+    }
+
+    bool RecordingLibrary::loadIndex()
+    {
+        std::ifstream file(m_indexPath);
+        if (!file.is_open())
+        {
+            return false;
+        }
+
+        std::string magic;
+        int version = 0, thumbWidth = 0, thumbHeight = 0, slotCount = 0;
+        file >> magic >> version >> thumbWidth >> thumbHeight >> slotCount;
+        if (magic != INDEX_MAGIC || version != INDEX_VERSION ||
+            thumbWidth != THUMB_WIDTH || thumbHeight != THUMB_HEIGHT || slotCount < 0)
+        {
+            Logger::warning("Ignoring incompatible library index: " + m_indexPath);
+            return false;
+        }
+
+        std::vector<LibraryEntry> entries;
+        std::string line;
+        std::getline(file, line);
+        while (std::getline(file, line))
+        {
+            // filename \t size \t modified \t hasDetails \t duration \t width \t height \t fps \t slot
+            size_t tab = line.find('\t');
+            if (tab == std::string::npos || tab == 0)
+            {
+                continue;
+            }
+
+            LibraryEntry entry;
+            entry.filename = line.substr(0, tab);
+            std::istringstream fields(line.substr(tab + 1));
+            int hasDetails = 0;
+            if (!(fields >> entry.size >> entry.modified >> hasDetails >> entry.duration >>
+                  entry.width >> entry.height >> entry.fps >> entry.thumbnailSlot))
+            {
+                continue;
+            }
+            entry.hasDetails = hasDetails != 0;
+            if (entry.thumbnailSlot >= slotCount)
+            {
+                entry.thumbnailSlot = -1;
+            }
+            entries.push_back(std::move(entry));
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries = std::move(entries);
+        m_slotCount = slotCount;
+        return true;
+    }
+
+    bool RecordingLibrary::saveIndex()
+    {
+        std::vector<LibraryEntry> entries;
+        int slotCount = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            entries = m_entries;
+            slotCount = m_slotCount;
+            m_indexDirty = false;
+        }
+
+        // Write to a temporary file and rename so a crash never leaves a torn index
+        std::string tempPath = m_indexPath + ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::trunc);
+            if (!file.is_open())
+            {
+                Logger::error("Failed to write library index: " + tempPath);
+                return false;
+            }
+
+            file << INDEX_MAGIC << ' ' << INDEX_VERSION << ' ' << THUMB_WIDTH << ' ' << THUMB_HEIGHT << ' '
+                 << slotCount << '\n';
+            file.precision(17);
+            for (const LibraryEntry &entry : entries)
+            {
+                file << entry.filename << '\t' << entry.size << ' ' << entry.modified << ' '
+                     << (entry.hasDetails ? 1 : 0) << ' ' << entry.duration << ' ' << entry.width << ' '
+                     << entry.height << ' ' << entry.fps << ' ' << entry.thumbnailSlot << '\n';
+            }
+
+            if (!file.good())
+            {
+                return false;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tempPath, m_indexPath, ec);
+        return !ec;
+    }
+
+} // namespace NanoRec
@@ -0,0 +1,279 @@
+#include "core/RecordingPlayer.hpp"
+#include "core/FrameScaler.hpp"
+#include "core/Logger.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace NanoRec
+{
+
+    RecordingPlayer::RecordingPlayer()
+    {
+    }
+
+    RecordingPlayer::~RecordingPlayer()
+    {
+        close();
+    }
+
+    bool RecordingPlayer::open(const std::string &path, int maxWidth, size_t cacheBudgetBytes)
+    {
+        close();
+
+        if (!MediaProbe::probe(path, m_info, true))
+        {
+            Logger::error("Cannot open recording: " + path);
+            return false;
+        }
+
+        m_path = path;
+        m_decodeWidth = m_info.width;
+        m_decodeHeight = m_info.height;
+        if (maxWidth > 0 && m_info.width > maxWidth)
+        {
+            // Scrubbing only needs preview resolution; decoding smaller keeps the cache deep
+            FrameScaler::calculateScaledDimensions(m_info.width, m_info.height, maxWidth,
+                                                   m_info.height * maxWidth / m_info.width,
+                                                   m_decodeWidth, m_decodeHeight);
+        }
+
+        m_cacheBudget = cacheBudgetBytes;
+        m_prefetchFrames = std::max(1, static_cast<int>(m_info.fps * 2.0));
+        m_frameCount.store(std::max(1, m_info.getFrameCount()));
+        m_playhead.store(0);
+        m_decodePos = -1;
+
+        m_shouldStop.store(false);
+        m_running.store(true);
+        m_thread = std::thread(&RecordingPlayer::decodeLoop, this);
+
+        Logger::info("Opened recording: " + path + " (" + std::to_string(m_info.width) + "x" +
+                     std::to_string(m_info.height) + ", " + std::to_string(m_frameCount.load()) +
+                     " frames, " + std::to_string(m_info.keyframes.size()) + " keyframes)");
+        return true;
+    }
+
+    void RecordingPlayer::close()
+    {
+        if (!m_running.load())
+        {
+            return;
+        }
+
+        m_shouldStop.store(true);
+        {
+            // Unblock a decode thread waiting on the pipe
+            std::lock_guard<std::mutex> lock(m_decoderMutex);
+            m_decoder.interrupt();
+        }
+        m_wakeDecoder.notify_all();
+
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+
+        m_decoder.kill();
+
+        std::lock_guard<std::mutex> lock(m_cacheMutex);
+        m_cache.clear();
+        m_lru.clear();
+        m_pool.clear();
+        m_running.store(false);
+    }
+
+    void RecordingPlayer::setPlayhead(int frameIndex)
+    {
+        frameIndex = std::clamp(frameIndex, 0, m_frameCount.load() - 1);
+        if (m_playhead.exchange(frameIndex) != frameIndex)
+        {
+            m_wakeDecoder.notify_one();
+        }
+    }
+
+    std::shared_ptr<const FrameBuffer> RecordingPlayer::getFrame(int frameIndex, int &actualIndex)
+    {
+        std::lock_guard<std::mutex> lock(m_cacheMutex);
+
+        actualIndex = -1;
+        auto it = m_cache.upper_bound(frameIndex);
+        if (it == m_cache.begin())
+        {
+            return nullptr;
+        }
+        --it;
+
+        // Mark as recently used
+        m_lru.splice(m_lru.begin(), m_lru, it->second.lruPos);
+
+        actualIndex = it->first;
+        return it->second.frame;
+    }
+
+    size_t RecordingPlayer::getCachedFrameCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_cacheMutex);
+        return m_cache.size();
+    }
+
+    int RecordingPlayer::findFirstMissing(int from, int to) const
+    {
+        std::lock_guard<std::mutex> lock(m_cacheMutex);
+        for (int i = from; i < to; ++i)
+        {
+            if (m_cache.find(i) == m_cache.end())
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    std::shared_ptr<FrameBuffer> RecordingPlayer::acquireBuffer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_cacheMutex);
+            while (!m_pool.empty())
+            {
+                std::shared_ptr<FrameBuffer> buffer = std::move(m_pool.back());
+                m_pool.pop_back();
+                // Only recycle buffers the UI is no longer displaying
+                if (buffer.use_count() == 1)
+                {
+                    return buffer;
+                }
+            }
+        }
+
+        auto buffer = std::make_shared<FrameBuffer>();
+        buffer->allocate(m_decodeWidth, m_decodeHeight);
+        return buffer;
+    }
+
+    void RecordingPlayer::insertFrame(int frameIndex, std::shared_ptr<FrameBuffer> frame)
+    {
+        std::lock_guard<std::mutex> lock(m_cacheMutex);
+
+        if (m_cache.count(frameIndex))
+        {
+            m_pool.push_back(std::move(frame));
+            return;
+        }
+
+        m_lru.push_front(frameIndex);
+        m_cache[frameIndex] = CacheEntry{std::move(frame), m_lru.begin()};
+
+        size_t frameBytes = static_cast<size_t>(m_decodeWidth) * m_decodeHeight * 3;
+        size_t maxFrames = std::max<size_t>(static_cast<size_t>(m_prefetchFrames) + 1, m_cacheBudget / frameBytes);
+
+        while (m_cache.size() > maxFrames)
+        {
+            int victim = m_lru.back();
+            m_lru.pop_back();
+
+            auto it = m_cache.find(victim);
+            m_pool.push_back(std::move(it->second.frame));
+            m_cache.erase(it);
+        }
+
+        // Keep the pool small; the rest is released
+        if (m_pool.size() > 8)
+        {
+            m_pool.resize(8);
+        }
+    }
+
+    bool RecordingPlayer::restartDecoder(int frameIndex)
+    {
+        double keyframeTime = m_info.keyframeAtOrBefore(frameIndex / m_info.fps);
+
+        std::ostringstream seek;
+        seek << std::fixed << std::setprecision(6) << keyframeTime;
+
+        std::vector<std::string> args = {"ffmpeg", "-v", "error", "-nostdin",
+                                         "-ss", seek.str(), "-i", m_path};
+        if (m_decodeWidth != m_info.width || m_decodeHeight != m_info.height)
+        {
+            args.push_back("-vf");
+            args.push_back("scale=" + std::to_string(m_decodeWidth) + ":" + std::to_string(m_decodeHeight));
+        }
+        args.insert(args.end(), {"-f", "rawvideo", "-pix_fmt", "rgb24", "pipe:1"});
+
+        std::lock_guard<std::mutex> lock(m_decoderMutex);
+        if (m_shouldStop.load())
+        {
+            return false;
+        }
+
+        m_decoder.kill();
+        if (!m_decoder.start(args, Subprocess::PIPE_STDOUT))
+        {
+            Logger::error("Failed to start ffmpeg decoder");
+            return false;
+        }
+
+        m_decodePos = static_cast<int>(keyframeTime * m_info.fps + 0.5);
+        return true;
+    }
+
+    void RecordingPlayer::decodeLoop()
+    {
+        const size_t frameBytes = static_cast<size_t>(m_decodeWidth) * m_decodeHeight * 3;
+
+        while (!m_shouldStop.load())
+        {
+            int target = m_playhead.load();
+            int end = std::min(target + m_prefetchFrames, m_frameCount.load());
+            int missing = findFirstMissing(target, end);
+
+            if (missing == -1)
+            {
+                // Everything around the playhead is cached; sleep until it moves
+                std::unique_lock<std::mutex> lock(m_cacheMutex);
+                m_wakeDecoder.wait_for(lock, std::chrono::milliseconds(100), [&]
+                                       { return m_shouldStop.load() || m_playhead.load() != target; });
+                continue;
+            }
+
+            // Seek when the frame is behind the decoder or a keyframe closer to it lies ahead
+            int missingKeyframe = static_cast<int>(m_info.keyframeAtOrBefore(missing / m_info.fps) * m_info.fps + 0.5);
+            bool needSeek = !m_decoder.isRunning() || m_decodePos > missing || missingKeyframe > m_decodePos;
+
+            if (needSeek && !restartDecoder(missing))
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                continue;
+            }
+
+            std::shared_ptr<FrameBuffer> frame = acquireBuffer();
+            if (!m_decoder.readExact(frame->data, frameBytes))
+            {
+                if (m_shouldStop.load())
+                {
+                    break;
+                }
+
+                // End of stream: trust the decoder over the probed duration
+                {
+                    std::lock_guard<std::mutex> lock(m_decoderMutex);
+                    m_decoder.wait();
+                }
+                if (m_decodePos > 0 && m_decodePos < m_frameCount.load())
+                {
+                    m_frameCount.store(m_decodePos);
+                }
+                else if (m_decodePos <= 0)
+                {
+                    Logger::error("Decoder produced no frames for: " + m_path);
+                    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+                }
+                continue;
+            }
+
+            insertFrame(m_decodePos, std::move(frame));
+            m_decodePos++;
+        }
+    }
+
+} // namespace NanoRec
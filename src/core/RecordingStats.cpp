@@ -0,0 +1,322 @@
+#include "core/RecordingStats.hpp"
+#include "core/Logger.hpp"
+#include "core/WorkerPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace NanoRec
+{
+
+    void LatencyHistogram::add(double microseconds)
+    {
+        microseconds = std::max(0.0, microseconds);
+        int bucket = 0;
+        if (microseconds > 1.0)
+        {
+            bucket = static_cast<int>(std::ceil(std::log2(microseconds) * BUCKETS_PER_OCTAVE));
+            bucket = std::min(bucket, BUCKET_COUNT - 1);
+        }
+
+        m_buckets[bucket]++;
+        m_count++;
+        m_sum += microseconds;
+        m_max = std::max(m_max, microseconds);
+    }
+
+    double LatencyHistogram::getPercentile(double fraction) const
+    {
+        if (m_count == 0)
+        {
+            return 0.0;
+        }
+
+        uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(fraction, 0.0, 1.0) * m_count));
+        rank = std::max<uint64_t>(rank, 1);
+        uint64_t seen = 0;
+        for (int bucket = 0; bucket < BUCKET_COUNT; ++bucket)
+        {
+            seen += m_buckets[bucket];
+            if (seen >= rank)
+            {
+                return std::min(m_max, std::exp2(static_cast<double>(bucket) / BUCKETS_PER_OCTAVE));
+            }
+        }
+        return m_max;
+    }
+
+    // CPU time of one thread in seconds, -1 if unavailable (e.g. the thread already exited)
+    static double threadCpuSeconds(std::thread::native_handle_type thread)
+    {
+#ifdef _WIN32
+        FILETIME created, exited, kernel, user;
+        if (!GetThreadTimes(static_cast<HANDLE>(thread), &created, &exited, &kernel, &user))
+        {
+            return -1.0;
+        }
+        auto ticks = [](const FILETIME &time)
+        { return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime; };
+        return (ticks(kernel) + ticks(user)) / 1e7;
+#else
+        // The thread's CLOCK_THREAD_CPUTIME_ID, readable from any thread
+        clockid_t clock;
+        struct timespec time;
+        if (pthread_getcpuclockid(thread, &clock) != 0 || clock_gettime(clock, &time) != 0)
+        {
+            return -1.0;
+        }
+        return time.tv_sec + time.tv_nsec / 1e9;
+#endif
+    }
+
+    // User + system CPU of the whole NanoRec process (UI, workers, capture)
+    static double processCpuSeconds()
+    {
+#ifdef _WIN32
+        FILETIME created, exited, kernel, user;
+        if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user))
+        {
+            return -1.0;
+        }
+        auto ticks = [](const FILETIME &time)
+        { return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime; };
+        return (ticks(kernel) + ticks(user)) / 1e7;
+#else
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+        {
+            return -1.0;
+        }
+        return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 + usage.ru_stime.tv_sec +
+               usage.ru_stime.tv_usec / 1e6;
+#endif
+    }
+
+    // Peak (process lifetime) and current resident set size in KB; 0 where unknown
+    static void residentSetKb(long &peakKb, long &currentKb)
+    {
+        peakKb = 0;
+        currentKb = 0;
+#ifndef _WIN32
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0)
+        {
+            peakKb = usage.ru_maxrss;
+        }
+
+        // statm: size resident shared ... (pages)
+        std::ifstream statm("/proc/self/statm");
+        long sizePages = 0;
+        long residentPages = 0;
+        if (statm >> sizePages >> residentPages)
+        {
+            currentKb = residentPages * (sysconf(_SC_PAGESIZE) / 1024);
+        }
+#endif
+    }
+
+    static std::string jsonString(const std::string &text)
+    {
+        std::ostringstream out;
+        out << '"';
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                out << '\\' << c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+            }
+            else
+            {
+                out << c;
+            }
+        }
+        out << '"';
+        return out.str();
+    }
+
+    // Seconds between two samples, or null when either side is unknown
+    static std::string jsonSeconds(double begin, double end)
+    {
+        if (begin < 0.0 || end < 0.0)
+        {
+            return "null";
+        }
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(3) << std::max(0.0, end - begin);
+        return out.str();
+    }
+
+    void RecordingStats::begin(const VideoConfig &config, std::thread &captureThread, IVideoWriter &writer,
+                               WorkerPool &workers)
+    {
+        *this = RecordingStats();
+        m_config = config;
+        m_begin = std::chrono::steady_clock::now();
+        m_end = m_begin;
+
+        m_haveCaptureThread = captureThread.joinable();
+        if (m_haveCaptureThread)
+        {
+            m_captureThread = captureThread.native_handle();
+            m_captureCpuBegin = threadCpuSeconds(m_captureThread);
+        }
+
+        m_haveQueueThread = writer.getWorkerThread(m_queueThread);
+        if (m_haveQueueThread)
+        {
+            m_queueCpuBegin = threadCpuSeconds(m_queueThread);
+        }
+        m_workerThreads = workers.getNativeHandles();
+        for (std::thread::native_handle_type worker : m_workerThreads)
+        {
+            m_workerCpuBegin.push_back(threadCpuSeconds(worker));
+        }
+        m_processCpuBegin = processCpuSeconds();
+    }
+
+    void RecordingStats::end()
+    {
+        m_end = std::chrono::steady_clock::now();
+        if (m_haveCaptureThread)
+        {
+            m_captureCpuEnd = threadCpuSeconds(m_captureThread);
+        }
+        if (m_haveQueueThread)
+        {
+            m_queueCpuEnd = threadCpuSeconds(m_queueThread);
+        }
+        m_workerCpuEnd.clear();
+        for (std::thread::native_handle_type worker : m_workerThreads)
+        {
+            m_workerCpuEnd.push_back(threadCpuSeconds(worker));
+        }
+        m_processCpuEnd = processCpuSeconds();
+    }
+
+    std::string RecordingStats::sidecarPath(const std::string &recordingPath)
+    {
+        return recordingPath + ".stats.json";
+    }
+
+    bool RecordingStats::write(const std::string &path, const IVideoWriter &writer) const
+    {
+        std::ofstream file(path);
+        if (!file)
+        {
+            Logger::warning("Cannot write recording stats: " + path);
+            return false;
+        }
+
+        double duration = std::chrono::duration<double>(m_end - m_begin).count();
+        long peakRssKb = 0;
+        long rssKb = 0;
+        residentSetKb(peakRssKb, rssKb);
+
+        // Everything but the threads reported by name: UI, preview server, ffmpeg pipe readers
+        std::string otherCpu = "null";
+        if (m_captureCpuBegin >= 0.0 && m_captureCpuEnd >= 0.0 && m_processCpuBegin >= 0.0 && m_processCpuEnd >= 0.0)
+        {
+            double namedCpu = m_captureCpuEnd - m_captureCpuBegin;
+            if (m_queueCpuBegin >= 0.0 && m_queueCpuEnd >= 0.0)
+            {
+                namedCpu += m_queueCpuEnd - m_queueCpuBegin;
+            }
+            for (size_t i = 0; i < m_workerCpuBegin.size() && i < m_workerCpuEnd.size(); ++i)
+            {
+                if (m_workerCpuBegin[i] >= 0.0 && m_workerCpuEnd[i] >= 0.0)
+                {
+                    namedCpu += m_workerCpuEnd[i] - m_workerCpuBegin[i];
+                }
+            }
+            otherCpu = jsonSeconds(namedCpu, m_processCpuEnd - m_processCpuBegin);
+        }
+
+        EncoderUsage encoder = writer.getEncoderUsage();
+
+        file << std::fixed << std::setprecision(3);
+        file << "{\n";
+        file << "  \"version\": 1,\n";
+        file << "  \"recording\": " << jsonString(m_config.output) << ",\n";
+        file << "  \"duration_seconds\": " << duration << ",\n";
+        file << "  \"video\": {\"width\": " << m_config.width << ", \"height\": " << m_config.height
+             << ", \"fps\": " << m_config.fps << ", \"preset\": " << jsonString(m_config.preset)
+             << ", \"pixel_format\": " << jsonString(m_config.pixelFormat)
+             << ", \"input_pixel_format\": " << jsonString(m_config.inputPixelFormat) << "},\n";
+        file << "  \"frames\": {\"captured\": " << m_captured << ", \"encoded\": " << m_encoded
+             << ", \"held\": " << m_held << ", \"dropped\": " << m_dropped << "},\n";
+        file << "  \"bytes_piped\": " << writer.getBytesWritten() << ",\n";
+        file << "  \"cpu_seconds\": {\"capture_thread\": " << jsonSeconds(m_captureCpuBegin, m_captureCpuEnd)
+             << ", \"encoder_queue_thread\": "
+             << (m_haveQueueThread ? jsonSeconds(m_queueCpuBegin, m_queueCpuEnd) : std::string("null"));
+        for (size_t i = 0; i < m_workerCpuBegin.size(); ++i)
+        {
+            file << ", \"pool_worker_" << i << "\": "
+                 << jsonSeconds(m_workerCpuBegin[i], i < m_workerCpuEnd.size() ? m_workerCpuEnd[i] : -1.0);
+        }
+        file << ", \"other_threads\": " << otherCpu
+             << ", \"process\": " << jsonSeconds(m_processCpuBegin, m_processCpuEnd) << "},\n";
+        file << "  \"encoder\": ";
+        if (encoder.valid)
+        {
+            file << "{\"user_seconds\": " << encoder.userSeconds << ", \"system_seconds\": " << encoder.systemSeconds
+                 << ", \"peak_rss_kb\": " << encoder.peakRssKb << "},\n";
+        }
+        else
+        {
+            file << "null,\n";
+        }
+        file << "  \"memory_kb\": {\"process_peak_rss\": " << peakRssKb << ", \"rss\": " << rssKb << "},\n";
+
+        WriterQueueStats queue;
+        file << "  \"queue\": ";
+        if (writer.getQueueStats(queue))
+        {
+            file << "{\"capacity_frames\": " << queue.capacityFrames << ", \"peak_frames\": " << queue.peakFrames
+                 << ", \"dropped\": " << queue.dropped << ", \"spilled_frames\": " << queue.spilledFrames
+                 << ", \"peak_spill_bytes\": " << queue.peakSpillBytes << ", \"write_failures\": "
+                 << queue.writeFailures << ", \"encoder_lost\": " << (queue.encoderLost ? "true" : "false") << "},\n";
+        }
+        else
+        {
+            file << "null,\n";
+        }
+
+        static const char *STAGE_NAMES[] = {"capture", "encode", "write", "frame"};
+        file << "  \"latency_us\": {";
+        for (int stage = 0; stage < static_cast<int>(Stage::Count); ++stage)
+        {
+            const LatencyHistogram &histogram = m_stages[stage];
+            file << (stage ? ",\n" : "\n") << "    \"" << STAGE_NAMES[stage] << "\": {\"count\": " << histogram.getCount()
+                 << std::setprecision(1) << ", \"mean\": " << histogram.getMean()
+                 << ", \"p50\": " << histogram.getPercentile(0.50) << ", \"p90\": " << histogram.getPercentile(0.90)
+                 << ", \"p99\": " << histogram.getPercentile(0.99) << ", \"max\": " << histogram.getMax() << "}"
+                 << std::setprecision(3);
+        }
+        file << "\n  }\n";
+        file << "}\n";
+
+        file.close();
+        if (file.fail())
+        {
+            Logger::warning("Cannot write recording stats: " + path);
+            return false;
+        }
+        return true;
+    }
+
+} // namespace NanoRec
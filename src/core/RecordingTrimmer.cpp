@@ -0,0 +1,234 @@
+#include "core/RecordingTrimmer.hpp"
+#include "core/Logger.hpp"
+#include "core/Subprocess.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+namespace NanoRec
+{
+
+    static std::string formatSeconds(double seconds)
+    {
+        std::ostringstream ss;
+        ss << std::fixed << std::setprecision(6) << seconds;
+        return ss.str();
+    }
+
+    static bool runFFmpeg(const std::vector<std::string> &args)
+    {
+        Subprocess process;
+        if (!process.start(args, Subprocess::PIPE_NONE))
+        {
+            return false;
+        }
+
+        int exitCode = process.wait();
+        if (exitCode != 0)
+        {
+            Logger::error("ffmpeg exited with code " + std::to_string(exitCode));
+            return false;
+        }
+        return true;
+    }
+
+    // Every part maps the same streams, so the concat demuxer lines them up:
+    // the first video stream and, if present, the first audio stream
+    static void appendStreamMaps(std::vector<std::string> &args, const MediaInfo &info)
+    {
+        args.insert(args.end(), {"-map", "0:v:0"});
+        if (info.hasAudio)
+        {
+            args.insert(args.end(), {"-map", "0:a:0"});
+        }
+        else
+        {
+            args.push_back("-an");
+        }
+    }
+
+    // ffprobe's H.264 profile name as an x264 -profile:v value ("" if x264 has none)
+    static std::string x264Profile(const std::string &profile)
+    {
+        static const struct
+        {
+            const char *probed;
+            const char *x264;
+        } PROFILES[] = {{"Constrained Baseline", "baseline"}, {"Baseline", "baseline"}, {"Main", "main"},
+                        {"High", "high"}, {"High 10", "high10"}, {"High 4:2:2", "high422"},
+                        {"High 4:4:4 Predictive", "high444"}};
+
+        for (const auto &entry : PROFILES)
+        {
+            if (profile == entry.probed)
+            {
+                return entry.x264;
+            }
+        }
+        return "";
+    }
+
+    bool RecordingTrimmer::canEncodeEdges(const MediaInfo &info)
+    {
+        return info.codec == "h264";
+    }
+
+    bool RecordingTrimmer::copySegment(const std::string &input, double start, double end, const MediaInfo &info,
+                                       const std::string &output, const char *format)
+    {
+        // Input seeking with stream copy lands on the keyframe at or before start
+        std::vector<std::string> args = {"ffmpeg", "-v", "error", "-nostdin", "-y",
+                                         "-ss", formatSeconds(start), "-i", input,
+                                         "-t", formatSeconds(end - start)};
+        appendStreamMaps(args, info);
+        args.insert(args.end(), {"-c", "copy", "-avoid_negative_ts", "make_zero", "-f", format, output});
+        return runFFmpeg(args);
+    }
+
+    bool RecordingTrimmer::encodeSegment(const std::string &input, double start, double end,
+                                         const MediaInfo &info, const std::string &output)
+    {
+        // Only a partial GOP goes through here, so a slow high-quality encode is cheap.
+        // The edges must match the copied middle's stream parameters for the concat copy.
+        std::vector<std::string> args = {"ffmpeg", "-v", "error", "-nostdin", "-y",
+                                         "-ss", formatSeconds(start), "-i", input,
+                                         "-t", formatSeconds(end - start)};
+        appendStreamMaps(args, info);
+        if (info.hasAudio)
+        {
+            // Audio packets decode independently, so the copied audio cuts anywhere
+            args.insert(args.end(), {"-c:a", "copy"});
+        }
+        args.insert(args.end(), {"-c:v", "libx264", "-preset", "medium", "-crf", "18"});
+
+        std::string profile = x264Profile(info.profile);
+        if (!profile.empty())
+        {
+            args.insert(args.end(), {"-profile:v", profile});
+        }
+        if (info.level > 0)
+        {
+            std::string level = std::to_string(info.level / 10) + "." + std::to_string(info.level % 10);
+            args.insert(args.end(), {"-level", level});
+        }
+        args.insert(args.end(), {"-pix_fmt", info.pixelFormat.empty() ? "yuv420p" : info.pixelFormat,
+                                 "-r", formatSeconds(info.fps), "-f", "mpegts", output});
+        return runFFmpeg(args);
+    }
+
+    bool RecordingTrimmer::concatSegments(const std::string &listFile, const std::string &output)
+    {
+        return runFFmpeg({"ffmpeg", "-v", "error", "-nostdin", "-y",
+                          "-f", "concat", "-safe", "0", "-i", listFile,
+                          "-c", "copy", output});
+    }
+
+    bool RecordingTrimmer::trim(const TrimRequest &request)
+    {
+        if (request.input.empty() || request.output.empty() || request.end <= request.start)
+        {
+            Logger::error("Invalid trim request");
+            return false;
+        }
+
+        MediaInfo info;
+        if (!MediaProbe::probe(request.input, info, true))
+        {
+            return false;
+        }
+
+        double start = std::max(0.0, request.start);
+        double end = info.duration > 0.0 ? std::min(request.end, info.duration) : request.end;
+        auto exportStart = std::chrono::steady_clock::now();
+
+        bool frameExact = request.frameExact && !info.keyframes.empty();
+        if (frameExact && !canEncodeEdges(info))
+        {
+            Logger::warning("Cannot re-encode " + info.codec + " edges to match " + request.input +
+                            ", exporting keyframe-aligned");
+            frameExact = false;
+        }
+
+        bool success = false;
+        if (!frameExact)
+        {
+            // Keyframe-aligned: the clip starts at the GOP containing start
+            success = copySegment(request.input, start, end, info, request.output, "mp4");
+        }
+        else
+        {
+            double headEnd = info.keyframeAtOrAfter(start);
+            double tailStart = info.keyframeAtOrBefore(end);
+
+            std::filesystem::path outputPath(request.output);
+            std::string base = (outputPath.parent_path() / outputPath.stem()).string();
+            std::vector<std::string> segments;
+
+            if (headEnd >= tailStart)
+            {
+                // No complete GOP inside the clip; it is short, encode it whole
+                segments.push_back(base + ".part0.ts");
+                success = encodeSegment(request.input, start, end, info, segments.back());
+            }
+            else
+            {
+                success = true;
+                if (headEnd > start)
+                {
+                    segments.push_back(base + ".part0.ts");
+                    success = encodeSegment(request.input, start, headEnd, info, segments.back());
+                }
+                if (success)
+                {
+                    segments.push_back(base + ".part1.ts");
+                    success = copySegment(request.input, headEnd, tailStart, info, segments.back(), "mpegts");
+                }
+                if (success && end > tailStart)
+                {
+                    segments.push_back(base + ".part2.ts");
+                    success = encodeSegment(request.input, tailStart, end, info, segments.back());
+                }
+            }
+
+            std::string listFile = base + ".parts.txt";
+            if (success)
+            {
+                std::ofstream list(listFile);
+                for (const std::string &segment : segments)
+                {
+                    std::string absolute = std::filesystem::absolute(segment).string();
+                    list << "file '" << absolute << "'\n";
+                }
+                list.close();
+                success = !list.fail() && concatSegments(listFile, request.output);
+            }
+
+            std::error_code ec;
+            for (const std::string &segment : segments)
+            {
+                std::filesystem::remove(segment, ec);
+            }
+            std::filesystem::remove(listFile, ec);
+        }
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::steady_clock::now() - exportStart)
+                           .count();
+
+        if (!success)
+        {
+            Logger::error("Failed to export clip: " + request.output);
+            return false;
+        }
+
+        Logger::info("Exported clip " + request.output + " (" + formatSeconds(end - start) + "s" +
+                     (frameExact ? ", frame-exact" : ", keyframe-aligned") + ") in " +
+                     std::to_string(elapsed) + " ms");
+        return true;
+    }
+
+} // namespace NanoRec
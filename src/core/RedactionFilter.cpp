@@ -0,0 +1,636 @@
+#include "core/RedactionFilter.hpp"
+#include "core/Logger.hpp"
+#include "core/Simd.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <poll.h>
+#endif
+
+namespace NanoRec
+{
+
+    static const int MAX_BLOCK_SIZE = 128;
+
+    static std::string toLower(std::string text)
+    {
+        std::transform(text.begin(), text.end(), text.begin(),
+                       [](unsigned char c)
+                       { return static_cast<char>(std::tolower(c)); });
+        return text;
+    }
+
+    bool RedactionFilter::matches(const std::vector<std::string> &patterns, const std::string &windowClass,
+                                  const std::string &windowName)
+    {
+        std::string lowerClass = toLower(windowClass);
+        std::string lowerName = toLower(windowName);
+
+        for (const std::string &raw : patterns)
+        {
+            std::string pattern = toLower(raw);
+            bool checkClass = true;
+            bool checkName = true;
+            if (pattern.rfind("class:", 0) == 0)
+            {
+                pattern.erase(0, 6);
+                checkName = false;
+            }
+            else if (pattern.rfind("name:", 0) == 0)
+            {
+                pattern.erase(0, 5);
+                checkClass = false;
+            }
+            if (pattern.empty())
+            {
+                continue;
+            }
+
+            if ((checkClass && lowerClass.find(pattern) != std::string::npos) ||
+                (checkName && lowerName.find(pattern) != std::string::npos))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void RedactionFilter::blackout(FrameBuffer &frame, const Rect &rect)
+    {
+        Rect area = rect.intersected(Rect(0, 0, static_cast<int>(frame.width), static_cast<int>(frame.height)));
+        if (area.isEmpty())
+        {
+            return;
+        }
+
+        for (int y = area.y; y < area.bottom(); ++y)
+        {
+            uint8_t *row = frame.data + static_cast<size_t>(y) * frame.stride + static_cast<size_t>(area.x) * 3;
+            std::memset(row, 0, static_cast<size_t>(area.width) * 3);
+        }
+    }
+
+    // Add one row of bytes into 16-bit column sums (at most 128 rows, so 128*255 fits)
+    static void accumulateRow(const uint8_t *row, uint16_t *sums, size_t count)
+    {
+        size_t i = 0;
+#ifdef NANOREC_HAVE_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i));
+            __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(sums + i));
+            __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(sums + i + 8));
+            lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(pixels, zero));
+            hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(pixels, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(sums + i), lo);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(sums + i + 8), hi);
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            sums[i] = static_cast<uint16_t>(sums[i] + row[i]);
+        }
+    }
+
+    void RedactionFilter::pixelate(FrameBuffer &frame, const Rect &rect, int blockSize)
+    {
+        Rect area = rect.intersected(Rect(0, 0, static_cast<int>(frame.width), static_cast<int>(frame.height)));
+        if (area.isEmpty())
+        {
+            return;
+        }
+
+        int block = std::clamp(blockSize, 2, MAX_BLOCK_SIZE);
+        size_t rowBytes = static_cast<size_t>(area.width) * 3;
+        std::vector<uint16_t> sums(rowBytes);
+        std::vector<uint8_t> averaged(rowBytes);
+
+        for (int top = area.y; top < area.bottom(); top += block)
+        {
+            int rows = std::min(block, area.bottom() - top);
+
+            // Vertical pass: column sums over the band, SIMD across the full row
+            std::fill(sums.begin(), sums.end(), static_cast<uint16_t>(0));
+            for (int y = top; y < top + rows; ++y)
+            {
+                accumulateRow(frame.data + static_cast<size_t>(y) * frame.stride + static_cast<size_t>(area.x) * 3,
+                              sums.data(), rowBytes);
+            }
+
+            // Horizontal pass: one average per block, expanded into a template row
+            for (int left = 0; left < area.width; left += block)
+            {
+                int cols = std::min(block, area.width - left);
+                uint32_t total[3] = {0, 0, 0};
+                const uint16_t *column = sums.data() + static_cast<size_t>(left) * 3;
+                for (int x = 0; x < cols; ++x)
+                {
+                    total[0] += column[x * 3 + 0];
+                    total[1] += column[x * 3 + 1];
+                    total[2] += column[x * 3 + 2];
+                }
+
+                uint32_t count = static_cast<uint32_t>(cols * rows);
+                uint8_t color[3];
+                for (int c = 0; c < 3; ++c)
+                {
+                    color[c] = static_cast<uint8_t>((total[c] + count / 2) / count);
+                }
+
+                uint8_t *out = averaged.data() + static_cast<size_t>(left) * 3;
+                for (int x = 0; x < cols; ++x)
+                {
+                    out[x * 3 + 0] = color[0];
+                    out[x * 3 + 1] = color[1];
+                    out[x * 3 + 2] = color[2];
+                }
+            }
+
+            for (int y = top; y < top + rows; ++y)
+            {
+                std::memcpy(frame.data + static_cast<size_t>(y) * frame.stride + static_cast<size_t>(area.x) * 3,
+                            averaged.data(), rowBytes);
+            }
+        }
+    }
+
+#ifdef __linux__
+
+    struct RedactionFilter::Tracker
+    {
+        struct Window
+        {
+            Rect rect;
+            bool mapped{false};
+            bool redacted{false};
+        };
+
+        Display *display{nullptr};
+        ::Window root{0};
+        Atom clientList{None};
+        Atom netWmName{None};
+        Atom utf8String{None};
+        std::vector<std::string> patterns;
+        std::unordered_map<::Window, Window> windows;
+
+        void refreshWindow(::Window window, Window &state);
+        void addWindow(::Window window);
+
+        /**
+         * @brief Client list from the window manager (EWMH); top-level children without one
+         */
+        void syncClients();
+
+        std::vector<Rect> collectRects() const;
+    };
+
+    // The Xlib error handler is process-wide: only the tracker's own window errors are filtered
+    static std::atomic<Display *> s_trackerDisplay{nullptr};
+    static XErrorHandler s_previousErrorHandler = nullptr;
+
+    static int filterWindowErrors(Display *display, XErrorEvent *error)
+    {
+        // Windows vanish between events and our requests; those errors are expected
+        if (display == s_trackerDisplay.load() &&
+            (error->error_code == BadWindow || error->error_code == BadDrawable || error->error_code == BadMatch))
+        {
+            return 0;
+        }
+        return s_previousErrorHandler ? s_previousErrorHandler(display, error) : 0;
+    }
+
+    RedactionFilter::RedactionFilter() = default;
+
+    RedactionFilter::~RedactionFilter()
+    {
+        stop();
+    }
+
+    bool RedactionFilter::start(const Options &options)
+    {
+        stop();
+
+        if (options.patterns.empty())
+        {
+            return false;
+        }
+
+        auto tracker = std::make_unique<Tracker>();
+        tracker->display = XOpenDisplay(nullptr);
+        if (!tracker->display)
+        {
+            Logger::error("Redaction: cannot open X display");
+            return false;
+        }
+
+        tracker->root = DefaultRootWindow(tracker->display);
+        tracker->clientList = XInternAtom(tracker->display, "_NET_CLIENT_LIST", False);
+        tracker->netWmName = XInternAtom(tracker->display, "_NET_WM_NAME", False);
+        tracker->utf8String = XInternAtom(tracker->display, "UTF8_STRING", False);
+        tracker->patterns = options.patterns;
+
+        s_trackerDisplay = tracker->display;
+        XErrorHandler previous = XSetErrorHandler(filterWindowErrors);
+        if (previous != filterWindowErrors)
+        {
+            s_previousErrorHandler = previous;
+        }
+
+        m_options = options;
+        m_options.blockSize = std::clamp(m_options.blockSize, 2, MAX_BLOCK_SIZE);
+
+        // Scan before returning: windows that are already open are redacted from the first captured frame
+        XSelectInput(tracker->display, tracker->root, PropertyChangeMask | SubstructureNotifyMask);
+        tracker->syncClients();
+        publish(tracker->collectRects());
+
+        m_tracker = std::move(tracker);
+        m_shouldStop = false;
+        m_running = true;
+        m_thread = std::thread(&RedactionFilter::trackerLoop, this);
+
+        Logger::info("Redaction: tracking " + std::to_string(m_options.patterns.size()) + " window pattern(s)");
+        return true;
+    }
+
+    void RedactionFilter::stop()
+    {
+        if (!m_running)
+        {
+            return;
+        }
+
+        m_shouldStop = true;
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+        m_running = false;
+
+        if (m_tracker && m_tracker->display)
+        {
+            XCloseDisplay(m_tracker->display);
+        }
+        m_tracker.reset();
+        publish({});
+
+        // Hand the error handler back unless someone installed theirs over ours since
+        s_trackerDisplay = nullptr;
+        XErrorHandler current = XSetErrorHandler(s_previousErrorHandler);
+        if (current != filterWindowErrors)
+        {
+            XSetErrorHandler(current);
+        }
+    }
+
+    static std::string readWindowName(Display *display, ::Window window, Atom netWmName, Atom utf8String)
+    {
+        Atom type = None;
+        int format = 0;
+        unsigned long count = 0;
+        unsigned long remaining = 0;
+        unsigned char *data = nullptr;
+
+        std::string name;
+        if (XGetWindowProperty(display, window, netWmName, 0, 1024, False, utf8String,
+                               &type, &format, &count, &remaining, &data) == Success &&
+            data)
+        {
+            name.assign(reinterpret_cast<char *>(data), count);
+            XFree(data);
+        }
+
+        if (name.empty())
+        {
+            char *legacy = nullptr;
+            if (XFetchName(display, window, &legacy) && legacy)
+            {
+                name = legacy;
+                XFree(legacy);
+            }
+        }
+        return name;
+    }
+
+    static std::string readWindowClass(Display *display, ::Window window)
+    {
+        XClassHint hint{};
+        std::string result;
+        if (XGetClassHint(display, window, &hint))
+        {
+            if (hint.res_name)
+            {
+                result = hint.res_name;
+                XFree(hint.res_name);
+            }
+            if (hint.res_class)
+            {
+                result += " ";
+                result += hint.res_class;
+                XFree(hint.res_class);
+            }
+        }
+        return result;
+    }
+
+    static bool readGeometry(Display *display, ::Window root, ::Window window, Rect &rect)
+    {
+        XWindowAttributes attributes;
+        if (!XGetWindowAttributes(display, window, &attributes))
+        {
+            return false;
+        }
+
+        int rootX = 0;
+        int rootY = 0;
+        ::Window child;
+        if (!XTranslateCoordinates(display, window, root, 0, 0, &rootX, &rootY, &child))
+        {
+            return false;
+        }
+
+        // Include the border; decorations belong to the frame window and stay visible
+        rect = Rect(rootX - attributes.border_width, rootY - attributes.border_width,
+                    attributes.width + 2 * attributes.border_width,
+                    attributes.height + 2 * attributes.border_width);
+        return true;
+    }
+
+    void RedactionFilter::Tracker::refreshWindow(::Window window, Window &state)
+    {
+        state.redacted = matches(patterns, readWindowClass(display, window),
+                                 readWindowName(display, window, netWmName, utf8String));
+        if (state.redacted)
+        {
+            readGeometry(display, root, window, state.rect);
+        }
+    }
+
+    void RedactionFilter::Tracker::addWindow(::Window window)
+    {
+        if (windows.count(window))
+        {
+            return;
+        }
+
+        XWindowAttributes attributes;
+        if (!XGetWindowAttributes(display, window, &attributes) || attributes.c_class == InputOnly)
+        {
+            return;
+        }
+
+        XSelectInput(display, window, PropertyChangeMask | StructureNotifyMask);
+        Window &state = windows[window];
+        state.mapped = attributes.map_state == IsViewable;
+        refreshWindow(window, state);
+    }
+
+    void RedactionFilter::Tracker::syncClients()
+    {
+        std::vector<::Window> clients;
+        Atom type = None;
+        int format = 0;
+        unsigned long count = 0;
+        unsigned long remaining = 0;
+        unsigned char *data = nullptr;
+        if (XGetWindowProperty(display, root, clientList, 0, 4096, False, XA_WINDOW, &type, &format, &count,
+                               &remaining, &data) == Success &&
+            data && format == 32)
+        {
+            const unsigned long *ids = reinterpret_cast<const unsigned long *>(data);
+            clients.assign(ids, ids + count);
+        }
+        if (data)
+        {
+            XFree(data);
+        }
+
+        if (clients.empty())
+        {
+            ::Window rootReturn;
+            ::Window parent;
+            ::Window *children = nullptr;
+            unsigned int childCount = 0;
+            if (XQueryTree(display, root, &rootReturn, &parent, &children, &childCount) && children)
+            {
+                clients.assign(children, children + childCount);
+                XFree(children);
+            }
+        }
+
+        for (auto it = windows.begin(); it != windows.end();)
+        {
+            if (std::find(clients.begin(), clients.end(), it->first) == clients.end())
+            {
+                it = windows.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        for (::Window window : clients)
+        {
+            addWindow(window);
+        }
+    }
+
+    std::vector<Rect> RedactionFilter::Tracker::collectRects() const
+    {
+        std::vector<Rect> rects;
+        for (const auto &entry : windows)
+        {
+            if (entry.second.redacted && entry.second.mapped && !entry.second.rect.isEmpty())
+            {
+                rects.push_back(entry.second.rect);
+            }
+        }
+        return rects;
+    }
+
+    void RedactionFilter::trackerLoop()
+    {
+        Tracker *tracker = m_tracker.get();
+        Display *display = tracker->display;
+
+        pollfd descriptor{};
+        descriptor.fd = ConnectionNumber(display);
+        descriptor.events = POLLIN;
+
+        while (!m_shouldStop)
+        {
+            if (XPending(display) == 0)
+            {
+                // Wake periodically so stop() never waits on a quiet desktop
+                poll(&descriptor, 1, 100);
+                if (XPending(display) == 0)
+                {
+                    continue;
+                }
+            }
+
+            bool changed = false;
+            while (XPending(display) > 0)
+            {
+                XEvent event;
+                XNextEvent(display, &event);
+
+                switch (event.type)
+                {
+                case PropertyNotify:
+                {
+                    const XPropertyEvent &property = event.xproperty;
+                    if (property.window == tracker->root)
+                    {
+                        if (property.atom == tracker->clientList)
+                        {
+                            tracker->syncClients();
+                            changed = true;
+                        }
+                    }
+                    else if (property.atom == XA_WM_NAME || property.atom == XA_WM_CLASS ||
+                             property.atom == tracker->netWmName)
+                    {
+                        auto it = tracker->windows.find(property.window);
+                        if (it != tracker->windows.end())
+                        {
+                            tracker->refreshWindow(property.window, it->second);
+                            changed = true;
+                        }
+                    }
+                    break;
+                }
+                case ConfigureNotify:
+                {
+                    // Reported to both the window and its parent; only our clients matter
+                    auto it = tracker->windows.find(event.xconfigure.window);
+                    if (it != tracker->windows.end() && it->second.redacted)
+                    {
+                        readGeometry(display, tracker->root, it->first, it->second.rect);
+                        changed = true;
+                    }
+                    break;
+                }
+                case MapNotify:
+                {
+                    auto it = tracker->windows.find(event.xmap.window);
+                    if (it != tracker->windows.end())
+                    {
+                        it->second.mapped = true;
+                        if (it->second.redacted)
+                        {
+                            readGeometry(display, tracker->root, it->first, it->second.rect);
+                        }
+                        changed = true;
+                    }
+                    break;
+                }
+                case UnmapNotify:
+                {
+                    auto it = tracker->windows.find(event.xunmap.window);
+                    if (it != tracker->windows.end())
+                    {
+                        it->second.mapped = false;
+                        changed = true;
+                    }
+                    break;
+                }
+                case DestroyNotify:
+                    changed = tracker->windows.erase(event.xdestroywindow.window) > 0 || changed;
+                    break;
+                case CreateNotify:
+                    // Without a window manager there is no client list to announce new windows
+                    if (event.xcreatewindow.parent == tracker->root && tracker->clientList != None)
+                    {
+                        tracker->syncClients();
+                        changed = true;
+                    }
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            if (changed)
+            {
+                publish(tracker->collectRects());
+            }
+        }
+    }
+
+#else
+
+    struct RedactionFilter::Tracker
+    {
+    };
+
+    RedactionFilter::RedactionFilter() = default;
+
+    RedactionFilter::~RedactionFilter()
+    {
+        stop();
+    }
+
+    bool RedactionFilter::start(const Options &)
+    {
+        Logger::warning("Redaction: window tracking is not supported on this platform");
+        return false;
+    }
+
+    void RedactionFilter::stop()
+    {
+    }
+
+    void RedactionFilter::trackerLoop()
+    {
+    }
+
+#endif
+
+    void RedactionFilter::publish(std::vector<Rect> rects)
+    {
+        std::lock_guard<std::mutex> lock(m_rectsMutex);
+        m_rects = std::move(rects);
+    }
+
+    std::vector<Rect> RedactionFilter::getRects() const
+    {
+        std::lock_guard<std::mutex> lock(m_rectsMutex);
+        return m_rects;
+    }
+
+    void RedactionFilter::apply(FrameBuffer &frame, int originX, int originY)
+    {
+        if (!m_running || !frame.data)
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_rectsMutex);
+            m_applyRects.assign(m_rects.begin(), m_rects.end());
+        }
+
+        for (const Rect &desktopRect : m_applyRects)
+        {
+            Rect rect(desktopRect.x - originX, desktopRect.y - originY, desktopRect.width, desktopRect.height);
+            if (m_options.mode == Mode::Blackout)
+            {
+                blackout(frame, rect);
+            }
+            else
+            {
+                pixelate(frame, rect, m_options.blockSize);
+            }
+        }
+    }
+
+} // namespace NanoRec
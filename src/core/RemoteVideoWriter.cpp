@@ -0,0 +1,472 @@
+/**
+ * @file RemoteVideoWriter.cpp
+ * @brief Video writer that offloads encoding to nanorec-encoder-node over TCP
+ * @author NanoRec-CPP Team
+ * @date 2026-10-18
+ */
+
+#include "core/RemoteVideoWriter.hpp"
+#include "core/Logger.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+
+namespace NanoRec
+{
+
+    namespace
+    {
+        // Spreads sessions over equally loaded nodes
+        std::atomic<unsigned> s_rotation{0};
+
+        struct Candidate
+        {
+            std::unique_ptr<EncoderLink> link;
+            std::string address;
+            uint32_t activeSessions{0};
+            uint32_t maxSessions{0};
+            uint32_t codecs{0};
+            size_t order{0};
+        };
+    } // namespace
+
+    std::vector<std::string> RemoteVideoWriter::parseNodeList(const std::string &list)
+    {
+        std::vector<std::string> nodes;
+        std::stringstream entries(list);
+        std::string node;
+        while (std::getline(entries, node, ','))
+        {
+            node.erase(0, node.find_first_not_of(" \t"));
+            node.erase(node.find_last_not_of(" \t") + 1);
+            if (!node.empty())
+            {
+                nodes.push_back(node);
+            }
+        }
+        return nodes;
+    }
+
+    RemoteVideoWriter::RemoteVideoWriter(const Options &options) : m_options(options)
+    {
+    }
+
+    RemoteVideoWriter::~RemoteVideoWriter()
+    {
+        if (m_active)
+        {
+            fail("writer destroyed before finalize()");
+            closeSession();
+            std::error_code ec;
+            std::filesystem::remove(m_partialPath, ec);
+        }
+    }
+
+    bool RemoteVideoWriter::initialize(const VideoConfig &config)
+    {
+        if (m_active)
+        {
+            Logger::error("Remote video writer already initialized");
+            return false;
+        }
+        if (config.width <= 0 || config.height <= 0 || config.fps <= 0 || config.output.empty())
+        {
+            Logger::error("Invalid video configuration");
+            return false;
+        }
+        if (m_options.nodes.empty())
+        {
+            Logger::error("No encoder nodes configured");
+            return false;
+        }
+
+        m_config = config;
+        m_frameSize = config.inputFrameSize();
+        m_queue.clear();
+        m_inFlight = 0;
+        m_nextSequence = 0;
+        m_dropped = 0;
+        m_finishing = false;
+        m_failed = false;
+        m_done = false;
+        m_bytesSent.store(0);
+        m_resultOk = false;
+        m_encodedFrames = 0;
+        m_encoderUsage = EncoderUsage();
+        m_fileSize = 0;
+        m_fileReceived = 0;
+        m_partialPath = config.output + ".part";
+
+        if (!openSession())
+        {
+            return false;
+        }
+
+        m_link->setReceiveTimeout(0);
+        m_delta.reset(m_frameSize);
+        m_start = std::chrono::steady_clock::now();
+        m_active = true;
+        m_sender = std::thread(&RemoteVideoWriter::sendLoop, this);
+        m_receiver = std::thread(&RemoteVideoWriter::receiveLoop, this);
+
+        Logger::info("Remote encoding on " + m_node + ": " + std::to_string(config.width) + "x" +
+                     std::to_string(config.height) + " @ " + std::to_string(config.fps) + " FPS, " +
+                     FrameDelta::codecName(m_codec) + " deltas");
+        return true;
+    }
+
+    bool RemoteVideoWriter::openSession()
+    {
+        // Ask every node for its load
+        std::vector<Candidate> candidates;
+        for (const std::string &address : m_options.nodes)
+        {
+            std::string host;
+            int port = 0;
+            if (!EncoderLink::parseAddress(address, host, port))
+            {
+                Logger::warning("Invalid encoder node address: " + address);
+                continue;
+            }
+
+            Candidate candidate;
+            candidate.link = std::make_unique<EncoderLink>();
+            candidate.address = host + ":" + std::to_string(port);
+            if (!candidate.link->connect(host, port, m_options.connectTimeoutMs))
+            {
+                continue;
+            }
+            candidate.link->setReceiveTimeout(m_options.connectTimeoutMs);
+
+            MessageWriter hello(EncoderMessage::Hello);
+            hello.put32(EncoderLink::MAGIC);
+            hello.put32(EncoderLink::VERSION);
+            EncoderMessage type;
+            std::vector<uint8_t> payload;
+            if (!candidate.link->send(hello) || !candidate.link->receive(type, payload) ||
+                type != EncoderMessage::Status)
+            {
+                Logger::warning("Encoder node " + candidate.address + " did not answer");
+                continue;
+            }
+
+            MessageReader status(payload.data(), payload.size());
+            uint32_t version = status.get32();
+            candidate.activeSessions = status.get32();
+            candidate.maxSessions = status.get32();
+            status.get32(); // Hardware threads (informational)
+            candidate.codecs = status.get32();
+            if (!status.ok() || version != EncoderLink::VERSION)
+            {
+                Logger::warning("Encoder node " + candidate.address + " speaks another protocol version");
+                continue;
+            }
+            candidate.order = candidates.size();
+            candidates.push_back(std::move(candidate));
+        }
+
+        // Least busy first; ties rotate so sequential sessions spread too
+        size_t rotation = candidates.empty() ? 0 : s_rotation.fetch_add(1) % candidates.size();
+        auto rank = [&](const Candidate &candidate)
+        {
+            bool full = candidate.activeSessions >= candidate.maxSessions;
+            size_t order = (candidate.order + candidates.size() - rotation) % candidates.size();
+            return std::make_tuple(full, candidate.activeSessions, order);
+        };
+        std::sort(candidates.begin(), candidates.end(),
+                  [&](const Candidate &a, const Candidate &b)
+                  { return rank(a) < rank(b); });
+
+        std::string name = std::filesystem::path(m_config.output).filename().string();
+        for (Candidate &candidate : candidates)
+        {
+            MessageWriter open(EncoderMessage::Open);
+            open.put32(static_cast<uint32_t>(m_config.width));
+            open.put32(static_cast<uint32_t>(m_config.height));
+            open.put32(static_cast<uint32_t>(m_config.fps));
+            open.putString(m_config.preset);
+            open.putString(m_config.pixelFormat);
+            open.putString(m_config.inputPixelFormat);
+            open.putString(name);
+            open.put64(m_frameSize);
+
+            // The node starts ffmpeg before answering
+            candidate.link->setReceiveTimeout(std::max(m_options.connectTimeoutMs, 10000));
+            EncoderMessage type;
+            std::vector<uint8_t> payload;
+            if (!candidate.link->send(open) || !candidate.link->receive(type, payload))
+            {
+                Logger::warning("Encoder node " + candidate.address + " dropped the session request");
+                continue;
+            }
+
+            MessageReader opened(payload.data(), payload.size());
+            bool ok = type == EncoderMessage::Opened && opened.get8() != 0;
+            std::string error = opened.getString();
+            if (!ok)
+            {
+                Logger::warning("Encoder node " + candidate.address + " refused the session: " + error);
+                continue;
+            }
+
+            m_link = std::move(candidate.link);
+            m_node = candidate.address;
+            m_codec = FrameDelta::bestCodec(candidate.codecs);
+            return true;
+        }
+
+        Logger::error("No encoder node accepted the recording");
+        return false;
+    }
+
+    bool RemoteVideoWriter::writeFrame(const uint8_t *frameData, size_t dataSize)
+    {
+        return enqueue(frameData, dataSize, -1);
+    }
+
+    bool RemoteVideoWriter::writeFrameAt(const uint8_t *frameData, size_t dataSize, int64_t pts)
+    {
+        return enqueue(frameData, dataSize, pts);
+    }
+
+    void RemoteVideoWriter::setEndTime(int64_t pts)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (pts > 0 && static_cast<uint64_t>(pts) > m_nextSequence)
+        {
+            m_nextSequence = static_cast<uint64_t>(pts);
+        }
+    }
+
+    bool RemoteVideoWriter::enqueue(const uint8_t *frameData, size_t dataSize, int64_t pts)
+    {
+        if (!m_active || frameData == nullptr)
+        {
+            return false;
+        }
+        if (dataSize != m_frameSize)
+        {
+            Logger::warning("Frame size mismatch: expected " + std::to_string(m_frameSize) + ", got " +
+                            std::to_string(dataSize));
+            return false;
+        }
+
+        // Every call takes a slot: the node repeats the previous frame for slots that never arrive
+        PendingFrame frame;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            frame.sequence = pts >= 0 ? std::max(static_cast<uint64_t>(pts), m_nextSequence) : m_nextSequence;
+            m_nextSequence = frame.sequence + 1;
+            if (m_failed || m_finishing || m_inFlight >= m_options.maxInFlight)
+            {
+                m_dropped++;
+                return false;
+            }
+            m_inFlight++;
+            if (!m_pool.empty())
+            {
+                frame.data = std::move(m_pool.back());
+                m_pool.pop_back();
+            }
+        }
+
+        frame.timestampUs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count());
+        frame.data.assign(frameData, frameData + dataSize);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.push_back(std::move(frame));
+        }
+        m_changed.notify_all();
+        return true;
+    }
+
+    void RemoteVideoWriter::sendLoop()
+    {
+        MessageWriter message(EncoderMessage::Frame);
+        for (;;)
+        {
+            PendingFrame frame;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_changed.wait(lock, [this]
+                               { return !m_queue.empty() || m_finishing || m_failed; });
+                if (m_failed)
+                {
+                    return;
+                }
+                if (m_queue.empty())
+                {
+                    // Drained: the node pads any trailing dropped frames up to the total
+                    message.reset(EncoderMessage::Finish);
+                    message.put64(m_nextSequence);
+                    lock.unlock();
+                    if (!m_link->send(message))
+                    {
+                        fail("connection lost while finishing");
+                    }
+                    return;
+                }
+                frame = std::move(m_queue.front());
+                m_queue.pop_front();
+            }
+
+            message.reset(EncoderMessage::Frame);
+            message.put64(frame.sequence);
+            message.put64(frame.timestampUs);
+            m_delta.encode(frame.data.data(), m_codec, message);
+            if (!m_link->send(message))
+            {
+                fail("connection lost");
+                return;
+            }
+            m_bytesSent.fetch_add(message.finish().size());
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (static_cast<int>(m_pool.size()) < m_options.maxInFlight)
+            {
+                m_pool.push_back(std::move(frame.data));
+            }
+        }
+    }
+
+    void RemoteVideoWriter::receiveLoop()
+    {
+        EncoderMessage type;
+        std::vector<uint8_t> payload;
+        while (m_link->receive(type, payload))
+        {
+            MessageReader in(payload.data(), payload.size());
+            switch (type)
+            {
+            case EncoderMessage::Ack:
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_inFlight = std::max(0, m_inFlight - 1);
+                break;
+            }
+            case EncoderMessage::Result:
+                m_resultOk = in.get8() != 0;
+                m_encodedFrames = in.get64();
+                in.get64(); // Bytes piped to the node's ffmpeg
+                m_encoderUsage.valid = in.get8() != 0;
+                m_encoderUsage.userSeconds = in.getDouble();
+                m_encoderUsage.systemSeconds = in.getDouble();
+                m_encoderUsage.peakRssKb = static_cast<long>(in.get64());
+                m_fileSize = in.get64();
+                m_file.open(m_partialPath, std::ios::binary | std::ios::trunc);
+                if (!m_file)
+                {
+                    Logger::error("Cannot write " + m_partialPath);
+                }
+                break;
+            case EncoderMessage::FileData:
+                if (!payload.empty())
+                {
+                    m_file.write(reinterpret_cast<const char *>(payload.data()), payload.size());
+                    m_fileReceived += payload.size();
+                    break;
+                }
+                m_file.close();
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_done = true;
+                }
+                m_changed.notify_all();
+                return;
+            case EncoderMessage::Error:
+                fail("node " + m_node + ": " + in.getString());
+                return;
+            default:
+                fail("unexpected message from " + m_node);
+                return;
+            }
+            m_changed.notify_all();
+        }
+        fail("connection to " + m_node + " lost");
+    }
+
+    void RemoteVideoWriter::fail(const std::string &reason)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_failed || m_done)
+            {
+                return;
+            }
+            m_failed = true;
+        }
+        Logger::error("Remote encoding failed: " + reason);
+        m_changed.notify_all();
+    }
+
+    void RemoteVideoWriter::closeSession()
+    {
+        if (m_link)
+        {
+            m_link->wake();
+        }
+        if (m_sender.joinable())
+        {
+            m_sender.join();
+        }
+        if (m_receiver.joinable())
+        {
+            m_receiver.join();
+        }
+        m_link.reset();
+        m_active = false;
+    }
+
+    bool RemoteVideoWriter::finalize()
+    {
+        if (!m_active)
+        {
+            return false;
+        }
+
+        bool done = false;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_finishing = true;
+            m_changed.notify_all();
+            done = m_changed.wait_for(lock, std::chrono::milliseconds(m_options.finishTimeoutMs),
+                                      [this]
+                                      { return m_done || m_failed; }) &&
+                   m_done;
+        }
+        if (!done)
+        {
+            fail("no result from " + m_node);
+        }
+        closeSession();
+
+        std::error_code ec;
+        bool complete = done && m_resultOk && m_file && m_fileReceived == m_fileSize;
+        if (complete)
+        {
+            std::filesystem::rename(m_partialPath, m_config.output, ec);
+            complete = !ec;
+        }
+        if (!complete)
+        {
+            std::filesystem::remove(m_partialPath, ec);
+            Logger::error("Remote recording " + m_config.output + " incomplete");
+            return false;
+        }
+
+        Logger::info("Remote encode finished on " + m_node + ": " + std::to_string(m_encodedFrames) + " frames, " +
+                     std::to_string(getDroppedFrames()) + " dropped by backpressure, " +
+                     std::to_string(m_bytesSent.load() / 1024) + " KB sent");
+        return true;
+    }
+
+    uint64_t RemoteVideoWriter::getDroppedFrames() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_dropped;
+    }
+
+} // namespace NanoRec
@@ -0,0 +1,171 @@
+/**
+ * @file SimulatedVideoWriter.cpp
+ * @brief Encoder stand-in with injectable latency, throughput caps and failures
+ * @author NanoRec-CPP Team
+ * @date 2026-10-18
+ */
+
+#include "core/SimulatedVideoWriter.hpp"
+#include "core/Logger.hpp"
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+namespace NanoRec
+{
+
+    bool SimulatedVideoWriter::parseSpec(const std::string &spec, Options &options)
+    {
+        std::stringstream entries(spec);
+        std::string entry;
+        while (std::getline(entries, entry, ','))
+        {
+            entry.erase(0, entry.find_first_not_of(" \t"));
+            entry.erase(entry.find_last_not_of(" \t") + 1);
+            if (entry.empty())
+            {
+                continue;
+            }
+            if (entry == "noinit")
+            {
+                options.failInitialize = true;
+                continue;
+            }
+
+            size_t equals = entry.find('=');
+            if (equals == std::string::npos)
+            {
+                return false;
+            }
+            std::string key = entry.substr(0, equals);
+            std::string value = entry.substr(equals + 1);
+            try
+            {
+                size_t used = 0;
+                if (key == "latency")
+                {
+                    options.latencyUs = static_cast<int>(std::stod(value, &used) * 1000.0);
+                }
+                else if (key == "spike")
+                {
+                    size_t slash = value.find('/');
+                    if (slash == std::string::npos)
+                    {
+                        return false;
+                    }
+                    size_t everyUsed = 0;
+                    options.spikeMs = std::stoi(value.substr(0, slash), &used);
+                    options.spikeEvery = std::stoi(value.substr(slash + 1), &everyUsed);
+                    used = used == slash ? slash + 1 + everyUsed : 0;
+                }
+                else if (key == "rate")
+                {
+                    options.throughputMBps = std::stod(value, &used);
+                }
+                else if (key == "partial")
+                {
+                    options.partialEvery = std::stoi(value, &used);
+                }
+                else if (key == "exit")
+                {
+                    options.exitAfterFrames = std::stoll(value, &used);
+                }
+                else
+                {
+                    return false;
+                }
+                if (used != value.size())
+                {
+                    return false;
+                }
+            }
+            catch (const std::exception &)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    SimulatedVideoWriter::SimulatedVideoWriter(const Options &options) : m_options(options)
+    {
+    }
+
+    bool SimulatedVideoWriter::initialize(const VideoConfig &config)
+    {
+        if (m_options.failInitialize)
+        {
+            Logger::error("Simulated encoder: failed to start");
+            return false;
+        }
+
+        m_config = config;
+        m_active = true;
+        m_exited.store(false);
+        m_writes = 0;
+        m_framesWritten = 0;
+        m_partialWrites = 0;
+        m_bytesWritten = 0;
+        Logger::info("Simulated encoder: " + std::to_string(config.width) + "x" + std::to_string(config.height) +
+                     " @ " + std::to_string(config.fps) + " FPS -> " + config.output);
+        return true;
+    }
+
+    bool SimulatedVideoWriter::writeFrame(const uint8_t *frameData, size_t dataSize)
+    {
+        if (!m_active || m_exited.load() || frameData == nullptr)
+        {
+            return false;
+        }
+        if (m_options.exitAfterFrames >= 0 && static_cast<int64_t>(m_framesWritten) >= m_options.exitAfterFrames)
+        {
+            // Like a crashed ffmpeg: the pipe breaks and stays broken
+            m_exited.store(true);
+            Logger::warning("Simulated encoder: exited after " + std::to_string(m_framesWritten) + " frames");
+            return false;
+        }
+
+        // A full pipe blocks the writer: encode time, occasional stalls, then the byte-rate cap
+        m_writes++;
+        auto delay = std::chrono::microseconds(m_options.latencyUs);
+        if (m_options.spikeEvery > 0 && m_writes % m_options.spikeEvery == 0)
+        {
+            delay += std::chrono::milliseconds(m_options.spikeMs);
+        }
+        // Time is taken per write, so idle periods never allow a later burst above the cap
+        auto ready = std::chrono::steady_clock::now() + delay;
+        if (m_options.throughputMBps > 0.0)
+        {
+            ready += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(dataSize / (m_options.throughputMBps * 1e6)));
+        }
+        std::this_thread::sleep_until(ready);
+
+        if (m_options.partialEvery > 0 && m_writes % m_options.partialEvery == 0)
+        {
+            m_partialWrites++;
+            return false;
+        }
+
+        if (m_options.onFrame)
+        {
+            m_options.onFrame(frameData, dataSize);
+        }
+        m_framesWritten++;
+        m_bytesWritten += dataSize;
+        return true;
+    }
+
+    bool SimulatedVideoWriter::finalize()
+    {
+        if (!m_active)
+        {
+            return true;
+        }
+        m_active = false;
+        Logger::info("Simulated encoder: " + std::to_string(m_framesWritten) + " frames, " +
+                     std::to_string(m_partialWrites) + " short writes" + (m_exited.load() ? ", exited early" : ""));
+        return !m_exited.load();
+    }
+
+} // namespace NanoRec
@@ -0,0 +1,99 @@
+#include "core/StripePipeline.hpp"
+#include "core/FrameScaler.hpp"
+#include "core/Logger.hpp"
+#include "core/WorkerPool.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace NanoRec
+{
+
+    bool StripePipeline::process(const FrameBuffer &source, int width, int height, const TextOverlay *overlay,
+                                 YuvFrame::Layout layout, YuvFrame &destination, int stripeRows, int threads)
+    {
+        if (!source.data || source.width <= 0 || source.height <= 0 || width <= 0 || height <= 0)
+        {
+            Logger::error("Invalid frame for stripe processing");
+            return false;
+        }
+
+        // Stripes start on even rows so each one owns whole chroma rows
+        stripeRows = std::max(2, (stripeRows + 1) & ~1);
+        destination.allocate(width, height, layout);
+
+        int stripes = (height + stripeRows - 1) / stripeRows;
+        threads = std::clamp(threads, 1, stripes);
+        int stripesPerBand = (stripes + threads - 1) / threads;
+
+        m_stripes.resize(threads);
+        for (FrameBuffer &stripe : m_stripes)
+        {
+            if (stripe.width != width || stripe.height != stripeRows || !stripe.data)
+            {
+                stripe.free();
+                stripe.allocate(width, stripeRows);
+            }
+        }
+
+        WorkerPool::shared().parallelFor(threads,
+                                         [&](int band)
+                                         {
+                                             int rowBegin = std::min(height, band * stripesPerBand * stripeRows);
+                                             int rowEnd = std::min(height, rowBegin + stripesPerBand * stripeRows);
+                                             processBand(source, overlay, destination, rowBegin, rowEnd, stripeRows,
+                                                         m_stripes[band]);
+                                         });
+        return true;
+    }
+
+    void StripePipeline::processBand(const FrameBuffer &source, const TextOverlay *overlay, YuvFrame &destination,
+                                     int rowBegin, int rowEnd, int stripeRows, FrameBuffer &stripe)
+    {
+        const int width = destination.width;
+        const int height = destination.height;
+        const bool scaling = source.width != width || source.height != height;
+
+        int overlayTop = 0;
+        int overlayBottom = 0;
+        if (overlay)
+        {
+            overlay->getPreparedRows(overlayTop, overlayBottom);
+        }
+
+        FrameBuffer view;
+        for (int top = rowBegin; top < rowEnd; top += stripeRows)
+        {
+            int rows = std::min(stripeRows, rowEnd - top);
+            bool covered = top < overlayBottom && top + rows > overlayTop;
+
+            // Untouched native-resolution rows go straight from the capture to YUV
+            if (!scaling && !covered)
+            {
+                YuvConverter::convertStripe(source, 0, destination, top, top + rows);
+                continue;
+            }
+
+            view.borrow(stripe.data, width, rows, stripe.stride);
+            if (scaling)
+            {
+                FrameScaler::scaleStripe(source, view, height, top);
+            }
+            else
+            {
+                for (int y = 0; y < rows; ++y)
+                {
+                    std::memcpy(view.data + static_cast<size_t>(y) * view.stride,
+                                source.data + static_cast<size_t>(top + y) * source.stride,
+                                static_cast<size_t>(width) * 3);
+                }
+            }
+
+            if (covered)
+            {
+                overlay->applyStripe(view, top);
+            }
+            YuvConverter::convertStripe(view, top, destination, top, top + rows);
+        }
+    }
+
+} // namespace NanoRec
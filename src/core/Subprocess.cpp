@@ -0,0 +1,506 @@
+#include "core/Subprocess.hpp"
+#include "core/Logger.hpp"
+#include <cstdint>
+#include <cstring>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace NanoRec
+{
+
+    Subprocess::Subprocess()
+#ifdef _WIN32
+        : m_stdin(INVALID_HANDLE_VALUE), m_stdout(INVALID_HANDLE_VALUE)
+#else
+        : m_stdinFd(-1), m_stdoutFd(-1), m_pid(-1)
+#endif
+    {
+#ifdef _WIN32
+        ZeroMemory(&m_processInfo, sizeof(m_processInfo));
+#endif
+    }
+
+    Subprocess::~Subprocess()
+    {
+        if (isRunning())
+        {
+            kill();
+        }
+        closePipes();
+    }
+
+    bool Subprocess::run(const std::vector<std::string> &args, std::string &output)
+    {
+        Subprocess process;
+        if (!process.start(args, PIPE_STDOUT))
+        {
+            return false;
+        }
+
+        char buffer[4096];
+        long n;
+        while ((n = process.readSome(buffer, sizeof(buffer))) > 0)
+        {
+            output.append(buffer, static_cast<size_t>(n));
+        }
+
+        return process.wait() == 0;
+    }
+
+    bool Subprocess::readExact(void *buffer, size_t size)
+    {
+        uint8_t *dst = static_cast<uint8_t *>(buffer);
+        while (size > 0)
+        {
+            long n = readSome(dst, size);
+            if (n <= 0)
+            {
+                return false;
+            }
+            dst += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+#ifdef _WIN32
+
+    static std::string quoteArgument(const std::string &arg)
+    {
+        if (!arg.empty() && arg.find_first_of(" \t\"") == std::string::npos)
+        {
+            return arg;
+        }
+
+        std::string quoted = "\"";
+        for (char c : arg)
+        {
+            if (c == '"')
+            {
+                quoted += '\\';
+            }
+            quoted += c;
+        }
+        quoted += '"';
+        return quoted;
+    }
+
+    bool Subprocess::start(const std::vector<std::string> &args, int pipes)
+    {
+        if (args.empty() || isRunning())
+        {
+            return false;
+        }
+
+        SECURITY_ATTRIBUTES saAttr;
+        saAttr.nLength = sizeof(SECURITY_ATTRIBUTES);
+        saAttr.bInheritHandle = TRUE;
+        saAttr.lpSecurityDescriptor = nullptr;
+
+        HANDLE childStdin = GetStdHandle(STD_INPUT_HANDLE);
+        HANDLE childStdout = GetStdHandle(STD_OUTPUT_HANDLE);
+
+        if (pipes & PIPE_STDIN)
+        {
+            if (!CreatePipe(&childStdin, &m_stdin, &saAttr, 0))
+            {
+                return false;
+            }
+            SetHandleInformation(m_stdin, HANDLE_FLAG_INHERIT, 0);
+        }
+
+        if (pipes & PIPE_STDOUT)
+        {
+            if (!CreatePipe(&m_stdout, &childStdout, &saAttr, 0))
+            {
+                closePipes();
+                return false;
+            }
+            SetHandleInformation(m_stdout, HANDLE_FLAG_INHERIT, 0);
+        }
+
+        std::string cmdStr;
+        for (const std::string &arg : args)
+        {
+            if (!cmdStr.empty())
+            {
+                cmdStr += ' ';
+            }
+            cmdStr += quoteArgument(arg);
+        }
+        std::vector<char> cmdLine(cmdStr.begin(), cmdStr.end());
+        cmdLine.push_back('\0');
+
+        STARTUPINFOA si = {sizeof(si)};
+        si.dwFlags = STARTF_USESTDHANDLES | STARTF_USESHOWWINDOW;
+        si.hStdInput = childStdin;
+        si.hStdOutput = childStdout;
+        si.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+        si.wShowWindow = SW_HIDE;
+
+        DWORD creationFlags = CREATE_NO_WINDOW | (m_idlePriority ? IDLE_PRIORITY_CLASS : 0);
+        BOOL success = CreateProcessA(nullptr, cmdLine.data(), nullptr, nullptr, TRUE,
+                                      creationFlags, nullptr, nullptr, &si, &m_processInfo);
+
+        if (pipes & PIPE_STDIN)
+        {
+            CloseHandle(childStdin);
+        }
+        if (pipes & PIPE_STDOUT)
+        {
+            CloseHandle(childStdout);
+        }
+
+        if (!success)
+        {
+            Logger::error("Failed to start process: " + args[0]);
+            closePipes();
+            ZeroMemory(&m_processInfo, sizeof(m_processInfo));
+            return false;
+        }
+
+        return true;
+    }
+
+    long Subprocess::readSome(void *buffer, size_t size)
+    {
+        DWORD bytesRead = 0;
+        if (m_stdout == INVALID_HANDLE_VALUE ||
+            !ReadFile(m_stdout, buffer, static_cast<DWORD>(size), &bytesRead, nullptr))
+        {
+            return GetLastError() == ERROR_BROKEN_PIPE ? 0 : -1;
+        }
+        return static_cast<long>(bytesRead);
+    }
+
+    bool Subprocess::writeAll(const void *data, size_t size)
+    {
+        const uint8_t *src = static_cast<const uint8_t *>(data);
+        while (size > 0)
+        {
+            DWORD written = 0;
+            if (m_stdin == INVALID_HANDLE_VALUE ||
+                !WriteFile(m_stdin, src, static_cast<DWORD>(size), &written, nullptr))
+            {
+                return false;
+            }
+            src += written;
+            size -= written;
+        }
+        return true;
+    }
+
+    void Subprocess::closeStdin()
+    {
+        if (m_stdin != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(m_stdin);
+            m_stdin = INVALID_HANDLE_VALUE;
+        }
+    }
+
+    void Subprocess::closePipes()
+    {
+        closeStdin();
+        if (m_stdout != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(m_stdout);
+            m_stdout = INVALID_HANDLE_VALUE;
+        }
+    }
+
+    int Subprocess::wait()
+    {
+        if (!isRunning())
+        {
+            return -1;
+        }
+
+        closeStdin();
+        WaitForSingleObject(m_processInfo.hProcess, INFINITE);
+
+        DWORD exitCode = 0;
+        GetExitCodeProcess(m_processInfo.hProcess, &exitCode);
+        CloseHandle(m_processInfo.hProcess);
+        CloseHandle(m_processInfo.hThread);
+        ZeroMemory(&m_processInfo, sizeof(m_processInfo));
+        closePipes();
+        return static_cast<int>(exitCode);
+    }
+
+    bool Subprocess::tryWait(int &exitCode)
+    {
+        if (!isRunning() || WaitForSingleObject(m_processInfo.hProcess, 0) != WAIT_OBJECT_0)
+        {
+            return false;
+        }
+        exitCode = wait();
+        return true;
+    }
+
+    void Subprocess::kill()
+    {
+        if (isRunning())
+        {
+            TerminateProcess(m_processInfo.hProcess, 1);
+            wait();
+        }
+    }
+
+    void Subprocess::interrupt()
+    {
+        if (isRunning())
+        {
+            TerminateProcess(m_processInfo.hProcess, 1);
+        }
+    }
+
+    bool Subprocess::suspend()
+    {
+        return false;
+    }
+
+    bool Subprocess::resume()
+    {
+        return false;
+    }
+
+    bool Subprocess::isRunning() const
+    {
+        return m_processInfo.hProcess != nullptr;
+    }
+
+#else
+
+    bool Subprocess::start(const std::vector<std::string> &args, int pipes)
+    {
+        if (args.empty() || isRunning())
+        {
+            return false;
+        }
+
+        int stdinPipe[2] = {-1, -1};
+        int stdoutPipe[2] = {-1, -1};
+
+        if ((pipes & PIPE_STDIN) && pipe2(stdinPipe, O_CLOEXEC) == -1)
+        {
+            Logger::error("Failed to create pipe: " + std::string(strerror(errno)));
+            return false;
+        }
+
+        if ((pipes & PIPE_STDOUT) && pipe2(stdoutPipe, O_CLOEXEC) == -1)
+        {
+            Logger::error("Failed to create pipe: " + std::string(strerror(errno)));
+            if (stdinPipe[0] != -1)
+            {
+                close(stdinPipe[0]);
+                close(stdinPipe[1]);
+            }
+            return false;
+        }
+
+        // Build argv before fork (only async-signal-safe calls in the child)
+        std::vector<char *> argv;
+        for (const std::string &arg : args)
+        {
+            argv.push_back(const_cast<char *>(arg.c_str()));
+        }
+        argv.push_back(nullptr);
+
+        pid_t pid = fork();
+        if (pid == -1)
+        {
+            Logger::error("Failed to fork process: " + std::string(strerror(errno)));
+            for (int fd : {stdinPipe[0], stdinPipe[1], stdoutPipe[0], stdoutPipe[1]})
+            {
+                if (fd != -1)
+                {
+                    close(fd);
+                }
+            }
+            return false;
+        }
+
+        if (pid == 0)
+        {
+            // Child process
+            if (stdinPipe[0] != -1)
+            {
+                dup2(stdinPipe[0], STDIN_FILENO);
+            }
+            if (stdoutPipe[1] != -1)
+            {
+                dup2(stdoutPipe[1], STDOUT_FILENO);
+            }
+
+            if (m_idlePriority)
+            {
+                // Only runs when the CPU would otherwise idle; I/O class idle (3), level 0
+                sched_param param{};
+                sched_setscheduler(0, SCHED_IDLE, &param);
+#ifdef SYS_ioprio_set
+                syscall(SYS_ioprio_set, 1 /* IOPRIO_WHO_PROCESS */, 0, (3 << 13) /* IOPRIO_CLASS_IDLE */);
+#endif
+            }
+
+            execvp(argv[0], argv.data());
+            _exit(127);
+        }
+
+        // Parent process
+        if (stdinPipe[0] != -1)
+        {
+            close(stdinPipe[0]);
+            m_stdinFd = stdinPipe[1];
+        }
+        if (stdoutPipe[1] != -1)
+        {
+            close(stdoutPipe[1]);
+            m_stdoutFd = stdoutPipe[0];
+        }
+
+        m_pid = pid;
+        return true;
+    }
+
+    long Subprocess::readSome(void *buffer, size_t size)
+    {
+        if (m_stdoutFd == -1)
+        {
+            return -1;
+        }
+
+        ssize_t n;
+        do
+        {
+            n = read(m_stdoutFd, buffer, size);
+        } while (n == -1 && errno == EINTR);
+
+        return static_cast<long>(n);
+    }
+
+    bool Subprocess::writeAll(const void *data, size_t size)
+    {
+        const uint8_t *src = static_cast<const uint8_t *>(data);
+        while (size > 0)
+        {
+            if (m_stdinFd == -1)
+            {
+                return false;
+            }
+
+            ssize_t n = write(m_stdinFd, src, size);
+            if (n == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+            src += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    void Subprocess::closeStdin()
+    {
+        if (m_stdinFd != -1)
+        {
+            close(m_stdinFd);
+            m_stdinFd = -1;
+        }
+    }
+
+    void Subprocess::closePipes()
+    {
+        closeStdin();
+        if (m_stdoutFd != -1)
+        {
+            close(m_stdoutFd);
+            m_stdoutFd = -1;
+        }
+    }
+
+    int Subprocess::wait()
+    {
+        if (!isRunning())
+        {
+            return -1;
+        }
+
+        closeStdin();
+
+        int status = 0;
+        while (waitpid(m_pid, &status, 0) == -1 && errno == EINTR)
+        {
+        }
+        m_pid = -1;
+        closePipes();
+
+        return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    }
+
+    bool Subprocess::tryWait(int &exitCode)
+    {
+        if (!isRunning())
+        {
+            return false;
+        }
+
+        int status = 0;
+        if (waitpid(m_pid, &status, WNOHANG) != m_pid)
+        {
+            return false;
+        }
+        m_pid = -1;
+        closePipes();
+
+        exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+        return true;
+    }
+
+    void Subprocess::kill()
+    {
+        if (isRunning())
+        {
+            ::kill(m_pid, SIGKILL);
+            wait();
+        }
+    }
+
+    void Subprocess::interrupt()
+    {
+        if (isRunning())
+        {
+            ::kill(m_pid, SIGKILL);
+        }
+    }
+
+    bool Subprocess::suspend()
+    {
+        return isRunning() && ::kill(m_pid, SIGSTOP) == 0;
+    }
+
+    bool Subprocess::resume()
+    {
+        return isRunning() && ::kill(m_pid, SIGCONT) == 0;
+    }
+
+    bool Subprocess::isRunning() const
+    {
+        return m_pid != -1;
+    }
+
+#endif
+
+} // namespace NanoRec
@@ -0,0 +1,382 @@
+#include "core/TextOverlay.hpp"
+#include "core/Logger.hpp"
+#include "core/Simd.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+
+#ifdef _WIN32
+#include <cstdlib>
+#else
+#include <unistd.h>
+#endif
+
+namespace NanoRec
+{
+
+    // Public domain 8x8 font (printable ASCII 32..126), one byte per row, bit 0 = leftmost pixel
+    static const uint8_t FONT_8X8[95][8] = {
+        {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // ' '
+        {0x18, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x18, 0x00}, // !
+        {0x36, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // "
+        {0x36, 0x36, 0x7F, 0x36, 0x7F, 0x36, 0x36, 0x00}, // #
+        {0x0C, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x0C, 0x00}, // $
+        {0x00, 0x63, 0x33, 0x18, 0x0C, 0x66, 0x63, 0x00}, // %
+        {0x1C, 0x36, 0x1C, 0x6E, 0x3B, 0x33, 0x6E, 0x00}, // &
+        {0x06, 0x06, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00}, // apostrophe
+        {0x18, 0x0C, 0x06, 0x06, 0x06, 0x0C, 0x18, 0x00}, // (
+        {0x06, 0x0C, 0x18, 0x18, 0x18, 0x0C, 0x06, 0x00}, // )
+        {0x00, 0x66, 0x3C, 0xFF, 0x3C, 0x66, 0x00, 0x00}, // *
+        {0x00, 0x0C, 0x0C, 0x3F, 0x0C, 0x0C, 0x00, 0x00}, // +
+        {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x06}, // ,
+        {0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x00}, // -
+        {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00}, // .
+        {0x60, 0x30, 0x18, 0x0C, 0x06, 0x03, 0x01, 0x00}, // /
+        {0x3E, 0x63, 0x73, 0x7B, 0x6F, 0x67, 0x3E, 0x00}, // 0
+        {0x0C, 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x3F, 0x00}, // 1
+        {0x1E, 0x33, 0x30, 0x1C, 0x06, 0x33, 0x3F, 0x00}, // 2
+        {0x1E, 0x33, 0x30, 0x1C, 0x30, 0x33, 0x1E, 0x00}, // 3
+        {0x38, 0x3C, 0x36, 0x33, 0x7F, 0x30, 0x78, 0x00}, // 4
+        {0x3F, 0x03, 0x1F, 0x30, 0x30, 0x33, 0x1E, 0x00}, // 5
+        {0x1C, 0x06, 0x03, 0x1F, 0x33, 0x33, 0x1E, 0x00}, // 6
+        {0x3F, 0x33, 0x30, 0x18, 0x0C, 0x0C, 0x0C, 0x00}, // 7
+        {0x1E, 0x33, 0x33, 0x1E, 0x33, 0x33, 0x1E, 0x00}, // 8
+        {0x1E, 0x33, 0x33, 0x3E, 0x30, 0x18, 0x0E, 0x00}, // 9
+        {0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x00}, // :
+        {0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x06}, // ;
+        {0x18, 0x0C, 0x06, 0x03, 0x06, 0x0C, 0x18, 0x00}, // <
+        {0x00, 0x00, 0x3F, 0x00, 0x00, 0x3F, 0x00, 0x00}, // =
+        {0x06, 0x0C, 0x18, 0x30, 0x18, 0x0C, 0x06, 0x00}, // >
+        {0x1E, 0x33, 0x30, 0x18, 0x0C, 0x00, 0x0C, 0x00}, // ?
+        {0x3E, 0x63, 0x7B, 0x7B, 0x7B, 0x03, 0x1E, 0x00}, // @
+        {0x0C, 0x1E, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x00}, // A
+        {0x3F, 0x66, 0x66, 0x3E, 0x66, 0x66, 0x3F, 0x00}, // B
+        {0x3C, 0x66, 0x03, 0x03, 0x03, 0x66, 0x3C, 0x00}, // C
+        {0x1F, 0x36, 0x66, 0x66, 0x66, 0x36, 0x1F, 0x00}, // D
+        {0x7F, 0x46, 0x16, 0x1E, 0x16, 0x46, 0x7F, 0x00}, // E
+        {0x7F, 0x46, 0x16, 0x1E, 0x16, 0x06, 0x0F, 0x00}, // F
+        {0x3C, 0x66, 0x03, 0x03, 0x73, 0x66, 0x7C, 0x00}, // G
+        {0x33, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x33, 0x00}, // H
+        {0x1E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00}, // I
+        {0x78, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E, 0x00}, // J
+        {0x67, 0x66, 0x36, 0x1E, 0x36, 0x66, 0x67, 0x00}, // K
+        {0x0F, 0x06, 0x06, 0x06, 0x46, 0x66, 0x7F, 0x00}, // L
+        {0x63, 0x77, 0x7F, 0x7F, 0x6B, 0x63, 0x63, 0x00}, // M
+        {0x63, 0x67, 0x6F, 0x7B, 0x73, 0x63, 0x63, 0x00}, // N
+        {0x1C, 0x36, 0x63, 0x63, 0x63, 0x36, 0x1C, 0x00}, // O
+        {0x3F, 0x66, 0x66, 0x3E, 0x06, 0x06, 0x0F, 0x00}, // P
+        {0x1E, 0x33, 0x33, 0x33, 0x3B, 0x1E, 0x38, 0x00}, // Q
+        {0x3F, 0x66, 0x66, 0x3E, 0x36, 0x66, 0x67, 0x00}, // R
+        {0x1E, 0x33, 0x07, 0x0E, 0x38, 0x33, 0x1E, 0x00}, // S
+        {0x3F, 0x2D, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00}, // T
+        {0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x3F, 0x00}, // U
+        {0x33, 0x33, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00}, // V
+        {0x63, 0x63, 0x63, 0x6B, 0x7F, 0x77, 0x63, 0x00}, // W
+        {0x63, 0x63, 0x36, 0x1C, 0x1C, 0x36, 0x63, 0x00}, // X
+        {0x33, 0x33, 0x33, 0x1E, 0x0C, 0x0C, 0x1E, 0x00}, // Y
+        {0x7F, 0x63, 0x31, 0x18, 0x4C, 0x66, 0x7F, 0x00}, // Z
+        {0x1E, 0x06, 0x06, 0x06, 0x06, 0x06, 0x1E, 0x00}, // [
+        {0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0x40, 0x00}, // backslash
+        {0x1E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1E, 0x00}, // ]
+        {0x08, 0x1C, 0x36, 0x63, 0x00, 0x00, 0x00, 0x00}, // ^
+        {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF}, // _
+        {0x0C, 0x0C, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00}, // `
+        {0x00, 0x00, 0x1E, 0x30, 0x3E, 0x33, 0x6E, 0x00}, // a
+        {0x07, 0x06, 0x06, 0x3E, 0x66, 0x66, 0x3B, 0x00}, // b
+        {0x00, 0x00, 0x1E, 0x33, 0x03, 0x33, 0x1E, 0x00}, // c
+        {0x38, 0x30, 0x30, 0x3E, 0x33, 0x33, 0x6E, 0x00}, // d
+        {0x00, 0x00, 0x1E, 0x33, 0x3F, 0x03, 0x1E, 0x00}, // e
+        {0x1C, 0x36, 0x06, 0x0F, 0x06, 0x06, 0x0F, 0x00}, // f
+        {0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x1F}, // g
+        {0x07, 0x06, 0x36, 0x6E, 0x66, 0x66, 0x67, 0x00}, // h
+        {0x0C, 0x00, 0x0E, 0x0C, 0x0C, 0x0C, 0x1E, 0x00}, // i
+        {0x30, 0x00, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E}, // j
+        {0x07, 0x06, 0x66, 0x36, 0x1E, 0x36, 0x67, 0x00}, // k
+        {0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00}, // l
+        {0x00, 0x00, 0x33, 0x7F, 0x7F, 0x6B, 0x63, 0x00}, // m
+        {0x00, 0x00, 0x1F, 0x33, 0x33, 0x33, 0x33, 0x00}, // n
+        {0x00, 0x00, 0x1E, 0x33, 0x33, 0x33, 0x1E, 0x00}, // o
+        {0x00, 0x00, 0x3B, 0x66, 0x66, 0x3E, 0x06, 0x0F}, // p
+        {0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x78}, // q
+        {0x00, 0x00, 0x3B, 0x6E, 0x66, 0x06, 0x0F, 0x00}, // r
+        {0x00, 0x00, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x00}, // s
+        {0x08, 0x0C, 0x3E, 0x0C, 0x0C, 0x2C, 0x18, 0x00}, // t
+        {0x00, 0x00, 0x33, 0x33, 0x33, 0x33, 0x6E, 0x00}, // u
+        {0x00, 0x00, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00}, // v
+        {0x00, 0x00, 0x63, 0x6B, 0x7F, 0x7F, 0x36, 0x00}, // w
+        {0x00, 0x00, 0x63, 0x36, 0x1C, 0x36, 0x63, 0x00}, // x
+        {0x00, 0x00, 0x33, 0x33, 0x33, 0x3E, 0x30, 0x1F}, // y
+        {0x00, 0x00, 0x3F, 0x19, 0x0C, 0x26, 0x3F, 0x00}, // z
+        {0x38, 0x0C, 0x0C, 0x07, 0x0C, 0x0C, 0x38, 0x00}, // {
+        {0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00}, // |
+        {0x07, 0x0C, 0x0C, 0x38, 0x0C, 0x0C, 0x07, 0x00}, // }
+        {0x6E, 0x3B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // ~
+    };
+
+    TextOverlay::TextOverlay() = default;
+
+    bool TextOverlay::configure(const Options &options)
+    {
+        if (options.scale < 1 || options.scale > 8)
+        {
+            Logger::error("Invalid overlay scale: " + std::to_string(options.scale));
+            return false;
+        }
+
+        m_options = options;
+        if (m_options.label.empty())
+        {
+            m_options.label = getHostName();
+        }
+
+        const int scale = m_options.scale;
+        const int shadow = std::max(1, scale / 2);
+        m_cellWidth = 8 * scale;
+        m_cellHeight = 8 * scale + shadow;
+
+        size_t cellBytes = static_cast<size_t>(m_cellWidth) * m_cellHeight * 3;
+        m_atlasPremul.assign(cellBytes * GLYPH_COUNT, 0);
+        m_atlasInverse.assign(cellBytes * GLYPH_COUNT, 0);
+
+        auto glyphBit = [&](int glyph, int x, int y)
+        {
+            // Font coordinates at cell scale; outside the 8x8 bitmap is empty
+            if (x < 0 || y < 0 || x >= 8 * scale || y >= 8 * scale)
+            {
+                return false;
+            }
+            return ((FONT_8X8[glyph][y / scale] >> (x / scale)) & 1) != 0;
+        };
+
+        // Composite background box, drop shadow and text once per glyph
+        for (int glyph = 0; glyph < GLYPH_COUNT; ++glyph)
+        {
+            uint8_t *premul = m_atlasPremul.data() + glyph * cellBytes;
+            uint8_t *inverse = m_atlasInverse.data() + glyph * cellBytes;
+
+            for (int y = 0; y < m_cellHeight; ++y)
+            {
+                for (int x = 0; x < m_cellWidth; ++x)
+                {
+                    int alpha = m_options.backgroundAlpha;
+                    int color[3] = {0, 0, 0};
+
+                    if (glyphBit(glyph, x, y))
+                    {
+                        alpha = 255;
+                        color[0] = m_options.color[0];
+                        color[1] = m_options.color[1];
+                        color[2] = m_options.color[2];
+                    }
+                    else if (glyphBit(glyph, x - shadow, y - shadow))
+                    {
+                        alpha = 255;
+                    }
+
+                    size_t offset = (static_cast<size_t>(y) * m_cellWidth + x) * 3;
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        premul[offset + c] = static_cast<uint8_t>((color[c] * alpha + 127) / 255);
+                        inverse[offset + c] = static_cast<uint8_t>(255 - alpha);
+                    }
+                }
+            }
+        }
+
+        m_text.clear();
+        m_stripPremul.clear();
+        m_stripInverse.clear();
+        return true;
+    }
+
+    std::string TextOverlay::getHostName()
+    {
+#ifdef _WIN32
+        const char *name = std::getenv("COMPUTERNAME");
+        return name ? name : "unknown";
+#else
+        char name[256] = {};
+        if (gethostname(name, sizeof(name) - 1) != 0)
+        {
+            return "unknown";
+        }
+        return name;
+#endif
+    }
+
+    std::string TextOverlay::timestampText() const
+    {
+        auto now = std::chrono::system_clock::now();
+        std::time_t seconds = std::chrono::system_clock::to_time_t(now);
+        int millis = static_cast<int>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000);
+
+        std::tm local{};
+#ifdef _WIN32
+        localtime_s(&local, &seconds);
+#else
+        localtime_r(&seconds, &local);
+#endif
+
+        char text[320];
+        size_t length = std::strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &local);
+        std::snprintf(text + length, sizeof(text) - length, ".%03d  %s", millis, m_options.label.c_str());
+        return text;
+    }
+
+    void TextOverlay::apply(FrameBuffer &frame)
+    {
+        apply(frame, timestampText());
+    }
+
+    void TextOverlay::apply(FrameBuffer &frame, const std::string &text)
+    {
+        if (!frame.data)
+        {
+            return;
+        }
+
+        prepareFrame(frame.width, frame.height, text);
+        applyStripe(frame, 0);
+    }
+
+    void TextOverlay::prepareFrame(int width, int height)
+    {
+        prepareFrame(width, height, timestampText());
+    }
+
+    void TextOverlay::prepareFrame(int width, int height, const std::string &text)
+    {
+        m_placed = m_cellWidth != 0 && !text.empty();
+        if (!m_placed)
+        {
+            return;
+        }
+
+        setText(text);
+
+        int stripWidth = static_cast<int>(m_text.size()) * m_cellWidth;
+        int margin = m_options.margin;
+        bool right = m_options.corner == Corner::TopRight || m_options.corner == Corner::BottomRight;
+        bool bottom = m_options.corner == Corner::BottomLeft || m_options.corner == Corner::BottomRight;
+        m_placedX = right ? width - stripWidth - margin : margin;
+        m_placedY = bottom ? height - m_cellHeight - margin : margin;
+    }
+
+    void TextOverlay::applyStripe(FrameBuffer &stripe, int stripeTop) const
+    {
+        if (m_placed && stripe.data)
+        {
+            // blend() clips to the stripe, so only the rows it holds are touched
+            blend(stripe, m_placedX, m_placedY - stripeTop);
+        }
+    }
+
+    void TextOverlay::getPreparedRows(int &top, int &bottom) const
+    {
+        top = m_placed ? m_placedY : 0;
+        bottom = m_placed ? m_placedY + m_cellHeight : 0;
+    }
+
+    void TextOverlay::setText(const std::string &text)
+    {
+        size_t cellBytes = static_cast<size_t>(m_cellWidth) * m_cellHeight * 3;
+
+        if (text.size() != m_text.size())
+        {
+            // Layout changed: rebuild every cell
+            m_stripPremul.assign(cellBytes * text.size(), 0);
+            m_stripInverse.assign(cellBytes * text.size(), 0);
+            m_text.assign(text.size(), '\0');
+        }
+
+        // Usually only the last few digits of the clock differ
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            if (text[i] != m_text[i])
+            {
+                copyCell(i, text[i]);
+                m_text[i] = text[i];
+            }
+        }
+    }
+
+    void TextOverlay::copyCell(size_t index, char c)
+    {
+        int glyph = static_cast<unsigned char>(c) - FIRST_GLYPH;
+        if (glyph < 0 || glyph >= GLYPH_COUNT)
+        {
+            glyph = '?' - FIRST_GLYPH;
+        }
+
+        size_t cellRow = static_cast<size_t>(m_cellWidth) * 3;
+        size_t stripRow = cellRow * m_text.size();
+        const uint8_t *premul = m_atlasPremul.data() + glyph * cellRow * m_cellHeight;
+        const uint8_t *inverse = m_atlasInverse.data() + glyph * cellRow * m_cellHeight;
+
+        for (int y = 0; y < m_cellHeight; ++y)
+        {
+            std::memcpy(m_stripPremul.data() + y * stripRow + index * cellRow, premul + y * cellRow, cellRow);
+            std::memcpy(m_stripInverse.data() + y * stripRow + index * cellRow, inverse + y * cellRow, cellRow);
+        }
+    }
+
+    // dst = premul + dst * inverse / 255, per byte; the strip is stored in the
+    // frame's byte layout so this is independent of channel order
+    static void blendRow(uint8_t *dst, const uint8_t *premul, const uint8_t *inverse, size_t count)
+    {
+        size_t i = 0;
+#ifdef NANOREC_HAVE_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i round = _mm_set1_epi16(128);
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+            __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(premul + i));
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(inverse + i));
+
+            __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(a, zero)), round);
+            __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(a, zero)), round);
+
+            // (x + (x >> 8)) >> 8 == x / 255 rounded, for x = d * a + 128
+            lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+            hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+
+            __m128i result = _mm_adds_epu8(_mm_packus_epi16(lo, hi), p);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), result);
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            unsigned x = dst[i] * inverse[i] + 128u;
+            unsigned value = premul[i] + ((x + (x >> 8)) >> 8);
+            dst[i] = static_cast<uint8_t>(std::min(255u, value));
+        }
+    }
+
+    void TextOverlay::blend(FrameBuffer &frame, int x, int y) const
+    {
+        int stripWidth = static_cast<int>(m_text.size()) * m_cellWidth;
+
+        // Clip the strip to the frame
+        int left = std::max(0, x);
+        int top = std::max(0, y);
+        int right = std::min(frame.width, x + stripWidth);
+        int bottom = std::min(frame.height, y + m_cellHeight);
+        if (left >= right || top >= bottom)
+        {
+            return;
+        }
+
+        size_t stripRow = static_cast<size_t>(stripWidth) * 3;
+        size_t count = static_cast<size_t>(right - left) * 3;
+        for (int row = top; row < bottom; ++row)
+        {
+            size_t stripOffset = (row - y) * stripRow + static_cast<size_t>(left - x) * 3;
+            blendRow(frame.data + static_cast<size_t>(row) * frame.stride + static_cast<size_t>(left) * 3,
+                     m_stripPremul.data() + stripOffset, m_stripInverse.data() + stripOffset, count);
+        }
+    }
+
+} // namespace NanoRec
@@ -1,6 +1,7 @@
 #include "core/ThreadSafeFrameBuffer.hpp"
 #include "core/Logger.hpp"
 #include <cstring>
+#include <utility>
 
 namespace NanoRec
 {
@@ -15,29 +16,47 @@ namespace NanoRec
 
     void ThreadSafeFrameBuffer::initialize(int width, int height)
     {
+        // May be called again (e.g. after a monitor switch) while frames are pushed:
+        // allocate() releases the old read buffer, and the write buffer belongs to
+        // the producer until the next swap (pushFrame resizes it), so it is only
+        // allocated here the first time
+        std::lock_guard<std::mutex> lock(m_swapMutex);
         m_width = width;
         m_height = height;
-
-        // Allocate both buffers
-        m_buffers[0].allocate(width, height);
-        m_buffers[1].allocate(width, height);
+        m_buffers[m_readIndex.load()].allocate(width, height);
+        FrameBuffer &writeBuffer = m_buffers[m_writeIndex.load()];
+        if (!writeBuffer.data)
+        {
+            writeBuffer.allocate(width, height);
+        }
+        m_hasNewFrame.store(false);
 
         Logger::info("ThreadSafeFrameBuffer initialized: " + std::to_string(width) + "x" + std::to_string(height));
     }
 
     bool ThreadSafeFrameBuffer::pushFrame(const FrameBuffer &frame)
     {
-        if (frame.data == nullptr || frame.width != m_width || frame.height != m_height)
+        if (frame.data == nullptr || frame.width <= 0 || frame.height <= 0)
         {
             return false;
         }
 
-        // Get current write buffer
+        // Get current write buffer (owned by the writer until the swap)
         int writeIdx = m_writeIndex.load();
         FrameBuffer &writeBuffer = m_buffers[writeIdx];
 
+        // Follow source resolution changes (e.g. a monitor switch) without re-initialization
+        if (writeBuffer.width != frame.width || writeBuffer.height != frame.height || !writeBuffer.data)
+        {
+            writeBuffer.allocate(frame.width, frame.height);
+        }
+
         // Copy frame data
-        std::memcpy(writeBuffer.data, frame.data, frame.size);
+        for (int y = 0; y < frame.height; ++y)
+        {
+            std::memcpy(writeBuffer.data + static_cast<size_t>(y) * writeBuffer.stride,
+                        frame.data + static_cast<size_t>(y) * frame.stride, static_cast<size_t>(frame.width) * 3);
+        }
 
         // Swap buffers atomically
         {
@@ -47,9 +66,11 @@ namespace NanoRec
 
             m_writeIndex.store(oldRead);
             m_readIndex.store(oldWrite);
+            m_width = frame.width;
+            m_height = frame.height;
+            m_hasNewFrame.store(true);
         }
 
-        m_hasNewFrame.store(true);
         return true;
     }
 
@@ -60,14 +81,14 @@ namespace NanoRec
             return false;
         }
 
-        // Get current read buffer
-        int readIdx = m_readIndex.load();
-        const FrameBuffer &readBuffer = m_buffers[readIdx];
+        // Held while copying so the writer can't swap this buffer back and resize it
+        std::lock_guard<std::mutex> lock(m_swapMutex);
+        const FrameBuffer &readBuffer = m_buffers[m_readIndex.load()];
 
-        // Ensure output buffer is allocated
-        if (outFrame.data == nullptr)
+        // Ensure output buffer is allocated with the current dimensions
+        if (outFrame.data == nullptr || outFrame.width != readBuffer.width || outFrame.height != readBuffer.height)
         {
-            outFrame.allocate(m_width, m_height);
+            outFrame.allocate(readBuffer.width, readBuffer.height);
         }
 
         // Copy frame data
@@ -81,4 +102,28 @@ namespace NanoRec
         return true;
     }
 
+    void ThreadSafeFrameBuffer::pushYuvFrame(YuvFrame &frame)
+    {
+        std::lock_guard<std::mutex> lock(m_yuvMutex);
+        std::swap(m_yuvFrame, frame);
+        m_hasNewYuvFrame.store(true);
+    }
+
+    bool ThreadSafeFrameBuffer::getLatestYuvFrame(YuvFrame &outFrame)
+    {
+        if (!m_hasNewYuvFrame.load())
+        {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(m_yuvMutex);
+        if (!m_hasNewYuvFrame.load())
+        {
+            return false;
+        }
+        std::swap(m_yuvFrame, outFrame);
+        m_hasNewYuvFrame.store(false);
+        return true;
+    }
+
 } // namespace NanoRec
@@ -0,0 +1,190 @@
+#include "core/TileChangeMap.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace NanoRec
+{
+
+    static inline uint64_t mixWord(uint64_t hash, uint64_t word)
+    {
+        hash ^= word;
+        hash *= 0x9E3779B97F4A7C15ull;
+        return hash ^ (hash >> 29);
+    }
+
+    void TileChangeMap::reset()
+    {
+        m_width = 0;
+        m_height = 0;
+        m_previous.clear();
+    }
+
+    int TileChangeMap::update(const FrameBuffer &frame, const std::vector<Rect> *dirty)
+    {
+        if (!frame.data || frame.width <= 0 || frame.height <= 0)
+        {
+            return 0;
+        }
+
+        bool resized = frame.width != m_width || frame.height != m_height;
+        if (resized)
+        {
+            m_width = frame.width;
+            m_height = frame.height;
+            m_tilesX = (m_width + TILE_SIZE - 1) / TILE_SIZE;
+            m_tilesY = (m_height + TILE_SIZE - 1) / TILE_SIZE;
+            m_hashes.assign(static_cast<size_t>(m_tilesX) * m_tilesY, 0);
+            m_previous.clear();
+            m_changed.assign(m_hashes.size(), 1);
+        }
+
+        std::swap(m_hashes, m_previous);
+        m_hashes.resize(static_cast<size_t>(m_tilesX) * m_tilesY);
+
+        // With a damage hint (and a previous frame to keep), only tiles it touches are re-hashed
+        bool hinted = dirty && m_previous.size() == m_hashes.size();
+        if (hinted)
+        {
+            m_dirty.assign(m_hashes.size(), 0);
+            m_dirtyRows.assign(m_tilesY, 0);
+            for (const Rect &rect : *dirty)
+            {
+                Rect tiles = tileRange(rect);
+                for (int ty = tiles.y; ty < tiles.bottom(); ++ty)
+                {
+                    std::fill_n(m_dirty.begin() + static_cast<size_t>(ty) * m_tilesX + tiles.x, tiles.width, 1);
+                    m_dirtyRows[ty] = 1;
+                }
+            }
+        }
+
+        // Seed every tile with its index so identical tiles in different places differ
+        for (size_t i = 0; i < m_hashes.size(); ++i)
+        {
+            m_hashes[i] = (hinted && !m_dirty[i]) ? m_previous[i] : 0xCBF29CE484222325ull + i;
+        }
+
+        // Single row-major pass: each row feeds the hash of every tile it crosses
+        const size_t tileBytes = TILE_SIZE * 3;
+        for (int y = 0; y < m_height; ++y)
+        {
+            if (hinted && !m_dirtyRows[y / TILE_SIZE])
+            {
+                y = (y / TILE_SIZE + 1) * TILE_SIZE - 1; // Skip the whole tile row
+                continue;
+            }
+
+            const uint8_t *row = frame.data + static_cast<size_t>(y) * frame.stride;
+            const size_t tileRow = static_cast<size_t>(y / TILE_SIZE) * m_tilesX;
+            uint64_t *tileHashes = &m_hashes[tileRow];
+            const size_t rowBytes = static_cast<size_t>(m_width) * 3;
+
+            for (int tx = 0; tx < m_tilesX; ++tx)
+            {
+                if (hinted && !m_dirty[tileRow + tx])
+                {
+                    continue;
+                }
+
+                size_t begin = tx * tileBytes;
+                size_t end = std::min(begin + tileBytes, rowBytes);
+                uint64_t hash = tileHashes[tx];
+
+                size_t i = begin;
+                for (; i + 8 <= end; i += 8)
+                {
+                    uint64_t word;
+                    std::memcpy(&word, row + i, 8);
+                    hash = mixWord(hash, word);
+                }
+                if (i < end)
+                {
+                    uint64_t word = 0;
+                    std::memcpy(&word, row + i, end - i);
+                    hash = mixWord(hash, word);
+                }
+
+                tileHashes[tx] = hash;
+            }
+        }
+
+        // Compare with the previous frame
+        m_changedCount = 0;
+        int minX = m_tilesX, minY = m_tilesY, maxX = -1, maxY = -1;
+        bool hasPrevious = m_previous.size() == m_hashes.size();
+
+        for (int ty = 0; ty < m_tilesY; ++ty)
+        {
+            for (int tx = 0; tx < m_tilesX; ++tx)
+            {
+                size_t idx = static_cast<size_t>(ty) * m_tilesX + tx;
+                bool changed = !hasPrevious || m_hashes[idx] != m_previous[idx];
+                m_changed[idx] = changed ? 1 : 0;
+                if (changed)
+                {
+                    m_changedCount++;
+                    minX = std::min(minX, tx);
+                    minY = std::min(minY, ty);
+                    maxX = std::max(maxX, tx);
+                    maxY = std::max(maxY, ty);
+                }
+            }
+        }
+
+        m_changedTiles = (maxX >= 0) ? Rect(minX, minY, maxX - minX + 1, maxY - minY + 1) : Rect();
+        return m_changedCount;
+    }
+
+    double TileChangeMap::getChangedFraction() const
+    {
+        if (m_hashes.empty())
+        {
+            return 0.0;
+        }
+        return static_cast<double>(m_changedCount) / static_cast<double>(m_hashes.size());
+    }
+
+    Rect TileChangeMap::getChangedBounds() const
+    {
+        if (m_changedTiles.isEmpty())
+        {
+            return Rect();
+        }
+
+        Rect pixels(m_changedTiles.x * TILE_SIZE, m_changedTiles.y * TILE_SIZE,
+                    m_changedTiles.width * TILE_SIZE, m_changedTiles.height * TILE_SIZE);
+        return pixels.intersected(Rect(0, 0, m_width, m_height));
+    }
+
+    Rect TileChangeMap::tileRange(const Rect &region) const
+    {
+        Rect clipped = region.intersected(Rect(0, 0, m_width, m_height));
+        if (clipped.isEmpty())
+        {
+            return Rect();
+        }
+
+        int tx0 = clipped.x / TILE_SIZE;
+        int ty0 = clipped.y / TILE_SIZE;
+        int tx1 = (clipped.right() - 1) / TILE_SIZE;
+        int ty1 = (clipped.bottom() - 1) / TILE_SIZE;
+        return Rect(tx0, ty0, tx1 - tx0 + 1, ty1 - ty0 + 1);
+    }
+
+    bool TileChangeMap::isRegionChanged(const Rect &region) const
+    {
+        Rect tiles = tileRange(region);
+        for (int ty = tiles.y; ty < tiles.bottom(); ++ty)
+        {
+            for (int tx = tiles.x; tx < tiles.right(); ++tx)
+            {
+                if (isTileChanged(tx, ty))
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+} // namespace NanoRec
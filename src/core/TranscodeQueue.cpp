@@ -0,0 +1,213 @@
+#include "core/TranscodeQueue.hpp"
+#include "core/Logger.hpp"
+#include "core/Subprocess.hpp"
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+
+namespace NanoRec
+{
+
+    static std::string formatMegabytes(uint64_t bytes)
+    {
+        std::ostringstream ss;
+        ss << std::fixed << std::setprecision(1) << bytes / (1024.0 * 1024.0) << " MB";
+        return ss.str();
+    }
+
+    TranscodeQueue::TranscodeQueue() = default;
+
+    TranscodeQueue::~TranscodeQueue()
+    {
+        stop();
+    }
+
+    bool TranscodeQueue::start(const Options &options)
+    {
+        if (m_running.load())
+        {
+            Logger::warning("Transcode queue already running");
+            return false;
+        }
+
+        m_options = options;
+        m_shouldStop.store(false);
+        m_running.store(true);
+        m_thread = std::thread(&TranscodeQueue::workerLoop, this);
+
+        Logger::info("Transcode queue started (preset " + m_options.preset + ")");
+        return true;
+    }
+
+    void TranscodeQueue::stop()
+    {
+        if (!m_running.load())
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_shouldStop.store(true);
+        }
+        m_cv.notify_all();
+
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+
+        m_running.store(false);
+        Logger::info("Transcode queue stopped (" + std::to_string(m_completed.load()) +
+                     " files, saved " + formatMegabytes(m_bytesSaved.load()) + ")");
+    }
+
+    bool TranscodeQueue::enqueue(const std::string &path)
+    {
+        std::error_code ec;
+        if (!std::filesystem::is_regular_file(path, ec))
+        {
+            Logger::warning("Not queued for transcode (missing file): " + path);
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending.push_back(path);
+        }
+        m_cv.notify_one();
+        return true;
+    }
+
+    size_t TranscodeQueue::getPendingCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_pending.size();
+    }
+
+    void TranscodeQueue::workerLoop()
+    {
+        while (true)
+        {
+            std::string path;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv.wait(lock, [this] { return m_shouldStop.load() || !m_pending.empty(); });
+                if (m_shouldStop.load())
+                {
+                    break;
+                }
+                path = m_pending.front();
+                m_pending.pop_front();
+            }
+
+            transcode(path);
+        }
+    }
+
+    bool TranscodeQueue::transcode(const std::string &path)
+    {
+        namespace fs = std::filesystem;
+
+        fs::path input(path);
+        fs::path output = input;
+        output.replace_extension(".transcode" + input.extension().string());
+
+        std::error_code ec;
+        uint64_t originalSize = fs::file_size(input, ec);
+        if (ec)
+        {
+            Logger::error("Transcode: cannot stat " + path);
+            return false;
+        }
+
+        Subprocess process;
+        process.setIdlePriority(true);
+        if (!process.start({"ffmpeg", "-v", "error", "-nostdin", "-y",
+                            "-i", input.string(),
+                            "-map", "0",
+                            "-c:v", "libx264", "-preset", m_options.preset,
+                            "-crf", std::to_string(m_options.crf), "-pix_fmt", "yuv420p",
+                            "-c:a", "copy", "-movflags", "+faststart",
+                            output.string()},
+                           Subprocess::PIPE_NONE))
+        {
+            return false;
+        }
+
+        Logger::info("Transcoding " + path + " (" + formatMegabytes(originalSize) + ")");
+        auto jobStart = std::chrono::steady_clock::now();
+
+        int exitCode = -1;
+        bool aborted = false;
+        while (!process.tryWait(exitCode))
+        {
+            // Idle priority alone is not enough when capture and encode share the
+            // cores: stop the child outright while the live pipeline needs headroom
+            bool shouldPause = m_pauseCondition && m_pauseCondition();
+            if (shouldPause != m_paused.load())
+            {
+                if (shouldPause ? process.suspend() : process.resume())
+                {
+                    m_paused.store(shouldPause);
+                    Logger::info(shouldPause ? "Transcode paused (live pipeline near budget)"
+                                             : "Transcode resumed");
+                }
+            }
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_cv.wait_for(lock, std::chrono::milliseconds(200), [this] { return m_shouldStop.load(); }))
+            {
+                lock.unlock();
+                process.resume();
+                process.kill();
+                aborted = true;
+                break;
+            }
+        }
+        m_paused.store(false);
+
+        if (aborted || exitCode != 0)
+        {
+            if (!aborted)
+            {
+                Logger::error("Transcode failed (ffmpeg exit code " + std::to_string(exitCode) + "): " + path);
+            }
+            fs::remove(output, ec);
+            return false;
+        }
+
+        uint64_t newSize = fs::file_size(output, ec);
+        if (ec || newSize == 0 || newSize >= originalSize)
+        {
+            // Nothing gained; keep the original untouched
+            Logger::info("Transcode kept original (no size reduction): " + path);
+            fs::remove(output, ec);
+            m_completed.fetch_add(1);
+            return true;
+        }
+
+        // Same directory, so the rename replaces the original atomically
+        fs::rename(output, input, ec);
+        if (ec)
+        {
+            Logger::error("Transcode: failed to replace " + path + ": " + ec.message());
+            fs::remove(output, ec);
+            return false;
+        }
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+                           std::chrono::steady_clock::now() - jobStart)
+                           .count();
+        uint64_t saved = originalSize - newSize;
+        m_bytesSaved.fetch_add(saved);
+        m_completed.fetch_add(1);
+
+        Logger::info("Transcoded " + path + ": " + formatMegabytes(originalSize) + " -> " +
+                     formatMegabytes(newSize) + " (saved " + formatMegabytes(saved) + ", " +
+                     std::to_string(elapsed) + " s)");
+        return true;
+    }
+
+} // namespace NanoRec
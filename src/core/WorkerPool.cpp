@@ -0,0 +1,116 @@
+#include "core/WorkerPool.hpp"
+#include <algorithm>
+
+namespace NanoRec
+{
+
+    WorkerPool::WorkerPool(int threads)
+    {
+        for (int i = 0; i < threads; ++i)
+        {
+            m_threads.emplace_back(&WorkerPool::workerLoop, this);
+        }
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_work.notify_all();
+        for (std::thread &thread : m_threads)
+        {
+            thread.join();
+        }
+    }
+
+    WorkerPool &WorkerPool::shared()
+    {
+        static WorkerPool pool(std::max(1, static_cast<int>(std::thread::hardware_concurrency())) - 1);
+        return pool;
+    }
+
+    std::vector<std::thread::native_handle_type> WorkerPool::getNativeHandles()
+    {
+        std::vector<std::thread::native_handle_type> handles;
+        for (std::thread &thread : m_threads)
+        {
+            handles.push_back(thread.native_handle());
+        }
+        return handles;
+    }
+
+    void WorkerPool::parallelFor(int count, const std::function<void(int)> &task)
+    {
+        if (count <= 1 || m_threads.empty())
+        {
+            for (int i = 0; i < count; ++i)
+            {
+                task(i);
+            }
+            return;
+        }
+
+        Job job{&task, count};
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (int i = 1; i < count; ++i)
+            {
+                m_queue.push_back(Band{&job, i});
+            }
+        }
+        m_work.notify_all();
+        m_done.notify_all(); // Callers waiting on their own jobs can help too
+        runBand(Band{&job, 0});
+
+        // Help with whatever is queued (possibly another caller's bands) instead of idling
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (job.remaining > 0)
+        {
+            if (!m_queue.empty())
+            {
+                Band band = m_queue.front();
+                m_queue.pop_front();
+                lock.unlock();
+                runBand(band);
+                lock.lock();
+            }
+            else
+            {
+                m_done.wait(lock);
+            }
+        }
+    }
+
+    void WorkerPool::runBand(const Band &band)
+    {
+        (*band.job->task)(band.index);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--band.job->remaining == 0)
+        {
+            m_done.notify_all();
+        }
+    }
+
+    void WorkerPool::workerLoop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;)
+        {
+            m_work.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+            if (m_queue.empty())
+            {
+                return;
+            }
+
+            Band band = m_queue.front();
+            m_queue.pop_front();
+            lock.unlock();
+            runBand(band);
+            lock.lock();
+        }
+    }
+
+} // namespace NanoRec
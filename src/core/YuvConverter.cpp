@@ -0,0 +1,108 @@
+#include "core/YuvConverter.hpp"
+#include "core/Logger.hpp"
+#include "core/WorkerPool.hpp"
+#include <algorithm>
+
+namespace NanoRec
+{
+
+    // BT.601 limited range in Q15 (luma) and Q17 after summing 2x2 pixels (chroma)
+    static const int32_t Y_R = 8414, Y_G = 16519, Y_B = 3208;
+    static const int32_t U_R = -4857, U_G = -9535, U_B = 14392;
+    static const int32_t V_R = 14392, V_G = -12051, V_B = -2341;
+
+    static inline uint8_t lumaOf(const uint8_t *p)
+    {
+        return static_cast<uint8_t>((Y_R * p[0] + Y_G * p[1] + Y_B * p[2] + (16 << 15) + (1 << 14)) >> 15);
+    }
+
+    bool YuvConverter::convert(const FrameBuffer &source, YuvFrame &destination, YuvFrame::Layout layout,
+                               int threads)
+    {
+        if (!source.data || source.width <= 0 || source.height <= 0)
+        {
+            Logger::error("Invalid source frame for YUV conversion");
+            return false;
+        }
+
+        destination.allocate(source.width, source.height, layout);
+
+        // Bands of chroma rows (two luma rows each) are independent
+        int chromaRows = destination.chromaHeight();
+        threads = std::clamp(threads, 1, std::max(1, chromaRows / 8));
+        int rowsPerBand = (chromaRows + threads - 1) / threads;
+        WorkerPool::shared().parallelFor(threads,
+                                         [&](int band)
+                                         {
+                                             int begin = std::min(chromaRows, band * rowsPerBand);
+                                             int end = std::min(chromaRows, begin + rowsPerBand);
+                                             convertRows(source, 0, destination, begin, end);
+                                         });
+        return true;
+    }
+
+    void YuvConverter::convertStripe(const FrameBuffer &source, int sourceTop, YuvFrame &destination, int rowBegin,
+                                     int rowEnd)
+    {
+        convertRows(source, sourceTop, destination, rowBegin / 2, std::min(destination.chromaHeight(), (rowEnd + 1) / 2));
+    }
+
+    void YuvConverter::convertRows(const FrameBuffer &source, int sourceTop, YuvFrame &destination,
+                                   int chromaRowBegin, int chromaRowEnd)
+    {
+        const int width = destination.width;
+        const int height = destination.height;
+        const int chromaWidth = destination.chromaWidth();
+        const bool nv12 = destination.layout == YuvFrame::Layout::NV12;
+
+        uint8_t *planeY = destination.data.data();
+        uint8_t *planeU = planeY + destination.lumaSize();
+        uint8_t *planeV = planeU + destination.chromaSize();
+
+        for (int cy = chromaRowBegin; cy < chromaRowEnd; ++cy)
+        {
+            int y0 = cy * 2;
+            int y1 = std::min(y0 + 1, height - 1);
+            const uint8_t *row0 = source.data + static_cast<size_t>(y0 - sourceTop) * source.stride;
+            const uint8_t *row1 = source.data + static_cast<size_t>(y1 - sourceTop) * source.stride;
+            uint8_t *outY0 = planeY + static_cast<size_t>(y0) * width;
+            uint8_t *outY1 = planeY + static_cast<size_t>(y1) * width;
+            uint8_t *outU = planeU + static_cast<size_t>(cy) * (nv12 ? chromaWidth * 2 : chromaWidth);
+            uint8_t *outV = planeV + static_cast<size_t>(cy) * chromaWidth;
+
+            for (int cx = 0; cx < chromaWidth; ++cx)
+            {
+                int x0 = cx * 2;
+                int x1 = std::min(x0 + 1, width - 1);
+                const uint8_t *p00 = row0 + x0 * 3;
+                const uint8_t *p01 = row0 + x1 * 3;
+                const uint8_t *p10 = row1 + x0 * 3;
+                const uint8_t *p11 = row1 + x1 * 3;
+
+                // Odd edges duplicate the last column/row, which is also what gets averaged
+                outY0[x0] = lumaOf(p00);
+                outY0[x1] = lumaOf(p01);
+                outY1[x0] = lumaOf(p10);
+                outY1[x1] = lumaOf(p11);
+
+                int32_t r = p00[0] + p01[0] + p10[0] + p11[0];
+                int32_t g = p00[1] + p01[1] + p10[1] + p11[1];
+                int32_t b = p00[2] + p01[2] + p10[2] + p11[2];
+                uint8_t u = static_cast<uint8_t>((U_R * r + U_G * g + U_B * b + (128 << 17) + (1 << 16)) >> 17);
+                uint8_t v = static_cast<uint8_t>((V_R * r + V_G * g + V_B * b + (128 << 17) + (1 << 16)) >> 17);
+
+                if (nv12)
+                {
+                    outU[cx * 2] = u;
+                    outU[cx * 2 + 1] = v;
+                }
+                else
+                {
+                    outU[cx] = u;
+                    outV[cx] = v;
+                }
+            }
+        }
+    }
+
+} // namespace NanoRec
@@ -0,0 +1,86 @@
+#include "core/EncoderNode.hpp"
+#include "core/Logger.hpp"
+
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace
+{
+    volatile std::sig_atomic_t g_stop = 0;
+
+    void handleSignal(int)
+    {
+        g_stop = 1;
+    }
+
+    void printUsage(const char *program)
+    {
+        std::cout << "Usage: " << program << " [options]\n"
+                  << "  --bind ADDRESS       Address to listen on (default 0.0.0.0)\n"
+                  << "  --port N             TCP port (default " << NanoRec::EncoderLink::DEFAULT_PORT << ")\n"
+                  << "  --output-dir DIR     Work directory for encoded files (default .)\n"
+                  << "  --max-sessions N     Concurrent encodes (default: hardware threads / 4)\n"
+                  << "  --keep               Keep encoded files after sending them back\n";
+    }
+} // namespace
+
+/**
+ * @brief Entry point of nanorec-encoder-node
+ *
+ * Serves RemoteVideoWriter sessions (app.encoder_nodes on the capture
+ * host) until SIGINT or SIGTERM.
+ */
+int main(int argc, char *argv[])
+{
+    NanoRec::EncoderNode::Options options;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--bind" && hasValue)
+        {
+            options.bindAddress = argv[++i];
+        }
+        else if (arg == "--port" && hasValue)
+        {
+            options.port = std::atoi(argv[++i]);
+        }
+        else if (arg == "--output-dir" && hasValue)
+        {
+            options.workDirectory = argv[++i];
+        }
+        else if (arg == "--max-sessions" && hasValue)
+        {
+            options.maxSessions = std::atoi(argv[++i]);
+        }
+        else if (arg == "--keep")
+        {
+            options.keepFiles = true;
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+
+    // A dying ffmpeg must fail its session, not the node
+    std::signal(SIGPIPE, SIG_IGN);
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+
+    NanoRec::EncoderNode node(options);
+    if (!node.start())
+    {
+        return 1;
+    }
+    while (!g_stop)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+    node.stop();
+    return 0;
+}
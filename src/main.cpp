@@ -3,6 +3,10 @@
 
 #include <exception>
 
+#ifndef _WIN32
+#include <csignal>
+#endif
+
 /**
  * @brief Main entry point for NanoRec-CPP
  *
@@ -11,6 +15,11 @@
  */
 int main(int argc, char *argv[])
 {
+#ifndef _WIN32
+    // ffmpeg exiting mid-recording must surface as a write error, not end the process
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
+
     try
     {
         // Create application instance
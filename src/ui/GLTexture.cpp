@@ -8,6 +8,17 @@
 #define GL_CLAMP_TO_EDGE 0x812F
 #endif
 
+// Single/dual-channel formats used for YUV planes (GL 3.0)
+#ifndef GL_RG
+#define GL_RG 0x8227
+#endif
+#ifndef GL_R8
+#define GL_R8 0x8229
+#endif
+#ifndef GL_RG8
+#define GL_RG8 0x822B
+#endif
+
 namespace NanoRec
 {
 
@@ -23,7 +34,7 @@ namespace NanoRec
 
     bool GLTexture::create(int width, int height, const uint8_t *data, int channels)
     {
-        if (width <= 0 || height <= 0 || channels < 3 || channels > 4)
+        if (width <= 0 || height <= 0 || channels < 1 || channels > 4)
         {
             Logger::error("Invalid texture parameters");
             return false;
@@ -40,15 +51,24 @@ namespace NanoRec
         m_channels = channels;
 
         // Set format based on channels
-        if (channels == 3)
+        switch (channels)
         {
+        case 1:
+            m_format = GL_RED;
+            m_internalFormat = GL_R8;
+            break;
+        case 2:
+            m_format = GL_RG;
+            m_internalFormat = GL_RG8;
+            break;
+        case 3:
             m_format = GL_RGB;
             m_internalFormat = GL_RGB8;
-        }
-        else // channels == 4
-        {
+            break;
+        default:
             m_format = GL_RGBA;
             m_internalFormat = GL_RGBA8;
+            break;
         }
 
         // Generate texture
@@ -68,8 +88,10 @@ namespace NanoRec
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-        // Upload texture data
+        // Upload texture data (plane rows of odd widths are not 4-byte aligned)
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
         glTexImage2D(GL_TEXTURE_2D, 0, m_internalFormat, m_width, m_height, 0, m_format, GL_UNSIGNED_BYTE, data);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
         // Check for errors
         GLenum error = glGetError();
@@ -108,7 +130,9 @@ namespace NanoRec
         glBindTexture(GL_TEXTURE_2D, m_textureID);
 
         // Update texture data (more efficient than glTexImage2D for updates)
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
         glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_width, m_height, m_format, GL_UNSIGNED_BYTE, data);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
         // Check for errors
         GLenum error = glGetError();
@@ -125,6 +149,38 @@ namespace NanoRec
         return true;
     }
 
+    bool GLTexture::updateRegion(int x, int y, int width, int height, const uint8_t *data)
+    {
+        if (m_textureID == 0 || data == nullptr)
+        {
+            Logger::error("Cannot update texture region: texture not created or data is null");
+            return false;
+        }
+
+        if (x < 0 || y < 0 || width <= 0 || height <= 0 || x + width > m_width || y + height > m_height)
+        {
+            Logger::error("Cannot update texture region: region out of bounds");
+            return false;
+        }
+
+        glBindTexture(GL_TEXTURE_2D, m_textureID);
+
+        // Region rows of odd widths are not 4-byte aligned
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, m_format, GL_UNSIGNED_BYTE, data);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+        GLenum error = glGetError();
+        glBindTexture(GL_TEXTURE_2D, 0);
+        if (error != GL_NO_ERROR)
+        {
+            Logger::error("OpenGL error updating texture region: " + std::to_string(error));
+            return false;
+        }
+
+        return true;
+    }
+
     void GLTexture::destroy()
     {
         if (m_textureID != 0)
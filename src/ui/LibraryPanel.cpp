@@ -0,0 +1,226 @@
+#include "ui/LibraryPanel.hpp"
+#include "core/Logger.hpp"
+
+#include <imgui.h>
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+
+namespace NanoRec
+{
+
+    static void formatDate(int64_t modified, char *buffer, size_t size)
+    {
+        // Entries store file-clock seconds; convert through the current offset to system time
+        auto fileTime = std::filesystem::file_time_type(std::chrono::seconds(modified));
+        auto systemTime = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+            fileTime - std::filesystem::file_time_type::clock::now() + std::chrono::system_clock::now());
+        std::time_t time = std::chrono::system_clock::to_time_t(systemTime);
+        std::strftime(buffer, size, "%Y-%m-%d %H:%M", std::localtime(&time));
+    }
+
+    LibraryPanel::LibraryPanel()
+        : m_thumbnail(RecordingLibrary::THUMB_BYTES),
+          m_slotByCell(ATLAS_COLUMNS * ATLAS_ROWS, -1),
+          m_cellLastUse(ATLAS_COLUMNS * ATLAS_ROWS, 0)
+    {
+    }
+
+    LibraryPanel::~LibraryPanel()
+    {
+        m_library.close();
+    }
+
+    bool LibraryPanel::open(const std::string &directory)
+    {
+        m_entries.clear();
+        m_requested.clear();
+        invalidateCells();
+        return m_library.open(directory);
+    }
+
+    void LibraryPanel::refresh()
+    {
+        m_library.rescan();
+    }
+
+    void LibraryPanel::shutdown()
+    {
+        m_library.close();
+        m_atlas.destroy();
+        invalidateCells();
+    }
+
+    void LibraryPanel::invalidateCells()
+    {
+        m_cellBySlot.clear();
+        std::fill(m_slotByCell.begin(), m_slotByCell.end(), -1);
+        std::fill(m_cellLastUse.begin(), m_cellLastUse.end(), 0);
+    }
+
+    int LibraryPanel::acquireCell(int slot)
+    {
+        auto it = m_cellBySlot.find(slot);
+        if (it != m_cellBySlot.end())
+        {
+            m_cellLastUse[it->second] = m_frameCounter;
+            return it->second;
+        }
+
+        if (!m_atlas.isValid())
+        {
+            std::vector<uint8_t> blank(static_cast<size_t>(ATLAS_COLUMNS) * RecordingLibrary::THUMB_BYTES * ATLAS_ROWS, 0);
+            if (!m_atlas.create(ATLAS_COLUMNS * RecordingLibrary::THUMB_WIDTH,
+                                ATLAS_ROWS * RecordingLibrary::THUMB_HEIGHT, blank.data(), 3))
+            {
+                return -1;
+            }
+        }
+
+        // Recycle the least recently drawn cell (never one drawn this frame)
+        int cell = 0;
+        for (int i = 1; i < static_cast<int>(m_cellLastUse.size()); ++i)
+        {
+            if (m_cellLastUse[i] < m_cellLastUse[cell])
+            {
+                cell = i;
+            }
+        }
+        if (m_cellLastUse[cell] == m_frameCounter)
+        {
+            return -1;
+        }
+
+        if (!m_library.readThumbnail(slot, m_thumbnail.data()) ||
+            !m_atlas.updateRegion((cell % ATLAS_COLUMNS) * RecordingLibrary::THUMB_WIDTH,
+                                  (cell / ATLAS_COLUMNS) * RecordingLibrary::THUMB_HEIGHT,
+                                  RecordingLibrary::THUMB_WIDTH, RecordingLibrary::THUMB_HEIGHT,
+                                  m_thumbnail.data()))
+        {
+            return -1;
+        }
+
+        if (m_slotByCell[cell] >= 0)
+        {
+            m_cellBySlot.erase(m_slotByCell[cell]);
+        }
+        m_slotByCell[cell] = slot;
+        m_cellBySlot[slot] = cell;
+        m_cellLastUse[cell] = m_frameCounter;
+        return cell;
+    }
+
+    void LibraryPanel::render(bool *visible)
+    {
+        ImGui::SetNextWindowPos(ImVec2(960, 20), ImGuiCond_FirstUseEver);
+        ImGui::SetNextWindowSize(ImVec2(620, 480), ImGuiCond_FirstUseEver);
+
+        if (!ImGui::Begin("Library", visible))
+        {
+            ImGui::End();
+            return;
+        }
+
+        m_frameCounter++;
+        size_t previousCount = m_entries.size();
+        if (m_library.snapshot(m_entries, m_generation) && m_entries.size() != previousCount)
+        {
+            // A rescan may have reassigned atlas slots of deleted recordings
+            invalidateCells();
+        }
+
+        ImGui::Text("%zu recordings in %s%s", m_entries.size(), m_library.getDirectory().c_str(),
+                    m_library.isScanning() ? " (indexing...)" : "");
+        ImGui::SameLine();
+        if (ImGui::Button("Refresh"))
+        {
+            refresh();
+        }
+
+        const float thumbHeight = 54.0f;
+        const float thumbWidth = thumbHeight * RecordingLibrary::THUMB_WIDTH / RecordingLibrary::THUMB_HEIGHT;
+        std::vector<std::string> visibleNames;
+
+        if (ImGui::BeginTable("recordings", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY))
+        {
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableSetupColumn("", ImGuiTableColumnFlags_WidthFixed, thumbWidth);
+            ImGui::TableSetupColumn("Name");
+            ImGui::TableSetupColumn("Length", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+            ImGui::TableSetupColumn("Size", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+            ImGui::TableSetupColumn("Date", ImGuiTableColumnFlags_WidthFixed, 120.0f);
+            ImGui::TableHeadersRow();
+
+            // Only rows inside the scroll view are laid out, probed and thumbnailed
+            ImGuiListClipper clipper;
+            clipper.Begin(static_cast<int>(m_entries.size()), thumbHeight + 4.0f);
+            while (clipper.Step())
+            {
+                for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row)
+                {
+                    const LibraryEntry &entry = m_entries[row];
+                    visibleNames.push_back(entry.filename);
+
+                    ImGui::TableNextRow(0, thumbHeight + 4.0f);
+                    ImGui::PushID(row);
+
+                    ImGui::TableNextColumn();
+                    int cell = entry.thumbnailSlot >= 0 ? acquireCell(entry.thumbnailSlot) : -1;
+                    if (cell >= 0)
+                    {
+                        float u0 = static_cast<float>(cell % ATLAS_COLUMNS) / ATLAS_COLUMNS;
+                        float v0 = static_cast<float>(cell / ATLAS_COLUMNS) / ATLAS_ROWS;
+                        ImGui::Image((void *)(intptr_t)m_atlas.getTextureID(), ImVec2(thumbWidth, thumbHeight),
+                                     ImVec2(u0, v0), ImVec2(u0 + 1.0f / ATLAS_COLUMNS, v0 + 1.0f / ATLAS_ROWS));
+                    }
+                    else
+                    {
+                        ImGui::Dummy(ImVec2(thumbWidth, thumbHeight));
+                    }
+
+                    ImGui::TableNextColumn();
+                    if (ImGui::Selectable(entry.filename.c_str(), false, ImGuiSelectableFlags_SpanAllColumns,
+                                          ImVec2(0, thumbHeight)) &&
+                        m_onOpen)
+                    {
+                        m_onOpen((std::filesystem::path(m_library.getDirectory()) / entry.filename).string());
+                    }
+
+                    ImGui::TableNextColumn();
+                    if (entry.hasDetails)
+                    {
+                        int seconds = static_cast<int>(entry.duration);
+                        ImGui::Text("%d:%02d", seconds / 60, seconds % 60);
+                        ImGui::TextDisabled("%dx%d", entry.width, entry.height);
+                    }
+                    else
+                    {
+                        ImGui::TextDisabled(entry.detailsFailed ? "n/a" : "...");
+                    }
+
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.1f MB", entry.size / (1024.0 * 1024.0));
+
+                    ImGui::TableNextColumn();
+                    char date[32];
+                    formatDate(entry.modified, date, sizeof(date));
+                    ImGui::TextUnformatted(date);
+
+                    ImGui::PopID();
+                }
+            }
+            clipper.End();
+            ImGui::EndTable();
+        }
+
+        if (visibleNames != m_requested)
+        {
+            m_requested = visibleNames;
+            m_library.requestDetails(m_requested);
+        }
+
+        ImGui::End();
+    }
+
+} // namespace NanoRec
@@ -0,0 +1,316 @@
+#include "ui/PlaybackPanel.hpp"
+#include "core/Logger.hpp"
+#include "core/GifExporter.hpp"
+#include "core/RecordingTrimmer.hpp"
+
+#include <imgui.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace NanoRec
+{
+
+    PlaybackPanel::PlaybackPanel()
+    {
+        m_pathBuffer[0] = '\0';
+    }
+
+    PlaybackPanel::~PlaybackPanel()
+    {
+        m_player.close();
+        if (m_exportResult.valid())
+        {
+            m_exportResult.wait();
+        }
+    }
+
+    void PlaybackPanel::setPath(const std::string &path)
+    {
+        std::snprintf(m_pathBuffer, sizeof(m_pathBuffer), "%s", path.c_str());
+    }
+
+    bool PlaybackPanel::open(const std::string &path)
+    {
+        setPath(path);
+        m_playing = false;
+        m_position = 0.0;
+        m_uploadedIndex = -1;
+        m_clipIn = 0;
+        m_clipOut = -1;
+
+        // Downsample the per-second activity to a fixed-width strip (peak per bin)
+        m_activityPlot.clear();
+        if (m_activity.load(path))
+        {
+            const std::vector<ActivitySecond> &seconds = m_activity.getSeconds();
+            size_t bins = std::min<size_t>(seconds.size(), 512);
+            m_activityPlot.assign(bins, 0.0f);
+            for (size_t i = 0; i < seconds.size(); ++i)
+            {
+                float &bin = m_activityPlot[i * bins / seconds.size()];
+                float value = std::max(seconds[i].changedFraction, seconds[i].inputSamples > 0 ? 0.02f : 0.0f);
+                bin = std::max(bin, value);
+            }
+        }
+        return m_player.open(path);
+    }
+
+    void PlaybackPanel::shutdown()
+    {
+        m_player.close();
+        m_texture.destroy();
+        m_uploadedIndex = -1;
+    }
+
+    void PlaybackPanel::uploadFrame()
+    {
+        int actualIndex = -1;
+        std::shared_ptr<const FrameBuffer> frame = m_player.getFrame(m_player.getPlayhead(), actualIndex);
+        if (!frame || actualIndex == m_uploadedIndex)
+        {
+            return;
+        }
+
+        bool needsRecreate = !m_texture.isValid() ||
+                             m_texture.getWidth() != frame->width ||
+                             m_texture.getHeight() != frame->height;
+
+        bool uploaded = needsRecreate ? m_texture.create(frame->width, frame->height, frame->data, 3)
+                                      : m_texture.update(frame->data);
+        if (uploaded)
+        {
+            m_uploadedIndex = actualIndex;
+        }
+    }
+
+    void PlaybackPanel::render(bool *visible)
+    {
+        ImGui::SetNextWindowPos(ImVec2(320, 420), ImGuiCond_FirstUseEver);
+        ImGui::SetNextWindowSize(ImVec2(640, 420), ImGuiCond_FirstUseEver);
+
+        if (!ImGui::Begin("Player", visible))
+        {
+            ImGui::End();
+            return;
+        }
+
+        ImGui::InputText("File", m_pathBuffer, sizeof(m_pathBuffer));
+        ImGui::SameLine();
+        if (ImGui::Button("Open") && std::strlen(m_pathBuffer) > 0)
+        {
+            if (!open(m_pathBuffer))
+            {
+                Logger::error(std::string("Failed to open recording: ") + m_pathBuffer);
+            }
+        }
+
+        if (!m_player.isOpen())
+        {
+            ImGui::TextDisabled("No recording loaded");
+            ImGui::End();
+            return;
+        }
+
+        const MediaInfo &info = m_player.getInfo();
+        int frameCount = m_player.getFrameCount();
+
+        // Advance playhead by wall-clock time while playing
+        double now = ImGui::GetTime();
+        if (m_playing)
+        {
+            m_position += (now - m_lastTime) * info.fps;
+            if (m_position >= frameCount - 1)
+            {
+                m_position = frameCount - 1;
+                m_playing = false;
+            }
+            m_player.setPlayhead(static_cast<int>(m_position));
+        }
+        m_lastTime = now;
+
+        uploadFrame();
+
+        // Video area (leave room for the transport controls)
+        ImVec2 contentRegion = ImGui::GetContentRegionAvail();
+        contentRegion.y -= ImGui::GetFrameHeightWithSpacing() * 2;
+        if (m_texture.isValid() && contentRegion.x > 0 && contentRegion.y > 0)
+        {
+            float textureAspect = (float)m_texture.getWidth() / (float)m_texture.getHeight();
+            ImVec2 imageSize = (textureAspect > contentRegion.x / contentRegion.y)
+                                   ? ImVec2(contentRegion.x, contentRegion.x / textureAspect)
+                                   : ImVec2(contentRegion.y * textureAspect, contentRegion.y);
+            ImGui::Image((void *)(intptr_t)m_texture.getTextureID(), imageSize);
+        }
+        else
+        {
+            ImGui::Dummy(ImVec2(contentRegion.x, contentRegion.y > 0 ? contentRegion.y : 1.0f));
+        }
+
+        if (ImGui::Button(m_playing ? "Pause" : "Play", ImVec2(60, 0)))
+        {
+            m_playing = !m_playing;
+            if (m_playing && m_position >= frameCount - 1)
+            {
+                m_position = 0.0;
+            }
+        }
+        ImGui::SameLine();
+
+        // Scrubbing only moves the playhead; the decoder seeks from the nearest keyframe
+        int frame = static_cast<int>(m_position);
+        ImGui::SetNextItemWidth(-1);
+        if (ImGui::SliderInt("##timeline", &frame, 0, frameCount - 1, ""))
+        {
+            m_position = frame;
+            m_player.setPlayhead(frame);
+        }
+
+        double seconds = m_position / info.fps;
+        ImGui::Text("%02d:%05.2f / %02d:%05.2f  (frame %d/%d, %zu cached)",
+                    static_cast<int>(seconds) / 60, seconds - 60 * (static_cast<int>(seconds) / 60),
+                    static_cast<int>(info.duration) / 60, info.duration - 60 * (static_cast<int>(info.duration) / 60),
+                    frame + 1, frameCount, m_player.getCachedFrameCount());
+
+        renderActivity(info.fps, frameCount);
+        renderClipExport(info.fps, frameCount);
+
+        ImGui::End();
+    }
+
+    void PlaybackPanel::seekSecond(int second, double fps, int frameCount)
+    {
+        if (second < 0)
+        {
+            return;
+        }
+        m_position = std::min(static_cast<double>(frameCount - 1), second * fps);
+        m_player.setPlayhead(static_cast<int>(m_position));
+    }
+
+    void PlaybackPanel::renderActivity(double fps, int frameCount)
+    {
+        if (!m_activity.isLoaded())
+        {
+            return;
+        }
+
+        int second = static_cast<int>(m_position / fps);
+        if (ImGui::Button("< Activity"))
+        {
+            seekSecond(m_activity.findPrevious(second, m_activityThreshold), fps, frameCount);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Activity >"))
+        {
+            seekSecond(m_activity.findNext(second, m_activityThreshold), fps, frameCount);
+        }
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(120);
+        ImGui::SliderFloat("Min change", &m_activityThreshold, 0.0005f, 0.2f, "%.4f",
+                           ImGuiSliderFlags_Logarithmic);
+        ImGui::SameLine();
+        ImGui::PlotHistogram("##activity", m_activityPlot.data(), static_cast<int>(m_activityPlot.size()), 0,
+                             nullptr, 0.0f, 1.0f, ImVec2(-1, ImGui::GetFrameHeight()));
+
+        if (second < static_cast<int>(m_activity.getSeconds().size()))
+        {
+            const ActivitySecond &current = m_activity.getSeconds()[second];
+            if (ImGui::IsItemHovered())
+            {
+                ImGui::SetTooltip("This second: %.2f%% changed (peak %.2f%%), region %dx%d at %d,%d, input %d",
+                                  current.changedFraction * 100.0f, current.peakFraction * 100.0f,
+                                  current.changedBounds.width, current.changedBounds.height,
+                                  current.changedBounds.x, current.changedBounds.y, current.inputSamples);
+            }
+        }
+    }
+
+    void PlaybackPanel::renderClipExport(double fps, int frameCount)
+    {
+        if (m_clipOut < 0 || m_clipOut >= frameCount)
+        {
+            m_clipOut = frameCount - 1;
+        }
+
+        ImGui::Separator();
+        if (ImGui::Button("Set In"))
+        {
+            m_clipIn = static_cast<int>(m_position);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Set Out"))
+        {
+            m_clipOut = static_cast<int>(m_position);
+        }
+        if (m_activity.isLoaded())
+        {
+            // Clip the burst of activity around the playhead (gaps up to 3 s are merged)
+            ImGui::SameLine();
+            int first = 0;
+            int last = 0;
+            if (ImGui::Button("Clip Activity") &&
+                m_activity.findSpan(static_cast<int>(m_position / fps), m_activityThreshold, 3, first, last))
+            {
+                m_clipIn = std::max(0, static_cast<int>((first - 1) * fps));
+                m_clipOut = std::min(frameCount - 1, static_cast<int>((last + 2) * fps) - 1);
+            }
+        }
+        ImGui::SameLine();
+        ImGui::Checkbox("Frame-exact", &m_frameExact);
+        ImGui::SameLine();
+        ImGui::Text("Clip: %.2fs - %.2fs", m_clipIn / fps, (m_clipOut + 1) / fps);
+
+        bool exporting = m_exportResult.valid();
+        if (exporting && m_exportResult.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            m_exportStatus = m_exportResult.get() ? "Clip exported" : "Clip export failed";
+            exporting = false;
+        }
+
+        if (exporting)
+        {
+            ImGui::TextDisabled("Exporting...");
+        }
+        else if (ImGui::Button("Export Clip") && m_clipOut > m_clipIn)
+        {
+            TrimRequest request;
+            request.input = m_pathBuffer;
+            std::string::size_type dot = request.input.rfind('.');
+            request.output = request.input.substr(0, dot) + "_clip_" + std::to_string(m_clipIn) + "-" +
+                             std::to_string(m_clipOut) + ".mp4";
+            request.start = m_clipIn / fps;
+            request.end = (m_clipOut + 1) / fps;
+            request.frameExact = m_frameExact;
+
+            m_exportStatus = "Exporting " + request.output;
+            m_exportResult = std::async(std::launch::async, [request]
+                                        { return RecordingTrimmer::trim(request); });
+        }
+
+        if (!exporting)
+        {
+            ImGui::SameLine();
+            if (ImGui::Button("Export GIF") && m_clipOut > m_clipIn)
+            {
+                std::string input = m_pathBuffer;
+                std::string output = input.substr(0, input.rfind('.')) + "_clip_" + std::to_string(m_clipIn) +
+                                     "-" + std::to_string(m_clipOut) + ".gif";
+                double start = m_clipIn / fps;
+                double end = (m_clipOut + 1) / fps;
+
+                m_exportStatus = "Exporting " + output;
+                m_exportResult = std::async(std::launch::async, [input, output, start, end]
+                                            { return GifExporter::exportRecording(input, start, end, output, 800,
+                                                                                  GifExporter::Options()); });
+            }
+        }
+
+        if (!m_exportStatus.empty())
+        {
+            ImGui::SameLine();
+            ImGui::TextUnformatted(m_exportStatus.c_str());
+        }
+    }
+
+} // namespace NanoRec
@@ -0,0 +1,378 @@
+#include "ui/YuvTexture.hpp"
+#include "core/Logger.hpp"
+
+#include <GLFW/glfw3.h>
+#include <string>
+
+// GL 2.0+ entry points are not exported by every platform's GL library, so
+// they are resolved through GLFW (the repo has no GL loader)
+#ifdef _WIN32
+#define NANOREC_GLAPI __stdcall
+#else
+#define NANOREC_GLAPI
+#endif
+
+#ifndef GL_FRAGMENT_SHADER
+#define GL_FRAGMENT_SHADER 0x8B30
+#define GL_VERTEX_SHADER 0x8B31
+#define GL_COMPILE_STATUS 0x8B81
+#define GL_LINK_STATUS 0x8B82
+#define GL_CURRENT_PROGRAM 0x8B8D
+#endif
+#ifndef GL_FRAMEBUFFER
+#define GL_FRAMEBUFFER 0x8D40
+#define GL_COLOR_ATTACHMENT0 0x8CE0
+#define GL_FRAMEBUFFER_COMPLETE 0x8CD5
+#define GL_FRAMEBUFFER_BINDING 0x8CA6
+#endif
+#ifndef GL_TEXTURE0
+#define GL_TEXTURE0 0x84C0
+#define GL_ACTIVE_TEXTURE 0x84E0
+#endif
+#ifndef GL_VERTEX_ARRAY_BINDING
+#define GL_VERTEX_ARRAY_BINDING 0x85B5
+#endif
+
+namespace NanoRec
+{
+
+    namespace
+    {
+        struct GLFunctions
+        {
+            GLuint(NANOREC_GLAPI *createShader)(GLenum);
+            void(NANOREC_GLAPI *shaderSource)(GLuint, GLsizei, const char *const *, const GLint *);
+            void(NANOREC_GLAPI *compileShader)(GLuint);
+            void(NANOREC_GLAPI *getShaderiv)(GLuint, GLenum, GLint *);
+            void(NANOREC_GLAPI *getShaderInfoLog)(GLuint, GLsizei, GLsizei *, char *);
+            void(NANOREC_GLAPI *deleteShader)(GLuint);
+            GLuint(NANOREC_GLAPI *createProgram)();
+            void(NANOREC_GLAPI *attachShader)(GLuint, GLuint);
+            void(NANOREC_GLAPI *linkProgram)(GLuint);
+            void(NANOREC_GLAPI *getProgramiv)(GLuint, GLenum, GLint *);
+            void(NANOREC_GLAPI *getProgramInfoLog)(GLuint, GLsizei, GLsizei *, char *);
+            void(NANOREC_GLAPI *deleteProgram)(GLuint);
+            void(NANOREC_GLAPI *useProgram)(GLuint);
+            GLint(NANOREC_GLAPI *getUniformLocation)(GLuint, const char *);
+            void(NANOREC_GLAPI *uniform1i)(GLint, GLint);
+            void(NANOREC_GLAPI *activeTexture)(GLenum);
+            void(NANOREC_GLAPI *genFramebuffers)(GLsizei, GLuint *);
+            void(NANOREC_GLAPI *bindFramebuffer)(GLenum, GLuint);
+            void(NANOREC_GLAPI *framebufferTexture2D)(GLenum, GLenum, GLenum, GLuint, GLint);
+            GLenum(NANOREC_GLAPI *checkFramebufferStatus)(GLenum);
+            void(NANOREC_GLAPI *deleteFramebuffers)(GLsizei, const GLuint *);
+            void(NANOREC_GLAPI *genVertexArrays)(GLsizei, GLuint *);
+            void(NANOREC_GLAPI *bindVertexArray)(GLuint);
+            void(NANOREC_GLAPI *deleteVertexArrays)(GLsizei, const GLuint *);
+        };
+
+        GLFunctions gl{};
+
+        template <typename T>
+        bool resolve(T &function, const char *name)
+        {
+            function = reinterpret_cast<T>(glfwGetProcAddress(name));
+            return function != nullptr;
+        }
+
+        bool loadFunctions()
+        {
+            static bool loaded = false;
+            if (loaded)
+            {
+                return true;
+            }
+
+            loaded = resolve(gl.createShader, "glCreateShader") &&
+                     resolve(gl.shaderSource, "glShaderSource") &&
+                     resolve(gl.compileShader, "glCompileShader") &&
+                     resolve(gl.getShaderiv, "glGetShaderiv") &&
+                     resolve(gl.getShaderInfoLog, "glGetShaderInfoLog") &&
+                     resolve(gl.deleteShader, "glDeleteShader") &&
+                     resolve(gl.createProgram, "glCreateProgram") &&
+                     resolve(gl.attachShader, "glAttachShader") &&
+                     resolve(gl.linkProgram, "glLinkProgram") &&
+                     resolve(gl.getProgramiv, "glGetProgramiv") &&
+                     resolve(gl.getProgramInfoLog, "glGetProgramInfoLog") &&
+                     resolve(gl.deleteProgram, "glDeleteProgram") &&
+                     resolve(gl.useProgram, "glUseProgram") &&
+                     resolve(gl.getUniformLocation, "glGetUniformLocation") &&
+                     resolve(gl.uniform1i, "glUniform1i") &&
+                     resolve(gl.activeTexture, "glActiveTexture") &&
+                     resolve(gl.genFramebuffers, "glGenFramebuffers") &&
+                     resolve(gl.bindFramebuffer, "glBindFramebuffer") &&
+                     resolve(gl.framebufferTexture2D, "glFramebufferTexture2D") &&
+                     resolve(gl.checkFramebufferStatus, "glCheckFramebufferStatus") &&
+                     resolve(gl.deleteFramebuffers, "glDeleteFramebuffers") &&
+                     resolve(gl.genVertexArrays, "glGenVertexArrays") &&
+                     resolve(gl.bindVertexArray, "glBindVertexArray") &&
+                     resolve(gl.deleteVertexArrays, "glDeleteVertexArrays");
+            return loaded;
+        }
+
+        // Full-screen triangle generated from gl_VertexID (no vertex buffer needed)
+        const char *VERTEX_SHADER = R"(#version 330 core
+out vec2 uv;
+void main()
+{
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    uv = position;
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+        // BT.601 limited range, the inverse of YuvConverter. Texture row 0 is
+        // the top image row in both the planes and the output, so no flip.
+        const char *FRAGMENT_SHADER = R"(#version 330 core
+in vec2 uv;
+out vec4 color;
+uniform sampler2D planeY;
+uniform sampler2D planeU;
+uniform sampler2D planeV;
+uniform int interleaved;
+void main()
+{
+    float y = texture(planeY, uv).r;
+    vec2 c = interleaved != 0 ? texture(planeU, uv).rg
+                              : vec2(texture(planeU, uv).r, texture(planeV, uv).r);
+    y = (y - 16.0 / 255.0) * (255.0 / 219.0);
+    c = (c - 128.0 / 255.0) * (255.0 / 224.0);
+    color = vec4(clamp(vec3(y + 1.402 * c.y,
+                            y - 0.344136 * c.x - 0.714136 * c.y,
+                            y + 1.772 * c.x), 0.0, 1.0), 1.0);
+}
+)";
+
+        GLuint compileShader(GLenum type, const char *source)
+        {
+            GLuint shader = gl.createShader(type);
+            gl.shaderSource(shader, 1, &source, nullptr);
+            gl.compileShader(shader);
+
+            GLint status = 0;
+            gl.getShaderiv(shader, GL_COMPILE_STATUS, &status);
+            if (!status)
+            {
+                char log[512] = {};
+                gl.getShaderInfoLog(shader, sizeof(log), nullptr, log);
+                Logger::error(std::string("YUV preview shader failed to compile: ") + log);
+                gl.deleteShader(shader);
+                return 0;
+            }
+            return shader;
+        }
+    } // namespace
+
+    YuvTexture::YuvTexture() = default;
+
+    YuvTexture::~YuvTexture()
+    {
+        destroy();
+    }
+
+    bool YuvTexture::initializeProgram()
+    {
+        if (m_program != 0)
+        {
+            return true;
+        }
+        if (m_programFailed)
+        {
+            return false;
+        }
+
+        // Don't retry every frame if the driver can't do it
+        m_programFailed = true;
+        if (!loadFunctions())
+        {
+            Logger::error("YUV preview: OpenGL 3.3 entry points unavailable");
+            return false;
+        }
+
+        GLuint vertex = compileShader(GL_VERTEX_SHADER, VERTEX_SHADER);
+        GLuint fragment = compileShader(GL_FRAGMENT_SHADER, FRAGMENT_SHADER);
+        if (vertex == 0 || fragment == 0)
+        {
+            if (vertex != 0)
+                gl.deleteShader(vertex);
+            if (fragment != 0)
+                gl.deleteShader(fragment);
+            return false;
+        }
+
+        GLuint program = gl.createProgram();
+        gl.attachShader(program, vertex);
+        gl.attachShader(program, fragment);
+        gl.linkProgram(program);
+        gl.deleteShader(vertex);
+        gl.deleteShader(fragment);
+
+        GLint status = 0;
+        gl.getProgramiv(program, GL_LINK_STATUS, &status);
+        if (!status)
+        {
+            char log[512] = {};
+            gl.getProgramInfoLog(program, sizeof(log), nullptr, log);
+            Logger::error(std::string("YUV preview shader failed to link: ") + log);
+            gl.deleteProgram(program);
+            return false;
+        }
+
+        GLint previousProgram = 0;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+        gl.useProgram(program);
+        gl.uniform1i(gl.getUniformLocation(program, "planeY"), 0);
+        gl.uniform1i(gl.getUniformLocation(program, "planeU"), 1);
+        gl.uniform1i(gl.getUniformLocation(program, "planeV"), 2);
+        m_layoutUniform = gl.getUniformLocation(program, "interleaved");
+        gl.useProgram(static_cast<GLuint>(previousProgram));
+
+        // Core profile refuses to draw without a vertex array bound
+        gl.genVertexArrays(1, &m_vertexArray);
+        gl.genFramebuffers(1, &m_framebuffer);
+
+        m_program = program;
+        m_programFailed = false;
+        Logger::info("YUV preview shader ready");
+        return true;
+    }
+
+    bool YuvTexture::createTargets(const YuvFrame &frame)
+    {
+        bool nv12 = frame.layout == YuvFrame::Layout::NV12;
+        m_layout = frame.layout;
+        m_planeV.destroy();
+
+        if (!m_planeY.create(frame.width, frame.height, nullptr, 1) ||
+            !m_planeU.create(frame.chromaWidth(), frame.chromaHeight(), nullptr, nv12 ? 2 : 1) ||
+            (!nv12 && !m_planeV.create(frame.chromaWidth(), frame.chromaHeight(), nullptr, 1)) ||
+            !m_output.create(frame.width, frame.height, nullptr, 3))
+        {
+            destroy();
+            return false;
+        }
+
+        GLint previousFramebuffer = 0;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+        gl.bindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+        gl.framebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_output.getTextureID(), 0);
+        GLenum status = gl.checkFramebufferStatus(GL_FRAMEBUFFER);
+        gl.bindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(previousFramebuffer));
+
+        if (status != GL_FRAMEBUFFER_COMPLETE)
+        {
+            Logger::error("YUV preview framebuffer incomplete: " + std::to_string(status));
+            m_output.destroy();
+            return false;
+        }
+        return true;
+    }
+
+    bool YuvTexture::update(const YuvFrame &frame)
+    {
+        if (frame.width <= 0 || frame.height <= 0 || frame.data.size() < frame.lumaSize() + 2 * frame.chromaSize())
+        {
+            Logger::error("Invalid YUV frame for preview");
+            return false;
+        }
+
+        if (!initializeProgram())
+        {
+            return false;
+        }
+
+        if (!m_output.isValid() || frame.width != m_output.getWidth() || frame.height != m_output.getHeight() ||
+            frame.layout != m_layout)
+        {
+            if (!createTargets(frame))
+            {
+                return false;
+            }
+        }
+
+        bool nv12 = frame.layout == YuvFrame::Layout::NV12;
+        if (!m_planeY.update(frame.planeY()) || !m_planeU.update(frame.planeU()) ||
+            (!nv12 && !m_planeV.update(frame.planeV())))
+        {
+            return false;
+        }
+
+        // Save the state the UI renderer may rely on
+        GLint previousFramebuffer = 0, previousProgram = 0, previousVertexArray = 0, previousActive = 0;
+        GLint previousViewport[4] = {};
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+        glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+        glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVertexArray);
+        glGetIntegerv(GL_ACTIVE_TEXTURE, &previousActive);
+        glGetIntegerv(GL_VIEWPORT, previousViewport);
+        GLboolean blend = glIsEnabled(GL_BLEND);
+        GLboolean scissor = glIsEnabled(GL_SCISSOR_TEST);
+
+        gl.bindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+        glViewport(0, 0, frame.width, frame.height);
+        glDisable(GL_BLEND);
+        glDisable(GL_SCISSOR_TEST);
+
+        gl.useProgram(m_program);
+        gl.uniform1i(m_layoutUniform, nv12 ? 1 : 0);
+        gl.activeTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, m_planeY.getTextureID());
+        gl.activeTexture(GL_TEXTURE0 + 1);
+        glBindTexture(GL_TEXTURE_2D, m_planeU.getTextureID());
+        gl.activeTexture(GL_TEXTURE0 + 2);
+        glBindTexture(GL_TEXTURE_2D, nv12 ? 0 : m_planeV.getTextureID());
+
+        gl.bindVertexArray(m_vertexArray);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+
+        // Restore
+        glBindTexture(GL_TEXTURE_2D, 0);
+        gl.activeTexture(GL_TEXTURE0 + 1);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        gl.activeTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        gl.activeTexture(static_cast<GLenum>(previousActive));
+        gl.bindVertexArray(static_cast<GLuint>(previousVertexArray));
+        gl.useProgram(static_cast<GLuint>(previousProgram));
+        gl.bindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(previousFramebuffer));
+        glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+        if (blend)
+            glEnable(GL_BLEND);
+        if (scissor)
+            glEnable(GL_SCISSOR_TEST);
+
+        GLenum error = glGetError();
+        if (error != GL_NO_ERROR)
+        {
+            Logger::error("OpenGL error converting YUV preview: " + std::to_string(error));
+            return false;
+        }
+        return true;
+    }
+
+    void YuvTexture::destroy()
+    {
+        m_planeY.destroy();
+        m_planeU.destroy();
+        m_planeV.destroy();
+        m_output.destroy();
+
+        // GL objects only exist if the program was built (and the functions loaded)
+        if (m_framebuffer != 0)
+        {
+            gl.deleteFramebuffers(1, &m_framebuffer);
+            m_framebuffer = 0;
+        }
+        if (m_vertexArray != 0)
+        {
+            gl.deleteVertexArrays(1, &m_vertexArray);
+            m_vertexArray = 0;
+        }
+        if (m_program != 0)
+        {
+            gl.deleteProgram(m_program);
+            m_program = 0;
+        }
+    }
+
+} // namespace NanoRec
@@ -0,0 +1,846 @@
+#include "BenchmarkStore.hpp"
+#include "core/Logger.hpp"
+#include "core/Simd.hpp"
+#include "core/Subprocess.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#ifdef __APPLE__
+#include <sys/sysctl.h>
+#endif
+#ifndef _WIN32
+#include <sys/utsname.h>
+#endif
+
+namespace NanoRec
+{
+
+    // ---------------------------------------------------------------------
+    // JSON (just enough for the store's own files)
+    // ---------------------------------------------------------------------
+
+    namespace
+    {
+
+        struct JsonValue
+        {
+            enum class Type
+            {
+                Null,
+                Bool,
+                Number,
+                String,
+                Array,
+                Object
+            };
+
+            Type type = Type::Null;
+            bool boolean = false;
+            double number = 0.0;
+            std::string text;
+            std::vector<JsonValue> items;
+            std::vector<std::pair<std::string, JsonValue>> members;
+
+            const JsonValue *get(const std::string &key) const
+            {
+                for (const auto &member : members)
+                {
+                    if (member.first == key)
+                    {
+                        return &member.second;
+                    }
+                }
+                return nullptr;
+            }
+
+            std::string getString(const std::string &key) const
+            {
+                const JsonValue *value = get(key);
+                return value && value->type == Type::String ? value->text : std::string();
+            }
+        };
+
+        class JsonReader
+        {
+        public:
+            explicit JsonReader(const std::string &text) : m_text(text) {}
+
+            bool parse(JsonValue &value)
+            {
+                if (!parseValue(value, 0))
+                {
+                    return false;
+                }
+                skipSpace();
+                return m_pos == m_text.size();
+            }
+
+        private:
+            static constexpr int MAX_DEPTH = 32;
+
+            void skipSpace()
+            {
+                while (m_pos < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_pos])))
+                {
+                    m_pos++;
+                }
+            }
+
+            bool consume(char c)
+            {
+                skipSpace();
+                if (m_pos < m_text.size() && m_text[m_pos] == c)
+                {
+                    m_pos++;
+                    return true;
+                }
+                return false;
+            }
+
+            bool consumeWord(const char *word)
+            {
+                size_t length = std::char_traits<char>::length(word);
+                if (m_text.compare(m_pos, length, word) != 0)
+                {
+                    return false;
+                }
+                m_pos += length;
+                return true;
+            }
+
+            bool parseValue(JsonValue &value, int depth)
+            {
+                skipSpace();
+                if (m_pos >= m_text.size() || depth > MAX_DEPTH)
+                {
+                    return false;
+                }
+
+                char c = m_text[m_pos];
+                if (c == '{')
+                {
+                    m_pos++;
+                    value.type = JsonValue::Type::Object;
+                    if (consume('}'))
+                    {
+                        return true;
+                    }
+                    do
+                    {
+                        std::pair<std::string, JsonValue> member;
+                        skipSpace();
+                        if (!parseString(member.first) || !consume(':') || !parseValue(member.second, depth + 1))
+                        {
+                            return false;
+                        }
+                        value.members.push_back(std::move(member));
+                    } while (consume(','));
+                    return consume('}');
+                }
+                if (c == '[')
+                {
+                    m_pos++;
+                    value.type = JsonValue::Type::Array;
+                    if (consume(']'))
+                    {
+                        return true;
+                    }
+                    do
+                    {
+                        value.items.emplace_back();
+                        if (!parseValue(value.items.back(), depth + 1))
+                        {
+                            return false;
+                        }
+                    } while (consume(','));
+                    return consume(']');
+                }
+                if (c == '"')
+                {
+                    value.type = JsonValue::Type::String;
+                    return parseString(value.text);
+                }
+                if (consumeWord("true") || consumeWord("false"))
+                {
+                    value.type = JsonValue::Type::Bool;
+                    value.boolean = c == 't';
+                    return true;
+                }
+                if (consumeWord("null"))
+                {
+                    value.type = JsonValue::Type::Null;
+                    return true;
+                }
+
+                const char *start = m_text.c_str() + m_pos;
+                char *end = nullptr;
+                value.number = std::strtod(start, &end);
+                if (end == start)
+                {
+                    return false;
+                }
+                value.type = JsonValue::Type::Number;
+                m_pos += static_cast<size_t>(end - start);
+                return true;
+            }
+
+            bool parseString(std::string &text)
+            {
+                if (m_pos >= m_text.size() || m_text[m_pos] != '"')
+                {
+                    return false;
+                }
+                m_pos++;
+                while (m_pos < m_text.size())
+                {
+                    char c = m_text[m_pos++];
+                    if (c == '"')
+                    {
+                        return true;
+                    }
+                    if (c != '\\')
+                    {
+                        text += c;
+                        continue;
+                    }
+                    if (m_pos >= m_text.size())
+                    {
+                        return false;
+                    }
+                    char escape = m_text[m_pos++];
+                    switch (escape)
+                    {
+                    case 'b':
+                        text += '\b';
+                        break;
+                    case 'f':
+                        text += '\f';
+                        break;
+                    case 'n':
+                        text += '\n';
+                        break;
+                    case 'r':
+                        text += '\r';
+                        break;
+                    case 't':
+                        text += '\t';
+                        break;
+                    case 'u':
+                    {
+                        // Basic Multilingual Plane only; the store writes \u for control characters
+                        if (m_pos + 4 > m_text.size())
+                        {
+                            return false;
+                        }
+                        unsigned long code = std::strtoul(m_text.substr(m_pos, 4).c_str(), nullptr, 16);
+                        m_pos += 4;
+                        if (code < 0x80)
+                        {
+                            text += static_cast<char>(code);
+                        }
+                        else if (code < 0x800)
+                        {
+                            text += static_cast<char>(0xC0 | (code >> 6));
+                            text += static_cast<char>(0x80 | (code & 0x3F));
+                        }
+                        else
+                        {
+                            text += static_cast<char>(0xE0 | (code >> 12));
+                            text += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                            text += static_cast<char>(0x80 | (code & 0x3F));
+                        }
+                        break;
+                    }
+                    default:
+                        text += escape; // \" \\ \/
+                        break;
+                    }
+                }
+                return false;
+            }
+
+            const std::string &m_text;
+            size_t m_pos{0};
+        };
+
+        std::string jsonString(const std::string &text)
+        {
+            std::ostringstream out;
+            out << '"';
+            for (char c : text)
+            {
+                if (c == '"' || c == '\\')
+                {
+                    out << '\\' << c;
+                }
+                else if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+                }
+                else
+                {
+                    out << c;
+                }
+            }
+            out << '"';
+            return out.str();
+        }
+
+        // -----------------------------------------------------------------
+        // Statistics
+        // -----------------------------------------------------------------
+
+        // Continued fraction of the regularized incomplete beta function (modified Lentz)
+        double betaContinuedFraction(double a, double b, double x)
+        {
+            const double tiny = 1e-300;
+            double c = 1.0;
+            double d = 1.0 - (a + b) * x / (a + 1.0);
+            d = 1.0 / (std::fabs(d) < tiny ? tiny : d);
+            double result = d;
+            for (int m = 1; m <= 300; ++m)
+            {
+                for (int step = 0; step < 2; ++step)
+                {
+                    double numerator = step == 0 ? m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m))
+                                                 : -(a + m) * (a + b + m) * x / ((a + 2 * m) * (a + 2 * m + 1));
+                    d = 1.0 + numerator * d;
+                    d = 1.0 / (std::fabs(d) < tiny ? tiny : d);
+                    c = 1.0 + numerator / c;
+                    c = std::fabs(c) < tiny ? tiny : c;
+                    result *= d * c;
+                }
+                if (std::fabs(d * c - 1.0) < 1e-12)
+                {
+                    break;
+                }
+            }
+            return result;
+        }
+
+        double incompleteBeta(double a, double b, double x)
+        {
+            if (x <= 0.0 || x >= 1.0)
+            {
+                return x <= 0.0 ? 0.0 : 1.0;
+            }
+            double front =
+                std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) + a * std::log(x) + b * std::log(1.0 - x));
+            if (x < (a + 1.0) / (a + b + 2.0))
+            {
+                return front * betaContinuedFraction(a, b, x) / a;
+            }
+            return 1.0 - front * betaContinuedFraction(b, a, 1.0 - x) / b;
+        }
+
+        // P(T <= t) for Student's t with (possibly fractional) df degrees of freedom, t >= 0
+        double studentCdf(double t, double df)
+        {
+            return 1.0 - 0.5 * incompleteBeta(df / 2.0, 0.5, df / (df + t * t));
+        }
+
+        // t such that P(-t <= T <= t) = confidence
+        double studentCritical(double confidence, double df)
+        {
+            double target = 0.5 + confidence / 2.0;
+            double low = 0.0;
+            double high = 1e4;
+            for (int i = 0; i < 100; ++i)
+            {
+                double middle = (low + high) / 2.0;
+                if (studentCdf(middle, df) < target)
+                {
+                    low = middle;
+                }
+                else
+                {
+                    high = middle;
+                }
+            }
+            return (low + high) / 2.0;
+        }
+
+        void meanAndVariance(const std::vector<double> &samples, double &mean, double &variance)
+        {
+            mean = 0.0;
+            variance = 0.0;
+            if (samples.empty())
+            {
+                return;
+            }
+            for (double sample : samples)
+            {
+                mean += sample;
+            }
+            mean /= static_cast<double>(samples.size());
+            if (samples.size() < 2)
+            {
+                return;
+            }
+            for (double sample : samples)
+            {
+                variance += (sample - mean) * (sample - mean);
+            }
+            variance /= static_cast<double>(samples.size() - 1);
+        }
+
+    } // namespace
+
+    // ---------------------------------------------------------------------
+    // Store
+    // ---------------------------------------------------------------------
+
+    const BenchmarkSeries *BenchmarkRun::find(const std::string &group, const std::string &name) const
+    {
+        for (const BenchmarkSeries &entry : series)
+        {
+            if (entry.group == group && entry.name == name)
+            {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    bool BenchmarkStore::load(const std::string &path)
+    {
+        m_runs.clear();
+        std::error_code ec;
+        if (!std::filesystem::exists(path, ec))
+        {
+            return true;
+        }
+
+        std::ifstream file(path, std::ios::binary);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        JsonValue root;
+        if (!file || !JsonReader(contents.str()).parse(root) || root.type != JsonValue::Type::Object)
+        {
+            Logger::error("Cannot parse benchmark store: " + path);
+            return false;
+        }
+
+        const JsonValue *runs = root.get("runs");
+        if (!runs || runs->type != JsonValue::Type::Array)
+        {
+            Logger::error("Benchmark store has no runs: " + path);
+            return false;
+        }
+        for (const JsonValue &entry : runs->items)
+        {
+            BenchmarkRun run;
+            run.machine = entry.getString("machine");
+            run.build = entry.getString("build");
+            run.revision = entry.getString("revision");
+            run.recorded = entry.getString("recorded");
+            const JsonValue *results = entry.get("results");
+            if (results && results->type == JsonValue::Type::Array)
+            {
+                for (const JsonValue &result : results->items)
+                {
+                    BenchmarkSeries series;
+                    series.group = result.getString("group");
+                    series.name = result.getString("name");
+                    const JsonValue *samples = result.get("samples_ms");
+                    if (samples && samples->type == JsonValue::Type::Array)
+                    {
+                        for (const JsonValue &sample : samples->items)
+                        {
+                            if (sample.type == JsonValue::Type::Number)
+                            {
+                                series.samples.push_back(sample.number);
+                            }
+                        }
+                    }
+                    run.series.push_back(std::move(series));
+                }
+            }
+            m_runs.push_back(std::move(run));
+        }
+        return true;
+    }
+
+    bool BenchmarkStore::save(const std::string &path) const
+    {
+        std::ofstream file(path);
+        if (!file)
+        {
+            Logger::error("Cannot write benchmark store: " + path);
+            return false;
+        }
+
+        file << "{\n  \"format\": 1,\n  \"runs\": [";
+        for (size_t i = 0; i < m_runs.size(); ++i)
+        {
+            const BenchmarkRun &run = m_runs[i];
+            file << (i ? ",\n" : "\n") << "    {\n";
+            file << "      \"machine\": " << jsonString(run.machine) << ",\n";
+            file << "      \"build\": " << jsonString(run.build) << ",\n";
+            file << "      \"revision\": " << jsonString(run.revision) << ",\n";
+            file << "      \"recorded\": " << jsonString(run.recorded) << ",\n";
+            file << "      \"results\": [";
+            for (size_t j = 0; j < run.series.size(); ++j)
+            {
+                const BenchmarkSeries &series = run.series[j];
+                file << (j ? ",\n" : "\n") << "        {\"group\": " << jsonString(series.group)
+                     << ", \"name\": " << jsonString(series.name) << ", \"samples_ms\": [";
+                for (size_t k = 0; k < series.samples.size(); ++k)
+                {
+                    char number[32];
+                    std::snprintf(number, sizeof(number), "%.6g", series.samples[k]);
+                    file << (k ? ", " : "") << number;
+                }
+                file << "]}";
+            }
+            file << (run.series.empty() ? "]\n" : "\n      ]\n") << "    }";
+        }
+        file << (m_runs.empty() ? "]\n}\n" : "\n  ]\n}\n");
+
+        if (!file)
+        {
+            Logger::error("Cannot write benchmark store: " + path);
+            return false;
+        }
+        return true;
+    }
+
+    void BenchmarkStore::record(const BenchmarkRun &run, bool append)
+    {
+        BenchmarkRun merged = run;
+        auto sameKey = [&](const BenchmarkRun &existing)
+        {
+            return existing.machine == run.machine && existing.build == run.build &&
+                   existing.revision == run.revision;
+        };
+        auto existing = std::find_if(m_runs.begin(), m_runs.end(), sameKey);
+        if (append && existing != m_runs.end())
+        {
+            merged.series = existing->series;
+            for (const BenchmarkSeries &series : run.series)
+            {
+                auto stored = std::find_if(merged.series.begin(), merged.series.end(),
+                                           [&](const BenchmarkSeries &entry)
+                                           { return entry.group == series.group && entry.name == series.name; });
+                if (stored == merged.series.end())
+                {
+                    merged.series.push_back(series);
+                }
+                else
+                {
+                    stored->samples.insert(stored->samples.end(), series.samples.begin(), series.samples.end());
+                }
+            }
+        }
+
+        // Re-recording moves the run to the end, so the order stays the order of recording
+        m_runs.erase(std::remove_if(m_runs.begin(), m_runs.end(), sameKey), m_runs.end());
+        m_runs.push_back(std::move(merged));
+    }
+
+    const BenchmarkRun *BenchmarkStore::findBaseline(const BenchmarkRun &current, const std::string &revision) const
+    {
+        const BenchmarkRun *prefixMatch = nullptr;
+        for (auto it = m_runs.rbegin(); it != m_runs.rend(); ++it)
+        {
+            if (it->machine != current.machine || it->build != current.build)
+            {
+                continue;
+            }
+            if (revision.empty())
+            {
+                if (it->revision != current.revision)
+                {
+                    return &*it;
+                }
+            }
+            else if (it->revision == revision)
+            {
+                return &*it;
+            }
+            else if (!prefixMatch && it->revision.compare(0, revision.size(), revision) == 0)
+            {
+                prefixMatch = &*it;
+            }
+        }
+        return prefixMatch;
+    }
+
+    std::vector<BenchmarkDelta> BenchmarkStore::compare(const BenchmarkRun &baseline, const BenchmarkRun &current,
+                                                        double confidence)
+    {
+        std::vector<BenchmarkDelta> deltas;
+        for (const BenchmarkSeries &series : current.series)
+        {
+            const BenchmarkSeries *base = baseline.find(series.group, series.name);
+            if (!base || base->samples.empty() || series.samples.empty())
+            {
+                continue;
+            }
+
+            BenchmarkDelta delta;
+            delta.group = series.group;
+            delta.name = series.name;
+            delta.baselineSamples = static_cast<int>(base->samples.size());
+            delta.currentSamples = static_cast<int>(series.samples.size());
+            double baseVariance = 0.0;
+            double currentVariance = 0.0;
+            meanAndVariance(base->samples, delta.baselineMs, baseVariance);
+            meanAndVariance(series.samples, delta.currentMs, currentVariance);
+            if (delta.baselineMs <= 0.0)
+            {
+                continue;
+            }
+
+            double difference = delta.currentMs - delta.baselineMs;
+            double margin = 0.0;
+            bool enoughSamples = delta.baselineSamples >= 2 && delta.currentSamples >= 2;
+            if (enoughSamples)
+            {
+                // Welch: unequal variances, Welch-Satterthwaite degrees of freedom
+                double baseTerm = baseVariance / delta.baselineSamples;
+                double currentTerm = currentVariance / delta.currentSamples;
+                double standardError = std::sqrt(baseTerm + currentTerm);
+                if (standardError > 0.0)
+                {
+                    double df = (baseTerm + currentTerm) * (baseTerm + currentTerm) /
+                                (baseTerm * baseTerm / (delta.baselineSamples - 1) +
+                                 currentTerm * currentTerm / (delta.currentSamples - 1));
+                    margin = studentCritical(confidence, df) * standardError;
+                }
+            }
+
+            delta.deltaPercent = 100.0 * difference / delta.baselineMs;
+            delta.lowPercent = 100.0 * (difference - margin) / delta.baselineMs;
+            delta.highPercent = 100.0 * (difference + margin) / delta.baselineMs;
+            delta.significant = enoughSamples && (delta.lowPercent > 0.0 || delta.highPercent < 0.0);
+            deltas.push_back(delta);
+        }
+
+        std::stable_sort(deltas.begin(), deltas.end(),
+                         [](const BenchmarkDelta &a, const BenchmarkDelta &b) { return a.group < b.group; });
+        return deltas;
+    }
+
+    int BenchmarkStore::printComparison(const std::vector<BenchmarkDelta> &deltas, double tolerancePercent)
+    {
+        std::printf("\n%-9s %-58s %10s %10s %8s %19s  %s\n", "Group", "Benchmark", "Base ms", "Now ms", "Delta",
+                    "Confidence", "Verdict");
+
+        int regressions = 0;
+        for (size_t i = 0; i < deltas.size(); ++i)
+        {
+            const BenchmarkDelta &delta = deltas[i];
+            const char *verdict = "noise";
+            if (delta.baselineSamples < 2 || delta.currentSamples < 2)
+            {
+                verdict = "n/a (1 sample)";
+            }
+            else if (delta.significant && delta.deltaPercent > tolerancePercent)
+            {
+                verdict = "SLOWER";
+                ++regressions;
+            }
+            else if (delta.significant && delta.deltaPercent < -tolerancePercent)
+            {
+                verdict = "faster";
+            }
+            else if (delta.significant)
+            {
+                verdict = "within tolerance";
+            }
+
+            char interval[40];
+            std::snprintf(interval, sizeof(interval), "[%+.1f%%, %+.1f%%]", delta.lowPercent, delta.highPercent);
+            std::printf("%-9s %-58s %10.3f %10.3f %+7.1f%% %19s  %s\n", delta.group.c_str(), delta.name.c_str(),
+                        delta.baselineMs, delta.currentMs, delta.deltaPercent, interval, verdict);
+
+            // Geometric mean of the ratios once a group is complete
+            if (i + 1 == deltas.size() || deltas[i + 1].group != delta.group)
+            {
+                double logSum = 0.0;
+                int count = 0;
+                for (const BenchmarkDelta &member : deltas)
+                {
+                    if (member.group == delta.group && member.currentMs > 0.0)
+                    {
+                        logSum += std::log(member.currentMs / member.baselineMs);
+                        ++count;
+                    }
+                }
+                std::printf("%-9s %-58s %10s %10s %+7.1f%%\n\n", delta.group.c_str(), "(geometric mean)", "", "",
+                            count ? 100.0 * (std::exp(logSum / count) - 1.0) : 0.0);
+            }
+        }
+        return regressions;
+    }
+
+    // ---------------------------------------------------------------------
+    // Environment
+    // ---------------------------------------------------------------------
+
+    std::string BenchmarkStore::machineFingerprint()
+    {
+        std::string cpu;
+#if defined(_WIN32)
+        if (const char *identifier = std::getenv("PROCESSOR_IDENTIFIER"))
+        {
+            cpu = identifier;
+        }
+#elif defined(__APPLE__)
+        char brand[256] = {};
+        size_t size = sizeof(brand);
+        if (sysctlbyname("machdep.cpu.brand_string", brand, &size, nullptr, 0) == 0)
+        {
+            cpu = brand;
+        }
+#else
+        // x86 reports "model name"; many ARM kernels only "Hardware" or "CPU part"
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        std::string fallback;
+        while (cpu.empty() && std::getline(cpuinfo, line))
+        {
+            size_t colon = line.find(':');
+            if (colon == std::string::npos)
+            {
+                continue;
+            }
+            std::string key = line.substr(0, line.find_last_not_of(" \t", colon - 1) + 1);
+            std::string value = line.substr(std::min(line.size(), colon + 2));
+            if (key == "model name")
+            {
+                cpu = value;
+            }
+            else if (fallback.empty() && (key == "Hardware" || key == "CPU part"))
+            {
+                fallback = key + " " + value;
+            }
+        }
+        if (cpu.empty())
+        {
+            cpu = fallback;
+        }
+#endif
+        // Collapse the padding some CPUs carry in their brand string
+        std::string model;
+        for (char c : cpu)
+        {
+            if (c != ' ' || (!model.empty() && model.back() != ' '))
+            {
+                model += c;
+            }
+        }
+        while (!model.empty() && model.back() == ' ')
+        {
+            model.pop_back();
+        }
+        if (model.empty())
+        {
+            model = "unknown CPU";
+        }
+
+        std::string system = "Windows";
+#ifndef _WIN32
+        struct utsname name;
+        system = uname(&name) == 0 ? std::string(name.sysname) + " " + name.machine : "unknown OS";
+#endif
+        return model + ", " + std::to_string(std::thread::hardware_concurrency()) + " threads, " + system;
+    }
+
+    std::string BenchmarkStore::buildFlags()
+    {
+        std::string compiler;
+#if defined(__clang__)
+        compiler = "clang " + std::to_string(__clang_major__) + "." + std::to_string(__clang_minor__);
+#elif defined(__GNUC__)
+        compiler = "gcc " + std::to_string(__GNUC__) + "." + std::to_string(__GNUC_MINOR__);
+#elif defined(_MSC_VER)
+        compiler = "msvc " + std::to_string(_MSC_VER);
+#else
+        compiler = "unknown compiler";
+#endif
+
+        // NANOREC_BUILD_CONFIG is empty for single-config builds without CMAKE_BUILD_TYPE
+        std::string config;
+#ifdef NANOREC_BUILD_CONFIG
+        config = NANOREC_BUILD_CONFIG;
+#endif
+        if (config.empty())
+        {
+#ifdef NDEBUG
+            config = "NDEBUG";
+#else
+            config = "no build type";
+#endif
+        }
+
+        std::string simd;
+#if defined(NANOREC_NO_SIMD)
+        simd = "scalar";
+#elif defined(__AVX2__)
+        simd = "avx2";
+#elif defined(NANOREC_HAVE_SSE2)
+        simd = "sse2";
+#elif defined(__ARM_NEON)
+        simd = "neon";
+#else
+        simd = "generic";
+#endif
+        return compiler + ", " + config + ", " + simd;
+    }
+
+    std::string BenchmarkStore::gitRevision(const std::string &sourceDir)
+    {
+        std::string output;
+        if (sourceDir.empty() || !Subprocess::run({"git", "-C", sourceDir, "rev-parse", "--short=12", "HEAD"}, output))
+        {
+            return "unknown";
+        }
+        std::string revision = output.substr(0, output.find_first_of("\r\n"));
+        if (revision.empty())
+        {
+            return "unknown";
+        }
+
+        // Timings of uncommitted code must not pass for the commit's own
+        std::string changes;
+        if (Subprocess::run({"git", "-C", sourceDir, "status", "--porcelain", "--untracked-files=no"}, changes) &&
+            !changes.empty())
+        {
+            revision += "-dirty";
+        }
+        return revision;
+    }
+
+    BenchmarkRun BenchmarkStore::currentRun(const std::string &sourceDir)
+    {
+        BenchmarkRun run;
+        run.machine = machineFingerprint();
+        run.build = buildFlags();
+        run.revision = gitRevision(sourceDir);
+
+        std::time_t now = std::time(nullptr);
+        std::tm utc{};
+#ifdef _WIN32
+        gmtime_s(&utc, &now);
+#else
+        gmtime_r(&now, &utc);
+#endif
+        char recorded[32];
+        std::strftime(recorded, sizeof(recorded), "%Y-%m-%dT%H:%M:%SZ", &utc);
+        run.recorded = recorded;
+        return run;
+    }
+
+} // namespace NanoRec
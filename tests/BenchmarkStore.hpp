@@ -0,0 +1,130 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace NanoRec
+{
+
+    /**
+     * @brief Repeated timings of one benchmark (milliseconds, lower is better)
+     */
+    struct BenchmarkSeries
+    {
+        std::string group; ///< "kernel" or "pipeline"
+        std::string name;
+        std::vector<double> samples;
+    };
+
+    /**
+     * @brief All series of one benchmark run, keyed by where and what was measured
+     *
+     * Runs are only comparable when machine and build match; revision is
+     * what changes between a baseline and the run under test.
+     */
+    struct BenchmarkRun
+    {
+        std::string machine;  ///< See BenchmarkStore::machineFingerprint()
+        std::string build;    ///< See BenchmarkStore::buildFlags()
+        std::string revision; ///< Git revision, "-dirty" when the tree had local changes
+        std::string recorded; ///< UTC time, ISO 8601
+        std::vector<BenchmarkSeries> series;
+
+        const BenchmarkSeries *find(const std::string &group, const std::string &name) const;
+    };
+
+    /**
+     * @brief One row of a baseline comparison
+     *
+     * The interval is Welch's t interval for the difference of the means,
+     * expressed relative to the baseline mean.
+     */
+    struct BenchmarkDelta
+    {
+        std::string group;
+        std::string name;
+        int baselineSamples = 0;
+        int currentSamples = 0;
+        double baselineMs = 0.0; ///< Means
+        double currentMs = 0.0;
+        double deltaPercent = 0.0; ///< (current - baseline) / baseline
+        double lowPercent = 0.0;   ///< Confidence interval of deltaPercent
+        double highPercent = 0.0;
+        bool significant = false; ///< The interval excludes zero (needs 2+ samples on both sides)
+    };
+
+    /**
+     * @class BenchmarkStore
+     * @brief JSON file of benchmark runs, one per machine/build/revision
+     *
+     * The bench targets record their timings here and compare them with a
+     * stored baseline, so a change can be checked for regressions before it
+     * lands.
+     */
+    class BenchmarkStore
+    {
+    public:
+        /**
+         * @brief Load a store; a missing file loads as an empty store
+         * @return false if the file exists but cannot be parsed
+         */
+        bool load(const std::string &path);
+
+        bool save(const std::string &path) const;
+
+        /**
+         * @brief Add a run under its machine, build and revision
+         * @param append Add the samples to a stored run with the same key instead of
+         *               replacing it, so repeated invocations also capture run-to-run noise
+         */
+        void record(const BenchmarkRun &run, bool append = false);
+
+        const std::vector<BenchmarkRun> &getRuns() const { return m_runs; }
+
+        /**
+         * @brief Find a baseline for @p current
+         * @param revision Revision (or prefix) to compare with; empty = the most
+         *                 recently recorded other revision
+         * @return Run with the same machine and build, or nullptr
+         */
+        const BenchmarkRun *findBaseline(const BenchmarkRun &current, const std::string &revision) const;
+
+        /**
+         * @brief Compare every series present in both runs
+         * @param confidence Two-sided confidence level of the intervals
+         */
+        static std::vector<BenchmarkDelta> compare(const BenchmarkRun &baseline, const BenchmarkRun &current,
+                                                   double confidence = 0.95);
+
+        /**
+         * @brief Print the delta table with a geometric-mean summary per group
+         * @param tolerancePercent Significant changes smaller than this are not reported as regressions
+         * @return Number of significant regressions above the tolerance
+         */
+        static int printComparison(const std::vector<BenchmarkDelta> &deltas, double tolerancePercent);
+
+        /**
+         * @brief CPU model, hardware threads and OS/architecture of this machine
+         */
+        static std::string machineFingerprint();
+
+        /**
+         * @brief Compiler, build configuration and SIMD level of the calling target
+         */
+        static std::string buildFlags();
+
+        /**
+         * @brief Short git revision of @p sourceDir, "unknown" outside a git checkout
+         */
+        static std::string gitRevision(const std::string &sourceDir);
+
+        /**
+         * @brief Machine, build, revision and time of a run starting now (no series)
+         */
+        static BenchmarkRun currentRun(const std::string &sourceDir);
+
+    private:
+        std::vector<BenchmarkRun> m_runs;
+    };
+
+} // namespace NanoRec
@@ -0,0 +1,112 @@
+/**
+ * @file TestSupport.hpp
+ * @brief Helpers shared by the standalone test programs
+ *
+ * PASS/FAIL checks with a failure count, the process id for per-run temp
+ * directories, and a reader for single values of a .stats.json sidecar.
+ */
+
+#ifndef NANOREC_TESTSUPPORT_HPP
+#define NANOREC_TESTSUPPORT_HPP
+
+#include "core/Logger.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace NanoRec::Test
+{
+
+    inline int g_failures = 0; ///< Failed check() calls of this run
+
+    /**
+     * @brief Log PASS/FAIL for one expectation and count failures
+     */
+    inline void check(bool condition, const std::string &what)
+    {
+        if (condition)
+        {
+            Logger::info("PASS: " + what);
+        }
+        else
+        {
+            Logger::error("FAIL: " + what);
+            g_failures++;
+        }
+    }
+
+    /**
+     * @brief Exit code of a test run: logs the outcome of all check() calls
+     * @param passed Message logged when nothing failed
+     */
+    inline int finish(const std::string &passed)
+    {
+        if (g_failures > 0)
+        {
+            Logger::error(std::to_string(g_failures) + " check(s) failed");
+            return 1;
+        }
+        Logger::info(passed);
+        return 0;
+    }
+
+    inline long processId()
+    {
+#ifdef _WIN32
+        return static_cast<long>(GetCurrentProcessId());
+#else
+        return static_cast<long>(getpid());
+#endif
+    }
+
+    /**
+     * @brief Read "<section>": {... "<field>": N ...} from a stats sidecar
+     *
+     * Sections are matched by name wherever they nest (e.g. a latency stage
+     * such as "frame"); booleans read as 1 and 0.
+     * @return -1 if missing or null (e.g. "queue": null)
+     */
+    inline double readStat(const std::string &path, const std::string &section, const std::string &field)
+    {
+        std::ifstream file(path);
+        std::stringstream text;
+        text << file.rdbuf();
+        std::string json = text.str();
+
+        size_t sectionPos = json.find("\"" + section + "\": {");
+        if (sectionPos == std::string::npos)
+        {
+            return -1.0;
+        }
+        size_t end = json.find('}', sectionPos);
+        size_t fieldPos = json.find("\"" + field + "\": ", sectionPos);
+        if (fieldPos == std::string::npos || fieldPos > end)
+        {
+            return -1.0;
+        }
+        std::string value = json.substr(fieldPos + field.size() + 4);
+        if (value.rfind("true", 0) == 0)
+        {
+            return 1.0;
+        }
+        if (value.rfind("false", 0) == 0)
+        {
+            return 0.0;
+        }
+        if (value.rfind("null", 0) == 0)
+        {
+            return -1.0;
+        }
+        return std::atof(value.c_str());
+    }
+
+} // namespace NanoRec::Test
+
+#endif // NANOREC_TESTSUPPORT_HPP
@@ -0,0 +1,1284 @@
+/**
+ * @file test_accuracy.cpp
+ * @brief Accuracy and speed harness for the pixel kernels
+ *
+ * Runs every variant of the scaler, colour-space converters, pixelation,
+ * overlay blend and GIF palette lookup kernels, and the fused stripe pipeline, over a corpus of synthetic frames
+ * (plus any real PPM screenshots passed on the command line) and compares the output with
+ * double-precision reference implementations. Kernels with SIMD paths are
+ * also compared with integer ports of their scalar fallbacks, which they
+ * must match bit for bit. Each kernel variant reports
+ * its worst max error, PSNR and SSIM next to its time per frame, and the
+ * run fails if any of them crosses the kernel's regression threshold.
+ *
+ * SIMD paths are compiled in by default; the test_accuracy_scalar target
+ * builds the same harness with NANOREC_NO_SIMD to cover the fallbacks.
+ *
+ * The timings can be recorded in a BenchmarkStore and compared with a
+ * baseline revision of the same machine and build (--store, --compare).
+ *
+ * Build and run via CMake:
+ *   cd build && cmake .. && make
+ *   ./bin/tests/test_accuracy [--repeat N] [--store FILE [--append] [--compare] [--baseline REV]
+ *                             [--tolerance PCT]] [corpus_dir_or_ppm ...]
+ */
+
+#include "capture/FileReplayCapture.hpp"
+#include "core/FrameScaler.hpp"
+#include "core/GifExporter.hpp"
+#include "core/Logger.hpp"
+#include "core/RedactionFilter.hpp"
+#include "core/StripePipeline.hpp"
+#include "core/TextOverlay.hpp"
+#include "core/YuvConverter.hpp"
+#include "BenchmarkStore.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace NanoRec;
+
+namespace
+{
+
+    /**
+     * @brief Comparison of a kernel's output with its reference
+     */
+    struct Metrics
+    {
+        int maxError = 0;
+        double psnr = std::numeric_limits<double>::infinity();
+        double ssim = 1.0;
+    };
+
+    /**
+     * @brief Regression limits for one kernel
+     */
+    struct Threshold
+    {
+        int maxError;
+        double minPsnr;
+        double minSsim;
+    };
+
+    struct CorpusFrame
+    {
+        std::string name;
+        FrameBuffer pixels;
+    };
+
+    /// Reference output as doubles (RGB24 layout, unrounded)
+    using Reference = std::vector<double>;
+
+    /// Runs a kernel variant on one frame; returns false if the kernel rejected it
+    using KernelRun = std::function<bool(const FrameBuffer &input, FrameBuffer &output)>;
+
+    void copyFrame(const FrameBuffer &source, FrameBuffer &destination)
+    {
+        destination.free();
+        destination.allocate(source.width, source.height);
+        for (int y = 0; y < source.height; ++y)
+        {
+            std::memcpy(destination.data + static_cast<size_t>(y) * destination.stride,
+                        source.data + static_cast<size_t>(y) * source.stride, static_cast<size_t>(source.width) * 3);
+        }
+    }
+
+    uint8_t toByte(double value)
+    {
+        return static_cast<uint8_t>(std::clamp(std::floor(value + 0.5), 0.0, 255.0));
+    }
+
+    // ---------------------------------------------------------------------
+    // Corpus
+    // ---------------------------------------------------------------------
+
+    void fillFrame(FrameBuffer &frame, int width, int height, const std::function<void(int, int, uint8_t *)> &pixel)
+    {
+        frame.allocate(width, height);
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                pixel(x, y, frame.data + static_cast<size_t>(y) * frame.stride + static_cast<size_t>(x) * 3);
+            }
+        }
+    }
+
+    std::vector<CorpusFrame> buildSyntheticCorpus(int width, int height)
+    {
+        std::vector<CorpusFrame> corpus(5);
+        std::mt19937 random(1234);
+
+        corpus[0].name = "gradient";
+        fillFrame(corpus[0].pixels, width, height, [&](int x, int y, uint8_t *p)
+                  {
+                      p[0] = static_cast<uint8_t>(x * 255 / (width - 1));
+                      p[1] = static_cast<uint8_t>(y * 255 / (height - 1));
+                      p[2] = static_cast<uint8_t>((x + y) * 255 / (width + height - 2)); });
+
+        corpus[1].name = "noise";
+        fillFrame(corpus[1].pixels, width, height, [&](int, int, uint8_t *p)
+                  {
+                      p[0] = static_cast<uint8_t>(random());
+                      p[1] = static_cast<uint8_t>(random());
+                      p[2] = static_cast<uint8_t>(random()); });
+
+        // Hard one-pixel edges, the worst case for resampling and chroma subsampling
+        corpus[2].name = "checker";
+        fillFrame(corpus[2].pixels, width, height, [&](int x, int y, uint8_t *p)
+                  {
+                      uint8_t value = ((x ^ y) & 1) ? 255 : 0;
+                      p[0] = value;
+                      p[1] = static_cast<uint8_t>(255 - value);
+                      p[2] = value; });
+
+        // Desktop-like: flat panels, a title bar and rows of dark "text" glyphs
+        corpus[3].name = "desktop";
+        fillFrame(corpus[3].pixels, width, height, [&](int x, int y, uint8_t *p)
+                  {
+                      bool titleBar = y < 32;
+                      bool sidebar = x < width / 5;
+                      bool text = !titleBar && (y % 20) < 12 && (x % 9) < 6 && ((x * 7 + y * 13) % 5) != 0;
+                      uint8_t base = titleBar ? 45 : (sidebar ? 230 : 250);
+                      p[0] = text ? 20 : base;
+                      p[1] = text ? 20 : static_cast<uint8_t>(titleBar ? 50 : base);
+                      p[2] = text ? 30 : static_cast<uint8_t>(titleBar ? 70 : base); });
+
+        // Saturated colour bars exercise clamping in the colour-space kernels
+        corpus[4].name = "bars";
+        static const uint8_t BARS[8][3] = {{255, 255, 255}, {255, 255, 0}, {0, 255, 255}, {0, 255, 0},
+                                           {255, 0, 255}, {255, 0, 0}, {0, 0, 255}, {0, 0, 0}};
+        fillFrame(corpus[4].pixels, width, height, [&](int x, int, uint8_t *p)
+                  {
+                      const uint8_t *bar = BARS[std::min(7, x * 8 / width)];
+                      std::memcpy(p, bar, 3); });
+
+        return corpus;
+    }
+
+    bool loadPpm(const std::string &path, FrameBuffer &frame)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::string magic;
+        int width = 0;
+        int height = 0;
+        int maxValue = 0;
+        file >> magic >> width >> height >> maxValue;
+        file.get();
+        if (!file || magic != "P6" || maxValue != 255 || width <= 0 || height <= 0)
+        {
+            return false;
+        }
+
+        frame.allocate(width, height);
+        file.read(reinterpret_cast<char *>(frame.data), static_cast<std::streamsize>(frame.size));
+        return static_cast<size_t>(file.gcount()) == frame.size;
+    }
+
+    void addRealFrames(const std::string &location, std::vector<CorpusFrame> &corpus)
+    {
+        std::vector<std::string> files;
+        std::error_code ec;
+        if (std::filesystem::is_directory(location, ec))
+        {
+            for (const auto &entry : std::filesystem::directory_iterator(location, ec))
+            {
+                if (entry.path().extension() == ".ppm")
+                {
+                    files.push_back(entry.path().string());
+                }
+            }
+            std::sort(files.begin(), files.end());
+        }
+        else
+        {
+            files.push_back(location);
+        }
+
+        for (const std::string &file : files)
+        {
+            CorpusFrame frame;
+            frame.name = std::filesystem::path(file).filename().string();
+            if (loadPpm(file, frame.pixels))
+            {
+                corpus.push_back(std::move(frame));
+            }
+            else
+            {
+                Logger::warning("Skipping unreadable corpus frame: " + file);
+            }
+        }
+    }
+
+    // ---------------------------------------------------------------------
+    // Metrics
+    // ---------------------------------------------------------------------
+
+    double luma(const uint8_t *p)
+    {
+        return 0.299 * p[0] + 0.587 * p[1] + 0.114 * p[2];
+    }
+
+    double luma(const double *p)
+    {
+        return 0.299 * toByte(p[0]) + 0.587 * toByte(p[1]) + 0.114 * toByte(p[2]);
+    }
+
+    /**
+     * @brief Max error and PSNR over all channels, SSIM on luma (8x8 windows, stride 4)
+     *
+     * The reference is rounded and clamped first, so a kernel that rounds
+     * exactly like the reference scores max error 0.
+     */
+    Metrics compare(const FrameBuffer &output, const Reference &reference)
+    {
+        Metrics metrics;
+        double squaredError = 0.0;
+        size_t rowBytes = static_cast<size_t>(output.width) * 3;
+
+        for (int y = 0; y < output.height; ++y)
+        {
+            const uint8_t *row = output.data + static_cast<size_t>(y) * output.stride;
+            const double *expected = reference.data() + y * rowBytes;
+            for (size_t i = 0; i < rowBytes; ++i)
+            {
+                int error = std::abs(static_cast<int>(row[i]) - static_cast<int>(toByte(expected[i])));
+                metrics.maxError = std::max(metrics.maxError, error);
+                squaredError += static_cast<double>(error) * error;
+            }
+        }
+
+        double mse = squaredError / (rowBytes * output.height);
+        metrics.psnr = mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : std::numeric_limits<double>::infinity();
+
+        const int window = 8;
+        const double c1 = (0.01 * 255) * (0.01 * 255);
+        const double c2 = (0.03 * 255) * (0.03 * 255);
+        double ssimSum = 0.0;
+        int windows = 0;
+        for (int top = 0; top + window <= output.height; top += 4)
+        {
+            for (int left = 0; left + window <= output.width; left += 4)
+            {
+                double sumA = 0, sumB = 0, sumAA = 0, sumBB = 0, sumAB = 0;
+                for (int y = top; y < top + window; ++y)
+                {
+                    for (int x = left; x < left + window; ++x)
+                    {
+                        double a = luma(output.data + static_cast<size_t>(y) * output.stride + x * 3);
+                        double b = luma(reference.data() + y * rowBytes + x * 3);
+                        sumA += a;
+                        sumB += b;
+                        sumAA += a * a;
+                        sumBB += b * b;
+                        sumAB += a * b;
+                    }
+                }
+
+                double n = window * window;
+                double meanA = sumA / n;
+                double meanB = sumB / n;
+                double varA = sumAA / n - meanA * meanA;
+                double varB = sumBB / n - meanB * meanB;
+                double covariance = sumAB / n - meanA * meanB;
+                ssimSum += ((2 * meanA * meanB + c1) * (2 * covariance + c2)) /
+                           ((meanA * meanA + meanB * meanB + c1) * (varA + varB + c2));
+                ++windows;
+            }
+        }
+        metrics.ssim = windows > 0 ? ssimSum / windows : 1.0;
+        return metrics;
+    }
+
+    // ---------------------------------------------------------------------
+    // Reference implementations (double precision)
+    // ---------------------------------------------------------------------
+
+    /// Bilinear with the scaler's sampling grid (destination x maps to x * srcW / dstW)
+    void referenceScale(const FrameBuffer &source, int width, int height, Reference &output)
+    {
+        output.assign(static_cast<size_t>(width) * height * 3, 0.0);
+        double xRatio = static_cast<double>(source.width) / width;
+        double yRatio = static_cast<double>(source.height) / height;
+
+        for (int y = 0; y < height; ++y)
+        {
+            double srcY = y * yRatio;
+            int y0 = std::min(static_cast<int>(std::floor(srcY)), source.height - 1);
+            int y1 = std::min(y0 + 1, source.height - 1);
+            double fy = srcY - y0;
+            for (int x = 0; x < width; ++x)
+            {
+                double srcX = x * xRatio;
+                int x0 = std::min(static_cast<int>(std::floor(srcX)), source.width - 1);
+                int x1 = std::min(x0 + 1, source.width - 1);
+                double fx = srcX - x0;
+                for (int c = 0; c < 3; ++c)
+                {
+                    auto at = [&](int px, int py)
+                    { return static_cast<double>(source.data[static_cast<size_t>(py) * source.stride + px * 3 + c]); };
+                    double top = at(x0, y0) * (1.0 - fx) + at(x1, y0) * fx;
+                    double bottom = at(x0, y1) * (1.0 - fx) + at(x1, y1) * fx;
+                    output[(static_cast<size_t>(y) * width + x) * 3 + c] = top * (1.0 - fy) + bottom * fy;
+                }
+            }
+        }
+    }
+
+    /// Block mean over the frame (the whole frame is the redacted rectangle)
+    void referencePixelate(const FrameBuffer &source, int block, Reference &output)
+    {
+        output.assign(static_cast<size_t>(source.width) * source.height * 3, 0.0);
+        for (int top = 0; top < source.height; top += block)
+        {
+            for (int left = 0; left < source.width; left += block)
+            {
+                int bottom = std::min(source.height, top + block);
+                int right = std::min(source.width, left + block);
+                double count = static_cast<double>(bottom - top) * (right - left);
+                for (int c = 0; c < 3; ++c)
+                {
+                    double sum = 0.0;
+                    for (int y = top; y < bottom; ++y)
+                    {
+                        for (int x = left; x < right; ++x)
+                        {
+                            sum += source.data[static_cast<size_t>(y) * source.stride + x * 3 + c];
+                        }
+                    }
+                    for (int y = top; y < bottom; ++y)
+                    {
+                        for (int x = left; x < right; ++x)
+                        {
+                            output[(static_cast<size_t>(y) * source.width + x) * 3 + c] = sum / count;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // ---------------------------------------------------------------------
+    // Scalar references (integer ports of the kernels' fallback paths)
+    // ---------------------------------------------------------------------
+
+    void copyToReference(const FrameBuffer &source, Reference &output)
+    {
+        output.resize(static_cast<size_t>(source.width) * source.height * 3);
+        for (int y = 0; y < source.height; ++y)
+        {
+            const uint8_t *row = source.data + static_cast<size_t>(y) * source.stride;
+            std::copy(row, row + static_cast<size_t>(source.width) * 3,
+                      output.begin() + static_cast<size_t>(y) * source.width * 3);
+        }
+    }
+
+    /// RedactionFilter::pixelate inside @p rect: integer block sums, rounded half up
+    void scalarPixelate(const FrameBuffer &source, const Rect &rect, int block, Reference &output)
+    {
+        copyToReference(source, output);
+        for (int top = rect.y; top < rect.bottom(); top += block)
+        {
+            for (int left = rect.x; left < rect.right(); left += block)
+            {
+                int bottom = std::min(rect.bottom(), top + block);
+                int right = std::min(rect.right(), left + block);
+                uint32_t count = static_cast<uint32_t>((bottom - top) * (right - left));
+                for (int c = 0; c < 3; ++c)
+                {
+                    uint32_t total = 0;
+                    for (int y = top; y < bottom; ++y)
+                    {
+                        for (int x = left; x < right; ++x)
+                        {
+                            total += source.data[static_cast<size_t>(y) * source.stride + x * 3 + c];
+                        }
+                    }
+                    uint32_t value = (total + count / 2) / count;
+                    for (int y = top; y < bottom; ++y)
+                    {
+                        for (int x = left; x < right; ++x)
+                        {
+                            output[(static_cast<size_t>(y) * source.width + x) * 3 + c] = value;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /// TextOverlay blend: premul + dst * inverse / 255 with the kernel's rounding, saturated
+    uint8_t scalarBlend(uint8_t dst, uint8_t premul, uint8_t inverse)
+    {
+        unsigned x = dst * inverse + 128u;
+        return static_cast<uint8_t>(std::min(255u, premul + ((x + (x >> 8)) >> 8)));
+    }
+
+    /// GifExporter lookup: nearest palette entry to each 15-bit cell centre, first one on ties
+    std::vector<uint8_t> scalarPaletteLookup(const std::vector<std::array<uint8_t, 3>> &palette)
+    {
+        std::vector<uint8_t> lookup(1 << 15, 0);
+        for (int key = 0; key < static_cast<int>(lookup.size()); ++key)
+        {
+            int r = ((key >> 10) << 3) | 4;
+            int g = (((key >> 5) & 31) << 3) | 4;
+            int b = ((key & 31) << 3) | 4;
+            int best = std::numeric_limits<int>::max();
+            for (size_t i = 0; i < palette.size(); ++i)
+            {
+                int dr = palette[i][0] - r;
+                int dg = palette[i][1] - g;
+                int db = palette[i][2] - b;
+                int distance = dr * dr + dg * dg + db * db;
+                if (distance < best)
+                {
+                    best = distance;
+                    lookup[key] = static_cast<uint8_t>(i);
+                }
+            }
+        }
+        return lookup;
+    }
+
+    int paletteKey(const uint8_t *pixel)
+    {
+        return ((pixel[0] >> 3) << 10) | ((pixel[1] >> 3) << 5) | (pixel[2] >> 3);
+    }
+
+    /**
+     * @brief 8-bit YUV planes produced from an RGB frame (BT.601), used as converter input
+     */
+    struct YuvPlanes
+    {
+        int width = 0;
+        int height = 0;
+        int shiftX = 1;
+        int shiftY = 1;
+        bool fullRange = false;
+        std::vector<uint8_t> y, u, v;
+
+        int chromaWidth() const { return (width + (1 << shiftX) - 1) >> shiftX; }
+        int chromaHeight() const { return (height + (1 << shiftY) - 1) >> shiftY; }
+    };
+
+    YuvPlanes makeYuv(const FrameBuffer &rgb, int shiftX, int shiftY, bool fullRange)
+    {
+        YuvPlanes planes;
+        planes.width = rgb.width;
+        planes.height = rgb.height;
+        planes.shiftX = shiftX;
+        planes.shiftY = shiftY;
+        planes.fullRange = fullRange;
+        planes.y.resize(static_cast<size_t>(rgb.width) * rgb.height);
+        planes.u.resize(static_cast<size_t>(planes.chromaWidth()) * planes.chromaHeight());
+        planes.v.resize(planes.u.size());
+
+        double lumaScale = fullRange ? 1.0 : 219.0 / 255.0;
+        double chromaScale = fullRange ? 1.0 : 224.0 / 255.0;
+        double lumaOffset = fullRange ? 0.0 : 16.0;
+
+        std::vector<double> sumU(planes.u.size(), 0.0), sumV(planes.u.size(), 0.0), count(planes.u.size(), 0.0);
+        for (int y = 0; y < rgb.height; ++y)
+        {
+            for (int x = 0; x < rgb.width; ++x)
+            {
+                const uint8_t *p = rgb.data + static_cast<size_t>(y) * rgb.stride + x * 3;
+                double luminance = 0.299 * p[0] + 0.587 * p[1] + 0.114 * p[2];
+                planes.y[static_cast<size_t>(y) * rgb.width + x] = toByte(lumaOffset + lumaScale * luminance);
+
+                size_t chroma = static_cast<size_t>(y >> shiftY) * planes.chromaWidth() + (x >> shiftX);
+                sumU[chroma] += (p[2] - luminance) / 1.772;
+                sumV[chroma] += (p[0] - luminance) / 1.402;
+                count[chroma] += 1.0;
+            }
+        }
+        for (size_t i = 0; i < planes.u.size(); ++i)
+        {
+            planes.u[i] = toByte(128.0 + chromaScale * sumU[i] / count[i]);
+            planes.v[i] = toByte(128.0 + chromaScale * sumV[i] / count[i]);
+        }
+        return planes;
+    }
+
+    /// Exact BT.601 YUV -> RGB of the quantized planes (what an ideal converter outputs)
+    void referenceYuvToRgb(const YuvPlanes &planes, Reference &output)
+    {
+        output.assign(static_cast<size_t>(planes.width) * planes.height * 3, 0.0);
+        double lumaScale = planes.fullRange ? 1.0 : 255.0 / 219.0;
+        double chromaScale = planes.fullRange ? 1.0 : 255.0 / 224.0;
+        double lumaOffset = planes.fullRange ? 0.0 : 16.0;
+
+        for (int y = 0; y < planes.height; ++y)
+        {
+            for (int x = 0; x < planes.width; ++x)
+            {
+                size_t chroma = static_cast<size_t>(y >> planes.shiftY) * planes.chromaWidth() + (x >> planes.shiftX);
+                double l = (planes.y[static_cast<size_t>(y) * planes.width + x] - lumaOffset) * lumaScale;
+                double u = (planes.u[chroma] - 128.0) * chromaScale;
+                double v = (planes.v[chroma] - 128.0) * chromaScale;
+                double *out = output.data() + (static_cast<size_t>(y) * planes.width + x) * 3;
+                out[0] = l + 1.402 * v;
+                out[1] = l - 0.344136 * u - 0.714136 * v;
+                out[2] = l + 1.772 * u;
+            }
+        }
+    }
+
+    /**
+     * @brief Exact BT.601 limited-range RGB -> 4:2:0 with 2x2 averaged chroma
+     *
+     * Stored as a 4:4:4 view (Y, U, V of the pixel's chroma block in the
+     * R, G, B slots) so the RGB metrics apply unchanged.
+     */
+    void referenceRgbToYuv420(const FrameBuffer &rgb, Reference &output)
+    {
+        int chromaWidth = (rgb.width + 1) / 2;
+        int chromaHeight = (rgb.height + 1) / 2;
+        std::vector<double> sumU(static_cast<size_t>(chromaWidth) * chromaHeight, 0.0);
+        std::vector<double> sumV(sumU.size(), 0.0), count(sumU.size(), 0.0);
+
+        output.assign(static_cast<size_t>(rgb.width) * rgb.height * 3, 0.0);
+        for (int y = 0; y < rgb.height; ++y)
+        {
+            for (int x = 0; x < rgb.width; ++x)
+            {
+                const uint8_t *p = rgb.data + static_cast<size_t>(y) * rgb.stride + x * 3;
+                double luminance = 0.299 * p[0] + 0.587 * p[1] + 0.114 * p[2];
+                output[(static_cast<size_t>(y) * rgb.width + x) * 3] = 16.0 + 219.0 / 255.0 * luminance;
+
+                size_t chroma = static_cast<size_t>(y / 2) * chromaWidth + x / 2;
+                sumU[chroma] += (p[2] - luminance) / 1.772;
+                sumV[chroma] += (p[0] - luminance) / 1.402;
+                count[chroma] += 1.0;
+            }
+        }
+        for (int y = 0; y < rgb.height; ++y)
+        {
+            for (int x = 0; x < rgb.width; ++x)
+            {
+                size_t chroma = static_cast<size_t>(y / 2) * chromaWidth + x / 2;
+                double *out = output.data() + (static_cast<size_t>(y) * rgb.width + x) * 3;
+                out[1] = 128.0 + 224.0 / 255.0 * sumU[chroma] / count[chroma];
+                out[2] = 128.0 + 224.0 / 255.0 * sumV[chroma] / count[chroma];
+            }
+        }
+    }
+
+    /// Expand I420/NV12 planes into the 4:4:4 view used by referenceRgbToYuv420
+    void unpackYuv420(const YuvFrame &frame, FrameBuffer &output)
+    {
+        output.free();
+        output.allocate(frame.width, frame.height);
+        bool nv12 = frame.layout == YuvFrame::Layout::NV12;
+        for (int y = 0; y < frame.height; ++y)
+        {
+            for (int x = 0; x < frame.width; ++x)
+            {
+                size_t chroma = static_cast<size_t>(y / 2) * frame.chromaWidth() + x / 2;
+                uint8_t *out = output.data + static_cast<size_t>(y) * output.stride + x * 3;
+                out[0] = frame.planeY()[static_cast<size_t>(y) * frame.width + x];
+                out[1] = nv12 ? frame.planeU()[chroma * 2] : frame.planeU()[chroma];
+                out[2] = nv12 ? frame.planeU()[chroma * 2 + 1] : frame.planeV()[chroma];
+            }
+        }
+    }
+
+    bool writeY4m(const std::string &path, const YuvPlanes &planes)
+    {
+        std::ofstream file(path, std::ios::binary);
+        const char *colorspace = planes.shiftX ? (planes.shiftY ? "420jpeg" : "422") : "444";
+        file << "YUV4MPEG2 W" << planes.width << " H" << planes.height << " F30:1 Ip A1:1 C" << colorspace;
+        if (planes.fullRange)
+        {
+            file << " XCOLORRANGE=FULL";
+        }
+        file << "\nFRAME\n";
+        file.write(reinterpret_cast<const char *>(planes.y.data()), static_cast<std::streamsize>(planes.y.size()));
+        file.write(reinterpret_cast<const char *>(planes.u.data()), static_cast<std::streamsize>(planes.u.size()));
+        file.write(reinterpret_cast<const char *>(planes.v.data()), static_cast<std::streamsize>(planes.v.size()));
+        return static_cast<bool>(file);
+    }
+
+    // ---------------------------------------------------------------------
+    // Harness
+    // ---------------------------------------------------------------------
+
+    struct Result
+    {
+        std::string kernel;
+        std::string variant;
+        Metrics worst;
+        double totalMs = 0.0;
+        std::vector<double> samplesMs; ///< ms/frame of each timed repetition
+        double megapixels = 0.0;
+        bool passed = true;
+        std::string failure;
+    };
+
+    std::vector<Result> g_results;
+    int g_repeat = 3; ///< Timed repetitions per frame after one warm-up run
+
+    /**
+     * @brief Run one kernel variant over the corpus and record its worst metrics
+     * @param prepare Builds the kernel input and the reference for a corpus frame
+     * @param inPlace Copy the input into the output before each (untimed) run
+     * @param run Kernel under test (timed: one warm-up, then g_repeat runs; best of all is reported)
+     * @param unpack Turns a non-RGB kernel result into the RGB24 layout of the reference (untimed)
+     */
+    void runKernel(const std::string &kernel, const std::string &variant, const Threshold &threshold,
+                   const std::vector<CorpusFrame> &corpus,
+                   const std::function<bool(const FrameBuffer &, FrameBuffer &, Reference &)> &prepare,
+                   bool inPlace, const KernelRun &run, const std::function<void(FrameBuffer &)> &unpack = {})
+    {
+        Result result;
+        result.kernel = kernel;
+        result.variant = variant;
+        result.worst.psnr = std::numeric_limits<double>::infinity();
+        result.worst.ssim = 1.0;
+        result.samplesMs.assign(g_repeat, 0.0);
+        int timedFrames = 0;
+
+        for (const CorpusFrame &frame : corpus)
+        {
+            FrameBuffer input;
+            Reference reference;
+            if (!prepare(frame.pixels, input, reference))
+            {
+                result.passed = false;
+                result.failure = "setup failed on " + frame.name;
+                continue;
+            }
+
+            FrameBuffer output;
+            double bestMs = std::numeric_limits<double>::infinity();
+            bool ok = true;
+            std::vector<double> attemptMs;
+            for (int attempt = 0; attempt <= g_repeat && ok; ++attempt)
+            {
+                if (inPlace)
+                {
+                    copyFrame(input, output);
+                }
+                auto start = std::chrono::steady_clock::now();
+                ok = run(input, output);
+                double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                bestMs = std::min(bestMs, ms);
+                if (attempt > 0)
+                {
+                    attemptMs.push_back(ms);
+                }
+            }
+            if (!ok || !output.data)
+            {
+                result.passed = false;
+                result.failure = "kernel failed on " + frame.name;
+                continue;
+            }
+            if (unpack)
+            {
+                unpack(output);
+            }
+
+            Metrics metrics = compare(output, reference);
+            result.totalMs += bestMs;
+            for (size_t i = 0; i < attemptMs.size(); ++i)
+            {
+                result.samplesMs[i] += attemptMs[i];
+            }
+            ++timedFrames;
+            result.megapixels += static_cast<double>(output.width) * output.height / 1e6;
+            result.worst.maxError = std::max(result.worst.maxError, metrics.maxError);
+            result.worst.psnr = std::min(result.worst.psnr, metrics.psnr);
+            result.worst.ssim = std::min(result.worst.ssim, metrics.ssim);
+
+            if (result.passed &&
+                (metrics.maxError > threshold.maxError || metrics.psnr < threshold.minPsnr ||
+                 metrics.ssim < threshold.minSsim))
+            {
+                result.passed = false;
+                char detail[160];
+                std::snprintf(detail, sizeof(detail), "%s: err %d (<=%d), PSNR %.2f (>=%.1f), SSIM %.5f (>=%.4f)",
+                              frame.name.c_str(), metrics.maxError, threshold.maxError, metrics.psnr,
+                              threshold.minPsnr, metrics.ssim, threshold.minSsim);
+                result.failure = detail;
+            }
+        }
+
+        for (double &sample : result.samplesMs)
+        {
+            sample = timedFrames > 0 ? sample / timedFrames : 0.0;
+        }
+        g_results.push_back(result);
+    }
+
+    // Pass the corpus frame through unchanged as kernel input
+    bool copyInput(const FrameBuffer &frame, FrameBuffer &input)
+    {
+        copyFrame(frame, input);
+        return true;
+    }
+
+    void testScaler(const std::vector<CorpusFrame> &corpus)
+    {
+        // Bilinear in float against double: only rounding at .5 boundaries may differ
+        const Threshold threshold{1, 50.0, 0.999};
+        const struct
+        {
+            const char *name;
+            double factor;
+        } ratios[] = {{"down 0.5", 0.5}, {"down 0.67", 2.0 / 3.0}, {"up 1.5", 1.5}};
+
+        for (const auto &ratio : ratios)
+        {
+            for (int threads : {1, 2, 4})
+            {
+                std::string variant = std::string(ratio.name) + ", " + std::to_string(threads) + " thread" +
+                                      (threads > 1 ? "s" : "");
+                int targetWidth = 0;
+                int targetHeight = 0;
+                runKernel(
+                    "FrameScaler::scaleFrame", variant, threshold, corpus,
+                    [&](const FrameBuffer &frame, FrameBuffer &input, Reference &reference)
+                    {
+                        targetWidth = std::max(2, static_cast<int>(frame.width * ratio.factor));
+                        targetHeight = std::max(2, static_cast<int>(frame.height * ratio.factor));
+                        referenceScale(frame, targetWidth, targetHeight, reference);
+                        return copyInput(frame, input);
+                    },
+                    false,
+                    [&](const FrameBuffer &input, FrameBuffer &output)
+                    { return FrameScaler::scaleFrame(input, output, targetWidth, targetHeight, threads); });
+            }
+        }
+    }
+
+    void testPixelate(const std::vector<CorpusFrame> &corpus)
+    {
+        // Integer sums with round-half-up are exact
+        const Threshold threshold{0, 0.0, 0.0};
+        for (int block : {8, 16, 31, 128})
+        {
+            runKernel(
+                "RedactionFilter::pixelate", "block " + std::to_string(block), threshold, corpus,
+                [&](const FrameBuffer &frame, FrameBuffer &input, Reference &reference)
+                {
+                    referencePixelate(frame, block, reference);
+                    return copyInput(frame, input);
+                },
+                true,
+                [&](const FrameBuffer &, FrameBuffer &output)
+                {
+                    RedactionFilter::pixelate(output, Rect(0, 0, output.width, output.height), block);
+                    return true;
+                });
+        }
+
+        // Rectangles off the 16-byte grid run the SIMD column sums into the scalar tail
+        const Threshold exact{0, 99.0, 1.0};
+        const struct
+        {
+            const char *name;
+            int block;
+            int x;
+            int y;
+            int width; ///< <= 0: frame width minus this
+        } rects[] = {{"vs scalar, block 16", 16, 1, 3, -6}, {"vs scalar, block 31", 31, 7, 0, -9},
+                     {"vs scalar, 5 px wide", 8, 11, 2, 5}};
+        for (const auto &rect : rects)
+        {
+            Rect area;
+            runKernel(
+                "RedactionFilter::pixelate", rect.name, exact, corpus,
+                [&](const FrameBuffer &frame, FrameBuffer &input, Reference &reference)
+                {
+                    int width = rect.width > 0 ? rect.width : frame.width + rect.width - rect.x;
+                    area = Rect(rect.x, rect.y, width, frame.height - rect.y - 1);
+                    scalarPixelate(frame, area, rect.block, reference);
+                    return copyInput(frame, input);
+                },
+                true,
+                [&](const FrameBuffer &, FrameBuffer &output)
+                {
+                    RedactionFilter::pixelate(output, area, rect.block);
+                    return true;
+                });
+        }
+    }
+
+    void testOverlayBlend(const std::vector<CorpusFrame> &corpus)
+    {
+        // The blend is dst * inverse / 255 + premul; recover both terms from black and white frames
+        const std::string text = "2025-12-04 13:37:00.042 accuracy-host";
+        const Threshold threshold{1, 50.0, 0.999};
+
+        for (int scale : {1, 2, 3})
+        {
+            TextOverlay overlay;
+            TextOverlay::Options options;
+            options.label = "accuracy-host";
+            options.scale = scale;
+            overlay.configure(options);
+
+            // Against the exact blend, and bit for bit against the scalar rounding
+            for (bool scalar : {false, true})
+            {
+                runKernel(
+                    "TextOverlay::blend", (scalar ? "vs scalar, scale " : "scale ") + std::to_string(scale),
+                    scalar ? Threshold{0, 99.0, 1.0} : threshold, corpus,
+                    [&](const FrameBuffer &frame, FrameBuffer &input, Reference &reference)
+                    {
+                        FrameBuffer black;
+                        FrameBuffer white;
+                        black.allocate(frame.width, frame.height);
+                        white.allocate(frame.width, frame.height);
+                        std::memset(black.data, 0, black.size);
+                        std::memset(white.data, 255, white.size);
+                        overlay.apply(black, text);
+                        overlay.apply(white, text);
+
+                        reference.resize(frame.size);
+                        for (size_t i = 0; i < frame.size; ++i)
+                        {
+                            uint8_t premul = black.data[i];
+                            uint8_t inverse = static_cast<uint8_t>(white.data[i] - premul);
+                            reference[i] = scalar ? scalarBlend(frame.data[i], premul, inverse)
+                                                  : premul + frame.data[i] * inverse / 255.0;
+                        }
+                        return copyInput(frame, input);
+                    },
+                    true,
+                    [&](const FrameBuffer &, FrameBuffer &output)
+                    {
+                        overlay.apply(output, text);
+                        return true;
+                    });
+            }
+        }
+    }
+
+    void testPaletteLookup(const std::vector<CorpusFrame> &corpus)
+    {
+        // The lookup table is exact: the SIMD search must pick the scalar search's entry, ties included
+        const Threshold threshold{0, 99.0, 1.0};
+        std::mt19937 random(4321);
+        const struct
+        {
+            const char *name;
+            int colors;
+            bool duplicates; ///< Every colour twice, so each lookup is a tie
+        } palettes[] = {{"2 colours", 2, false},
+                        {"17 colours", 17, false},
+                        {"255 colours", 255, false},
+                        {"256 colours", 256, false},
+                        {"128 colours, ties", 64, true}};
+
+        for (const auto &variant : palettes)
+        {
+            std::vector<std::array<uint8_t, 3>> palette(variant.colors);
+            for (auto &entry : palette)
+            {
+                entry = {static_cast<uint8_t>(random()), static_cast<uint8_t>(random()),
+                         static_cast<uint8_t>(random())};
+            }
+            if (variant.duplicates)
+            {
+                palette.insert(palette.end(), palette.begin(), palette.end());
+                std::shuffle(palette.begin(), palette.end(), random);
+            }
+            std::vector<uint8_t> expected = scalarPaletteLookup(palette);
+            std::vector<uint8_t> lookup;
+
+            // Pixels are replaced by their palette index (grey), so picking an equal colour's twin fails too
+            runKernel(
+                "GifExporter::buildLookupTable", variant.name, threshold, corpus,
+                [&](const FrameBuffer &frame, FrameBuffer &input, Reference &reference)
+                {
+                    reference.resize(static_cast<size_t>(frame.width) * frame.height * 3);
+                    for (int y = 0; y < frame.height; ++y)
+                    {
+                        for (int x = 0; x < frame.width; ++x)
+                        {
+                            const uint8_t *p = frame.data + static_cast<size_t>(y) * frame.stride + x * 3;
+                            std::fill_n(reference.begin() + (static_cast<size_t>(y) * frame.width + x) * 3, 3,
+                                        expected[paletteKey(p)]);
+                        }
+                    }
+                    return copyInput(frame, input);
+                },
+                false,
+                [&](const FrameBuffer &input, FrameBuffer &output)
+                {
+                    GifExporter::buildLookupTable(palette, lookup);
+                    if (!output.data)
+                    {
+                        output.allocate(input.width, input.height);
+                    }
+                    for (int y = 0; y < input.height; ++y)
+                    {
+                        const uint8_t *src = input.data + static_cast<size_t>(y) * input.stride;
+                        uint8_t *dst = output.data + static_cast<size_t>(y) * output.stride;
+                        for (int x = 0; x < input.width; ++x, src += 3, dst += 3)
+                        {
+                            std::memset(dst, lookup[paletteKey(src)], 3);
+                        }
+                    }
+                    return true;
+                });
+        }
+    }
+
+    void testYuvConversion(const std::vector<CorpusFrame> &corpus)
+    {
+        // 8.8 fixed-point coefficients: allow off-by-one/two from coefficient rounding
+        const Threshold threshold{2, 45.0, 0.995};
+        const struct
+        {
+            const char *name;
+            int shiftX;
+            int shiftY;
+            bool fullRange;
+        } formats[] = {{"y4m 420 limited", 1, 1, false}, {"y4m 420 full", 1, 1, true},
+                       {"y4m 422 limited", 1, 0, false}, {"y4m 444 full", 0, 0, true}};
+
+        std::string path = (std::filesystem::temp_directory_path() / "nanorec_accuracy.y4m").string();
+        for (const auto &format : formats)
+        {
+            std::unique_ptr<FileReplayCapture> replay;
+            runKernel(
+                "FileReplayCapture (YUV->RGB)", format.name, threshold, corpus,
+                [&](const FrameBuffer &frame, FrameBuffer &input, Reference &reference)
+                {
+                    YuvPlanes planes = makeYuv(frame, format.shiftX, format.shiftY, format.fullRange);
+                    referenceYuvToRgb(planes, reference);
+                    if (!writeY4m(path, planes))
+                    {
+                        return false;
+                    }
+
+                    FileReplayCapture::Options options;
+                    options.path = path;
+                    options.realtime = false;
+                    replay = std::make_unique<FileReplayCapture>(options);
+                    input.allocate(1, 1); // Unused; the replay source reads the mapped file
+                    return replay->initialize();
+                },
+                false,
+                [&](const FrameBuffer &, FrameBuffer &output)
+                { return replay->captureFrame(output); });
+            replay.reset();
+        }
+
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+
+    void testRgbToYuv(const std::vector<CorpusFrame> &corpus)
+    {
+        // Q15/Q17 fixed point: only rounding at .5 boundaries may differ
+        const Threshold threshold{1, 50.0, 0.999};
+        const struct
+        {
+            const char *name;
+            YuvFrame::Layout layout;
+            int threads;
+        } variants[] = {{"I420 1 thread", YuvFrame::Layout::I420, 1},
+                        {"I420 4 threads", YuvFrame::Layout::I420, 4},
+                        {"NV12 1 thread", YuvFrame::Layout::NV12, 1},
+                        {"NV12 4 threads", YuvFrame::Layout::NV12, 4}};
+
+        for (const auto &variant : variants)
+        {
+            YuvFrame yuv;
+            runKernel(
+                "YuvConverter (RGB->YUV)", variant.name, threshold, corpus,
+                [&](const FrameBuffer &frame, FrameBuffer &input, Reference &reference)
+                {
+                    referenceRgbToYuv420(frame, reference);
+                    return copyInput(frame, input);
+                },
+                false,
+                [&](const FrameBuffer &input, FrameBuffer &output)
+                {
+                    // The output frame only marks success; unpack fills it afterwards
+                    if (!output.data)
+                    {
+                        output.allocate(1, 1);
+                    }
+                    return YuvConverter::convert(input, yuv, variant.layout, variant.threads);
+                },
+                [&](FrameBuffer &output) { unpackYuv420(yuv, output); });
+        }
+    }
+
+    void testStripePipeline(const std::vector<CorpusFrame> &corpus)
+    {
+        // Stripe mode must produce the same encoder frame as the full-frame path, bit for bit
+        const Threshold threshold{0, 99.0, 1.0};
+        const std::string text = "2025-12-04 13:37:00.042 accuracy-host";
+        TextOverlay overlay;
+        TextOverlay::Options options;
+        options.label = "accuracy-host";
+        overlay.configure(options);
+
+        const struct
+        {
+            const char *name;
+            double factor;
+        } sizes[] = {{"1x", 1.0}, {"0.5x", 0.5}};
+
+        for (const auto &size : sizes)
+        {
+            for (int stripeRows : {0, 16, 64})
+            {
+                std::string variant = std::string(size.name) + ", " +
+                                      (stripeRows == 0 ? "full frames" : std::to_string(stripeRows) + "-row stripes");
+                YuvFrame yuv;
+                FrameBuffer scaled;
+                StripePipeline pipeline;
+                int width = 0;
+                int height = 0;
+                runKernel(
+                    "Encoder path (scale+text+YUV)", variant, threshold, corpus,
+                    [&](const FrameBuffer &frame, FrameBuffer &input, Reference &reference)
+                    {
+                        width = static_cast<int>(frame.width * size.factor) & ~1;
+                        height = static_cast<int>(frame.height * size.factor) & ~1;
+
+                        // Reference: the full-frame path, kept as the encoder frame's 4:4:4 view
+                        FrameBuffer expected;
+                        if (size.factor != 1.0)
+                        {
+                            FrameScaler::scaleFrame(frame, expected, width, height);
+                        }
+                        else
+                        {
+                            copyFrame(frame, expected);
+                        }
+                        overlay.apply(expected, text);
+                        YuvFrame expectedYuv;
+                        YuvConverter::convert(expected, expectedYuv, YuvFrame::Layout::I420);
+                        FrameBuffer unpacked;
+                        unpackYuv420(expectedYuv, unpacked);
+                        reference.assign(unpacked.data, unpacked.data + unpacked.size);
+                        return copyInput(frame, input);
+                    },
+                    true,
+                    [&](const FrameBuffer &input, FrameBuffer &output)
+                    {
+                        if (stripeRows > 0)
+                        {
+                            overlay.prepareFrame(width, height, text);
+                            return pipeline.process(input, width, height, &overlay, YuvFrame::Layout::I420, yuv,
+                                                    stripeRows);
+                        }
+
+                        // Full-frame path as CaptureThread runs it; at native size the
+                        // text is drawn in place into the (untimed) copy of the capture
+                        FrameBuffer *frame = &output;
+                        if (size.factor != 1.0)
+                        {
+                            FrameScaler::scaleFrame(input, scaled, width, height);
+                            frame = &scaled;
+                        }
+                        overlay.apply(*frame, text);
+                        return YuvConverter::convert(*frame, yuv, YuvFrame::Layout::I420);
+                    },
+                    [&](FrameBuffer &output) { unpackYuv420(yuv, output); });
+            }
+        }
+    }
+
+    /**
+     * @brief Record this run's timings in the store and compare them with a baseline if asked
+     * @return false if the store cannot be used or the comparison found regressions
+     */
+    bool recordTimings(const std::string &storePath, bool append, bool compareBaseline,
+                       const std::string &baselineRevision, double tolerancePercent, size_t corpusFrames)
+    {
+#ifdef NANOREC_SOURCE_DIR
+        BenchmarkRun run = BenchmarkStore::currentRun(NANOREC_SOURCE_DIR);
+#else
+        BenchmarkRun run = BenchmarkStore::currentRun("");
+#endif
+        for (const Result &result : g_results)
+        {
+            // The fused encoder path is the pipeline as CaptureThread runs it; the rest are single kernels
+            BenchmarkSeries series;
+            series.group = result.kernel.rfind("Encoder path", 0) == 0 ? "pipeline" : "kernel";
+            series.name = result.kernel + " / " + result.variant;
+            series.samples = result.samplesMs;
+            run.series.push_back(series);
+        }
+        Logger::info("Benchmark run: " + run.revision + " on " + run.machine + " (" + run.build + "), " +
+                     std::to_string(corpusFrames) + " corpus frames, " + std::to_string(g_repeat) + " repetitions");
+
+        BenchmarkStore store;
+        if (!store.load(storePath))
+        {
+            return false;
+        }
+
+        // With --append the comparison covers every invocation recorded for this revision
+        store.record(run, append);
+        if (!store.save(storePath))
+        {
+            return false;
+        }
+        Logger::info("Timings recorded in " + storePath);
+        if (!compareBaseline)
+        {
+            return true;
+        }
+
+        const BenchmarkRun &current = store.getRuns().back();
+        const BenchmarkRun *baseline = store.findBaseline(current, baselineRevision);
+        if (!baseline)
+        {
+            Logger::error("No baseline " + (baselineRevision.empty() ? "run" : baselineRevision) +
+                          " for this machine and build in " + storePath);
+            for (const BenchmarkRun &stored : store.getRuns())
+            {
+                Logger::info("  stored: " + stored.revision + " on " + stored.machine + " (" + stored.build + ")");
+            }
+            return false;
+        }
+
+        Logger::info("Baseline: " + baseline->revision + " recorded " + baseline->recorded);
+        int regressions =
+            BenchmarkStore::printComparison(BenchmarkStore::compare(*baseline, current), tolerancePercent);
+        if (regressions > 0)
+        {
+            Logger::error(std::to_string(regressions) + " benchmark(s) significantly slower than " +
+                          baseline->revision);
+            return false;
+        }
+        return true;
+    }
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Logger::info("=== Pixel Kernel Accuracy Test ===");
+#ifdef NANOREC_NO_SIMD
+    Logger::info("Build: scalar kernels (NANOREC_NO_SIMD)");
+#else
+    Logger::info("Build: SIMD kernels where available");
+#endif
+
+    std::string storePath;
+    std::string baselineRevision;
+    bool appendSamples = false;
+    bool compareBaseline = false;
+    double tolerancePercent = 3.0;
+    std::vector<CorpusFrame> corpus = buildSyntheticCorpus(1280, 720);
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--repeat" && hasValue)
+        {
+            g_repeat = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--store" && hasValue)
+        {
+            storePath = argv[++i];
+        }
+        else if (arg == "--append")
+        {
+            appendSamples = true;
+        }
+        else if (arg == "--compare")
+        {
+            compareBaseline = true;
+        }
+        else if (arg == "--baseline" && hasValue)
+        {
+            baselineRevision = argv[++i];
+            compareBaseline = true;
+        }
+        else if (arg == "--tolerance" && hasValue)
+        {
+            tolerancePercent = std::atof(argv[++i]);
+        }
+        else if (arg.rfind("--", 0) == 0)
+        {
+            Logger::error("Unknown or incomplete option: " + arg);
+            return 2;
+        }
+        else
+        {
+            addRealFrames(arg, corpus);
+        }
+    }
+    if ((compareBaseline || appendSamples) && storePath.empty())
+    {
+        Logger::error("--append, --compare and --baseline need --store FILE");
+        return 2;
+    }
+    Logger::info("Corpus: " + std::to_string(corpus.size()) + " frames");
+
+    testScaler(corpus);
+    testPixelate(corpus);
+    testOverlayBlend(corpus);
+    testPaletteLookup(corpus);
+    testYuvConversion(corpus);
+    testRgbToYuv(corpus);
+    testStripePipeline(corpus);
+
+    std::printf("\n%-30s %-22s %7s %9s %9s %10s %10s  %s\n", "Kernel", "Variant", "MaxErr", "PSNR", "SSIM",
+                "ms/frame", "Mpix/s", "Status");
+    int failures = 0;
+    for (const Result &result : g_results)
+    {
+        size_t frames = corpus.size();
+        char psnr[16];
+        if (std::isinf(result.worst.psnr))
+        {
+            std::snprintf(psnr, sizeof(psnr), "inf");
+        }
+        else
+        {
+            std::snprintf(psnr, sizeof(psnr), "%.2f", result.worst.psnr);
+        }
+
+        std::printf("%-30s %-22s %7d %9s %9.5f %10.3f %10.1f  %s\n", result.kernel.c_str(), result.variant.c_str(),
+                    result.worst.maxError, psnr, result.worst.ssim, result.totalMs / frames,
+                    result.totalMs > 0.0 ? result.megapixels / (result.totalMs / 1000.0) : 0.0,
+                    result.passed ? "ok" : "FAIL");
+        if (!result.passed)
+        {
+            std::printf("    %s\n", result.failure.c_str());
+            ++failures;
+        }
+    }
+    std::printf("\n");
+
+    bool timingsOk = storePath.empty() || recordTimings(storePath, appendSamples, compareBaseline, baselineRevision,
+                                                        tolerancePercent, corpus.size());
+
+    if (failures > 0)
+    {
+        Logger::error(std::to_string(failures) + " kernel variant(s) regressed");
+        return 1;
+    }
+    if (!timingsOk)
+    {
+        return 1;
+    }
+
+    Logger::info("All kernel variants within accuracy limits");
+    return 0;
+}
@@ -7,8 +7,10 @@
  * Build and run via CMake:
  *   cd build && cmake .. && make
  *   ./bin/tests/test_capture
+ *   ./bin/tests/test_capture --vnc localhost:0   # RFB source instead of the local screen
  */ \
 #include "capture/IScreenCapture.hpp"
+#include "capture/VncScreenCapture.hpp"
 #include "core/Logger.hpp"
 #include <iostream>
 #include <fstream>
@@ -41,12 +43,26 @@ void saveFrameAsPPM(const FrameBuffer &buffer, const std::string &filename)
     Logger::log(Logger::Level::INFO, "Saved frame to: " + filename);
 }
 
-int main()
+int main(int argc, char **argv)
 {
     Logger::log(Logger::Level::INFO, "=== Screen Capture Test ===");
 
     // Create screen capture instance
-    auto capture = createScreenCapture();
+    std::unique_ptr<IScreenCapture> capture;
+    if (argc >= 3 && std::string(argv[1]) == "--vnc")
+    {
+        VncScreenCapture::Options options;
+        if (!VncScreenCapture::parseAddress(argv[2], options.host, options.port))
+        {
+            Logger::log(Logger::Level::ERROR_LEVEL, std::string("Invalid VNC address: ") + argv[2]);
+            return 1;
+        }
+        capture = std::make_unique<VncScreenCapture>(options);
+    }
+    else
+    {
+        capture = createScreenCapture();
+    }
     if (!capture)
     {
         Logger::log(Logger::Level::ERROR_LEVEL, "Failed to create screen capture instance");
@@ -87,8 +103,14 @@ int main()
         double ms = duration.count() / 1000.0;
         totalTime += ms;
 
+        std::string damage;
+        std::vector<Rect> dirty;
+        if (capture->getDirtyRects(dirty))
+        {
+            damage = " (" + std::to_string(dirty.size()) + " dirty rects)";
+        }
         Logger::log(Logger::Level::INFO, "Frame " + std::to_string(i + 1) + " captured in " +
-                                             std::to_string(ms) + " ms");
+                                             std::to_string(ms) + " ms" + damage);
 
         // Save first frame as sample
         if (i == 0)
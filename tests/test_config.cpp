@@ -0,0 +1,94 @@
+/**
+ * @file test_config.cpp
+ * @brief Config file round-trips
+ *
+ * Saves the configuration with non-default values, resets it and loads the
+ * file back, checking that:
+ *  - every kind of field (string, number, bool) comes back unchanged;
+ *  - string values containing '#' and ';' (labels, window patterns, node
+ *    lists) are not cut at those characters;
+ *  - whole-line '#' and ';' comments are still skipped.
+ * Needs no display and no ffmpeg.
+ *
+ * Build and run via CMake:
+ *   cd build && cmake .. && make
+ *   ./bin/tests/test_config
+ */
+
+#include "core/Config.hpp"
+#include "core/Logger.hpp"
+#include "TestSupport.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace NanoRec;
+using namespace NanoRec::Test;
+
+namespace
+{
+
+    void testRoundTrip(const std::filesystem::path &path)
+    {
+        Config &config = Config::getInstance();
+        config.resetToDefaults();
+        config.getVideoConfig().fps = 24;
+        config.getVideoConfig().adaptiveRate = true;
+        config.getAppConfig().overlayLabel = "Build #42; nightly";
+        config.getAppConfig().redactWindows = "KeePassXC;#secret,1Password";
+        config.getAppConfig().encoderNodes = "node-a:9400;node-b#2";
+        config.getAppConfig().archivePreset = "veryslow";
+        check(config.save(path.string()), "config saved");
+
+        config.resetToDefaults();
+        check(config.load(path.string()), "config loaded");
+        check(config.getVideoConfig().fps == 24, "number round-trips");
+        check(config.getVideoConfig().adaptiveRate, "bool round-trips");
+        check(config.getAppConfig().archivePreset == "veryslow", "plain string round-trips");
+        check(config.getAppConfig().overlayLabel == "Build #42; nightly",
+              "label with '#' and ';' round-trips (\"" + config.getAppConfig().overlayLabel + "\")");
+        check(config.getAppConfig().redactWindows == "KeePassXC;#secret,1Password",
+              "redaction patterns with '#' and ';' round-trip (\"" + config.getAppConfig().redactWindows + "\")");
+        check(config.getAppConfig().encoderNodes == "node-a:9400;node-b#2",
+              "node list with '#' and ';' round-trips (\"" + config.getAppConfig().encoderNodes + "\")");
+    }
+
+    void testComments(const std::filesystem::path &path)
+    {
+        {
+            std::ofstream file(path);
+            file << "# comment line\n"
+                 << "; another comment\n"
+                 << "[video]\n"
+                 << "  # indented comment = ignored\n"
+                 << "fps = 15\n"
+                 << ";fps = 99\n"
+                 << "[app]\n"
+                 << "overlay_label = #1\n";
+        }
+
+        Config &config = Config::getInstance();
+        config.resetToDefaults();
+        check(config.load(path.string()), "commented config loaded");
+        check(config.getVideoConfig().fps == 15, "comment lines skipped (fps " +
+                                                     std::to_string(config.getVideoConfig().fps) + ")");
+        check(config.getAppConfig().overlayLabel == "#1", "value starting with '#' kept");
+    }
+
+} // namespace
+
+int main()
+{
+    Logger::info("=== Config Test ===");
+
+    std::filesystem::path workDir =
+        std::filesystem::temp_directory_path() / ("nanorec_config_" + std::to_string(processId()));
+    std::filesystem::remove_all(workDir);
+    std::filesystem::create_directories(workDir);
+
+    testRoundTrip(workDir / "roundtrip.ini");
+    testComments(workDir / "comments.ini");
+
+    std::filesystem::remove_all(workDir);
+    return finish("All config checks passed");
+}
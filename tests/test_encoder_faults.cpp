@@ -0,0 +1,366 @@
+/**
+ * @file test_encoder_faults.cpp
+ * @brief Capture pipeline behavior with a slow, flaky or dying encoder
+ *
+ * Records a synthetic 60 FPS source through CaptureThread into
+ * SimulatedVideoWriter, which injects latency spikes, a throughput cap
+ * below the frame rate, short writes and a sudden encoder exit. Each
+ * scenario checks, from the outside:
+ *  - the capture thread never goes longer than the stall budget between
+ *    two captures (except in the synchronous reference run, which shows
+ *    the stall the queue exists to absorb);
+ *  - the encoder queue never exceeds its configured frame and spill limits
+ *    (from the segment's .stats.json);
+ *  - drop mode drops, spill mode delivers every frame in order, short
+ *    writes are counted, and a dead encoder either continues in a new
+ *    segment (encoderRestarts) or ends the recording cleanly.
+ * Needs no ffmpeg.
+ *
+ * Build and run via CMake:
+ *   cd build && cmake .. && make
+ *   ./bin/tests/test_encoder_faults
+ */
+
+#include "core/CaptureThread.hpp"
+#include "core/Logger.hpp"
+#include "core/RecordingStats.hpp"
+#include "core/SimulatedVideoWriter.hpp"
+#include "core/ThreadSafeFrameBuffer.hpp"
+#include "TestSupport.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace NanoRec;
+using namespace NanoRec::Test;
+
+namespace
+{
+
+    constexpr int FPS = 60;
+    constexpr int WIDTH = 320;
+    constexpr int HEIGHT = 240;
+    constexpr double STALL_BUDGET_MS = 120.0; ///< Longest allowed gap between two captures (frame interval 16.7 ms)
+
+    /**
+     * @brief One static monitor; every frame carries its index in the first 8 bytes
+     *
+     * Also measures the longest gap between two captureFrame() calls, i.e.
+     * how long the capture thread was held up.
+     */
+    class StampedCapture : public IScreenCapture
+    {
+    public:
+        bool initialize() override { return true; }
+
+        bool captureFrame(FrameBuffer &buffer) override
+        {
+            if (buffer.width != WIDTH || buffer.height != HEIGHT || !buffer.data)
+            {
+                buffer.allocate(WIDTH, HEIGHT);
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            if (m_measuring.load() && m_haveLast)
+            {
+                double gapMs = std::chrono::duration<double, std::milli>(now - m_last).count();
+                m_maxGapMs.store(std::max(m_maxGapMs.load(), gapMs));
+            }
+            m_last = now;
+            m_haveLast = true;
+
+            uint64_t index = m_frames.fetch_add(1);
+            std::memset(buffer.data, static_cast<int>(index & 0x3f), static_cast<size_t>(buffer.stride) * HEIGHT);
+            std::memcpy(buffer.data, &index, sizeof(index));
+            return true;
+        }
+
+        int getWidth() const override { return WIDTH; }
+        int getHeight() const override { return HEIGHT; }
+
+        std::vector<MonitorInfo> enumerateMonitors() override
+        {
+            MonitorInfo monitor;
+            monitor.id = 0;
+            monitor.name = "Stamped";
+            monitor.width = WIDTH;
+            monitor.height = HEIGHT;
+            monitor.isPrimary = true;
+            return {monitor};
+        }
+
+        bool selectMonitor(int monitorId) override { return monitorId == 0; }
+        int getCurrentMonitor() const override { return 0; }
+        void shutdown() override {}
+
+        /**
+         * @brief Start a measurement window (captures outside it are not timed)
+         */
+        void measure(bool enabled)
+        {
+            m_maxGapMs.store(0.0);
+            m_measuring.store(enabled);
+        }
+
+        double getMaxGapMs() const { return m_maxGapMs.load(); }
+
+    private:
+        std::atomic<uint64_t> m_frames{0};
+        std::atomic<bool> m_measuring{false};
+        std::atomic<double> m_maxGapMs{0.0};
+        std::chrono::steady_clock::time_point m_last;
+        bool m_haveLast{false};
+    };
+
+    /**
+     * @brief Frame indices the simulated encoders accepted (written from the queue worker)
+     */
+    struct EncodedLog
+    {
+        std::mutex mutex;
+        std::vector<uint64_t> indices;
+
+        void add(const uint8_t *data)
+        {
+            uint64_t index = 0;
+            std::memcpy(&index, data, sizeof(index));
+            std::lock_guard<std::mutex> lock(mutex);
+            indices.push_back(index);
+        }
+
+        bool strictlyIncreasing()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return std::adjacent_find(indices.begin(), indices.end(), std::greater_equal<uint64_t>()) ==
+                   indices.end();
+        }
+
+        size_t size()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return indices.size();
+        }
+    };
+
+    struct Scenario
+    {
+        std::string name;
+        SimulatedVideoWriter::Options encoder;
+        int queueFrames = 0;
+        bool spill = false;
+        int spillMb = 64;
+        int restarts = 0;
+        double seconds = 2.0;
+    };
+
+    struct Outcome
+    {
+        double maxGapMs = 0.0;
+        bool stillRecording = false;
+        std::vector<std::string> segments;
+        size_t encodedFrames = 0;
+        bool inOrder = false;
+    };
+
+    Outcome run(const Scenario &scenario, const std::filesystem::path &workDir)
+    {
+        Logger::info("--- " + scenario.name + " ---");
+
+        StampedCapture capture;
+        ThreadSafeFrameBuffer frameBuffer;
+        frameBuffer.initialize(WIDTH, HEIGHT);
+        EncodedLog log;
+
+        CaptureThread captureThread;
+        SimulatedVideoWriter::Options encoderOptions = scenario.encoder;
+        encoderOptions.onFrame = [&log](const uint8_t *data, size_t)
+        { log.add(data); };
+        captureThread.setVideoWriterFactory([encoderOptions]
+                                            { return std::make_unique<SimulatedVideoWriter>(encoderOptions); });
+
+        CaptureSettings settings;
+        settings.monitor = 0;
+        settings.fps = FPS;
+        settings.pixelFormat = "rgb24"; // Frames reach the encoder as captured, stamp included
+        settings.encoderQueueFrames = scenario.queueFrames;
+        settings.encoderSpill = scenario.spill;
+        settings.encoderSpillMb = scenario.spillMb;
+        settings.encoderRestarts = scenario.restarts;
+        captureThread.applySettings(settings);
+
+        Outcome outcome;
+        if (!captureThread.start(&capture, &frameBuffer))
+        {
+            return outcome;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        std::string output = (workDir / (scenario.name + ".mp4")).string();
+        capture.measure(true);
+        if (captureThread.startRecording(output, FPS))
+        {
+            std::this_thread::sleep_for(std::chrono::duration<double>(scenario.seconds));
+        }
+        outcome.maxGapMs = capture.getMaxGapMs();
+        outcome.stillRecording = captureThread.isRecording();
+        capture.measure(false);
+
+        // Drains the queue and spill file into the (slow) encoder
+        captureThread.stopRecording();
+        captureThread.stop();
+
+        outcome.segments = captureThread.getSegments();
+        outcome.encodedFrames = log.size();
+        outcome.inOrder = log.strictlyIncreasing();
+        Logger::info(scenario.name + ": longest capture gap " + std::to_string(outcome.maxGapMs) + " ms, " +
+                     std::to_string(outcome.encodedFrames) + " frames encoded, " +
+                     std::to_string(outcome.segments.size()) + " segment(s)");
+        return outcome;
+    }
+
+    double stat(const Outcome &outcome, size_t segment, const std::string &section, const std::string &field)
+    {
+        if (segment >= outcome.segments.size())
+        {
+            return -1.0;
+        }
+        return readStat(RecordingStats::sidecarPath(outcome.segments[segment]), section, field);
+    }
+
+} // namespace
+
+int main()
+{
+    Logger::info("=== Encoder Fault Injection Test ===");
+
+    std::filesystem::path workDir =
+        std::filesystem::temp_directory_path() / ("nanorec_faults_" + std::to_string(processId()));
+    std::filesystem::remove_all(workDir);
+    std::filesystem::create_directories(workDir);
+
+    // 1. Reference: without a queue, an encoder stall stalls capture
+    {
+        Scenario scenario;
+        scenario.name = "sync_spikes";
+        scenario.encoder.spikeMs = 300;
+        scenario.encoder.spikeEvery = 30;
+        Outcome outcome = run(scenario, workDir);
+        check(outcome.maxGapMs >= 250.0, "synchronous writes stall capture for the spike (" +
+                                             std::to_string(outcome.maxGapMs) + " ms)");
+        check(stat(outcome, 0, "frames", "captured") > 0.0 && stat(outcome, 0, "queue", "peak_frames") == -1.0,
+              "synchronous run reports no queue");
+        check(stat(outcome, 0, "cpu_seconds", "encoder_queue_thread") == -1.0,
+              "synchronous run reports no encoder queue thread");
+    }
+
+    // 2. Spikes with a small queue in drop mode: capture keeps its rate, the queue stays at its limit
+    {
+        Scenario scenario;
+        scenario.name = "queue_drop";
+        scenario.encoder.spikeMs = 300;
+        scenario.encoder.spikeEvery = 30;
+        scenario.queueFrames = 8;
+        Outcome outcome = run(scenario, workDir);
+        check(outcome.maxGapMs < STALL_BUDGET_MS, "capture not stalled by spikes (" +
+                                                      std::to_string(outcome.maxGapMs) + " ms)");
+        check(stat(outcome, 0, "queue", "peak_frames") <= 8.0 && stat(outcome, 0, "queue", "peak_frames") > 0.0,
+              "queue bounded at 8 frames");
+        check(stat(outcome, 0, "cpu_seconds", "encoder_queue_thread") >= 0.0, "encoder queue thread CPU reported");
+        double dropped = stat(outcome, 0, "queue", "dropped");
+        check(dropped > 0.0 && stat(outcome, 0, "frames", "dropped") == dropped,
+              "frames dropped while the encoder stalls (" + std::to_string(dropped) + ")");
+        check(outcome.inOrder, "encoder received frames in order");
+        check(stat(outcome, 0, "frames", "encoded") == static_cast<double>(outcome.encodedFrames),
+              "every queued frame reached the encoder");
+    }
+
+    // 3. Encoder slower than capture, spilling: no frame lost, order kept, spill within its limit
+    {
+        Scenario scenario;
+        scenario.name = "spill";
+        scenario.encoder.throughputMBps = 10.0; // 60 FPS of 320x240 RGB needs 13.8 MB/s
+        scenario.queueFrames = 8;
+        scenario.spill = true;
+        scenario.spillMb = 64;
+        Outcome outcome = run(scenario, workDir);
+        check(outcome.maxGapMs < STALL_BUDGET_MS, "capture not stalled by the throughput cap (" +
+                                                      std::to_string(outcome.maxGapMs) + " ms)");
+        check(stat(outcome, 0, "queue", "spilled_frames") > 0.0, "backlog spilled to disk (" +
+                                                                     std::to_string(static_cast<int>(stat(
+                                                                         outcome, 0, "queue", "spilled_frames"))) +
+                                                                     " frames)");
+        check(stat(outcome, 0, "queue", "dropped") == 0.0, "no frame dropped while spilling");
+        check(outcome.inOrder && static_cast<double>(outcome.encodedFrames) == stat(outcome, 0, "frames", "captured"),
+              "every captured frame encoded in order after the spill drained");
+        check(stat(outcome, 0, "queue", "peak_spill_bytes") <= 64.0 * (1 << 20), "spill within 64 MB");
+        check(!std::filesystem::exists(outcome.segments[0] + ".spill"), "spill file removed");
+    }
+
+    // 4. Spill limit reached: drops resume instead of growing the backlog
+    {
+        Scenario scenario;
+        scenario.name = "spill_limit";
+        scenario.encoder.throughputMBps = 5.0;
+        scenario.queueFrames = 4;
+        scenario.spill = true;
+        scenario.spillMb = 1;
+        Outcome outcome = run(scenario, workDir);
+        check(outcome.maxGapMs < STALL_BUDGET_MS, "capture not stalled at the spill limit");
+        check(stat(outcome, 0, "queue", "peak_spill_bytes") <= 1 << 20, "spill backlog stays within 1 MB");
+        check(stat(outcome, 0, "queue", "dropped") > 0.0, "frames dropped once the spill is full");
+        check(outcome.inOrder, "frames still in order");
+    }
+
+    // 5. Short writes: counted, recording goes on
+    {
+        Scenario scenario;
+        scenario.name = "partial_writes";
+        scenario.encoder.partialEvery = 10;
+        scenario.queueFrames = 8;
+        Outcome outcome = run(scenario, workDir);
+        check(outcome.stillRecording, "recording survives short writes");
+        check(stat(outcome, 0, "queue", "write_failures") >= 10.0, "short writes counted (" +
+                                                                       std::to_string(static_cast<int>(stat(
+                                                                           outcome, 0, "queue", "write_failures"))) +
+                                                                       ")");
+        check(stat(outcome, 0, "queue", "encoder_lost") == 0.0, "encoder not considered lost");
+    }
+
+    // 6. Encoder exits; one restart allowed: a second segment, then the recording ends cleanly
+    {
+        Scenario scenario;
+        scenario.name = "exit_restart";
+        scenario.encoder.exitAfterFrames = 40;
+        scenario.queueFrames = 8;
+        scenario.restarts = 1;
+        scenario.seconds = 3.0;
+        Outcome outcome = run(scenario, workDir);
+        check(outcome.segments.size() == 2, "encoder restarted once in a new segment (" +
+                                                std::to_string(outcome.segments.size()) + " segments)");
+        check(!outcome.stillRecording, "recording ended after the restart budget");
+        check(outcome.maxGapMs < STALL_BUDGET_MS, "capture not stalled by the encoder exit");
+        check(stat(outcome, 0, "queue", "encoder_lost") == 1.0 && stat(outcome, 1, "queue", "encoder_lost") == 1.0,
+              "both segments report the lost encoder");
+        check(outcome.encodedFrames == 80, "each encoder took its frames before exiting (" +
+                                               std::to_string(outcome.encodedFrames) + ")");
+    }
+
+    // 7. Encoder exits on the capture thread (no queue, no restarts): recording stops, capture continues
+    {
+        Scenario scenario;
+        scenario.name = "exit_sync";
+        scenario.encoder.exitAfterFrames = 30;
+        Outcome outcome = run(scenario, workDir);
+        check(!outcome.stillRecording && outcome.segments.size() == 1, "recording stopped after the encoder exit");
+        check(outcome.maxGapMs < STALL_BUDGET_MS, "capture went on after the recording stopped");
+    }
+
+    std::filesystem::remove_all(workDir);
+    return finish("All encoder fault checks passed");
+}
@@ -0,0 +1,406 @@
+/**
+ * @file test_pipeline.cpp
+ * @brief Capture pipeline graph: spec validation, frame routing and stage placement
+ *
+ * Builds FramePipeline graphs from spec strings and runs synthetic frames
+ * through them, checking that:
+ *  - invalid specs (unknown stages, two inputs, sinks with outputs, kind
+ *    mismatches, hashing after a transform, sinks not below redact) are
+ *    rejected and the previous graph is kept;
+ *  - the default graph hands the encoder exactly what scale + convert
+ *    produce, and runs only the stages that feed a sink with demand;
+ *  - a stage drawing in place copies a frame another branch still reads;
+ *  - stripe mode fuses scale > overlay > convert and matches StripePipeline;
+ *  - expensive parallel stages move to the worker pool, cheap ones stay;
+ *  - WorkerPool runs every band, also for nested and concurrent callers;
+ *  - a branched spec saved to the config file loads back whole and builds.
+ * Needs no display and no ffmpeg.
+ *
+ * Build and run via CMake:
+ *   cd build && cmake .. && make
+ *   ./bin/tests/test_pipeline
+ */
+
+#include "core/Config.hpp"
+#include "core/FramePipeline.hpp"
+#include "core/FrameScaler.hpp"
+#include "core/Logger.hpp"
+#include "core/StripePipeline.hpp"
+#include "core/TextOverlay.hpp"
+#include "core/ThreadSafeFrameBuffer.hpp"
+#include "core/TileChangeMap.hpp"
+#include "core/WorkerPool.hpp"
+#include "core/YuvConverter.hpp"
+#include "TestSupport.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace NanoRec;
+using namespace NanoRec::Test;
+
+namespace
+{
+
+    constexpr int WIDTH = 320;
+    constexpr int HEIGHT = 240;
+
+    void fillFrame(FrameBuffer &frame, int seed)
+    {
+        frame.allocate(WIDTH, HEIGHT);
+        for (int y = 0; y < HEIGHT; ++y)
+        {
+            for (int x = 0; x < WIDTH; ++x)
+            {
+                uint8_t *pixel = frame.data + static_cast<size_t>(y) * frame.stride + x * 3;
+                pixel[0] = static_cast<uint8_t>(x * 3 + seed);
+                pixel[1] = static_cast<uint8_t>(y * 5 + x);
+                pixel[2] = static_cast<uint8_t>((x ^ y) + seed * 7);
+            }
+        }
+    }
+
+    bool sameFrame(const FrameBuffer &a, const FrameBuffer &b)
+    {
+        return a.width == b.width && a.height == b.height && std::memcmp(a.data, b.data, a.size) == 0;
+    }
+
+    /**
+     * @brief Records what reached the encoder sink
+     */
+    struct EncoderProbe
+    {
+        int frames = 0;
+        FrameKind kind = FrameKind::Rgb;
+        std::vector<uint8_t> bytes;
+
+        void attach(PipelineContext &context)
+        {
+            context.encoderSink = [this](const PipelineFrame &frame)
+            {
+                frames++;
+                kind = frame.kind;
+                if (frame.kind == FrameKind::Yuv)
+                {
+                    bytes = frame.yuv->data;
+                }
+                else
+                {
+                    bytes.assign(frame.rgb->data, frame.rgb->data + frame.rgb->size);
+                }
+            };
+        }
+    };
+
+    bool rejects(const std::string &spec, const std::string &what)
+    {
+        FramePipeline pipeline;
+        std::string error;
+        pipeline.build(FramePipeline::DEFAULT_SPEC, false, error);
+        bool rejected = !pipeline.build(spec, false, error);
+        check(rejected && pipeline.getSpec() == FramePipeline::DEFAULT_SPEC,
+              "rejects " + what + (rejected ? " (" + error + ")" : ""));
+        return rejected;
+    }
+
+    bool hasStage(const FramePipeline &pipeline, const std::string &name)
+    {
+        std::vector<FramePipeline::StageReport> reports = pipeline.getStageReports();
+        return std::any_of(reports.begin(), reports.end(),
+                           [&](const FramePipeline::StageReport &report) { return report.name == name; });
+    }
+
+    void testValidation()
+    {
+        FramePipeline pipeline;
+        std::string error;
+        check(pipeline.build(FramePipeline::DEFAULT_SPEC, false, error), "default spec builds");
+        check(pipeline.convertsForEncoder(), "default graph converts for the encoder");
+        check(pipeline.build("capture > redact > hash > encoder", false, error) && !pipeline.convertsForEncoder(),
+              "minimal graph builds and hands RGB to the encoder");
+        check(pipeline.build(" capture>redact >hash ; hash> scale>encoder;;", false, error),
+              "whitespace and empty chains are ignored");
+
+        rejects("capture > redact > hash > blur > encoder", "unknown stage");
+        rejects("redact > hash > encoder", "graph not starting at capture");
+        rejects("capture > redact > hash > encoder; scale > preview", "chain starting at an undeclared stage");
+        rejects("capture > redact > hash > scale > encoder; hash > scale", "stage with two inputs");
+        rejects("capture > redact > hash > encoder > preview", "sink with an output");
+        rejects("capture > redact > hash > convert > overlay > encoder", "YUV into an RGB stage");
+        rejects("capture > redact > hash > convert > preview > encoder", "YUV into the RGB preview");
+        rejects("capture > redact > scale > hash > encoder", "hash after a transform");
+        rejects("capture > hash > encoder; capture > redact > preview", "sink that bypasses redact");
+        rejects("capture > redact > hash > preview", "graph without an encoder");
+        rejects("capture > redact > hash > > encoder", "empty stage name");
+        rejects("", "empty spec");
+    }
+
+    void testRouting()
+    {
+        FrameBuffer source;
+        fillFrame(source, 1);
+
+        // Reference: scale + convert by hand
+        FrameBuffer scaled;
+        FrameScaler::scaleFrame(source, scaled, WIDTH / 2, HEIGHT / 2);
+        YuvFrame expected;
+        YuvConverter::convert(scaled, expected, YuvFrame::Layout::I420);
+
+        FramePipeline pipeline;
+        std::string error;
+        pipeline.build(FramePipeline::DEFAULT_SPEC, false, error);
+
+        TileChangeMap changeMap;
+        ThreadSafeFrameBuffer preview;
+        preview.initialize(WIDTH, HEIGHT);
+        EncoderProbe probe;
+        PipelineContext context;
+        probe.attach(context);
+        context.changeMap = &changeMap;
+        context.preview = &preview;
+        context.width = WIDTH / 2;
+        context.height = HEIGHT / 2;
+        context.yuvOutput = true;
+
+        // Nothing wants this frame: no stage runs
+        FrameBuffer captured;
+        fillFrame(captured, 1);
+        pipeline.run(captured, context);
+        check(probe.frames == 0 && !context.hashed && pipeline.getUpstreamUs("encoder") == 0.0,
+              "no demand runs no stage");
+
+        // Preview only: the encoder branch stays idle
+        context.previewDue = true;
+        pipeline.run(captured, context);
+        FrameBuffer shown;
+        check(preview.getLatestFrame(shown) && sameFrame(shown, source) && probe.frames == 0,
+              "preview demand reaches only the preview");
+
+        // Encoder: exactly the hand-made frame, hashed on the way
+        context.previewDue = false;
+        context.encoderWanted = true;
+        context.hashWanted = true;
+        pipeline.run(captured, context);
+        check(probe.frames == 1 && probe.kind == FrameKind::Yuv && probe.bytes == expected.data,
+              "encoder gets the scaled and converted frame");
+        check(context.hashed, "hash runs when the change map is wanted");
+        check(sameFrame(captured, source), "transforms out of place leave the captured frame alone");
+
+        // Encoded format without a YUV layout: convert passes RGB through
+        context.yuvOutput = false;
+        pipeline.run(captured, context);
+        check(probe.frames == 2 && probe.kind == FrameKind::Rgb && probe.bytes.size() == scaled.size &&
+                  std::memcmp(probe.bytes.data(), scaled.data, scaled.size) == 0,
+              "convert passes RGB through without a YUV layout");
+    }
+
+    void testCopyOnWrite()
+    {
+        FrameBuffer source;
+        fillFrame(source, 2);
+        TextOverlay overlay;
+        TextOverlay::Options options;
+        options.label = "pipeline";
+        overlay.configure(options);
+
+        ThreadSafeFrameBuffer preview;
+        preview.initialize(WIDTH, HEIGHT);
+        EncoderProbe probe;
+        PipelineContext context;
+        probe.attach(context);
+        context.preview = &preview;
+        context.overlay = &overlay;
+        context.previewDue = true;
+        context.encoderWanted = true;
+
+        // Overlay runs before the preview branch, which still needs the clean frame
+        FramePipeline pipeline;
+        std::string error;
+        check(pipeline.build("capture > redact > hash > scale > overlay > encoder; hash > preview", false, error),
+              "graph with the preview branch after the encoder branch builds");
+        FrameBuffer captured;
+        fillFrame(captured, 2);
+        pipeline.run(captured, context);
+        FrameBuffer shown;
+        check(preview.getLatestFrame(shown) && sameFrame(shown, source), "preview sees the frame without overlay");
+        check(sameFrame(captured, source), "overlay drew into a copy while the frame was shared");
+        check(probe.frames == 1 && probe.bytes.size() == source.size &&
+                  std::memcmp(probe.bytes.data(), source.data, source.size) != 0,
+              "encoder frame carries the overlay");
+
+        // Nobody reads the frame after the overlay: it draws in place, no copy
+        pipeline.build("capture > redact > hash > preview; hash > scale > overlay > encoder", false, error);
+        pipeline.run(captured, context);
+        check(preview.getLatestFrame(shown) && sameFrame(shown, source), "preview ran before the overlay");
+        check(!sameFrame(captured, source) && std::memcmp(probe.bytes.data(), captured.data, captured.size) == 0,
+              "last reader draws into the captured frame");
+    }
+
+    void testStripeFusion()
+    {
+        FrameBuffer source;
+        fillFrame(source, 3);
+
+        FramePipeline pipeline;
+        std::string error;
+        check(pipeline.build(FramePipeline::DEFAULT_SPEC, true, error) && hasStage(pipeline, "stripes") &&
+                  !hasStage(pipeline, "scale") && !hasStage(pipeline, "convert") && pipeline.convertsForEncoder(),
+              "stripe mode fuses scale > overlay > convert");
+
+        EncoderProbe probe;
+        PipelineContext context;
+        probe.attach(context);
+        context.width = WIDTH / 2;
+        context.height = HEIGHT / 2;
+        context.yuvOutput = true;
+        context.layout = YuvFrame::Layout::NV12;
+        context.stripeRows = 16;
+        context.encoderWanted = true;
+        pipeline.run(source, context);
+
+        StripePipeline stripes;
+        YuvFrame expected;
+        stripes.process(source, WIDTH / 2, HEIGHT / 2, nullptr, YuvFrame::Layout::NV12, expected, 16);
+        check(probe.frames == 1 && probe.bytes == expected.data, "fused stage matches StripePipeline");
+
+        check(pipeline.build("capture > redact > hash > scale > overlay > convert > encoder; overlay > preview", true,
+                             error) &&
+                  hasStage(pipeline, "scale") && !hasStage(pipeline, "stripes"),
+              "a branch inside the run prevents fusion");
+    }
+
+    void testPlacement()
+    {
+        FrameBuffer source;
+        fillFrame(source, 4);
+        EncoderProbe probe;
+        PipelineContext context;
+        probe.attach(context);
+        context.width = WIDTH * 2;
+        context.height = HEIGHT * 2;
+        context.yuvOutput = true;
+        context.encoderWanted = true;
+        context.maxThreads = 4;
+
+        // Budget far below the stage costs: scale and convert move to the pool (if there is one)
+        FramePipeline pipeline;
+        std::string error;
+        pipeline.build(FramePipeline::DEFAULT_SPEC, false, error);
+        context.frameBudgetUs = 1.0;
+        for (int i = 0; i < FramePipeline::MIN_SAMPLES; ++i)
+        {
+            pipeline.run(source, context);
+        }
+        bool poolAvailable = WorkerPool::shared().getThreadCount() > 0;
+        for (const FramePipeline::StageReport &report : pipeline.getStageReports())
+        {
+            if (report.name == "scale" || report.name == "convert")
+            {
+                check(report.onPool == poolAvailable,
+                      report.name + (poolAvailable ? " moved to the worker pool" : " stays inline without a pool") +
+                          " (" + std::to_string(static_cast<int>(report.costUs)) + " us)");
+            }
+            else
+            {
+                check(!report.onPool, report.name + " is not a parallel stage and stays inline");
+            }
+        }
+
+        // Generous budget: nothing is worth splitting
+        pipeline.build("capture > redact > hash > scale > convert > encoder", false, error);
+        context.frameBudgetUs = 1e9;
+        for (int i = 0; i < FramePipeline::MIN_SAMPLES * 2; ++i)
+        {
+            pipeline.run(source, context);
+        }
+        std::vector<FramePipeline::StageReport> reports = pipeline.getStageReports();
+        check(std::none_of(reports.begin(), reports.end(),
+                           [](const FramePipeline::StageReport &report) { return report.onPool; }),
+              "cheap stages stay on the capture thread");
+
+        // One thread allowed: the pool is never used
+        pipeline.build(FramePipeline::DEFAULT_SPEC, false, error);
+        context.frameBudgetUs = 1.0;
+        context.maxThreads = 1;
+        for (int i = 0; i < FramePipeline::MIN_SAMPLES * 2; ++i)
+        {
+            pipeline.run(source, context);
+        }
+        reports = pipeline.getStageReports();
+        check(std::none_of(reports.begin(), reports.end(),
+                           [](const FramePipeline::StageReport &report) { return report.onPool; }),
+              "scaler_threads = 1 keeps every stage inline");
+        check(probe.frames == FramePipeline::MIN_SAMPLES * 5, "every run reached the encoder");
+    }
+
+    void testWorkerPool()
+    {
+        WorkerPool pool(3);
+        std::vector<int> hits(64, 0);
+        pool.parallelFor(64, [&](int band) { hits[band]++; });
+        check(std::all_of(hits.begin(), hits.end(), [](int count) { return count == 1; }), "every band runs once");
+
+        // Bands that split again must not wait on workers busy with their parent
+        std::atomic<int> inner{0};
+        pool.parallelFor(4, [&](int) { pool.parallelFor(8, [&](int) { inner++; }); });
+        check(inner.load() == 32, "nested parallelFor completes");
+
+        // Two frames' worth of work submitted at once
+        std::atomic<int> total{0};
+        std::thread other([&]() { pool.parallelFor(16, [&](int) { total++; }); });
+        pool.parallelFor(16, [&](int) { total++; });
+        other.join();
+        check(total.load() == 32, "concurrent callers share the pool");
+
+        WorkerPool inlinePool(0);
+        std::thread::id caller = std::this_thread::get_id();
+        bool sameThread = true;
+        inlinePool.parallelFor(4, [&](int) { sameThread = sameThread && std::this_thread::get_id() == caller; });
+        check(sameThread, "a pool without threads runs bands on the caller");
+    }
+
+    void testConfigRoundTrip()
+    {
+        // Chains are separated by ';', which must not end the value in the config file
+        const std::string spec = "capture > redact > hash > preview; hash > scale > convert > encoder";
+        std::filesystem::path path =
+            std::filesystem::temp_directory_path() / ("nanorec_pipeline_" + std::to_string(processId()) + ".ini");
+
+        Config &config = Config::getInstance();
+        config.resetToDefaults();
+        config.getVideoConfig().pipeline = spec;
+        bool saved = config.save(path.string());
+        config.resetToDefaults();
+        bool loaded = saved && config.load(path.string());
+        std::filesystem::remove(path);
+
+        check(loaded && config.getVideoConfig().pipeline == spec,
+              "branched spec round-trips through the config file (\"" + config.getVideoConfig().pipeline + "\")");
+
+        FramePipeline pipeline;
+        std::string error;
+        check(pipeline.build(config.getVideoConfig().pipeline, false, error) && hasStage(pipeline, "encoder") &&
+                  hasStage(pipeline, "preview"),
+              "loaded branched spec builds with both sinks");
+    }
+
+} // namespace
+
+int main()
+{
+    Logger::info("=== Pipeline Graph Test ===");
+
+    testValidation();
+    testRouting();
+    testCopyOnWrite();
+    testStripeFusion();
+    testPlacement();
+    testWorkerPool();
+    testConfigRoundTrip();
+
+    return finish("All pipeline checks passed");
+}
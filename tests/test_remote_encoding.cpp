@@ -0,0 +1,231 @@
+/**
+ * @file test_remote_encoding.cpp
+ * @brief Remote encoding over loopback: node selection, backpressure and file return
+ *
+ * Starts two in-process EncoderNode instances (one session each) on
+ * ephemeral loopback ports and records through RemoteVideoWriter:
+ *  - two concurrent sessions must land on different nodes and both
+ *    encoded files must come back complete;
+ *  - a session with maxInFlight 1 fed as fast as possible must drop frames
+ *    instead of blocking, while the node still encodes one frame per
+ *    writeFrame() call (the gaps are padded with the previous frame);
+ *  - a yuv420p-input session must encode every frame;
+ *  - frames written with times must have their gaps and the time up to
+ *    the end time filled by the node.
+ * Requires ffmpeg in PATH.
+ *
+ * Build and run via CMake:
+ *   cd build && cmake .. && make
+ *   ./bin/tests/test_remote_encoding
+ */
+
+#include "core/EncoderNode.hpp"
+#include "core/Logger.hpp"
+#include "core/RemoteVideoWriter.hpp"
+#include "TestSupport.hpp"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace NanoRec;
+using namespace NanoRec::Test;
+
+namespace
+{
+
+    /**
+     * @brief Static background with a moving box, so deltas touch a few blocks per frame
+     */
+    void drawFrame(std::vector<uint8_t> &frame, const VideoConfig &config, int index)
+    {
+        frame.resize(config.inputFrameSize());
+        for (size_t i = 0; i < frame.size(); ++i)
+        {
+            frame[i] = static_cast<uint8_t>((i * 7) >> 4);
+        }
+
+        int bytesPerPixel = config.inputPixelFormat == "rgb24" ? 3 : 1; // Box drawn in luma only for YUV
+        int size = config.height / 4;
+        int x0 = (index * 8) % std::max(1, config.width - size);
+        for (int y = size; y < 2 * size; ++y)
+        {
+            uint8_t *row = frame.data() + (static_cast<size_t>(y) * config.width + x0) * bytesPerPixel;
+            std::memset(row, 255 - (index % 64), static_cast<size_t>(size) * bytesPerPixel);
+        }
+    }
+
+    VideoConfig makeConfig(const std::filesystem::path &output, const std::string &inputFormat)
+    {
+        VideoConfig config(320, 240, 30, output.string());
+        config.preset = "ultrafast";
+        config.inputPixelFormat = inputFormat;
+        return config;
+    }
+
+    bool fileComplete(const std::filesystem::path &path)
+    {
+        std::error_code ec;
+        return std::filesystem::file_size(path, ec) > 0 && !ec &&
+               !std::filesystem::exists(path.string() + ".part");
+    }
+
+} // namespace
+
+int main()
+{
+    Logger::info("=== Remote Encoding Test ===");
+
+    // A failed ffmpeg on the node must surface as a session error, not kill the test
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::filesystem::path workDir =
+        std::filesystem::temp_directory_path() / ("nanorec_remote_" + std::to_string(processId()));
+    std::filesystem::remove_all(workDir);
+    std::filesystem::create_directories(workDir / "node0");
+    std::filesystem::create_directories(workDir / "node1");
+
+    std::vector<std::unique_ptr<EncoderNode>> nodes;
+    RemoteVideoWriter::Options options;
+    for (int i = 0; i < 2; ++i)
+    {
+        EncoderNode::Options nodeOptions;
+        nodeOptions.bindAddress = "127.0.0.1";
+        nodeOptions.port = 0;
+        nodeOptions.maxSessions = 1;
+        nodeOptions.workDirectory = (workDir / ("node" + std::to_string(i))).string();
+        nodes.push_back(std::make_unique<EncoderNode>(nodeOptions));
+        if (!nodes.back()->start())
+        {
+            Logger::error("Cannot start encoder node");
+            return 1;
+        }
+        options.nodes.push_back("127.0.0.1:" + std::to_string(nodes.back()->getPort()));
+    }
+
+    // 1. Concurrent sessions spread over the nodes
+    {
+        const int frames = 60;
+        RemoteVideoWriter first(options);
+        RemoteVideoWriter second(options);
+        VideoConfig firstConfig = makeConfig(workDir / "first.mp4", "rgb24");
+        VideoConfig secondConfig = makeConfig(workDir / "second.mp4", "rgb24");
+        bool opened = first.initialize(firstConfig) && second.initialize(secondConfig);
+        check(opened, "two concurrent sessions opened");
+        check(opened && first.getNode() != second.getNode(), "concurrent sessions on different nodes");
+
+        std::vector<uint8_t> frame;
+        for (int i = 0; i < frames && opened; ++i)
+        {
+            drawFrame(frame, firstConfig, i);
+            first.writeFrame(frame.data(), frame.size());
+            second.writeFrame(frame.data(), frame.size());
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        bool finalized = opened && first.finalize() && second.finalize();
+        check(finalized, "both sessions finalized");
+        check(fileComplete(firstConfig.output) && fileComplete(secondConfig.output), "encoded files returned");
+        check(first.getEncodedFrames() == frames && second.getEncodedFrames() == frames,
+              "every frame encoded (" + std::to_string(first.getEncodedFrames()) + ", " +
+                  std::to_string(second.getEncodedFrames()) + " of " + std::to_string(frames) + ")");
+        check(first.getBytesWritten() < static_cast<uint64_t>(frames) * firstConfig.inputFrameSize() / 4,
+              "deltas send a fraction of the raw frames (" + std::to_string(first.getBytesWritten() / 1024) +
+                  " KB)");
+    }
+
+    // 2. Backpressure drops instead of blocking; the node pads the gaps
+    {
+        const int frames = 300;
+        RemoteVideoWriter::Options tight = options;
+        tight.maxInFlight = 1;
+        RemoteVideoWriter writer(tight);
+        VideoConfig config = makeConfig(workDir / "pressure.mp4", "rgb24");
+        bool opened = writer.initialize(config);
+        check(opened, "backpressure session opened");
+
+        std::vector<uint8_t> frame;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames && opened; ++i)
+        {
+            drawFrame(frame, config, i);
+            writer.writeFrame(frame.data(), frame.size());
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        check(writer.getDroppedFrames() > 0,
+              "frames dropped under backpressure (" + std::to_string(writer.getDroppedFrames()) + " of " +
+                  std::to_string(frames) + " in " + std::to_string(seconds) + " s)");
+        check(opened && writer.finalize(), "backpressure session finalized");
+        check(writer.getEncodedFrames() == frames, "dropped frames padded on the node (" +
+                                                       std::to_string(writer.getEncodedFrames()) + " encoded)");
+        check(fileComplete(config.output), "backpressure file returned");
+    }
+
+    // 3. Planar YUV input
+    {
+        const int frames = 30;
+        RemoteVideoWriter writer(options);
+        VideoConfig config = makeConfig(workDir / "yuv.mp4", "yuv420p");
+        bool opened = writer.initialize(config);
+        check(opened, "yuv420p session opened");
+
+        std::vector<uint8_t> frame;
+        for (int i = 0; i < frames && opened; ++i)
+        {
+            drawFrame(frame, config, i);
+            writer.writeFrame(frame.data(), frame.size());
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        check(opened && writer.finalize() && writer.getEncodedFrames() == frames, "yuv420p frames encoded");
+        check(fileComplete(config.output), "yuv420p file returned");
+    }
+
+    // 4. Timestamped frames: skipped slots and the end time are covered by the previous frame
+    {
+        const int64_t endPts = 45;
+        RemoteVideoWriter writer(options);
+        VideoConfig config = makeConfig(workDir / "timed.mp4", "yuv420p");
+        config.timestamps = true;
+        bool opened = writer.initialize(config);
+        check(opened, "timestamped session opened");
+
+        std::vector<uint8_t> frame;
+        for (int64_t pts : {0, 1, 2, 10, 11, 30})
+        {
+            drawFrame(frame, config, static_cast<int>(pts));
+            writer.writeFrameAt(frame.data(), frame.size(), pts);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        writer.setEndTime(endPts);
+        check(opened && writer.finalize(), "timestamped session finalized");
+        check(writer.getEncodedFrames() == static_cast<uint64_t>(endPts),
+              "timestamped gaps padded up to the end time (" + std::to_string(writer.getEncodedFrames()) +
+                  " encoded)");
+        check(fileComplete(config.output), "timestamped file returned");
+    }
+
+    // 5. No reachable node fails cleanly
+    {
+        RemoteVideoWriter::Options unreachable;
+        unreachable.nodes = {"127.0.0.1:1"};
+        unreachable.connectTimeoutMs = 500;
+        RemoteVideoWriter writer(unreachable);
+        check(!writer.initialize(makeConfig(workDir / "none.mp4", "rgb24")), "unreachable node rejected");
+    }
+
+    uint64_t completed = 0;
+    for (auto &node : nodes)
+    {
+        completed += node->getCompletedSessions();
+        node->stop();
+    }
+    check(completed == 5, "nodes completed 5 sessions");
+    check(std::filesystem::is_empty(workDir / "node0") && std::filesystem::is_empty(workDir / "node1"),
+          "node work directories cleaned up");
+
+    std::filesystem::remove_all(workDir);
+    return finish("All remote encoding checks passed");
+}
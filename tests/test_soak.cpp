@@ -0,0 +1,477 @@
+/**
+ * @file test_soak.cpp
+ * @brief Long-duration soak test of the capture and recording pipeline
+ *
+ * Drives CaptureThread, ThreadSafeFrameBuffer and FFmpegVideoWriter with a
+ * synthetic two-monitor source in accelerated mode: the capture loop runs
+ * at --rate frames per second and every 30 frames count as one simulated
+ * second, so hours of recording pass in minutes. On a simulated schedule
+ * it switches monitors (re-initializing the preview buffer like a UI
+ * would), starts and stops recordings, takes screenshots and changes the
+ * output resolution and stripe mode, while sampling RSS, open file
+ * descriptors and the per-segment stage latencies from the
+ * .stats.json sidecars.
+ *
+ * Fails if, after warm-up, RSS grows by more than --rss-limit-mb, the fd
+ * count after a stopped recording ever exceeds its first value, or the
+ * median frame latency of the last third of the recordings drifts more
+ * than 50% above the first third. Requires ffmpeg in PATH.
+ *
+ * Build and run via CMake:
+ *   cd build && cmake .. && make
+ *   ./bin/tests/test_soak [--hours 1] [--rate 1000] [--rss-limit-mb 8]
+ */
+
+#include "core/CaptureThread.hpp"
+#include "core/ImageWriter.hpp"
+#include "core/Logger.hpp"
+#include "core/RecordingStats.hpp"
+#include "core/ThreadSafeFrameBuffer.hpp"
+#include "TestSupport.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <csignal>
+#include <unistd.h>
+#endif
+
+using namespace NanoRec;
+using namespace NanoRec::Test;
+
+namespace
+{
+
+    constexpr double SIMULATED_FPS = 30.0; ///< Captured frames per simulated second
+
+    /**
+     * @brief Two fake monitors of different sizes with moving content
+     *
+     * Cheap enough that the pipeline, not the source, sets the pace.
+     */
+    class SyntheticCapture : public IScreenCapture
+    {
+    public:
+        bool initialize() override
+        {
+            m_monitors.clear();
+            m_monitors.push_back(makeMonitor(0, "Synthetic A", 0, 0, 640, 360, true));
+            m_monitors.push_back(makeMonitor(1, "Synthetic B", 640, 0, 480, 272, false));
+            return true;
+        }
+
+        bool captureFrame(FrameBuffer &buffer) override
+        {
+            const MonitorInfo &monitor = m_monitors[std::max(0, m_selected)];
+            if (buffer.width != monitor.width || buffer.height != monitor.height || !buffer.data)
+            {
+                buffer.allocate(monitor.width, monitor.height);
+            }
+
+            // Horizontal bands scrolling down plus a moving block: every frame changes a little
+            uint64_t frame = m_frames.load();
+            for (int y = 0; y < buffer.height; ++y)
+            {
+                uint8_t shade = static_cast<uint8_t>(((y + frame) / 8) * 16);
+                std::memset(buffer.data + static_cast<size_t>(y) * buffer.stride, shade,
+                            static_cast<size_t>(buffer.width) * 3);
+            }
+            int blockX = static_cast<int>(frame % static_cast<uint64_t>(buffer.width - 32));
+            for (int y = 16; y < 48 && y < buffer.height; ++y)
+            {
+                std::memset(buffer.data + static_cast<size_t>(y) * buffer.stride + blockX * 3, 255, 32 * 3);
+            }
+
+            m_frames.fetch_add(1);
+            return true;
+        }
+
+        int getWidth() const override { return m_monitors[std::max(0, m_selected)].width; }
+        int getHeight() const override { return m_monitors[std::max(0, m_selected)].height; }
+
+        std::vector<MonitorInfo> enumerateMonitors() override { return m_monitors; }
+
+        bool selectMonitor(int monitorId) override
+        {
+            if (monitorId < 0 || monitorId >= static_cast<int>(m_monitors.size()))
+            {
+                return false;
+            }
+            m_selected = monitorId;
+            return true;
+        }
+
+        int getCurrentMonitor() const override { return m_selected; }
+
+        void shutdown() override {}
+
+        uint64_t getFrameCount() const { return m_frames.load(); }
+
+    private:
+        static MonitorInfo makeMonitor(int id, const std::string &name, int x, int y, int width, int height,
+                                       bool primary)
+        {
+            MonitorInfo monitor;
+            monitor.id = id;
+            monitor.name = name;
+            monitor.x = x;
+            monitor.y = y;
+            monitor.width = width;
+            monitor.height = height;
+            monitor.isPrimary = primary;
+            return monitor;
+        }
+
+        std::vector<MonitorInfo> m_monitors;
+        int m_selected{0};
+        std::atomic<uint64_t> m_frames{0};
+    };
+
+    struct Options
+    {
+        double hours = 1.0;       ///< Simulated recording time
+        int rate = 1000;          ///< Real capture rate (frames per wall-clock second)
+        double rssLimitMb = 8.0; ///< Allowed RSS growth after warm-up
+    };
+
+    struct Sample
+    {
+        double hours;
+        long rssKb;
+        double budget;
+    };
+
+    long residentKb()
+    {
+#ifdef _WIN32
+        return -1;
+#else
+        std::ifstream statm("/proc/self/statm");
+        long sizePages = 0;
+        long residentPages = 0;
+        if (!(statm >> sizePages >> residentPages))
+        {
+            return -1;
+        }
+        return residentPages * (sysconf(_SC_PAGESIZE) / 1024);
+#endif
+    }
+
+    int openFileDescriptors()
+    {
+        std::error_code error;
+        std::filesystem::directory_iterator it("/proc/self/fd", error);
+        if (error)
+        {
+            return -1;
+        }
+        return static_cast<int>(std::distance(it, std::filesystem::directory_iterator()));
+    }
+
+    double median(std::vector<double> values)
+    {
+        if (values.empty())
+        {
+            return 0.0;
+        }
+        std::sort(values.begin(), values.end());
+        return values[values.size() / 2];
+    }
+
+    double meanRss(const std::vector<Sample> &samples, size_t begin, size_t end)
+    {
+        double sum = 0.0;
+        for (size_t i = begin; i < end; ++i)
+        {
+            sum += samples[i].rssKb;
+        }
+        return end > begin ? sum / (end - begin) : 0.0;
+    }
+
+    bool parseOptions(int argc, char **argv, Options &options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                Logger::error("Missing value for " + arg);
+                return false;
+            }
+            if (arg == "--hours")
+            {
+                options.hours = std::atof(argv[++i]);
+            }
+            else if (arg == "--rate")
+            {
+                options.rate = std::atoi(argv[++i]);
+            }
+            else if (arg == "--rss-limit-mb")
+            {
+                options.rssLimitMb = std::atof(argv[++i]);
+            }
+            else
+            {
+                Logger::error("Unknown option: " + arg);
+                return false;
+            }
+        }
+        return options.hours > 0.0 && options.rate > 0;
+    }
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Logger::info("=== Pipeline Soak Test ===");
+
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        Logger::error("Usage: test_soak [--hours H] [--rate FPS] [--rss-limit-mb MB]");
+        return 1;
+    }
+
+#ifndef _WIN32
+    // A failed ffmpeg must surface as a write error, not kill the test
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
+
+    // Per-process directory so parallel runs (e.g. a sanitizer build) don't delete each other's files
+    std::filesystem::path workDir =
+        std::filesystem::temp_directory_path() / ("nanorec_soak_" + std::to_string(processId()));
+    std::filesystem::remove_all(workDir);
+    std::filesystem::create_directories(workDir);
+
+    SyntheticCapture capture;
+    capture.initialize();
+    ThreadSafeFrameBuffer frameBuffer;
+    frameBuffer.initialize(capture.getWidth(), capture.getHeight());
+
+    CaptureThread captureThread;
+    CaptureSettings settings;
+    settings.monitor = 0;
+    settings.fps = options.rate;
+    settings.preset = "ultrafast";
+    captureThread.applySettings(settings);
+    if (!captureThread.start(&capture, &frameBuffer))
+    {
+        return 1;
+    }
+
+    // Simulated schedule (minutes); coprime periods so the actions overlap in many combinations
+    const double monitorEvery = 3.0;
+    const double screenshotEvery = 5.0;
+    const double resolutionEvery = 11.0;
+    const double recordMinutes = 20.0;
+    const double pauseMinutes = 3.0;
+
+    double nextMonitor = monitorEvery;
+    double nextScreenshot = screenshotEvery;
+    double nextResolution = resolutionEvery;
+    double nextSample = 0.0;
+    double nextRecordToggle = 0.0;
+    bool recording = false;
+    int recordingIndex = 0;
+
+    std::vector<Sample> samples;
+    std::vector<int> fdAfterStop;
+    std::vector<double> frameP50;
+    std::vector<double> frameP99;
+    int screenshots = 0;
+    int monitorSwitches = 0;
+    int failures = 0;
+    FrameBuffer screenshot;
+
+    auto wallStart = std::chrono::steady_clock::now();
+    double totalMinutes = options.hours * 60.0;
+    double lastProgress = 0.0;
+
+    for (;;)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        double minutes = capture.getFrameCount() / SIMULATED_FPS / 60.0;
+        bool finished = minutes >= totalMinutes;
+
+        if (finished || minutes >= nextRecordToggle)
+        {
+            if (recording)
+            {
+                captureThread.stopRecording();
+                recording = false;
+
+                // Collect the segments' latency reports, then delete everything the recording wrote
+                std::vector<double> p50;
+                std::vector<double> p99;
+                for (const std::string &segment : captureThread.getSegments())
+                {
+                    std::string statsPath = RecordingStats::sidecarPath(segment);
+                    double value = readStat(statsPath, "frame", "p50");
+                    if (value >= 0.0)
+                    {
+                        p50.push_back(value);
+                        p99.push_back(readStat(statsPath, "frame", "p99"));
+                    }
+                }
+                if (!p50.empty())
+                {
+                    frameP50.push_back(median(p50));
+                    frameP99.push_back(median(p99));
+                }
+                for (const auto &entry : std::filesystem::directory_iterator(workDir))
+                {
+                    std::filesystem::remove(entry.path());
+                }
+
+                fdAfterStop.push_back(openFileDescriptors());
+                nextRecordToggle = minutes + pauseMinutes;
+            }
+            else if (!finished)
+            {
+                std::string filename = (workDir / ("soak_" + std::to_string(recordingIndex++) + ".mp4")).string();
+                CaptureSettings current = captureThread.getSettings();
+                if (!captureThread.startRecording(filename, options.rate, current.targetWidth, current.targetHeight))
+                {
+                    Logger::error("Recording failed to start (is ffmpeg in PATH?)");
+                    captureThread.stop();
+                    return 1;
+                }
+                recording = true;
+                nextRecordToggle = minutes + recordMinutes;
+            }
+        }
+
+        if (finished)
+        {
+            break;
+        }
+
+        if (minutes >= nextMonitor)
+        {
+            // Like a UI that re-initializes its preview buffer for the new size
+            CaptureSettings current = captureThread.getSettings();
+            current.monitor = 1 - capture.getCurrentMonitor();
+            const MonitorInfo monitor = capture.enumerateMonitors()[current.monitor];
+            frameBuffer.initialize(monitor.width, monitor.height);
+            captureThread.applySettings(current);
+            monitorSwitches++;
+            nextMonitor += monitorEvery;
+        }
+
+        if (minutes >= nextResolution)
+        {
+            CaptureSettings current = captureThread.getSettings();
+            bool scaled = current.targetWidth != 0;
+            current.targetWidth = scaled ? 0 : 320;
+            current.targetHeight = scaled ? 0 : 180;
+            current.stripeRows = scaled ? 0 : 32;
+            captureThread.applySettings(current);
+            nextResolution += resolutionEvery;
+        }
+
+        if (minutes >= nextScreenshot)
+        {
+            if (frameBuffer.getLatestFrame(screenshot))
+            {
+                std::string path = (workDir / "screenshot.png").string();
+                if (ImageWriter::savePNG(path, screenshot))
+                {
+                    screenshots++;
+                }
+                std::filesystem::remove(path);
+            }
+            nextScreenshot += screenshotEvery;
+        }
+
+        if (minutes >= nextSample)
+        {
+            samples.push_back({minutes / 60.0, residentKb(), captureThread.getBudgetUsage()});
+            nextSample += 1.0;
+        }
+
+        if (minutes - lastProgress >= 30.0)
+        {
+            lastProgress = minutes;
+            double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+            std::printf("  %.1f / %.1f simulated hours (%.0fx), RSS %ld KB\n", minutes / 60.0, options.hours,
+                        minutes * 60.0 / std::max(wall, 1e-3), samples.empty() ? 0L : samples.back().rssKb);
+            std::fflush(stdout);
+        }
+    }
+
+    captureThread.stop();
+    std::filesystem::remove_all(workDir);
+
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    std::printf("\nSimulated %.2f h in %.0f s: %d recordings, %d monitor switches, %d screenshots\n", options.hours,
+                wallSeconds, recordingIndex, monitorSwitches, screenshots);
+
+    // RSS: warm-up is the first fifth; compare the first and last quarter of the rest
+    size_t warmup = samples.size() / 5;
+    size_t window = (samples.size() - warmup) / 4;
+    if (window > 0 && samples[warmup].rssKb >= 0)
+    {
+        double baseline = meanRss(samples, warmup, warmup + window);
+        double late = meanRss(samples, samples.size() - window, samples.size());
+        double growthMb = (late - baseline) / 1024.0;
+        bool ok = growthMb <= options.rssLimitMb;
+        std::printf("%-24s baseline %8.1f MB  late %8.1f MB  growth %+7.2f MB (limit %.1f)  %s\n", "RSS",
+                    baseline / 1024.0, late / 1024.0, growthMb, options.rssLimitMb, ok ? "ok" : "FAIL");
+        failures += ok ? 0 : 1;
+    }
+    else
+    {
+        std::printf("%-24s not enough samples (run longer)\n", "RSS");
+    }
+
+    // Descriptors with no recording open must not accumulate (pipes, sidecars, mappings)
+    if (fdAfterStop.size() >= 2 && fdAfterStop.front() >= 0)
+    {
+        int worst = *std::max_element(fdAfterStop.begin(), fdAfterStop.end());
+        bool ok = worst <= fdAfterStop.front();
+        std::printf("%-24s first %d  worst %d  last %d  %s\n", "Open fds after stop", fdAfterStop.front(), worst,
+                    fdAfterStop.back(), ok ? "ok" : "FAIL");
+        failures += ok ? 0 : 1;
+    }
+
+    // Latency drift: median frame p50 over the last third of recordings vs the first third
+    if (frameP50.size() >= 3)
+    {
+        size_t third = frameP50.size() / 3;
+        double early = median(std::vector<double>(frameP50.begin(), frameP50.begin() + third));
+        double late = median(std::vector<double>(frameP50.end() - third, frameP50.end()));
+        double earlyTail = median(std::vector<double>(frameP99.begin(), frameP99.begin() + third));
+        double lateTail = median(std::vector<double>(frameP99.end() - third, frameP99.end()));
+        bool ok = late <= early * 1.5 + 100.0;
+        std::printf("%-24s p50 %8.1f -> %8.1f us   p99 %8.1f -> %8.1f us  %s\n", "Frame latency", early, late,
+                    earlyTail, lateTail, ok ? "ok" : "FAIL");
+        failures += ok ? 0 : 1;
+    }
+    else
+    {
+        std::printf("%-24s fewer than 3 recordings (run longer)\n", "Frame latency");
+    }
+
+    double budget = samples.empty() ? 0.0 : samples.back().budget;
+    std::printf("%-24s %.2f of the accelerated frame budget at the end\n\n", "Budget usage", budget);
+
+    if (failures > 0)
+    {
+        Logger::error(std::to_string(failures) + " soak check(s) failed");
+        return 1;
+    }
+
+    Logger::info("Soak test passed");
+    return 0;
+}